@@ -0,0 +1,393 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// lyapunov-bench: checks the lyapunov coefficients of the dense polynomials
+// (hpoly) against those of the sorted lists they replaced, and times both,
+// on the weak foci in the directory systems/ next to this file.  The files
+// there are input files of lyapunov, as Maple writes them.  The list
+// version is kept here, as it was in lypcoeff.cpp, only for this purpose.
+
+#include "../lyapunov/lyapunov.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#else
+#include "../version.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// the same globals as in lyapunov, the sum tables refer to them
+bool env_maple = false;
+bool env_reduce = false;
+bool env_windows = false;
+char *win_sumtablepath = nullptr;
+
+// the reference systems, in the directory given on the command line
+static const char *sSystems[]{"focus2", "focus3", "focus9"};
+
+// default minimum duration of one measurement (seconds) and number of
+// measurements of which the median is reported
+#define BENCH_MINTIME 0.2
+#define BENCH_REPETITIONS 5
+
+static double sMinTime{BENCH_MINTIME};
+static int sRepetitions{BENCH_REPETITIONS};
+static FILE *sOutput{stdout};
+
+// -----------------------------------------------------------------------
+//                          USAGE
+// -----------------------------------------------------------------------
+
+static void usage()
+{
+    printf("lyapunov-bench Version: %s Date: %s\n%s", VERSION, VERSIONDATE,
+           "SYNTAX: lyapunov-bench [-o file] [-t seconds] [-r repetitions]\n"
+           "                      directory [system ...]\n"
+           "\tComputes the lyapunov coefficients of the weak foci in\n"
+           "\tdirectory (focus2, focus3 and focus9, or those given, read\n"
+           "\tfrom <system>.lyp) with the dense polynomials and with the\n"
+           "\tlists they replaced, on one thread, checks that they are the\n"
+           "\tsame, and times both.  The sum tables are looked up as in\n"
+           "\tlyapunov (P4_DIR/sumtables, or the current directory).\n\n"
+           "\t-o file         write the results to file (default stdout,\n"
+           "\t\twhere the messages about the sum tables go as well)\n"
+           "\t-t seconds      minimum duration of a measurement (0.2)\n"
+           "\t-r repetitions  number of measurements per benchmark (5)\n\n"
+           "\tEvery check and every benchmark writes one line of JSON:\n"
+           "\t{\"system\":..., \"check\":\"dense_vs_list\", \"orders\":...,\n"
+           "\t \"identical\":..., \"max_rel_diff\":...}\n"
+           "\t{\"system\":..., \"benchmark\":..., \"iterations\":...,\n"
+           "\t \"repetitions\":..., \"median_ns\":..., \"min_ns\":...,\n"
+           "\t \"max_ns\":...}\n"
+           "\twith the times of all coefficients of the system, in\n"
+           "\tnanoseconds.  The exit status is 1 if a check fails.\n");
+}
+
+// -----------------------------------------------------------------------
+//                          THE LIST VERSION
+// -----------------------------------------------------------------------
+
+static void diff_list(poly *f)
+{
+    poly *w = f->next_poly;
+
+    while (w != nullptr) {
+        if (w->degz) {
+            w->re *= w->degz;
+            w->im *= w->degz;
+            w->degz--;
+            f = w;
+            w = w->next_poly;
+        } else {
+            w = w->next_poly;
+            delete_coeff(f);
+        }
+    }
+}
+
+static void G_list(poly *f)
+{
+    int deg = 0;
+    double a;
+    poly *w = f->next_poly;
+
+    if (w)
+        deg = w->degz + w->degzb;
+    while (w != nullptr) {
+        if (deg - 2 * w->degzb) {
+            a = 2.0 / (deg - 2 * w->degzb);
+            w->re *= a;
+            w->im *= a;
+            f = w;
+            w = w->next_poly;
+        } else {
+            w = w->next_poly;
+            delete_coeff(f);
+        }
+    }
+}
+
+static void Imgz_list(poly *f, poly *g)
+{
+    poly *h;
+
+    prod_poly(f, g);
+    diff_list(f);
+    G_list(f);
+    h = conj_poly(f);
+    sub_poly(f, h);
+    delete_poly(&h);
+    multc_poly(f, 0.0, -0.5);
+}
+
+static void Regz_list(poly *f, poly *g)
+{
+    poly *h;
+
+    prod_poly(f, g);
+    multc_poly(f, 0.0, -1.0);
+    diff_list(f);
+    G_list(f);
+    h = conj_poly(f);
+    add_poly(f, h);
+    delete_poly(&h);
+    multc_poly(f, 0.5, 0.0);
+}
+
+static void LL_list(poly *f, poly *g, int i, double *v)
+{
+    v[0] = 0.0;
+    v[1] = 0.0;
+    prod_poly(f, g);
+    diff_list(f);
+    while ((f = f->next_poly) != nullptr) {
+        if (i > f->degz)
+            break;
+        if (i == f->degz && i > f->degzb)
+            break;
+        if (i == f->degz && i == f->degzb) {
+            v[0] = f->re;
+            v[1] = f->im;
+            break;
+        }
+    }
+}
+
+static double part_lyapunov_coeff_list(const lyapunov_job *job, char *s,
+                                       int k)
+{
+    poly *R[DIM1];
+    poly *f;
+    int i, t = 0, ok = 1, j = 0;
+    char a[DIM1];
+    double v[2], w;
+
+    for (i = 0; s[i]; i++) {
+        if (s[i] == ',') {
+            a[j] = 0;
+            R[t] = find_poly(job->vec_field, atoi(a) + 1);
+            if (R[t] == nullptr) {
+                ok = 0;
+                break;
+            }
+            t++;
+            j = 0;
+        } else {
+            a[j] = s[i];
+            j++;
+        }
+    }
+    if (ok) {
+        a[j] = 0;
+        R[t] = find_poly(job->vec_field, atoi(a) + 1);
+        if (R[t] == nullptr)
+            ok = 0;
+    }
+    if (ok) {
+        f = new poly;
+        f->next_poly = nullptr;
+        ins_poly(f, 0, 0, -1.0, 0.0); /* f=-1 */
+        for (i = 0; i < t; i++) {
+            if (i % 2)
+                Regz_list(f, R[i]);
+            else
+                Imgz_list(f, R[i]);
+        }
+        if (t % 2) {
+            multc_poly(f, 0.0, -1.0);
+            LL_list(f, R[t], (k - 1) / 2, v);
+            w = v[1];
+        } else {
+            LL_list(f, R[t], (k - 1) / 2, v);
+            w = v[0];
+        }
+        delete_poly(&f);
+    } else
+        w = 0.0;
+    return w;
+}
+
+// as lyapunov_coeff on one thread, with the same summation
+static double lyapunov_coeff_list(const lyapunov_job *job, int k)
+{
+    const std::vector<std::string> &table = sum_table(k - 1);
+    char buf[DIM2];
+    size_t i;
+    double V = 0.0, c = 0.0, y, t;
+
+    for (i = 0; i < table.size(); i++) {
+        strcpy(buf, table[i].c_str());
+        y = -part_lyapunov_coeff_list(job, buf, k) - c;
+        t = V + y;
+        c = (t - V) - y;
+        V = t;
+    }
+    return V;
+}
+
+static void run_job_list(lyapunov_job *job)
+{
+    int k;
+    double V;
+
+    job->V.clear();
+    job->order = 0;
+    for (k = 1; k <= job->weakness_level; k++) {
+        V = lyapunov_coeff_list(job, 2 * k + 1);
+        job->V.push_back(V);
+        if (fabs(V) >= job->precision) {
+            job->order = k;
+            break;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+//                          TIMING
+// -----------------------------------------------------------------------
+
+template <typename OP> static double timeOps(OP &op, unsigned long n)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < n; i++)
+        op();
+    std::chrono::duration<double> t{std::chrono::steady_clock::now() - t0};
+    return t.count();
+}
+
+// as in p4-bench
+template <typename OP>
+static void bench(const char *system, const char *name, OP op)
+{
+    unsigned long n{1};
+    double t;
+    while ((t = timeOps(op, n)) < sMinTime) {
+        if (t < sMinTime / 16)
+            n *= 16;
+        else
+            n = static_cast<unsigned long>(n * 1.2 * sMinTime / t) + 1;
+    }
+
+    std::vector<double> ns;
+    for (int k = 0; k < sRepetitions; k++)
+        ns.push_back(timeOps(op, n) * 1e9 / n);
+    std::sort(ns.begin(), ns.end());
+
+    fprintf(sOutput,
+            "{\"system\":\"%s\",\"benchmark\":\"%s\",\"iterations\":%lu,"
+            "\"repetitions\":%d,\"median_ns\":%.2f,\"min_ns\":%.2f,"
+            "\"max_ns\":%.2f}\n",
+            system, name, n, sRepetitions, ns[ns.size() / 2], ns.front(),
+            ns.back());
+    fflush(sOutput);
+}
+
+// -----------------------------------------------------------------------
+//                          SYSTEMS
+// -----------------------------------------------------------------------
+
+static bool benchSystem(const char *dir, const char *system)
+{
+    std::string file{std::string{dir} + "/" + system + ".lyp"};
+    lyapunov_job dense, list;
+    size_t k;
+    double d, rel = 0.0;
+    bool identical;
+
+    read_table(file.c_str(), &dense);
+    read_table(file.c_str(), &list);
+
+    // the sum tables are read here, before any timing
+    run_job(&dense, 1);
+    run_job_list(&list);
+
+    identical = dense.V.size() == list.V.size() && dense.order == list.order;
+    for (k = 0; identical && k < dense.V.size(); k++) {
+        if (dense.V[k] != list.V[k]) {
+            identical = false;
+            d = fabs(dense.V[k] - list.V[k]);
+            if (list.V[k] != 0.0)
+                d /= fabs(list.V[k]);
+            rel = std::max(rel, d);
+        }
+    }
+    fprintf(sOutput,
+            "{\"system\":\"%s\",\"check\":\"dense_vs_list\",\"orders\":%d,"
+            "\"identical\":%s,\"max_rel_diff\":%g}\n",
+            system, (int)list.V.size(), identical ? "true" : "false", rel);
+    fflush(sOutput);
+
+    bench(system, "lyapunov_coeff_dense", [&]() { run_job(&dense, 1); });
+    bench(system, "lyapunov_coeff_list", [&]() { run_job_list(&list); });
+    return identical;
+}
+
+// -----------------------------------------------------------------------
+//                          MAIN
+// -----------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    int returnvalue{0};
+    int i;
+
+    for (i = 1; i < argc - 1 && argv[i][0] == '-'; i += 2) {
+        if (!strcmp(argv[i], "-o")) {
+            sOutput = fopen(argv[i + 1], "w");
+            if (sOutput == nullptr) {
+                fprintf(stderr, "Cannot write %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-t")) {
+            sMinTime = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-r")) {
+            sRepetitions = atoi(argv[i + 1]);
+        } else {
+            break;
+        }
+    }
+    if (i >= argc || argv[i][0] == '-' || sMinTime <= 0 || sRepetitions < 1) {
+        usage();
+        return -1;
+    }
+
+    const char *dir{argv[i++]};
+    if (i == argc) {
+        for (auto system : sSystems)
+            if (!benchSystem(dir, system))
+                returnvalue = 1;
+    } else {
+        for (; i < argc; i++)
+            if (!benchSystem(dir, argv[i]))
+                returnvalue = 1;
+    }
+
+    if (sOutput != stdout)
+        fclose(sOutput);
+    return returnvalue;
+}
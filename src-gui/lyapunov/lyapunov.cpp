@@ -54,16 +54,30 @@
  *
  *      Optionally use path to load&store sum tables.
  *      if not present, using current working directory.
+ *
+ *  LYAPUNOV    -batch batchfile outputfile [MAPLE [WINDOWS [path]]]
+ *  --> work in batch mode
+ *
+ *      The batch file holds a number of jobs, followed by that many
+ *      input files one after the other.  The jobs are run in parallel,
+ *      sharing the sum tables, and the output file holds the outputs of
+ *      all jobs in order, each as a single run would write it.
+ *
+ *  The environment variable P4_LYAPUNOV_THREADS limits the number of
+ *  threads used to sum the lyapunov coefficients.  By default, all
+ *  available cores are used.
+ *
+ *  When the rounding errors could change the sign of a coefficient, or
+ *  whether it is negligible, the same arguments are passed on to
+ *  lyapunov_mpf (next to this program), which certifies the coefficients
+ *  with interval arithmetic and writes the output file instead.
  */
 
 // initialise lyapunov.h global variables
 bool env_maple = false;
 bool env_reduce = false;
 bool env_windows = false;
-int weakness_level = 0;
-double precision = 0.0;
 char *win_sumtablepath = nullptr;
-struct hom_poly volatile *vec_field = nullptr;
 
 // --------------------------------------------------------------------------
 //                      REMOVEQUOTES
@@ -102,23 +116,105 @@ char *AddTrailingSlash(char *buf, char s)
     return buf;
 }
 
+// --------------------------------------------------------------------------
+//                      WRITE_RESULT
+// --------------------------------------------------------------------------
+
+void write_result(FILE *fp2, lyapunov_job *job)
+{
+    size_t k;
+
+    if (env_reduce) {
+        fprintf(fp2, "off echo$\n");
+        fprintf(fp2, "openfile(result_file)$\n");
+        fprintf(fp2, "write$\n");
+    }
+
+    for (k = 1; k <= job->V.size(); k++) {
+        if (env_reduce)
+            fprintf(fp2, "write \"V(%d)=%e\"$\n", (int)(2 * k + 1),
+                    job->V[k - 1]);
+
+        if (env_maple)
+            fprintf(fp2, "%d\n%e\n", (int)(2 * k + 1), job->V[k - 1]);
+    }
+    if (job->order != 0 && env_maple)
+        fprintf(fp2, "-1\n");
+
+    if (env_reduce) {
+        fprintf(fp2, "out 't$\n");
+        if (job->order != 0)
+            fprintf(fp2, "w:=%d$\n lyp:=%e$\n", job->order,
+                    job->V[job->order - 1]);
+        else
+            fprintf(fp2, "lyp:=0$\n");
+    }
+
+    if (env_maple) {
+        if (job->order != 0)
+            fprintf(fp2, "1\n%d\n%e\n", job->order, job->V[job->order - 1]);
+        else
+            fprintf(fp2, "0\n0\n0\n");
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      CERTIFY
+// --------------------------------------------------------------------------
+//
+// runs lyapunov_mpf, from the directory of this program, with the given
+// arguments; returns true if it succeeded
+
+bool certify(int argc, char *argv[])
+{
+    std::string cmd;
+    const char *name;
+    int i;
+
+    name = argv[0];
+    for (i = 0; argv[0][i]; i++)
+        if (argv[0][i] == '/' || argv[0][i] == '\\')
+            name = argv[0] + i + 1;
+    cmd = "\"";
+    cmd.append(argv[0], name - argv[0]);
+    cmd += env_windows ? "lyapunov_mpf.exe\"" : "lyapunov_mpf\"";
+    for (i = 1; i < argc; i++) {
+        cmd += " \"";
+        cmd += RemoveQuotes(argv[i]);
+        cmd += "\"";
+    }
+    if (env_windows)
+        cmd = "\"" + cmd + "\"";
+
+    fflush(stdout);
+    return system(cmd.c_str()) == 0;
+}
+
 // --------------------------------------------------------------------------
 //                      MAIN
 // --------------------------------------------------------------------------
 
 int main(int argc, char *argv[])
 {
-    double V;
-    int k, ok = 0;
-    char file_name[220], s[DIM2];
+    std::vector<lyapunov_job> jobs;
+    size_t j, k;
+    bool batch = false;
     static char wstpbuf[256];
-    FILE *fp, *fp2;
+    FILE *fp2;
+    char **args = argv;
+    int nargs = argc;
 
     env_reduce = true;
     env_maple = false;
     env_windows = false;
     win_sumtablepath = nullptr;
 
+    if (argc >= 2 && !strcmp(argv[1], "-batch")) {
+        batch = true;
+        argv++;
+        argc--;
+    }
+
     if (argc <= 1) {
         printf(
             "Lyapunov Version: %s Date: %s\n%s", VERSION, VERSIONDATE,
@@ -142,7 +238,18 @@ int main(int argc, char *argv[])
             "SYNTAX: lyapunov inputfile outputfile MAPLE WINDOWS [path]\n"
             "\t--> work in maple/windows mode\n"
             "\toptionally use path to load&store sum tables.\n"
-            "\tIf not present, using current working directory.\n");
+            "\tIf not present, using current working directory.\n"
+            "\n"
+            "SYNTAX: lyapunov -batch batchfile outputfile [MAPLE ...]\n"
+            "\t--> work in batch mode\n"
+            "\tThe batch file holds the number of jobs, followed by that\n"
+            "\tmany input files.  The output file holds the outputs of all\n"
+            "\tjobs, in the same order.\n"
+            "\n"
+            "The environment variable P4_LYAPUNOV_THREADS limits the number\n"
+            "of threads used (default: all available cores).\n"
+            "When the sign of a coefficient is in doubt, lyapunov_mpf is\n"
+            "run with the same arguments to certify it.\n");
         exit(-3);
     }
 
@@ -169,71 +276,52 @@ int main(int argc, char *argv[])
             }
         }
     }
-    read_table(RemoveQuotes(argv[1])); // read in precision and vector field
+
+    // read in precision and vector field
+    if (batch) {
+        read_batch(RemoveQuotes(argv[1]), &jobs);
+    } else {
+        jobs.resize(1);
+        read_table(RemoveQuotes(argv[1]), &jobs[0]);
+    }
 
     fp2 = fopen(RemoveQuotes(argv[2]), "w");
     if (fp2 == nullptr)
         exit(-4);
 
-    if (env_reduce) {
-        fprintf(fp2, "off echo$\n");
-        fprintf(fp2, "openfile(result_file)$\n");
-        fprintf(fp2, "write$\n");
-    }
-
-    for (k = 1; k <= weakness_level; k++) {
-        check_sum(file_name, 2 * k);
-
-        // check if table for the decomposition of 2*k exist, if not create it
-
-        fp = fopen(file_name, "r");
-        if (fp == nullptr) {
-            perror(file_name);
-            exit(-3);
-        }
-
-        V = 0.0; // V is the lyapunov coeff that we want to calculate
-        while (!feof(fp)) {
-            if (fscanf(fp, "%s", s) != 1)
-                break;
-            if (!feof(fp)) {
-                V -= part_lyapunov_coeff(s, 2 * k + 1);
-            }
-        }
-        fclose(fp);
-        // V*=2.0*PI/(k+1);
-
-        printf("k=%d V=%20.19f, precision=%20.19f\n", k, V, precision);
-
-        if (env_reduce)
-            fprintf(fp2, "write \"V(%d)=%e\"$\n", 2 * k + 1, V);
-
-        if (env_maple)
-            fprintf(fp2, "%d\n%e\n", 2 * k + 1, V);
-
-        if (fabs(V) >= precision) {
-            ok = 1;
-            if (env_maple)
-                fprintf(fp2, "-1\n");
+    if (batch)
+        run_batch(&jobs);
+    else
+        run_job(&jobs[0], lyapunov_threads());
+
+    for (j = 0; j < jobs.size(); j++) {
+        if (jobs[j].doubt != 0) {
+            if (batch)
+                printf("job %d: ", (int)j + 1);
+            printf("the sign of V(%d) is in doubt, certifying it with "
+                   "lyapunov_mpf\n",
+                   2 * jobs[j].doubt + 1);
             break;
         }
     }
-
-    // write the result to a file
-
-    if (env_reduce) {
-        fprintf(fp2, "out 't$\n");
-        if (ok)
-            fprintf(fp2, "w:=%d$\n lyp:=%e$\n", k, V);
-        else
-            fprintf(fp2, "lyp:=0$\n");
+    if (j < jobs.size()) {
+        fclose(fp2);
+        if (certify(nargs, args))
+            return 0;
+        printf("lyapunov_mpf failed, keeping the double precision results\n");
+        fp2 = fopen(RemoveQuotes(argv[2]), "w");
+        if (fp2 == nullptr)
+            exit(-4);
     }
 
-    if (env_maple) {
-        if (ok)
-            fprintf(fp2, "1\n%d\n%e\n", k, V);
-        else
-            fprintf(fp2, "0\n0\n0\n");
+    for (j = 0; j < jobs.size(); j++) {
+        for (k = 1; k <= jobs[j].V.size(); k++) {
+            if (batch)
+                printf("job %d: ", (int)j + 1);
+            printf("k=%d V=%20.19f, precision=%20.19f\n", (int)k,
+                   jobs[j].V[k - 1], jobs[j].precision);
+        }
+        write_result(fp2, &jobs[j]);
     }
 
     fclose(fp2);
@@ -20,6 +20,11 @@
 #ifndef LYAPUNOV_H
 #define LYAPUNOV_H
 
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
 // definitions
 
 #define DIM 100
@@ -27,6 +32,12 @@
 #define DIM2 (2 * DIM)
 #define PI 3.1415926535897932384626433832
 
+// The rounding error of a coefficient is estimated as this many machine
+// epsilons times the sum of the absolute values of its contributions (see
+// lyapunov_coeff).  It is meant to be pessimistic: a coefficient that may
+// be wrong in sign is then handed to lyapunov_mpf, which certifies it.
+#define LYAPUNOV_DOUBT 1.0e4
+
 // structures
 
 struct poly {
@@ -41,42 +52,80 @@ struct hom_poly {
     hom_poly *next_hom_poly;
 };
 
+// Dense homogeneous polynomial: the coefficient of z^(degree-k) zb^k is
+// stored at index k.  All polynomials met in part_lyapunov_coeff are
+// homogeneous, so one row of degree+1 coefficients replaces the sorted
+// list there.  A negative degree is the zero polynomial.
+
+struct hpoly {
+    int degree;
+    int size; // allocated coefficients
+    double *re, *im;
+};
+
+// One weak focus, as read from an input file, together with the
+// coefficients computed for it.  A batch run holds one job per focus.
+
+struct lyapunov_job {
+    int weakness_level;
+    double precision;
+    hom_poly *vec_field;
+    hpoly **hvec_field; // dense copy of vec_field, indexed by total degree
+    int hvec_field_degree;
+
+    std::vector<double> V; // V[k-1] is the coefficient of order 2k+1
+    int order;             // k with |V[k-1]| >= precision, 0 if none
+    int doubt;             // first k whose V[k-1] is in doubt, 0 if none
+};
+
 // variables
 
 extern bool env_maple;
 extern bool env_reduce;
 extern bool env_windows;
-extern int weakness_level;
-extern double precision;
 extern char *win_sumtablepath;
-extern hom_poly volatile *vec_field;
 
 // prototypes
 
 void create_sum(int);
 void check_sum(char *, int);
-void read_table(const char *);
-void ins_hom_poly(hom_poly volatile *, int, int, double, double);
-void ins_poly(poly volatile *, int, int, double, double);
-poly volatile *copy_poly(poly volatile *);
-poly volatile *search_poly(poly volatile *, int, int, int *);
-void ins_coeff(poly volatile *, int, int, double, double);
-void delete_coeff(poly volatile *);
-void add_poly(poly volatile *, poly volatile *);
-void sub_poly(poly volatile *, poly volatile *);
-void term_prod(poly volatile *, int, int, double, double);
-void prod_poly(poly volatile *, poly volatile *);
-void multc_poly(poly volatile *, double, double);
-void delete_poly(poly volatile **);
-poly volatile *conj_poly(poly volatile *);
-void print_poly(poly volatile *);
-void read_poly(poly volatile *);
-poly volatile *find_poly(hom_poly volatile *, int);
-void diff(poly volatile *);
-void G(poly volatile *);
-void Imgz(poly volatile *, poly volatile *);
-void Regz(poly volatile *, poly volatile *);
-void LL(poly volatile *, poly volatile *, int, double *);
-double part_lyapunov_coeff(char *, int);
+void read_table(const char *, lyapunov_job *);
+void read_job(FILE *, const char *, lyapunov_job *);
+void read_batch(const char *, std::vector<lyapunov_job> *);
+void ins_hom_poly(hom_poly *, int, int, double, double);
+void ins_poly(poly *, int, int, double, double);
+poly *copy_poly(poly *);
+poly *search_poly(poly *, int, int, int *);
+void ins_coeff(poly *, int, int, double, double);
+void delete_coeff(poly *);
+void add_poly(poly *, poly *);
+void sub_poly(poly *, poly *);
+void term_prod(poly *, int, int, double, double);
+void prod_poly(poly *, poly *);
+void multc_poly(poly *, double, double);
+void delete_poly(poly **);
+poly *conj_poly(poly *);
+void print_poly(poly *);
+void read_poly(poly *);
+poly *find_poly(hom_poly *, int);
+void init_hpoly(hpoly *, int);
+void set_hpoly_degree(hpoly *, int);
+void clear_hpoly(hpoly *);
+void poly_to_hpoly(hpoly *, poly *, int);
+void prod_hpoly(hpoly *, hpoly *, hpoly *);
+void multc_hpoly(hpoly *, double, double);
+void make_hvec_field(lyapunov_job *);
+hpoly *find_hpoly(const lyapunov_job *, int);
+void diff(hpoly *);
+void G(hpoly *);
+void Imgz(hpoly *, hpoly *, hpoly *);
+void Regz(hpoly *, hpoly *, hpoly *);
+void LL(hpoly *, hpoly *, hpoly *, int, double *);
+double part_lyapunov_coeff(const lyapunov_job *, char *, int);
+int lyapunov_threads(void);
+const std::vector<std::string> &sum_table(int);
+double lyapunov_coeff(const lyapunov_job *, int, int, double *);
+void run_job(lyapunov_job *, int);
+void run_batch(std::vector<lyapunov_job> *);
 
 #endif // LYAPUNOV_H
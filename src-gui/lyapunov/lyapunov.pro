@@ -23,7 +23,7 @@
 include(../../P4.pri)
 DESTDIR = $$BUILD_DIR/lyapunov/
 
-CONFIG +=  console c++11
+CONFIG +=  console c++11 thread
 macx {
     CONFIG -= app_bundle
     QMAKE_LFLAGS += -L/usr/local/opt/qt/lib
@@ -18,12 +18,20 @@
  */
 
 #include "lyapunov.h"
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-void DEBUG_MONOME(poly volatile *f)
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+void DEBUG_MONOME(poly *f)
 {
     if (f->degz + f->degzb != 0)
         if (fabs(f->re) > 1e-10 && fabs(f->im) > 1e-10)
@@ -57,7 +65,7 @@ void DEBUG_MONOME(poly volatile *f)
     }
 }
 
-void DEBUG_POLY(poly volatile *f)
+void DEBUG_POLY(poly *f)
 {
     if (f->next_poly == nullptr)
         fprintf(stderr, "0");
@@ -74,7 +82,7 @@ void DEBUG_POLY(poly volatile *f)
 //                      FIND_POLY
 // --------------------------------------------------------------------------
 
-poly volatile *find_poly(hom_poly volatile *f, int i)
+poly *find_poly(hom_poly *f, int i)
 {
     poly *g = nullptr;
 
@@ -88,50 +96,51 @@ poly volatile *find_poly(hom_poly volatile *f, int i)
     return (g);
 }
 
+// --------------------------------------------------------------------------
+//                      FIND_HPOLY
+// --------------------------------------------------------------------------
+//
+// dense version of find_poly(job->vec_field, i)
+
+hpoly *find_hpoly(const lyapunov_job *job, int i)
+{
+    if (i < 0 || i > job->hvec_field_degree)
+        return nullptr;
+    return job->hvec_field[i];
+}
+
 // --------------------------------------------------------------------------
 //                      DIFF
 // --------------------------------------------------------------------------
 
-void diff(poly volatile *f)
+void diff(hpoly *f)
 {
-    poly *w = f->next_poly;
-
-    while (w != nullptr) {
-        if (w->degz) {
-            w->re *= w->degz;
-            w->im *= w->degz;
-            w->degz--;
-            f = w;
-            w = w->next_poly;
-        } else {
-            w = w->next_poly;
-            delete_coeff(f);
-        }
+    int k;
+
+    for (k = 0; k < f->degree; k++) {
+        f->re[k] *= f->degree - k;
+        f->im[k] *= f->degree - k;
     }
+    f->degree--;
 }
 
 // --------------------------------------------------------------------------
 //                      G
 // --------------------------------------------------------------------------
 
-void G(poly volatile *f)
+void G(hpoly *f)
 {
-    int deg;
+    int k, deg = f->degree;
     double a;
-    poly *w = f->next_poly;
-
-    if (w)
-        deg = w->degz + w->degzb;
-    while (w != nullptr) {
-        if (deg - 2 * w->degzb) {
-            a = 2.0 / (deg - 2 * w->degzb);
-            w->re *= a;
-            w->im *= a;
-            f = w;
-            w = w->next_poly;
+
+    for (k = 0; k <= deg; k++) {
+        if (deg - 2 * k) {
+            a = 2.0 / (deg - 2 * k);
+            f->re[k] *= a;
+            f->im[k] *= a;
         } else {
-            w = w->next_poly;
-            delete_coeff(f);
+            f->re[k] = 0.0;
+            f->im[k] = 0.0;
         }
     }
 }
@@ -139,58 +148,65 @@ void G(poly volatile *f)
 // --------------------------------------------------------------------------
 //                      IMGZ
 // --------------------------------------------------------------------------
+//
+// h is scratch space
 
-void Imgz(poly volatile *f, poly volatile *g)
+void Imgz(hpoly *f, hpoly *g, hpoly *h)
 {
-    poly volatile *h;
-
-    prod_poly(f, g);
-    diff(f);
-    G(f);
-    h = conj_poly(f);
-    sub_poly(f, h);
-    delete_poly(&h);
-    multc_poly(f, 0.0, -0.5);
+    int k, d;
+
+    prod_hpoly(h, f, g);
+    diff(h);
+    G(h);
+    d = h->degree;
+    set_hpoly_degree(f, d);
+    for (k = 0; k <= d; k++) {
+        // f = h - conj(h)
+        f->re[k] = h->re[k] - h->re[d - k];
+        f->im[k] = h->im[k] + h->im[d - k];
+    }
+    multc_hpoly(f, 0.0, -0.5);
 }
 
 // --------------------------------------------------------------------------
 //                      REGZ
 // --------------------------------------------------------------------------
+//
+// h is scratch space
 
-void Regz(poly volatile *f, poly volatile *g)
+void Regz(hpoly *f, hpoly *g, hpoly *h)
 {
-    poly volatile *h;
-
-    prod_poly(f, g);
-    multc_poly(f, 0.0, -1.0);
-    diff(f);
-    G(f);
-    h = conj_poly(f);
-    add_poly(f, h);
-    delete_poly(&h);
-    multc_poly(f, 0.5, 0.0);
+    int k, d;
+
+    prod_hpoly(h, f, g);
+    multc_hpoly(h, 0.0, -1.0);
+    diff(h);
+    G(h);
+    d = h->degree;
+    set_hpoly_degree(f, d);
+    for (k = 0; k <= d; k++) {
+        // f = h + conj(h)
+        f->re[k] = h->re[k] + h->re[d - k];
+        f->im[k] = h->im[k] - h->im[d - k];
+    }
+    multc_hpoly(f, 0.5, 0.0);
 }
 
 // --------------------------------------------------------------------------
 //                      LL
 // --------------------------------------------------------------------------
+//
+// coefficient of (z*zb)^i in d/dz (f*g); h is scratch space
 
-void LL(poly volatile *f, poly volatile *g, int i, double *v)
+void LL(hpoly *f, hpoly *g, hpoly *h, int i, double *v)
 {
     v[0] = 0.0;
     v[1] = 0.0;
-    prod_poly(f, g);
-    diff(f);
-    while ((f = f->next_poly) != nullptr) {
-        if (i > f->degz)
-            break;
-        if (i == f->degz && i > f->degzb)
-            break;
-        if (i == f->degz && i == f->degzb) {
-            v[0] = f->re;
-            v[1] = f->im;
-            break;
-        }
+    prod_hpoly(h, f, g);
+    diff(h);
+    if (h->degree == 2 * i) {
+        v[0] = h->re[i];
+        v[1] = h->im[i];
     }
 }
 
@@ -198,20 +214,19 @@ void LL(poly volatile *f, poly volatile *g, int i, double *v)
 //                      PART_LYAPUNOV_COEFF
 // --------------------------------------------------------------------------
 
-double part_lyapunov_coeff(char *s, int k)
+double part_lyapunov_coeff(const lyapunov_job *job, char *s, int k)
 {
-    poly volatile *R[DIM1];
-    poly volatile *f = nullptr;
+    hpoly *R[DIM1];
+    hpoly f, h;
     int i, t = 0, ok = 1, j = 0;
     char a[DIM1];
     double v[2], w;
 
-    // fprintf(stderr,"k=%d\n",k);
     for (i = 0; s[i]; i++) {
         if (s[i] == ',') {
-            R[t] =
-                find_poly(vec_field, atoi(a) + 1); /* find the homogeneus part
-                                                      of degree a+1 */
+            a[j] = 0;
+            R[t] = find_hpoly(job, atoi(a) + 1); /* find the homogeneus
+                                                    part of degree a+1 */
             if (R[t] == nullptr) {
                 ok = 0;
                 break;
@@ -224,70 +239,223 @@ double part_lyapunov_coeff(char *s, int k)
         }
     }
     if (ok) {
-        R[t] = find_poly(vec_field, atoi(a) + 1);
+        a[j] = 0;
+        R[t] = find_hpoly(job, atoi(a) + 1);
         if (R[t] == nullptr)
             ok = 0;
     }
     if (ok) {
-        // fprintf(stderr, "k=%d\n", k);
-
-        // for( i = 0; i <= t; i++ )
-        //{
-        // fprintf(stderr, "R[%d] = ",i);
-        // DEBUG_POLY(R[i]);
-        // fprintf(stderr, "\n");
-        //}
-
-        f = (poly *)malloc(sizeof(poly));
-        f->next_poly = nullptr;
-        // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-        // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-        ins_poly(f, 0, 0, -1.0, 0.0); /* f=-1 */
-        // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-        // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-        // fprintf(stderr, "f = ");        DEBUG_POLY(f);        fprintf(stderr,
-        // "\n");
+        init_hpoly(&f, 0);
+        init_hpoly(&h, -1);
+        f.re[0] = -1.0; /* f=-1 */
         for (i = 0; i < t; i++) {
-            // fprintf(stderr, "t=%d\n",t);
-            // fprintf(stderr, "f%d = ",i);        DEBUG_POLY(f);
-            // fprintf(stderr, "\n");
-            if (i % 2) {
-                Regz(f, R[i]);
-                // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-                // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-            } else {
-                Imgz(f, R[i]);
-                // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-                // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-            }
-            // fprintf(stderr, "f%d = ",i);        DEBUG_POLY(f);
-            // fprintf(stderr, "\n");
+            if (i % 2)
+                Regz(&f, R[i], &h);
+            else
+                Imgz(&f, R[i], &h);
         }
         if (t % 2) {
-            multc_poly(f, 0.0, -1.0);
-            // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-            // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-            LL(f, R[t], (k - 1) / 2, v);
-            // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-            // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-            // fprintf(stderr, "f%d = ",i);        DEBUG_POLY(f);
-            // fprintf(stderr, "\n");
+            multc_hpoly(&f, 0.0, -1.0);
+            LL(&f, R[t], &h, (k - 1) / 2, v);
             w = v[1];
         } else {
-            LL(f, R[t], (k - 1) / 2, v);
-            // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-            // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-            // fprintf(stderr, "f%d = ",i);        DEBUG_POLY(f);
-            // fprintf(stderr, "\n");
+            LL(&f, R[t], &h, (k - 1) / 2, v);
             w = v[0];
         }
-        // fprintf(stderr, "f%d = ",i);        DEBUG_POLY(f);
-        // fprintf(stderr, "\n");
-        // fprintf(stderr,"degz:%d,degzb:%d, re:%g, im:%g,
-        // next:%d\n",f->degz,f->degzb,f->re,f->im,f->next_poly);
-        delete_poly(&f);
+        clear_hpoly(&f);
+        clear_hpoly(&h);
     } else
         w = 0.0;
-    // printf( "w = %f\n", w);
     return w;
 }
+
+// --------------------------------------------------------------------------
+//                      LYAPUNOV_THREADS
+// --------------------------------------------------------------------------
+//
+// number of worker threads: P4_LYAPUNOV_THREADS if set, otherwise the
+// number of available cores.
+
+int lyapunov_threads(void)
+{
+    int n = 0;
+
+    if (getenv("P4_LYAPUNOV_THREADS") != nullptr)
+        n = atoi(getenv("P4_LYAPUNOV_THREADS"));
+    if (n <= 0)
+        n = (int)std::thread::hardware_concurrency();
+    if (n <= 0)
+        n = 1;
+    return n;
+}
+
+// --------------------------------------------------------------------------
+//                      SUM_TABLE
+// --------------------------------------------------------------------------
+//
+// The compositions of n, as listed in the sum table sum<n>.tab.  Each table
+// is checked (or created) and read only once per run, and then shared by
+// all jobs, so this may be called from several threads.
+
+const std::vector<std::string> &sum_table(int n)
+{
+    static std::map<int, std::vector<std::string>> tables;
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    std::map<int, std::vector<std::string>>::iterator it;
+    std::vector<std::string> *table;
+    FILE *fp;
+    char file_name[220];
+    char s[DIM2];
+
+    it = tables.find(n);
+    if (it != tables.end())
+        return it->second;
+
+    // check if table for the decomposition of n exist, if not create it
+    check_sum(file_name, n);
+
+    table = &tables[n];
+    fp = fopen(file_name, "r");
+    if (fp == nullptr) {
+        perror(file_name);
+        exit(-3);
+    }
+    while (!feof(fp)) {
+        if (fscanf(fp, "%s", s) != 1)
+            break;
+        if (!feof(fp))
+            table->push_back(s);
+    }
+    fclose(fp);
+    return *table;
+}
+
+// --------------------------------------------------------------------------
+//                      LYAPUNOV_COEFF
+// --------------------------------------------------------------------------
+//
+// The lyapunov coefficient of order k is minus the sum of the contributions
+// of every composition listed in the sum table of k-1.  The compositions
+// are independent, so they are handed out to (at most nthreads) worker
+// threads, each working on its own polynomials.  Every contribution is
+// stored at its position in the table, and the sum is done afterwards in
+// table order with Kahan summation, so the result does not depend on the
+// number of threads.
+//
+// *err is an estimate of the rounding error of the result: the sum of the
+// absolute values of the contributions times LYAPUNOV_DOUBT machine
+// epsilons.  It is large when the contributions cancel each other.
+
+double lyapunov_coeff(const lyapunov_job *job, int k, int nthreads,
+                      double *err)
+{
+    const std::vector<std::string> &table = sum_table(k - 1);
+    std::vector<double> part;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0);
+    size_t i;
+    int n;
+    double V, c, y, t, a;
+
+    part.resize(table.size());
+
+    auto work = [&]() {
+        char buf[DIM2];
+        size_t j;
+
+        while ((j = next++) < table.size()) {
+            strcpy(buf, table[j].c_str());
+            part[j] = part_lyapunov_coeff(job, buf, k);
+        }
+    };
+
+    n = nthreads;
+    if ((size_t)n > table.size())
+        n = (int)table.size();
+    for (i = 1; i < (size_t)n; i++)
+        workers.push_back(std::thread(work));
+    work();
+    for (i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    V = 0.0;
+    c = 0.0;
+    a = 0.0;
+    for (i = 0; i < part.size(); i++) {
+        y = -part[i] - c;
+        t = V + y;
+        c = (t - V) - y;
+        V = t;
+        a += fabs(part[i]);
+    }
+    *err = a * LYAPUNOV_DOUBT * DBL_EPSILON;
+    return V;
+}
+
+// --------------------------------------------------------------------------
+//                      RUN_JOB
+// --------------------------------------------------------------------------
+//
+// computes the coefficients of job up to the first one that is not
+// negligible, or up to its weakness level.  A coefficient is in doubt when
+// its estimated rounding error could change its sign, or whether it is
+// negligible.
+
+void run_job(lyapunov_job *job, int nthreads)
+{
+    int k;
+    double V, err;
+
+    job->V.clear();
+    job->order = 0;
+    job->doubt = 0;
+    for (k = 1; k <= job->weakness_level; k++) {
+        V = lyapunov_coeff(job, 2 * k + 1, nthreads, &err);
+        // V*=2.0*PI/(k+1);
+        job->V.push_back(V);
+        if (job->doubt == 0 &&
+            (fabs(V) <= err || fabs(fabs(V) - job->precision) <= err))
+            job->doubt = k;
+        if (fabs(V) >= job->precision) {
+            job->order = k;
+            break;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      RUN_BATCH
+// --------------------------------------------------------------------------
+//
+// The jobs are handed out to worker threads like the compositions in
+// lyapunov_coeff.  The threads that are left over when there are fewer
+// jobs than threads are shared out over the jobs.
+
+void run_batch(std::vector<lyapunov_job> *jobs)
+{
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0);
+    size_t i;
+    int n, inner;
+
+    n = lyapunov_threads();
+    if ((size_t)n > jobs->size())
+        n = (int)jobs->size();
+    if (n < 1)
+        return;
+    inner = lyapunov_threads() / n;
+
+    auto work = [&]() {
+        size_t j;
+
+        while ((j = next++) < jobs->size())
+            run_job(&(*jobs)[j], inner);
+    };
+
+    for (i = 1; i < (size_t)n; i++)
+        workers.push_back(std::thread(work));
+    work();
+    for (i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
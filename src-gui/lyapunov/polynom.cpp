@@ -25,7 +25,7 @@
 //                      INS_HOM_POLY
 // --------------------------------------------------------------------------
 
-void ins_hom_poly(hom_poly volatile *f, int degz, int degzb, double re,
+void ins_hom_poly(hom_poly *f, int degz, int degzb, double re,
                   double im)
 {
     int total_degree = degz + degzb, ok = 1;
@@ -57,7 +57,7 @@ void ins_hom_poly(hom_poly volatile *f, int degz, int degzb, double re,
 //                      INS_POLY
 // --------------------------------------------------------------------------
 
-void ins_poly(poly volatile *f, int degz, int degzb, double re, double im)
+void ins_poly(poly *f, int degz, int degzb, double re, double im)
 {
     poly *w = f->next_poly;
 
@@ -82,11 +82,11 @@ void ins_poly(poly volatile *f, int degz, int degzb, double re, double im)
 //                      COPY_POLY
 // --------------------------------------------------------------------------
 
-poly volatile *copy_poly(poly volatile *f)
+poly *copy_poly(poly *f)
 {
     if (f == nullptr)
         return f;
-    poly volatile *current = f;
+    poly *current = f;
 
     poly *copy = new poly;
     copy->degz = current->degz;
@@ -115,9 +115,9 @@ poly volatile *copy_poly(poly volatile *f)
 //                      SEARCH_POLY
 // --------------------------------------------------------------------------
 
-poly volatile *search_poly(poly volatile *f, int degz, int degzb, int *present)
+poly *search_poly(poly *f, int degz, int degzb, int *present)
 {
-    poly volatile *w;
+    poly *w;
 
     w = f;
     *present = 0;
@@ -139,7 +139,7 @@ poly volatile *search_poly(poly volatile *f, int degz, int degzb, int *present)
 //                      INS_COEFF
 // --------------------------------------------------------------------------
 
-void ins_coeff(poly volatile *f, int degz, int degzb, double re, double im)
+void ins_coeff(poly *f, int degz, int degzb, double re, double im)
 {
 
     poly *w;
@@ -157,7 +157,7 @@ void ins_coeff(poly volatile *f, int degz, int degzb, double re, double im)
 //                      DELETE_COEFF
 // --------------------------------------------------------------------------
 
-void delete_coeff(poly volatile *f)
+void delete_coeff(poly *f)
 {
     poly *w;
 
@@ -171,10 +171,10 @@ void delete_coeff(poly volatile *f)
 //                      ADD_POLY
 // --------------------------------------------------------------------------
 
-void add_poly(poly volatile *f, poly volatile *g)
+void add_poly(poly *f, poly *g)
 {
     int present;
-    poly volatile *w1, *w2;
+    poly *w1, *w2;
 
     while ((g = g->next_poly) != nullptr) {
         w1 = search_poly(f, g->degz, g->degzb, &present);
@@ -197,10 +197,10 @@ void add_poly(poly volatile *f, poly volatile *g)
 //                      SUB_POLY
 // --------------------------------------------------------------------------
 
-void sub_poly(poly volatile *f, poly volatile *g)
+void sub_poly(poly *f, poly *g)
 {
     int present;
-    poly volatile *w1, *w2;
+    poly *w1, *w2;
 
     while ((g = g->next_poly) != nullptr) {
         w1 = search_poly(f, g->degz, g->degzb, &present);
@@ -223,7 +223,7 @@ void sub_poly(poly volatile *f, poly volatile *g)
 //                      TERM_PROD
 // --------------------------------------------------------------------------
 
-void term_prod(poly volatile *f, int degz, int degzb, double re, double im)
+void term_prod(poly *f, int degz, int degzb, double re, double im)
 {
     double r, i;
 
@@ -243,9 +243,9 @@ void term_prod(poly volatile *f, int degz, int degzb, double re, double im)
 //                      PROD_POLY
 // --------------------------------------------------------------------------
 
-void prod_poly(poly volatile *f, poly volatile *g)
+void prod_poly(poly *f, poly *g)
 {
-    poly volatile *w1, *w2;
+    poly *w1, *w2;
 
     if ((f->next_poly != nullptr) && (g->next_poly != nullptr)) {
         w2 = copy_poly(f);
@@ -274,10 +274,10 @@ void prod_poly(poly volatile *f, poly volatile *g)
 //                      MULTC_POLY
 // --------------------------------------------------------------------------
 
-void multc_poly(poly volatile *f, double re, double im)
+void multc_poly(poly *f, double re, double im)
 {
     double r, i;
-    poly volatile *w = f;
+    poly *w = f;
 
     while ((w = w->next_poly) != nullptr) {
         r = w->re * re - w->im * im;
@@ -291,9 +291,9 @@ void multc_poly(poly volatile *f, double re, double im)
 //                      DELETE_POLY
 // --------------------------------------------------------------------------
 
-void delete_poly(poly volatile **f)
+void delete_poly(poly **f)
 {
-    poly volatile *w, *tmp;
+    poly *w, *tmp;
     w = *f;
     while (w != nullptr) {
         tmp = w;
@@ -316,9 +316,9 @@ void delete_poly(poly volatile **f)
 //                      CONJ_POLY
 // --------------------------------------------------------------------------
 
-poly volatile *conj_poly(poly volatile *f)
+poly *conj_poly(poly *f)
 {
-    poly volatile *g;
+    poly *g;
 
     g = new poly; //( poly * ) malloc( sizeof( poly ) );
     g->next_poly = nullptr;
@@ -331,7 +331,7 @@ poly volatile *conj_poly(poly volatile *f)
 //                      PRINT_POLY
 // --------------------------------------------------------------------------
 
-void print_poly(poly volatile *f)
+void print_poly(poly *f)
 {
     if (f)
         while ((f = f->next_poly))
@@ -343,7 +343,7 @@ void print_poly(poly volatile *f)
 //                      READ_POLY
 // --------------------------------------------------------------------------
 
-void read_poly(poly volatile *f)
+void read_poly(poly *f)
 {
     int degz, degzb;
     double re, im;
@@ -360,6 +360,122 @@ void read_poly(poly volatile *f)
     }
 }
 
+// --------------------------------------------------------------------------
+//                      INIT_HPOLY
+// --------------------------------------------------------------------------
+
+void init_hpoly(hpoly *f, int degree)
+{
+    f->degree = -1;
+    f->size = 0;
+    f->re = nullptr;
+    f->im = nullptr;
+    set_hpoly_degree(f, degree);
+}
+
+// --------------------------------------------------------------------------
+//                      SET_HPOLY_DEGREE
+// --------------------------------------------------------------------------
+//
+// make f the zero polynomial of the given degree, reusing its storage
+
+void set_hpoly_degree(hpoly *f, int degree)
+{
+    int k;
+
+    if (degree + 1 > f->size) {
+        delete[] f->re;
+        delete[] f->im;
+        f->size = degree + 1;
+        f->re = new double[f->size];
+        f->im = new double[f->size];
+    }
+    f->degree = degree;
+    for (k = 0; k <= degree; k++) {
+        f->re[k] = 0.0;
+        f->im[k] = 0.0;
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      CLEAR_HPOLY
+// --------------------------------------------------------------------------
+
+void clear_hpoly(hpoly *f)
+{
+    delete[] f->re;
+    delete[] f->im;
+    f->re = nullptr;
+    f->im = nullptr;
+    f->size = 0;
+    f->degree = -1;
+}
+
+// --------------------------------------------------------------------------
+//                      POLY_TO_HPOLY
+// --------------------------------------------------------------------------
+//
+// f = g, where g is a homogeneous polynomial of the given degree
+
+void poly_to_hpoly(hpoly *f, poly *g, int degree)
+{
+    set_hpoly_degree(f, degree);
+    while ((g = g->next_poly) != nullptr) {
+        f->re[g->degzb] = g->re;
+        f->im[g->degzb] = g->im;
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      PROD_HPOLY
+// --------------------------------------------------------------------------
+//
+// h = f*g.  Zero terms of g are skipped.  Every coefficient of h is
+// accumulated in the same order as prod_poly does, so both give the same
+// rounding.
+
+void prod_hpoly(hpoly *h, hpoly *f, hpoly *g)
+{
+    int i, j;
+    double re, im;
+    double *hre, *him;
+
+    if (f->degree < 0 || g->degree < 0) {
+        set_hpoly_degree(h, -1);
+        return;
+    }
+    set_hpoly_degree(h, f->degree + g->degree);
+    for (j = 0; j <= g->degree; j++) {
+        re = g->re[j];
+        im = g->im[j];
+        if (re == 0.0 && im == 0.0)
+            continue;
+        hre = h->re + j;
+        him = h->im + j;
+        for (i = 0; i <= f->degree; i++) {
+            hre[i] += f->re[i] * re - f->im[i] * im;
+            him[i] += f->re[i] * im + f->im[i] * re;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      MULTC_HPOLY
+// --------------------------------------------------------------------------
+
+void multc_hpoly(hpoly *f, double re, double im)
+{
+    int k;
+    double r, i;
+
+    for (k = 0; k <= f->degree; k++) {
+        r = f->re[k] * re - f->im[k] * im;
+        i = f->re[k] * im + f->im[k] * re;
+        f->re[k] = r;
+        f->im[k] = i;
+    }
+}
+
 /*
 void main()
 {
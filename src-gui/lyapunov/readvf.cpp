@@ -23,28 +23,27 @@
 #include <stdlib.h>
 
 // --------------------------------------------------------------------------
-//                      READ_TABLE
+//                      READ_JOB
 // --------------------------------------------------------------------------
+//
+// reads the precision and the vector field of one weak focus from fp
 
-void read_table(const char *file)
+void read_job(FILE *fp, const char *file, lyapunov_job *job)
 {
-    FILE *fp;
     int l, t, degx, degy;
     double re, im;
     int dummy;
 
-    vec_field = (hom_poly *)malloc(sizeof(hom_poly));
-    vec_field->next_hom_poly = nullptr;
+    job->vec_field = (hom_poly *)malloc(sizeof(hom_poly));
+    job->vec_field->next_hom_poly = nullptr;
+    job->V.clear();
+    job->order = 0;
+    job->doubt = 0;
 
-    fp = fopen(file, "r");
-    if (fp == nullptr) {
-        perror(file);
-        exit(-5);
-    }
     // dummy should be 0, it is only nonzero when the mpf version of this
     // program is called.
     if (fscanf(fp, "%d", &dummy) != 1 ||
-        fscanf(fp, "%d %lf", &weakness_level, &precision) != 2 ||
+        fscanf(fp, "%d %lf", &job->weakness_level, &job->precision) != 2 ||
         fscanf(fp, "%i\n\n", &l) != 1) {
         fprintf(stderr, "Error reading %s\n", file);
         exit(-5);
@@ -56,7 +55,83 @@ void read_table(const char *file)
             fprintf(stderr, "Error reading %s\n", file);
             exit(-5);
         }
-        ins_hom_poly(vec_field, degx, degy, re, im);
+        ins_hom_poly(job->vec_field, degx, degy, re, im);
     }
+
+    make_hvec_field(job);
+}
+
+// --------------------------------------------------------------------------
+//                      READ_TABLE
+// --------------------------------------------------------------------------
+
+void read_table(const char *file, lyapunov_job *job)
+{
+    FILE *fp;
+
+    fp = fopen(file, "r");
+    if (fp == nullptr) {
+        perror(file);
+        exit(-5);
+    }
+    read_job(fp, file, job);
     fclose(fp);
 }
+
+// --------------------------------------------------------------------------
+//                      READ_BATCH
+// --------------------------------------------------------------------------
+//
+// A batch file starts with the number of jobs, followed by that many
+// input files (in the format of read_table) one after the other.
+
+void read_batch(const char *file, std::vector<lyapunov_job> *jobs)
+{
+    FILE *fp;
+    int n, j;
+
+    fp = fopen(file, "r");
+    if (fp == nullptr) {
+        perror(file);
+        exit(-5);
+    }
+    if (fscanf(fp, "%d", &n) != 1 || n < 0) {
+        fprintf(stderr, "Error reading %s\n", file);
+        exit(-5);
+    }
+    jobs->resize(n);
+    for (j = 0; j < n; j++)
+        read_job(fp, file, &(*jobs)[j]);
+    fclose(fp);
+}
+
+// --------------------------------------------------------------------------
+//                      MAKE_HVEC_FIELD
+// --------------------------------------------------------------------------
+//
+// dense copy of the vector field of job, indexed by total degree, used by
+// the lyapunov coefficient computations
+
+void make_hvec_field(lyapunov_job *job)
+{
+    hom_poly *f;
+    int i;
+
+    job->hvec_field_degree = -1;
+    for (f = job->vec_field->next_hom_poly; f != nullptr;
+         f = f->next_hom_poly)
+        if (f->total_degree > job->hvec_field_degree)
+            job->hvec_field_degree = f->total_degree;
+
+    job->hvec_field = new hpoly *[job->hvec_field_degree + 1];
+    for (i = 0; i <= job->hvec_field_degree; i++)
+        job->hvec_field[i] = nullptr;
+
+    for (f = job->vec_field->next_hom_poly; f != nullptr;
+         f = f->next_hom_poly) {
+        i = f->total_degree;
+        job->hvec_field[i] = new hpoly;
+        init_hpoly(job->hvec_field[i], -1);
+        poly_to_hpoly(job->hvec_field[i], f->p, i);
+    }
+}
@@ -0,0 +1,637 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lyapunov_mpf.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ *  ADAPTIVE PRECISION LYAPUNOV COEFFICIENTS
+ *
+ *  The coefficient is first computed with interval arithmetic on doubles.
+ *  Only when the resulting enclosure does not decide whether |V| reaches
+ *  the requested precision, the computation is repeated with intervals of
+ *  mpfr numbers (rounded outwards with MPFR_RNDD/MPFR_RNDU), doubling the
+ *  number of bits each time.  The enclosures are rigorous with respect to
+ *  the decimal coefficients of the input file.
+ *
+ *  The polynomial routines below follow prod_hpoly, diff, G, Imgz, Regz,
+ *  LL and part_lyapunov_coeff, but are written once for both interval
+ *  types.
+ */
+
+#define CERTIFY_FIRST_BITS 128
+#define CERTIFY_MAX_BITS 8192
+
+// --------------------------------------------------------------------------
+//                      INTERVALS OF DOUBLES
+// --------------------------------------------------------------------------
+//
+// Every operation is done in round-to-nearest and the result is widened
+// by one unit in the last place on both sides.
+
+struct dival {
+    double lo, hi;
+};
+
+static inline double round_down(double x) { return nextafter(x, -HUGE_VAL); }
+static inline double round_up(double x) { return nextafter(x, HUGE_VAL); }
+
+static inline void iv_init(dival *x) { x->lo = x->hi = 0.0; }
+static inline void iv_clear(dival *) {}
+static inline void iv_zero(dival *x) { x->lo = x->hi = 0.0; }
+static inline bool iv_is_zero(dival *x) { return x->lo == 0 && x->hi == 0; }
+static inline void iv_set(dival *r, dival *x) { *r = *x; }
+
+static inline void iv_neg(dival *x)
+{
+    double t = x->lo;
+    x->lo = -x->hi;
+    x->hi = -t;
+}
+
+static inline void iv_add(dival *r, dival *x, dival *y)
+{
+    r->lo = round_down(x->lo + y->lo);
+    r->hi = round_up(x->hi + y->hi);
+}
+
+static inline void iv_sub(dival *r, dival *x, dival *y)
+{
+    double lo = round_down(x->lo - y->hi);
+    r->hi = round_up(x->hi - y->lo);
+    r->lo = lo;
+}
+
+// r must not be x or y
+static inline void iv_mul(dival *r, dival *x, dival *y)
+{
+    double p1 = x->lo * y->lo, p2 = x->lo * y->hi;
+    double p3 = x->hi * y->lo, p4 = x->hi * y->hi;
+
+    r->lo = round_down(fmin(fmin(p1, p2), fmin(p3, p4)));
+    r->hi = round_up(fmax(fmax(p1, p2), fmax(p3, p4)));
+}
+
+// x *= num/den, den > 0
+static inline void iv_mul_q(dival *x, long num, unsigned long den)
+{
+    double lo, hi;
+
+    if (num >= 0) {
+        lo = round_down(round_down(x->lo * num) / den);
+        hi = round_up(round_up(x->hi * num) / den);
+    } else {
+        lo = round_down(round_down(x->hi * num) / den);
+        hi = round_up(round_up(x->lo * num) / den);
+    }
+    x->lo = lo;
+    x->hi = hi;
+}
+
+static void iv_set_str(dival *x, const char *s)
+{
+    mpfr_t a;
+
+    mpfr_init2(a, 53);
+    mpfr_set_str(a, s, 10, MPFR_RNDD);
+    x->lo = mpfr_get_d(a, MPFR_RNDD);
+    mpfr_set_str(a, s, 10, MPFR_RNDU);
+    x->hi = mpfr_get_d(a, MPFR_RNDU);
+    mpfr_clear(a);
+}
+
+static inline void iv_get(mpfr_t lo, mpfr_t hi, dival *x)
+{
+    mpfr_set_d(lo, x->lo, MPFR_RNDD);
+    mpfr_set_d(hi, x->hi, MPFR_RNDU);
+}
+
+// --------------------------------------------------------------------------
+//                      INTERVALS OF MPFR NUMBERS
+// --------------------------------------------------------------------------
+//
+// The bounds get the default precision of the calling thread.
+
+struct mival {
+    mpfr_t lo, hi;
+};
+
+// one scratch register per thread for iv_mul and iv_mul_q
+struct mival_scratch {
+    mpfr_t t;
+
+    mival_scratch() { mpfr_init(t); }
+    ~mival_scratch() { mpfr_clear(t); }
+};
+
+static mpfr_ptr mival_tmp(void)
+{
+    static thread_local mival_scratch s;
+
+    if (mpfr_get_prec(s.t) != mpfr_get_default_prec())
+        mpfr_set_prec(s.t, mpfr_get_default_prec());
+    return s.t;
+}
+
+static inline void iv_init(mival *x)
+{
+    mpfr_init(x->lo);
+    mpfr_init(x->hi);
+    mpfr_set_zero(x->lo, 1);
+    mpfr_set_zero(x->hi, 1);
+}
+
+static inline void iv_clear(mival *x)
+{
+    mpfr_clear(x->lo);
+    mpfr_clear(x->hi);
+}
+
+static inline void iv_zero(mival *x)
+{
+    mpfr_set_zero(x->lo, 1);
+    mpfr_set_zero(x->hi, 1);
+}
+
+static inline bool iv_is_zero(mival *x)
+{
+    return mpfr_zero_p(x->lo) && mpfr_zero_p(x->hi);
+}
+
+static inline void iv_set(mival *r, mival *x)
+{
+    mpfr_set(r->lo, x->lo, MPFR_RNDD);
+    mpfr_set(r->hi, x->hi, MPFR_RNDU);
+}
+
+static inline void iv_neg(mival *x)
+{
+    mpfr_swap(x->lo, x->hi);
+    mpfr_neg(x->lo, x->lo, MPFR_RNDD);
+    mpfr_neg(x->hi, x->hi, MPFR_RNDU);
+}
+
+static inline void iv_add(mival *r, mival *x, mival *y)
+{
+    mpfr_add(r->lo, x->lo, y->lo, MPFR_RNDD);
+    mpfr_add(r->hi, x->hi, y->hi, MPFR_RNDU);
+}
+
+static inline void iv_sub(mival *r, mival *x, mival *y)
+{
+    mpfr_ptr t = mival_tmp();
+
+    mpfr_sub(t, x->lo, y->hi, MPFR_RNDD);
+    mpfr_sub(r->hi, x->hi, y->lo, MPFR_RNDU);
+    mpfr_swap(r->lo, t);
+}
+
+// r must not be x or y
+static inline void iv_mul(mival *r, mival *x, mival *y)
+{
+    mpfr_ptr t = mival_tmp();
+
+    mpfr_mul(r->lo, x->lo, y->lo, MPFR_RNDD);
+    mpfr_mul(t, x->lo, y->hi, MPFR_RNDD);
+    mpfr_min(r->lo, r->lo, t, MPFR_RNDD);
+    mpfr_mul(t, x->hi, y->lo, MPFR_RNDD);
+    mpfr_min(r->lo, r->lo, t, MPFR_RNDD);
+    mpfr_mul(t, x->hi, y->hi, MPFR_RNDD);
+    mpfr_min(r->lo, r->lo, t, MPFR_RNDD);
+
+    mpfr_mul(r->hi, x->lo, y->lo, MPFR_RNDU);
+    mpfr_mul(t, x->lo, y->hi, MPFR_RNDU);
+    mpfr_max(r->hi, r->hi, t, MPFR_RNDU);
+    mpfr_mul(t, x->hi, y->lo, MPFR_RNDU);
+    mpfr_max(r->hi, r->hi, t, MPFR_RNDU);
+    mpfr_mul(t, x->hi, y->hi, MPFR_RNDU);
+    mpfr_max(r->hi, r->hi, t, MPFR_RNDU);
+}
+
+// x *= num/den, den > 0
+static inline void iv_mul_q(mival *x, long num, unsigned long den)
+{
+    mpfr_ptr t = mival_tmp();
+
+    if (num >= 0) {
+        mpfr_mul_si(t, x->lo, num, MPFR_RNDD);
+        mpfr_mul_si(x->hi, x->hi, num, MPFR_RNDU);
+    } else {
+        mpfr_mul_si(t, x->hi, num, MPFR_RNDD);
+        mpfr_mul_si(x->hi, x->lo, num, MPFR_RNDU);
+    }
+    mpfr_div_ui(x->lo, t, den, MPFR_RNDD);
+    mpfr_div_ui(x->hi, x->hi, den, MPFR_RNDU);
+}
+
+static void iv_set_str(mival *x, const char *s)
+{
+    mpfr_set_str(x->lo, s, 10, MPFR_RNDD);
+    mpfr_set_str(x->hi, s, 10, MPFR_RNDU);
+}
+
+static inline void iv_get(mpfr_t lo, mpfr_t hi, mival *x)
+{
+    mpfr_set(lo, x->lo, MPFR_RNDD);
+    mpfr_set(hi, x->hi, MPFR_RNDU);
+}
+
+// --------------------------------------------------------------------------
+//                      HOMOGENEOUS INTERVAL POLYNOMIALS
+// --------------------------------------------------------------------------
+//
+// Same layout as hpoly: index k holds the coefficient of z^(degree-k) zb^k.
+
+template <class T> struct ihpoly {
+    int degree;
+    int size;
+    T *re, *im;
+};
+
+template <class T> static void set_ihpoly_degree(ihpoly<T> *f, int degree)
+{
+    int k;
+
+    if (degree + 1 > f->size) {
+        for (k = 0; k < f->size; k++) {
+            iv_clear(&f->re[k]);
+            iv_clear(&f->im[k]);
+        }
+        delete[] f->re;
+        delete[] f->im;
+        f->size = degree + 1;
+        f->re = new T[f->size];
+        f->im = new T[f->size];
+        for (k = 0; k < f->size; k++) {
+            iv_init(&f->re[k]);
+            iv_init(&f->im[k]);
+        }
+    }
+    f->degree = degree;
+    for (k = 0; k <= degree; k++) {
+        iv_zero(&f->re[k]);
+        iv_zero(&f->im[k]);
+    }
+}
+
+template <class T> static void init_ihpoly(ihpoly<T> *f, int degree)
+{
+    f->degree = -1;
+    f->size = 0;
+    f->re = nullptr;
+    f->im = nullptr;
+    set_ihpoly_degree(f, degree);
+}
+
+template <class T> static void clear_ihpoly(ihpoly<T> *f)
+{
+    int k;
+
+    for (k = 0; k < f->size; k++) {
+        iv_clear(&f->re[k]);
+        iv_clear(&f->im[k]);
+    }
+    delete[] f->re;
+    delete[] f->im;
+    f->re = nullptr;
+    f->im = nullptr;
+    f->size = 0;
+    f->degree = -1;
+}
+
+// h = f*g
+template <class T>
+static void prod_ihpoly(ihpoly<T> *h, ihpoly<T> *f, ihpoly<T> *g, T *t)
+{
+    int i, j;
+
+    if (f->degree < 0 || g->degree < 0) {
+        set_ihpoly_degree(h, -1);
+        return;
+    }
+    set_ihpoly_degree(h, f->degree + g->degree);
+    for (j = 0; j <= g->degree; j++) {
+        if (iv_is_zero(&g->re[j]) && iv_is_zero(&g->im[j]))
+            continue;
+        for (i = 0; i <= f->degree; i++) {
+            iv_mul(&t[0], &f->re[i], &g->re[j]);
+            iv_mul(&t[1], &f->im[i], &g->im[j]);
+            iv_sub(&t[0], &t[0], &t[1]);
+            iv_add(&h->re[i + j], &h->re[i + j], &t[0]);
+
+            iv_mul(&t[0], &f->re[i], &g->im[j]);
+            iv_mul(&t[1], &f->im[i], &g->re[j]);
+            iv_add(&t[0], &t[0], &t[1]);
+            iv_add(&h->im[i + j], &h->im[i + j], &t[0]);
+        }
+    }
+}
+
+// f *= -i
+template <class T> static void multi_ihpoly(ihpoly<T> *f)
+{
+    int k;
+
+    for (k = 0; k <= f->degree; k++) {
+        iv_neg(&f->re[k]);
+        std::swap(f->re[k], f->im[k]);
+    }
+}
+
+template <class T> static void diff_ihpoly(ihpoly<T> *f)
+{
+    int k;
+
+    for (k = 0; k < f->degree; k++) {
+        iv_mul_q(&f->re[k], f->degree - k, 1);
+        iv_mul_q(&f->im[k], f->degree - k, 1);
+    }
+    f->degree--;
+}
+
+template <class T> static void G_ihpoly(ihpoly<T> *f)
+{
+    int k, deg = f->degree;
+
+    for (k = 0; k <= deg; k++) {
+        if (deg - 2 * k > 0) {
+            iv_mul_q(&f->re[k], 2, deg - 2 * k);
+            iv_mul_q(&f->im[k], 2, deg - 2 * k);
+        } else if (deg - 2 * k < 0) {
+            iv_mul_q(&f->re[k], -2, 2 * k - deg);
+            iv_mul_q(&f->im[k], -2, 2 * k - deg);
+        } else {
+            iv_zero(&f->re[k]);
+            iv_zero(&f->im[k]);
+        }
+    }
+}
+
+template <class T>
+static void Imgz_ihpoly(ihpoly<T> *f, ihpoly<T> *g, ihpoly<T> *h, T *t)
+{
+    int k, d;
+
+    prod_ihpoly(h, f, g, t);
+    diff_ihpoly(h);
+    G_ihpoly(h);
+    d = h->degree;
+    set_ihpoly_degree(f, d);
+    for (k = 0; k <= d; k++) {
+        // f = (h - conj(h)) * (-i/2)
+        iv_add(&f->re[k], &h->im[k], &h->im[d - k]);
+        iv_mul_q(&f->re[k], 1, 2);
+        iv_sub(&f->im[k], &h->re[k], &h->re[d - k]);
+        iv_mul_q(&f->im[k], -1, 2);
+    }
+}
+
+template <class T>
+static void Regz_ihpoly(ihpoly<T> *f, ihpoly<T> *g, ihpoly<T> *h, T *t)
+{
+    int k, d;
+
+    prod_ihpoly(h, f, g, t);
+    multi_ihpoly(h);
+    diff_ihpoly(h);
+    G_ihpoly(h);
+    d = h->degree;
+    set_ihpoly_degree(f, d);
+    for (k = 0; k <= d; k++) {
+        // f = (h + conj(h)) / 2
+        iv_add(&f->re[k], &h->re[k], &h->re[d - k]);
+        iv_mul_q(&f->re[k], 1, 2);
+        iv_sub(&f->im[k], &h->im[k], &h->im[d - k]);
+        iv_mul_q(&f->im[k], 1, 2);
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      ONE PRECISION STAGE
+// --------------------------------------------------------------------------
+
+template <class T> struct istage {
+    int degree; // of the vector field
+    ihpoly<T> *vf;
+    ihpoly<T> **R;
+};
+
+template <class T>
+static void init_istage(istage<T> *s, const std::vector<vf_coeff> &vf_coeffs)
+{
+    size_t n;
+    int d;
+
+    s->degree = -1;
+    for (n = 0; n < vf_coeffs.size(); n++) {
+        d = vf_coeffs[n].degz + vf_coeffs[n].degzb;
+        if (d > s->degree)
+            s->degree = d;
+    }
+    s->vf = new ihpoly<T>[s->degree + 1];
+    s->R = new ihpoly<T> *[s->degree + 1];
+    for (d = 0; d <= s->degree; d++) {
+        init_ihpoly(&s->vf[d], d);
+        s->R[d] = nullptr;
+    }
+    for (n = 0; n < vf_coeffs.size(); n++) {
+        d = vf_coeffs[n].degz + vf_coeffs[n].degzb;
+        iv_set_str(&s->vf[d].re[vf_coeffs[n].degzb], vf_coeffs[n].re.c_str());
+        iv_set_str(&s->vf[d].im[vf_coeffs[n].degzb], vf_coeffs[n].im.c_str());
+        s->R[d] = &s->vf[d];
+    }
+}
+
+template <class T> static void clear_istage(istage<T> *s)
+{
+    int d;
+
+    for (d = 0; d <= s->degree; d++)
+        clear_ihpoly(&s->vf[d]);
+    delete[] s->vf;
+    delete[] s->R;
+}
+
+// enclosure of the contribution of the composition s, see
+// part_lyapunov_coeff
+template <class T>
+static void part_ival(istage<T> *st, const char *s, int k, T *w,
+                      ihpoly<T> *f, ihpoly<T> *h, T *t)
+{
+    ihpoly<T> *R[DIM1];
+    int i, n = 0, j = 0, deg;
+    char a[DIM1];
+
+    iv_zero(w);
+    for (i = 0;; i++) {
+        if (s[i] == ',' || s[i] == 0) {
+            a[j] = 0;
+            deg = atoi(a) + 1;
+            if (deg > st->degree || st->R[deg] == nullptr)
+                return;
+            R[n] = st->R[deg];
+            if (s[i] == 0)
+                break;
+            n++;
+            j = 0;
+        } else {
+            a[j] = s[i];
+            j++;
+        }
+    }
+
+    set_ihpoly_degree(f, 0);
+    iv_set_str(&f->re[0], "-1"); // f=-1
+    for (i = 0; i < n; i++) {
+        if (i % 2)
+            Regz_ihpoly(f, R[i], h, t);
+        else
+            Imgz_ihpoly(f, R[i], h, t);
+    }
+    if (n % 2)
+        multi_ihpoly(f);
+
+    // LL: coefficient of (z*zb)^((k-1)/2) in d/dz (f*R[n])
+    prod_ihpoly(h, f, R[n], t);
+    diff_ihpoly(h);
+    i = (k - 1) / 2;
+    if (h->degree == 2 * i)
+        iv_set(w, (n % 2) ? &h->im[i] : &h->re[i]);
+}
+
+// enclosure [lo,hi] of the lyapunov coefficient of order k of job with
+// the interval type T, using the compositions in table
+template <class T>
+static void stage_lyapunov_coeff(const lyapunov_job *job,
+                                 const std::vector<std::string> &table, int k,
+                                 mpfr_t lo, mpfr_t hi)
+{
+    istage<T> st;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0);
+    mpfr_prec_t prec = mpfr_get_default_prec();
+    size_t i, n = table.size();
+    T *part, V;
+
+    init_istage(&st, job->vf_coeffs);
+    part = new T[n];
+    for (i = 0; i < n; i++)
+        iv_init(&part[i]);
+
+    auto work = [&]() {
+        ihpoly<T> f, h;
+        T t[2];
+
+        mpfr_set_default_prec(prec);
+        init_ihpoly(&f, -1);
+        init_ihpoly(&h, -1);
+        iv_init(&t[0]);
+        iv_init(&t[1]);
+        for (size_t j; (j = next++) < n;)
+            part_ival(&st, table[j].c_str(), k, &part[j], &f, &h, t);
+        iv_clear(&t[1]);
+        iv_clear(&t[0]);
+        clear_ihpoly(&h);
+        clear_ihpoly(&f);
+    };
+
+    for (i = 1; i < (size_t)job->threads && i < n; i++)
+        workers.push_back(std::thread(work));
+    work();
+    for (i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    // V = - sum of the parts
+    iv_init(&V);
+    for (i = 0; i < n; i++)
+        iv_sub(&V, &V, &part[i]);
+    iv_get(lo, hi, &V);
+    iv_clear(&V);
+
+    for (i = 0; i < n; i++)
+        iv_clear(&part[i]);
+    delete[] part;
+    clear_istage(&st);
+}
+
+// --------------------------------------------------------------------------
+//                      CERTIFY_LYAPUNOV_COEFF
+// --------------------------------------------------------------------------
+//
+// Computes the lyapunov coefficient of order k of job from the sum table
+// for k-1,
+// with just enough precision to decide whether |V| reaches the requested
+// precision.  Returns
+//
+//       1  if certainly |V| >= precision
+//       0  if certainly |V| < precision
+//      -1  if this could not be decided with CERTIFY_MAX_BITS bits
+//
+// *value is the midpoint of the last enclosure, *bits the number of bits
+// that was needed (53 for the double stage).
+
+int certify_lyapunov_coeff(lyapunov_job *job, int k, double *value,
+                           int *bits)
+{
+    const std::vector<std::string> &table = sum_table(k - 1);
+    mpfr_prec_t oldprec = mpfr_get_default_prec();
+    mpfr_t lo, hi, plo, phi, mphi;
+    int result = -1;
+
+    // the enclosures are compared with the highest precision, so that
+    // the comparison itself never loses bits
+    mpfr_inits2(CERTIFY_MAX_BITS, lo, hi, plo, phi, mphi, (mpfr_ptr)0);
+    mpfr_set_str(plo, job->precision_str.c_str(), 10, MPFR_RNDD);
+    mpfr_set_str(phi, job->precision_str.c_str(), 10, MPFR_RNDU);
+    mpfr_neg(mphi, phi, MPFR_RNDN);
+
+    *bits = 53;
+    stage_lyapunov_coeff<dival>(job, table, k, lo, hi);
+    for (;;) {
+        if (mpfr_cmp(lo, phi) >= 0 || mpfr_cmp(hi, mphi) <= 0)
+            result = 1; // |V| >= precision
+        else if (mpfr_cmpabs(lo, plo) < 0 && mpfr_cmpabs(hi, plo) < 0)
+            result = 0; // |V| < precision
+        if (result >= 0 || *bits >= CERTIFY_MAX_BITS)
+            break;
+        *bits = (*bits < CERTIFY_FIRST_BITS) ? CERTIFY_FIRST_BITS : 2 * *bits;
+        job_printf(&job->log,
+                   "k=%d [%g,%g] is not decisive, retrying with %d bits\n",
+                   (k - 1) / 2, mpfr_get_d(lo, MPFR_RNDD),
+                   mpfr_get_d(hi, MPFR_RNDU), *bits);
+        mpfr_set_default_prec(*bits);
+        stage_lyapunov_coeff<mival>(job, table, k, lo, hi);
+    }
+    mpfr_set_default_prec(oldprec);
+
+    mpfr_add(lo, lo, hi, MPFR_RNDN);
+    *value = mpfr_get_d(lo, MPFR_RNDN) / 2;
+    mpfr_clears(lo, hi, plo, phi, mphi, (mpfr_ptr)0);
+    return result;
+}
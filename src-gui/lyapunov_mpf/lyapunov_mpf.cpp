@@ -26,10 +26,14 @@
 #endif
 
 #include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <thread>
+
 /*
  *  LYAPUNOV	inputfile outputfile
  *  --> work in reduce/linux mode
@@ -54,16 +58,30 @@
  *
  *      Optionally use path to load&store sum tables.
  *      if not present, using current working directory.
+ *
+ *  LYAPUNOV	-batch batchfile outputfile [MAPLE [WINDOWS [path]]]
+ *  --> work in batch mode
+ *
+ *      The batch file holds a number of jobs, followed by that many
+ *      input files one after the other.  The jobs are run in parallel,
+ *      sharing the sum tables, and the output file holds the
+ *      outputs of all jobs in order, each as a single run would write it.
+ *
+ *  The environment variable P4_LYAPUNOV_THREADS limits the number of
+ *  threads used to sum the lyapunov coefficients.  By default, all
+ *  available cores are used.
+ *
+ *  When the input file requests 0 digits of precision, the precision is
+ *  chosen adaptively: every coefficient is enclosed in an interval, first
+ *  with doubles and then with more and more bits, until it is certain
+ *  whether it reaches the requested precision (see certify_mpf.cpp).
  */
 
 bool env_maple = false;
 bool env_reduce = false;
 bool env_windows = false;
 char *win_sumtablepath = nullptr;
-int weakness_level = 0;
-mpfr_t precision;
 mpfr_t one, zero, onehalf, minusonehalf, minusone;
-struct hom_poly *vec_field = nullptr;
 
 // --------------------------------------------------------------------------
 //                      REMOVEQUOTES
@@ -102,25 +120,169 @@ char *AddTrailingSlash(char *buf, char s)
     return buf;
 }
 
+// --------------------------------------------------------------------------
+//                      JOB_PRINTF
+// --------------------------------------------------------------------------
+//
+// printf to the string *s.  The jobs of a batch run in parallel, so what
+// they write is kept, and written out in order when all are done.
+
+void job_printf(std::string *s, const char *fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    s->append(buf);
+}
+
+// --------------------------------------------------------------------------
+//                      RUN_JOB
+// --------------------------------------------------------------------------
+//
+// computes the lyapunov coefficients of the vector field read by read_job,
+// and keeps the result for the output file in job->out
+
+void run_job(lyapunov_job *job)
+{
+    mpfr_t V;
+    double _V = 0;
+    int k, ok = 0, certified, bits;
+    double _prec;
+
+    // the default precision of mpfr is kept per thread
+    mpfr_set_default_prec(job->prec);
+    mpfr_init_set_si(V, 0, MPFR_RNDN);
+
+    if (env_reduce) {
+        job_printf(&job->out, "off echo$\n");
+        job_printf(&job->out, "openfile(result_file)$\n");
+        job_printf(&job->out, "write$\n");
+    }
+
+    for (k = 1; k <= job->weakness_level; k++) {
+        // here V is the lyapunov coeff that we want to calculate
+        if (job->requested_digits > 0) {
+            lyapunov_coeff(job, 2 * k + 1, &V);
+            // V*=2.0*PI/(k+1);
+            _V = mpfr_get_d(V, MPFR_RNDN);
+        } else {
+            certified = certify_lyapunov_coeff(job, 2 * k + 1, &_V, &bits);
+            mpfr_set_d(V, _V, MPFR_RNDN);
+            if (certified < 0)
+                job_printf(&job->log,
+                           "k=%d could not be certified with %d bits\n", k,
+                           bits);
+            else
+                job_printf(&job->log, "k=%d certified %s with %d bits\n", k,
+                           certified ? "nonzero" : "negligible", bits);
+            if (certified == 0)
+                mpfr_set_zero(V, 1);
+        }
+        _prec = mpfr_get_d(job->precision, MPFR_RNDN);
+
+        job_printf(&job->log, "k=%d V=%20.19f, precision=%20.19f\n", k, _V,
+                   _prec);
+
+        if (env_reduce)
+            job_printf(&job->out, "write \"V(%d)=%e\"$\n", 2 * k + 1, _V);
+
+        if (env_maple)
+            job_printf(&job->out, "%d\n%e\n", 2 * k + 1, _V);
+
+        if (!mpfr_negligible_V(job, V)) {
+            ok = 1;
+            if (env_maple)
+                job_printf(&job->out, "-1\n");
+            break;
+        }
+    }
+
+    // write the result to a file
+    _V = mpfr_get_d(V, MPFR_RNDN);
+
+    if (env_reduce) {
+        job_printf(&job->out, "out 't$\n");
+        if (ok)
+            job_printf(&job->out, "w:=%d$\n lyp:=%e$\n", k, _V);
+        else
+            job_printf(&job->out, "lyp:=0$\n");
+    }
+
+    if (env_maple) {
+        if (ok)
+            job_printf(&job->out, "1\n%d\n%e\n", k, _V);
+        else
+            job_printf(&job->out, "0\n0\n0\n");
+    }
+
+    mpfr_clear(V);
+}
+
+// --------------------------------------------------------------------------
+//                      RUN_BATCH
+// --------------------------------------------------------------------------
+//
+// The jobs are handed out to worker threads like the compositions in
+// lyapunov_coeff.  The threads that are left over when there are fewer
+// jobs than threads are shared out over the jobs.
+
+void run_batch(std::vector<lyapunov_job> *jobs)
+{
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0);
+    size_t i;
+    int n, inner;
+
+    n = lyapunov_threads();
+    if ((size_t)n > jobs->size())
+        n = (int)jobs->size();
+    if (n < 1)
+        return;
+    inner = lyapunov_threads() / n;
+
+    auto work = [&]() {
+        size_t j;
+
+        while ((j = next++) < jobs->size()) {
+            (*jobs)[j].threads = inner;
+            run_job(&(*jobs)[j]);
+        }
+    };
+
+    for (i = 1; i < (size_t)n; i++)
+        workers.push_back(std::thread(work));
+    work();
+    for (i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
 // --------------------------------------------------------------------------
 //                      MAIN
 // --------------------------------------------------------------------------
 
 int main(int argc, char *argv[])
 {
-    mpfr_t V, Vi, accu;
-    double _V;
-    int k, ok = 0;
-    char file_name[220], s[DIM2];
+    int n = 1;
+    size_t j;
+    bool batch = false;
     static char wstpbuf[256];
+    char *file;
     FILE *fp, *fp2;
-    double _prec;
 
     env_reduce = true;
     env_maple = false;
     env_windows = false;
     win_sumtablepath = nullptr;
 
+    if (argc >= 2 && !strcmp(argv[1], "-batch")) {
+        batch = true;
+        argv++;
+        argc--;
+    }
+
     if (argc <= 1) {
         printf(
             "Lyapunov Version: %s Date: %s\n%s", VERSION, VERSIONDATE,
@@ -144,7 +306,18 @@ int main(int argc, char *argv[])
             "SYNTAX: lyapunov inputfile outputfile MAPLE WINDOWS [path]\n"
             "\t--> work in maple/windows mode\n"
             "\toptionally use path to load&store sum tables.\n"
-            "\tIf not present, using current working directory.\n");
+            "\tIf not present, using current working directory.\n"
+            "\n"
+            "SYNTAX: lyapunov -batch batchfile outputfile [MAPLE ...]\n"
+            "\t--> work in batch mode\n"
+            "\tThe batch file holds the number of jobs, followed by that\n"
+            "\tmany input files.  The output file holds the outputs of all\n"
+            "\tjobs, in the same order.\n"
+            "\n"
+            "The environment variable P4_LYAPUNOV_THREADS limits the number\n"
+            "of threads used (default: all available cores).\n"
+            "If the inputfile requests 0 digits, the precision is adapted\n"
+            "until each coefficient is certified.\n");
         exit(-3);
     }
 
@@ -172,10 +345,21 @@ int main(int argc, char *argv[])
         printf("Using current directory as place to store sumtables...\n");
     }
 
-    read_table(RemoveQuotes(argv[1])); // read in precision and vector field
+    file = RemoveQuotes(argv[1]);
+    fp = fopen(file, "r");
+    if (fp == nullptr) {
+        perror(file);
+        exit(-5);
+    }
+    if (batch && (fscanf(fp, "%d", &n) != 1 || n < 0)) {
+        fprintf(stderr, "Error reading %s\n", file);
+        exit(-5);
+    }
+
+    fp2 = fopen(RemoveQuotes(argv[2]), "w");
+    if (fp2 == nullptr)
+        exit(-4);
 
-    mpfr_init_set_si(V, 0, MPFR_RNDN);
-    mpfr_init_set_si(Vi, 0, MPFR_RNDN);
     mpfr_init_set_si(zero, 0, MPFR_RNDN);
     mpfr_init_set_si(one, 1, MPFR_RNDN);
     mpfr_init_set_si(minusone, -1, MPFR_RNDN);
@@ -183,116 +367,48 @@ int main(int argc, char *argv[])
     mpfr_div_ui(onehalf, one, 2, MPFR_RNDN);
     mpfr_init(minusonehalf);
     mpfr_div_ui(minusonehalf, minusone, 2, MPFR_RNDN);
-    mpfr_init(accu);
 
-    fp2 = fopen(RemoveQuotes(argv[2]), "w");
-    if (fp2 == nullptr)
-        exit(-4);
+    std::vector<lyapunov_job> jobs(n);
+    for (j = 0; j < jobs.size(); j++)
+        read_job(fp, file, &jobs[j]); // read in precision and vector field
+    fclose(fp);
 
-    if (env_reduce) {
-        fprintf(fp2, "off echo$\n");
-        fprintf(fp2, "openfile(result_file)$\n");
-        fprintf(fp2, "write$\n");
+    if (batch)
+        run_batch(&jobs);
+    else if (!jobs.empty()) {
+        jobs[0].threads = lyapunov_threads();
+        run_job(&jobs[0]);
     }
 
-    for (k = 1; k <= weakness_level; k++) {
-        // check if table for the decomposition of 2*k exist, if not create it
-        check_sum(file_name, 2 * k);
-
-        fp = fopen(file_name, "r");
-        if (fp == nullptr) {
-            perror(file_name);
-            exit(-3);
-        }
-        // here V is the lyapunov coeff that we want to calculate
-        mpfr_set_si(V, 0, MPFR_RNDN);
-        while (!feof(fp)) {
-            if (fscanf(fp, "%s", s) != 1)
-                break;
-            if (!feof(fp)) {
-                part_lyapunov_coeff(s, 2 * k + 1, &Vi);
-                mpfr_sub(accu, V, Vi, MPFR_RNDN); // V -= Vi;
-                mpfr_set(V, accu, MPFR_RNDN);
-            }
-        }
-        fclose(fp);
-        // V*=2.0*PI/(k+1);
-        _V = mpfr_get_d(V, MPFR_RNDN);
-        _prec = mpfr_get_d(precision, MPFR_RNDN);
-
-        printf("k=%d V=%20.19f, precision=%20.19f\n", k, _V, _prec);
-
-        if (env_reduce)
-            fprintf(fp2, "write \"V(%d)=%e\"$\n", 2 * k + 1, _V);
-
-        if (env_maple)
-            fprintf(fp2, "%d\n%e\n", 2 * k + 1, _V);
-
-        if (!mpfr_negligible_V(V)) {
-            ok = 1;
-            if (env_maple)
-                fprintf(fp2, "-1\n");
-            break;
-        }
-    }
-
-    // write the result to a file
-    _V = mpfr_get_d(V, MPFR_RNDN);
-
-    if (env_reduce) {
-        fprintf(fp2, "out 't$\n");
-        if (ok)
-            fprintf(fp2, "w:=%d$\n lyp:=%e$\n", k, _V);
-        else
-            fprintf(fp2, "lyp:=0$\n");
+    for (j = 0; j < jobs.size(); j++) {
+        if (batch)
+            printf("job %d:\n", (int)j + 1);
+        fputs(jobs[j].log.c_str(), stdout);
+        fputs(jobs[j].out.c_str(), fp2);
+        clear_job(&jobs[j]);
     }
 
-    if (env_maple) {
-        if (ok)
-            fprintf(fp2, "1\n%d\n%e\n", k, _V);
-        else
-            fprintf(fp2, "0\n0\n0\n");
-    }
-
-    fclose(fp2);
-
-    mpfr_clear(precision);
-    mpfr_clear(V);
-    mpfr_clear(Vi);
     mpfr_clear(zero);
     mpfr_clear(minusone);
     mpfr_clear(onehalf);
     mpfr_clear(minusonehalf);
     mpfr_clear(one);
+
+    fclose(fp2);
     return 0;
 }
 
+// called from the worker threads, so it must not use static scratch space
 bool mpfr_negligible(mpfr_t accu)
 {
-    static mpfr_t s;
-    static bool s_init = false;
-    if (!s_init) {
-        mpfr_init(s);
-        s_init = true;
-    }
-
-    mpfr_abs(s, accu, MPFR_RNDN);
-    if (mpfr_cmp_ui(s, 0) == 0)
+    if (mpfr_zero_p(accu))
         return true;
     return false;
 }
 
-bool mpfr_negligible_V(mpfr_t accu)
+bool mpfr_negligible_V(const lyapunov_job *job, mpfr_t accu)
 {
-    static mpfr_t s;
-    static bool s_init = false;
-    if (!s_init) {
-        mpfr_init(s);
-        s_init = true;
-    }
-
-    mpfr_abs(s, accu, MPFR_RNDN);
-    if (mpfr_cmp(s, precision) >= 0)
+    if (mpfr_cmpabs(accu, job->precision) >= 0)
         return false;
     return true;
 }
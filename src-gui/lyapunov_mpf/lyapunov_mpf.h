@@ -27,6 +27,11 @@
 #include <mpfr.h>
 #endif
 
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
 // definitions
 
 #define DIM 100
@@ -52,21 +57,75 @@ struct hom_poly {
     hom_poly() : next_hom_poly(nullptr){};
 };
 
+// Dense homogeneous polynomial: the coefficient of z^(degree-k) zb^k is
+// stored at index k.  All polynomials met in part_lyapunov_coeff are
+// homogeneous, so one row of degree+1 coefficients replaces the sorted
+// list there.  A negative degree is the zero polynomial.
+
+struct hpoly {
+    int degree;
+    int size; // allocated (and mpfr_init'ed) coefficients
+    mpfr_t *re, *im;
+};
+
+// Scratch space of one thread, kept for the whole run so that the hot
+// path of part_lyapunov_coeff does no mpfr_init/mpfr_clear or allocation.
+// It is created on first use, so the thread must have set its default
+// precision before.
+
+struct scratch_mpf {
+    mpfr_t r, i, accu;  // prod_hpoly, multc_hpoly
+    mpfr_t a, b;        // G
+    mpfr_t v[2];        // part_lyapunov_coeff
+    hpoly f, h;         // part_lyapunov_coeff
+
+    scratch_mpf();
+    ~scratch_mpf();
+};
+
+// A term of the vector field as it was read from the input file.  The
+// decimal strings are kept so that certify_lyapunov_coeff can round them
+// outwards at any precision.
+
+struct vf_coeff {
+    int degz, degzb;
+    std::string re, im;
+};
+
+// One weak focus, as read from an input file, together with what is
+// written for it.  A batch run holds one job per focus, and runs the jobs
+// in parallel; the output and the messages of each job are kept until all
+// are done, and then written in order.
+
+struct lyapunov_job {
+    int weakness_level;
+    int requested_digits;
+    mpfr_prec_t prec; // default precision of mpfr while running the job
+    int threads;      // worker threads for the sum of one coefficient
+    mpfr_t precision;
+    std::string precision_str;
+    std::vector<vf_coeff> vf_coeffs;
+    hom_poly *vec_field;
+    hpoly **hvec_field; // dense copy of vec_field, indexed by total degree
+    int hvec_field_degree;
+
+    std::string out; // for the output file
+    std::string log; // for the terminal
+};
+
 // variables
 
 extern bool env_maple;
 extern bool env_reduce;
 extern bool env_windows;
-extern int weakness_level;
-extern mpfr_t precision;
 extern char *win_sumtablepath;
-extern hom_poly *vec_field;
 
 // prototypes
 
 void create_sum(int);
 void check_sum(char *, int);
-void read_table(const char *);
+void read_job(FILE *, const char *, lyapunov_job *);
+void clear_job(lyapunov_job *);
 void ins_hom_poly(hom_poly *, int, int, mpfr_t, mpfr_t);
 void ins_poly(poly *, int, int, mpfr_t, mpfr_t);
 poly *copy_poly(poly *);
@@ -83,12 +142,28 @@ poly *conj_poly(poly *);
 void print_poly(poly *);
 void read_poly(poly *);
 poly *find_poly(hom_poly *, int);
-void diff(poly *);
-void G(poly *);
-void Imgz(poly *, poly *);
-void Regz(poly *, poly *);
-void LL(poly *, poly *, int, mpfr_t *);
-void part_lyapunov_coeff(char *, int, mpfr_t *);
+void init_hpoly(hpoly *, int);
+void set_hpoly_degree(hpoly *, int);
+void clear_hpoly(hpoly *);
+void poly_to_hpoly(hpoly *, poly *, int);
+void prod_hpoly(hpoly *, hpoly *, hpoly *);
+void multc_hpoly(hpoly *, mpfr_t, mpfr_t);
+scratch_mpf &thread_scratch(void);
+void make_hvec_field(lyapunov_job *);
+hpoly *find_hpoly(const lyapunov_job *, int);
+void diff(hpoly *);
+void G(hpoly *);
+void Imgz(hpoly *, hpoly *, hpoly *);
+void Regz(hpoly *, hpoly *, hpoly *);
+void LL(hpoly *, hpoly *, hpoly *, int, mpfr_t *);
+void part_lyapunov_coeff(const lyapunov_job *, char *, int, mpfr_t *);
+int lyapunov_threads(void);
+const std::vector<std::string> &sum_table(int);
+void lyapunov_coeff(const lyapunov_job *, int, mpfr_t *);
+int certify_lyapunov_coeff(lyapunov_job *, int, double *, int *);
+void job_printf(std::string *, const char *, ...);
+void run_job(lyapunov_job *);
+void run_batch(std::vector<lyapunov_job> *);
 
 extern mpfr_t zero;
 extern mpfr_t minusone;
@@ -97,4 +172,4 @@ extern mpfr_t minusonehalf;
 extern mpfr_t one;
 
 bool mpfr_negligible(mpfr_t);
-bool mpfr_negligible_V(mpfr_t);
+bool mpfr_negligible_V(const lyapunov_job *, mpfr_t);
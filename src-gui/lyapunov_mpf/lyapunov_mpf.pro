@@ -24,10 +24,11 @@ include(../../P4.pri)
 
 DESTDIR = $$BUILD_DIR/lyapunov_mpf/
 
-CONFIG += console c++11
+CONFIG += console c++11 thread
 
 SOURCES = lyapunov_mpf.cpp lypcoeff_mpf.cpp polynom_mpf.cpp \
-          checktbl_mpf.cpp createtbl_mpf.cpp readvf_mpf.cpp
+          checktbl_mpf.cpp createtbl_mpf.cpp readvf_mpf.cpp \
+          certify_mpf.cpp
 HEADERS = lyapunov_mpf.h ../version.h
 
 unix:LIBS += -lgmp -lmpfr
@@ -24,6 +24,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 void DEBUG_MONOME(poly *f)
 {
     mpfr_t absre, absim;
@@ -95,127 +102,123 @@ poly *find_poly(hom_poly *f, int i)
     return (g);
 }
 
+// --------------------------------------------------------------------------
+//                      FIND_HPOLY
+// --------------------------------------------------------------------------
+//
+// dense version of find_poly(job->vec_field, i)
+
+hpoly *find_hpoly(const lyapunov_job *job, int i)
+{
+    if (i < 0 || i > job->hvec_field_degree)
+        return nullptr;
+    return job->hvec_field[i];
+}
+
 // --------------------------------------------------------------------------
 //                      DIFF
 // --------------------------------------------------------------------------
 
-void diff(poly *f)
+void diff(hpoly *f)
 {
-    poly *w = f->next_poly;
-    mpfr_t accu;
-
-    mpfr_init(accu);
-    while (w != nullptr) {
-        if (w->degz) {
-            mpfr_mul_ui(accu, w->re, w->degz, MPFR_RNDN);
-            mpfr_set(w->re, accu, MPFR_RNDN);
-            mpfr_mul_ui(accu, w->im, w->degz, MPFR_RNDN);
-            mpfr_set(w->im, accu, MPFR_RNDN);
-            w->degz--;
-            f = w;
-            w = w->next_poly;
-        } else {
-            delete_coeff(f);
-            f = w;
-            w = w->next_poly;
-        }
+    int k;
+
+    for (k = 0; k < f->degree; k++) {
+        mpfr_mul_ui(f->re[k], f->re[k], f->degree - k, MPFR_RNDN);
+        mpfr_mul_ui(f->im[k], f->im[k], f->degree - k, MPFR_RNDN);
     }
-    mpfr_clear(accu);
+    f->degree--;
 }
 
 // --------------------------------------------------------------------------
 //                      G
 // --------------------------------------------------------------------------
 
-void G(poly *f)
+void G(hpoly *f)
 {
-    int deg;
-    mpfr_t a, b;
-    mpfr_init(a);
-    mpfr_init(b);
-    poly *w = f->next_poly;
-
-    if (w)
-        deg = w->degz + w->degzb;
-    while (w != nullptr) {
-        if (deg - 2 * w->degzb) {
-            if (deg - 2 * w->degzb > 0) {
-                mpfr_set_si(a, 2, MPFR_RNDN);
-                mpfr_div_ui(b, a, deg - 2 * w->degzb, MPFR_RNDN);
+    int k, deg = f->degree;
+    scratch_mpf &s = thread_scratch();
+
+    for (k = 0; k <= deg; k++) {
+        if (deg - 2 * k) {
+            if (deg - 2 * k > 0) {
+                mpfr_set_si(s.a, 2, MPFR_RNDN);
+                mpfr_div_ui(s.b, s.a, deg - 2 * k, MPFR_RNDN);
             } else {
-                mpfr_set_si(a, -2, MPFR_RNDN);
-                mpfr_div_ui(b, a, 2 * w->degzb - deg, MPFR_RNDN);
+                mpfr_set_si(s.a, -2, MPFR_RNDN);
+                mpfr_div_ui(s.b, s.a, 2 * k - deg, MPFR_RNDN);
             }
-            mpfr_mul(a, w->re, b, MPFR_RNDN);
-            mpfr_set(w->re, a, MPFR_RNDN);
-            mpfr_mul(a, w->im, b, MPFR_RNDN);
-            mpfr_set(w->im, a, MPFR_RNDN);
-            f = w;
-            w = w->next_poly;
+            mpfr_mul(f->re[k], f->re[k], s.b, MPFR_RNDN);
+            mpfr_mul(f->im[k], f->im[k], s.b, MPFR_RNDN);
         } else {
-            delete_coeff(f);
-            f = w;
-            w = w->next_poly;
+            mpfr_set_zero(f->re[k], 1);
+            mpfr_set_zero(f->im[k], 1);
         }
     }
-    mpfr_clear(a);
-    mpfr_clear(b);
 }
 
 // --------------------------------------------------------------------------
 //                      IMGZ
 // --------------------------------------------------------------------------
+//
+// h is scratch space
 
-void Imgz(poly *f, poly *g)
+void Imgz(hpoly *f, hpoly *g, hpoly *h)
 {
-    poly *h;
-    prod_poly(f, g);
-    diff(f);
-    G(f);
-    h = conj_poly(f);
-    sub_poly(f, h);
-    delete_poly(h);
-    multc_poly(f, zero, minusonehalf);
+    int k, d;
+
+    prod_hpoly(h, f, g);
+    diff(h);
+    G(h);
+    d = h->degree;
+    set_hpoly_degree(f, d);
+    for (k = 0; k <= d; k++) {
+        // f = h - conj(h)
+        mpfr_sub(f->re[k], h->re[k], h->re[d - k], MPFR_RNDN);
+        mpfr_add(f->im[k], h->im[k], h->im[d - k], MPFR_RNDN);
+    }
+    multc_hpoly(f, zero, minusonehalf);
 }
 
 // --------------------------------------------------------------------------
 //                      REGZ
 // --------------------------------------------------------------------------
+//
+// h is scratch space
 
-void Regz(poly *f, poly *g)
+void Regz(hpoly *f, hpoly *g, hpoly *h)
 {
-    poly *h;
-
-    prod_poly(f, g);
-    multc_poly(f, zero, minusone);
-    diff(f);
-    G(f);
-    h = conj_poly(f);
-    add_poly(f, h);
-    delete_poly(h);
-    multc_poly(f, onehalf, zero);
+    int k, d;
+
+    prod_hpoly(h, f, g);
+    multc_hpoly(h, zero, minusone);
+    diff(h);
+    G(h);
+    d = h->degree;
+    set_hpoly_degree(f, d);
+    for (k = 0; k <= d; k++) {
+        // f = h + conj(h)
+        mpfr_add(f->re[k], h->re[k], h->re[d - k], MPFR_RNDN);
+        mpfr_sub(f->im[k], h->im[k], h->im[d - k], MPFR_RNDN);
+    }
+    multc_hpoly(f, onehalf, zero);
 }
 
 // --------------------------------------------------------------------------
 //                      LL
 // --------------------------------------------------------------------------
+//
+// coefficient of (z*zb)^i in d/dz (f*g); h is scratch space
 
-void LL(poly *f, poly *g, int i, mpfr_t *v)
+void LL(hpoly *f, hpoly *g, hpoly *h, int i, mpfr_t *v)
 {
     mpfr_set_si(v[0], 0, MPFR_RNDN);
     mpfr_set_si(v[1], 0, MPFR_RNDN);
-    prod_poly(f, g);
-    diff(f);
-    while ((f = f->next_poly) != nullptr) {
-        if (i > f->degz)
-            break;
-        if (i == f->degz && i > f->degzb)
-            break;
-        if (i == f->degz && i == f->degzb) {
-            mpfr_set(v[0], f->re, MPFR_RNDN);
-            mpfr_set(v[1], f->im, MPFR_RNDN);
-            break;
-        }
+    prod_hpoly(h, f, g);
+    diff(h);
+    if (h->degree == 2 * i) {
+        mpfr_set(v[0], h->re[i], MPFR_RNDN);
+        mpfr_set(v[1], h->im[i], MPFR_RNDN);
     }
 }
 
@@ -223,22 +226,21 @@ void LL(poly *f, poly *g, int i, mpfr_t *v)
 //                      PART_LYAPUNOV_COEFF
 // --------------------------------------------------------------------------
 
-void part_lyapunov_coeff(char *s, int k, mpfr_t *returnvalue)
+void part_lyapunov_coeff(const lyapunov_job *job, char *s, int k,
+                         mpfr_t *returnvalue)
 {
-    poly *R[DIM1], *f = nullptr;
+    hpoly *R[DIM1];
     int i, t = 0, ok = 1, j = 0;
     char a[DIM1];
-    mpfr_t v[2], w;
-
-    mpfr_init(v[0]);
-    mpfr_init(v[1]);
-    mpfr_init(w);
+    scratch_mpf &sc = thread_scratch();
+    hpoly *f = &sc.f, *h = &sc.h;
+    mpfr_t *v = sc.v;
 
     for (i = 0; s[i]; i++) {
         if (s[i] == ',') {
-            R[t] =
-                find_poly(vec_field, atoi(a) + 1); /* find the homogeneus part
-                                                      of degree a+1 */
+            a[j] = 0;
+            R[t] = find_hpoly(job, atoi(a) + 1); /* find the homogeneus
+                                                    part of degree a+1 */
             if (R[t] == nullptr) {
                 ok = 0;
                 break;
@@ -251,50 +253,150 @@ void part_lyapunov_coeff(char *s, int k, mpfr_t *returnvalue)
         }
     }
     if (ok) {
-        R[t] = find_poly(vec_field, atoi(a) + 1);
+        a[j] = 0;
+        R[t] = find_hpoly(job, atoi(a) + 1);
         if (R[t] == nullptr)
             ok = 0;
     }
     if (ok) {
-        //        printf( "k=%d\n", k);
-        /*
-        for( i = 0; i <= t; i++ )
-        {
-            printf( "R[%d] = ",i);
-            DEBUG_POLY(R[i]);
-            printf( "\n");
-        }
-*/ f = (poly *)malloc(sizeof(poly));
-        f->next_poly = nullptr;
-        ins_poly(f, 0, 0, minusone, zero); /* f=-1 */
-        //        printf( "f = ",i);        DEBUG_POLY(f);        printf( "\n");
+        set_hpoly_degree(f, 0);
+        mpfr_set(f->re[0], minusone, MPFR_RNDN); /* f=-1 */
         for (i = 0; i < t; i++) {
             if (i % 2)
-                Regz(f, R[i]);
+                Regz(f, R[i], h);
             else
-                Imgz(f, R[i]);
-            //            printf( "f = ",i);        DEBUG_POLY(f);
-            //            printf( "\n");
+                Imgz(f, R[i], h);
         }
         if (t % 2) {
-            multc_poly(f, zero, minusone);
-            LL(f, R[t], (k - 1) / 2, v);
-            //            printf( "f = ",i);        DEBUG_POLY(f);
-            //            printf( "\n");
-            mpfr_set(w, v[1], MPFR_RNDN);
+            multc_hpoly(f, zero, minusone);
+            LL(f, R[t], h, (k - 1) / 2, v);
+            mpfr_set(*returnvalue, v[1], MPFR_RNDN);
         } else {
-            LL(f, R[t], (k - 1) / 2, v);
-            //            printf( "f = ",i);        DEBUG_POLY(f);
-            //            printf( "\n");
-            mpfr_set(w, v[0], MPFR_RNDN);
+            LL(f, R[t], h, (k - 1) / 2, v);
+            mpfr_set(*returnvalue, v[0], MPFR_RNDN);
         }
-        delete_poly(f);
     } else
-        mpfr_set_si(w, 0, MPFR_RNDN);
-    //    printf( "w = %f\n", mpfr_get_d(w));
-    mpfr_set(*returnvalue, w, MPFR_RNDN);
+        mpfr_set_si(*returnvalue, 0, MPFR_RNDN);
+}
+
+// --------------------------------------------------------------------------
+//                      LYAPUNOV_THREADS
+// --------------------------------------------------------------------------
+//
+// number of worker threads: P4_LYAPUNOV_THREADS if set, otherwise the
+// number of available cores.
+
+int lyapunov_threads(void)
+{
+    int n = 0;
+
+    if (getenv("P4_LYAPUNOV_THREADS") != nullptr)
+        n = atoi(getenv("P4_LYAPUNOV_THREADS"));
+    if (n <= 0)
+        n = (int)std::thread::hardware_concurrency();
+    if (n <= 0)
+        n = 1;
+    return n;
+}
+
+// --------------------------------------------------------------------------
+//                      SUM_TABLE
+// --------------------------------------------------------------------------
+//
+// the compositions of n, as listed in the sum table for n.  Each table
+// is checked (or created) and read only once per run, and then shared by
+// all jobs of a batch, so this may be called from several threads.
+
+const std::vector<std::string> &sum_table(int n)
+{
+    static std::map<int, std::vector<std::string>> tables;
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    std::map<int, std::vector<std::string>>::iterator it;
+    std::vector<std::string> *table;
+    FILE *fp;
+    char file_name[220];
+    char s[DIM2];
+
+    it = tables.find(n);
+    if (it != tables.end())
+        return it->second;
+
+    // check if table for the decomposition of n exist, if not create it
+    check_sum(file_name, n);
+
+    table = &tables[n];
+    fp = fopen(file_name, "r");
+    if (fp == nullptr) {
+        perror(file_name);
+        exit(-3);
+    }
+    while (!feof(fp)) {
+        if (fscanf(fp, "%s", s) != 1)
+            break;
+        if (!feof(fp))
+            table->push_back(s);
+    }
+    fclose(fp);
+    return *table;
+}
+
+// --------------------------------------------------------------------------
+//                      LYAPUNOV_COEFF
+// --------------------------------------------------------------------------
+//
+// The lyapunov coefficient of order k is minus the sum of the contributions
+// of every composition listed in the sum table for k-1.  The compositions
+// are handed out to (at most job->threads) worker threads, each working on
+// its own polynomials.
+// The contributions are kept in table order and added with mpfr_sum, which
+// rounds the exact sum only once, so the result does not depend on the
+// number of threads.
+//
+// The default precision of mpfr is a per-thread setting, so the workers
+// copy the one of the calling thread.
+
+void lyapunov_coeff(const lyapunov_job *job, int k, mpfr_t *returnvalue)
+{
+    const std::vector<std::string> &table = sum_table(k - 1);
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0);
+    mpfr_t *part;
+    mpfr_ptr *tab;
+    mpfr_prec_t prec;
+    size_t i, n;
+
+    n = table.size();
+    part = new mpfr_t[n];
+    tab = new mpfr_ptr[n];
+    for (i = 0; i < n; i++) {
+        mpfr_init(part[i]);
+        tab[i] = part[i];
+    }
+
+    prec = mpfr_get_default_prec();
+    auto work = [&]() {
+        char buf[DIM2];
+        size_t j;
+
+        mpfr_set_default_prec(prec);
+        while ((j = next++) < n) {
+            strcpy(buf, table[j].c_str());
+            part_lyapunov_coeff(job, buf, k, &part[j]);
+            mpfr_neg(part[j], part[j], MPFR_RNDN); // V -= part
+        }
+    };
+
+    for (i = 1; i < (size_t)job->threads && i < n; i++)
+        workers.push_back(std::thread(work));
+    work();
+    for (i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    mpfr_sum(*returnvalue, tab, n, MPFR_RNDN);
 
-    mpfr_clear(v[0]);
-    mpfr_clear(v[1]);
-    mpfr_clear(w);
+    for (i = 0; i < n; i++)
+        mpfr_clear(part[i]);
+    delete[] tab;
+    delete[] part;
 }
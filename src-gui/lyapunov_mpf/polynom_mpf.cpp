@@ -417,6 +417,185 @@ void read_poly(poly *f)
     mpfr_clear(re);
 }
 
+// --------------------------------------------------------------------------
+//                      INIT_HPOLY
+// --------------------------------------------------------------------------
+
+void init_hpoly(hpoly *f, int degree)
+{
+    f->degree = -1;
+    f->size = 0;
+    f->re = nullptr;
+    f->im = nullptr;
+    set_hpoly_degree(f, degree);
+}
+
+// --------------------------------------------------------------------------
+//                      SET_HPOLY_DEGREE
+// --------------------------------------------------------------------------
+//
+// make f the zero polynomial of the given degree, reusing its storage
+
+void set_hpoly_degree(hpoly *f, int degree)
+{
+    int k;
+
+    if (degree + 1 > f->size) {
+        for (k = 0; k < f->size; k++) {
+            mpfr_clear(f->re[k]);
+            mpfr_clear(f->im[k]);
+        }
+        delete[] f->re;
+        delete[] f->im;
+        f->size = degree + 1;
+        f->re = new mpfr_t[f->size];
+        f->im = new mpfr_t[f->size];
+        for (k = 0; k < f->size; k++) {
+            mpfr_init(f->re[k]);
+            mpfr_init(f->im[k]);
+        }
+    }
+    f->degree = degree;
+    for (k = 0; k <= degree; k++) {
+        mpfr_set_zero(f->re[k], 1);
+        mpfr_set_zero(f->im[k], 1);
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      CLEAR_HPOLY
+// --------------------------------------------------------------------------
+
+void clear_hpoly(hpoly *f)
+{
+    int k;
+
+    for (k = 0; k < f->size; k++) {
+        mpfr_clear(f->re[k]);
+        mpfr_clear(f->im[k]);
+    }
+    delete[] f->re;
+    delete[] f->im;
+    f->re = nullptr;
+    f->im = nullptr;
+    f->size = 0;
+    f->degree = -1;
+}
+
+// --------------------------------------------------------------------------
+//                      POLY_TO_HPOLY
+// --------------------------------------------------------------------------
+//
+// f = g, where g is a homogeneous polynomial of the given degree
+
+void poly_to_hpoly(hpoly *f, poly *g, int degree)
+{
+    set_hpoly_degree(f, degree);
+    while ((g = g->next_poly) != nullptr) {
+        mpfr_set(f->re[g->degzb], g->re, MPFR_RNDN);
+        mpfr_set(f->im[g->degzb], g->im, MPFR_RNDN);
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      PROD_HPOLY
+// --------------------------------------------------------------------------
+//
+// h = f*g.  Zero terms of g are skipped.  Every coefficient of h is
+// accumulated in the same order as prod_poly does, so both give the same
+// rounding.
+
+void prod_hpoly(hpoly *h, hpoly *f, hpoly *g)
+{
+    int i, j;
+    scratch_mpf &s = thread_scratch();
+
+    if (f->degree < 0 || g->degree < 0) {
+        set_hpoly_degree(h, -1);
+        return;
+    }
+    set_hpoly_degree(h, f->degree + g->degree);
+
+    for (j = 0; j <= g->degree; j++) {
+        if (mpfr_zero_p(g->re[j]) && mpfr_zero_p(g->im[j]))
+            continue;
+        for (i = 0; i <= f->degree; i++) {
+            // h[i+j] += f->re[i] * g->re[j] - f->im[i] * g->im[j];
+            mpfr_mul(s.r, f->re[i], g->re[j], MPFR_RNDN);
+            mpfr_mul(s.accu, f->im[i], g->im[j], MPFR_RNDN);
+            mpfr_sub(s.r, s.r, s.accu, MPFR_RNDN);
+            mpfr_add(h->re[i + j], h->re[i + j], s.r, MPFR_RNDN);
+
+            // h[i+j] += f->re[i] * g->im[j] + f->im[i] * g->re[j];
+            mpfr_mul(s.r, f->re[i], g->im[j], MPFR_RNDN);
+            mpfr_mul(s.accu, f->im[i], g->re[j], MPFR_RNDN);
+            mpfr_add(s.r, s.r, s.accu, MPFR_RNDN);
+            mpfr_add(h->im[i + j], h->im[i + j], s.r, MPFR_RNDN);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      MULTC_HPOLY
+// --------------------------------------------------------------------------
+
+void multc_hpoly(hpoly *f, mpfr_t re, mpfr_t im)
+{
+    int k;
+    scratch_mpf &s = thread_scratch();
+
+    for (k = 0; k <= f->degree; k++) {
+        // r = f->re * re - f->im * im;
+        mpfr_mul(s.r, f->re[k], re, MPFR_RNDN);
+        mpfr_mul(s.accu, f->im[k], im, MPFR_RNDN);
+        mpfr_sub(s.r, s.r, s.accu, MPFR_RNDN);
+
+        // i = f->re * im + f->im * re;
+        mpfr_mul(s.i, f->re[k], im, MPFR_RNDN);
+        mpfr_mul(s.accu, f->im[k], re, MPFR_RNDN);
+        mpfr_add(s.i, s.i, s.accu, MPFR_RNDN);
+
+        mpfr_swap(f->re[k], s.r);
+        mpfr_swap(f->im[k], s.i);
+    }
+}
+
+// --------------------------------------------------------------------------
+//                      THREAD_SCRATCH
+// --------------------------------------------------------------------------
+
+scratch_mpf::scratch_mpf()
+{
+    mpfr_init(r);
+    mpfr_init(i);
+    mpfr_init(accu);
+    mpfr_init(a);
+    mpfr_init(b);
+    mpfr_init(v[0]);
+    mpfr_init(v[1]);
+    init_hpoly(&f, -1);
+    init_hpoly(&h, -1);
+}
+
+scratch_mpf::~scratch_mpf()
+{
+    clear_hpoly(&h);
+    clear_hpoly(&f);
+    mpfr_clear(v[1]);
+    mpfr_clear(v[0]);
+    mpfr_clear(b);
+    mpfr_clear(a);
+    mpfr_clear(accu);
+    mpfr_clear(i);
+    mpfr_clear(r);
+}
+
+scratch_mpf &thread_scratch(void)
+{
+    static thread_local scratch_mpf s;
+    return s;
+}
+
 /*
 void main()
 {
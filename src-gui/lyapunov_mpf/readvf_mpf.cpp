@@ -27,7 +27,7 @@
 //                      SETMPFPRECISION
 // --------------------------------------------------------------------------
 
-void SetMPFPrecision(int digits)
+void SetMPFPrecision(int digits, std::string *log)
 {
     char buf[100];
     int k;
@@ -36,7 +36,7 @@ void SetMPFPrecision(int digits)
     mpfr_t accu3;
 
     sprintf(buf, "1e-%d", digits);
-    printf("Requesting %d digits of precision ...\n", digits);
+    job_printf(log, "Requesting %d digits of precision ...\n", digits);
 
     for (k = 10; k <= 10000; k++) {
         mpfr_set_default_prec(k);
@@ -60,19 +60,22 @@ void SetMPFPrecision(int digits)
         exit(1);
     }
     mpfr_init(accu1);
-    printf("Working with >= %d bits (=%ld bits) precision.\n", k,
-           mpfr_get_prec(accu1));
+    job_printf(log, "Working with >= %d bits (=%ld bits) precision.\n", k,
+               mpfr_get_prec(accu1));
     mpfr_clear(accu1);
     return;
 }
 
 // --------------------------------------------------------------------------
-//                      READ_TABLE
+//                      READ_JOB
 // --------------------------------------------------------------------------
+//
+// reads precision and vector field of one weak focus from fp, which is
+// positioned at the start of an input file, or of a job in a batch file,
+// together with the precision of mpfr to run the job with
 
-void read_table(const char *file)
+void read_job(FILE *fp, const char *file, lyapunov_job *job)
 {
-    FILE *fp;
     char re_string[10000];
     char im_string[10000];
     int l, t, degx, degy;
@@ -80,25 +83,28 @@ void read_table(const char *file)
     int prec0;
     mpfr_t re, im;
 
-    vec_field = new hom_poly;
-    vec_field->next_hom_poly = nullptr;
+    job->vec_field = new hom_poly;
+    job->vec_field->next_hom_poly = nullptr;
 
-    fp = fopen(file, "r");
-    if (fp == nullptr) {
-        perror(file);
+    if (fscanf(fp, "%d", &prec0) != 1) {
+        fprintf(stderr, "Error reading %s\n", file);
         exit(-5);
     }
-
-    fscanf(fp, "%d", &prec0);
     prec0 = (prec0 - 2) / 2;
-    SetMPFPrecision(prec0);
+    job->requested_digits = prec0;
+    if (prec0 <= 0)
+        job_printf(&job->log, "Adaptive precision requested ...\n");
+    else
+        SetMPFPrecision(prec0, &job->log);
     mpfr_set_default_prec(200);
-    mpfr_init_set_si(precision, 0, MPFR_RNDN); // precision=0
+    job->prec = mpfr_get_default_prec();
+    mpfr_init_set_si(job->precision, 0, MPFR_RNDN); // precision=0
     mpfr_init(re);
     mpfr_init(im);
 
-    fscanf(fp, "%d %s", &weakness_level, prec);
-    mpfr_set_str(precision, prec, 10, MPFR_RNDN);
+    fscanf(fp, "%d %s", &job->weakness_level, prec);
+    mpfr_set_str(job->precision, prec, 10, MPFR_RNDN);
+    job->precision_str = prec;
 
     fscanf(fp, "%i\n\n", &l);
     for (t = 1; t <= l; t++) {
@@ -106,9 +112,75 @@ void read_table(const char *file)
                im_string);
         mpfr_set_str(re, re_string, 10, MPFR_RNDN);
         mpfr_set_str(im, im_string, 10, MPFR_RNDN);
-        ins_hom_poly(vec_field, degx, degy, re, im);
+        ins_hom_poly(job->vec_field, degx, degy, re, im);
+        job->vf_coeffs.push_back({degx, degy, re_string, im_string});
     }
     mpfr_clear(re);
     mpfr_clear(im);
-    fclose(fp);
+
+    make_hvec_field(job);
+}
+
+// --------------------------------------------------------------------------
+//                      CLEAR_JOB
+// --------------------------------------------------------------------------
+//
+// frees what read_job has read
+
+void clear_job(lyapunov_job *job)
+{
+    hom_poly *f;
+    int i;
+
+    for (i = 0; i <= job->hvec_field_degree; i++) {
+        if (job->hvec_field[i] != nullptr) {
+            clear_hpoly(job->hvec_field[i]);
+            delete job->hvec_field[i];
+        }
+    }
+    delete[] job->hvec_field;
+    job->hvec_field = nullptr;
+    job->hvec_field_degree = -1;
+
+    while ((f = job->vec_field->next_hom_poly) != nullptr) {
+        job->vec_field->next_hom_poly = f->next_hom_poly;
+        delete_poly(f->p);
+        delete f;
+    }
+    delete job->vec_field;
+    job->vec_field = nullptr;
+
+    job->vf_coeffs.clear();
+    mpfr_clear(job->precision);
+}
+
+// --------------------------------------------------------------------------
+//                      MAKE_HVEC_FIELD
+// --------------------------------------------------------------------------
+//
+// dense copy of the vector field of job, indexed by total degree, used by
+// the lyapunov coefficient computations
+
+void make_hvec_field(lyapunov_job *job)
+{
+    hom_poly *f;
+    int i;
+
+    job->hvec_field_degree = -1;
+    for (f = job->vec_field->next_hom_poly; f != nullptr;
+         f = f->next_hom_poly)
+        if (f->total_degree > job->hvec_field_degree)
+            job->hvec_field_degree = f->total_degree;
+
+    job->hvec_field = new hpoly *[job->hvec_field_degree + 1];
+    for (i = 0; i <= job->hvec_field_degree; i++)
+        job->hvec_field[i] = nullptr;
+
+    for (f = job->vec_field->next_hom_poly; f != nullptr;
+         f = f->next_hom_poly) {
+        i = f->total_degree;
+        job->hvec_field[i] = new hpoly;
+        init_hpoly(job->hvec_field[i], -1);
+        poly_to_hpoly(job->hvec_field[i], f->p, i);
+    }
 }
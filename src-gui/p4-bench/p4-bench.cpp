@@ -0,0 +1,477 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// p4-bench: times the numerical core of P4 on a fixed set of reference
+// systems, so that a change in the integrators, the polynomial evaluation or
+// the reading of the tables can be measured.  The systems are in the
+// directory systems/ next to this file, together with their tables in the
+// format that Maple writes, so Maple is not needed (evaluating the .inp files
+// in p4 writes equivalent ones).  Every result is one line of JSON on the
+// output, see usage().
+
+#include <QFile>
+#include <QGuiApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "P4InputVF.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4Trace.hpp"
+#include "P4VFStudy.hpp"
+#include "custom.hpp"
+#include "main.hpp"
+#include "math_charts.hpp"
+#include "math_desep.hpp"
+#include "math_numerics.hpp"
+#include "math_orbits.hpp"
+#include "math_p4.hpp"
+#include "math_polynom.hpp"
+#include "p4settings.hpp"
+#include "structures.hpp"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#else
+#include "../version.h"
+#endif
+
+// the same globals as in p4, the core sources refer to them
+QString gP4version;
+QString gP4versionDate;
+QString gP4platform;
+
+bool gActionOnlyPrepareFile = false;
+bool gActionSaveAll = DEFAULTSAVEALL;
+
+QString gCmdLineFilename;
+bool gCmdLineAutoEvaluate{false};
+bool gCmdLineAutoPlot{false};
+bool gCmdLineAutoExit{false};
+
+P4ParentStudy gVFResults;
+P4InputVF *gThisVF{nullptr};
+
+// the reference systems, in the directory given on the command line
+static const char *sSystems[]{"quadratic", "cubic", "degenerate", "lyapunov",
+                              "piecewise"};
+
+// default minimum duration of one measurement (seconds) and number of
+// measurements of which the median is reported
+#define BENCH_MINTIME 0.2
+#define BENCH_REPETITIONS 5
+
+// number of sample points every benchmark cycles through (a power of two)
+#define BENCH_NUMPOINTS 256
+
+// number of steps after which an orbit is restarted, so that it does not
+// end up in a singular point where the steps are no longer typical
+#define BENCH_ORBITSTEPS 64
+
+static double sMinTime{BENCH_MINTIME};
+static int sRepetitions{BENCH_REPETITIONS};
+static const char *sFilter{nullptr};
+static FILE *sOutput{stdout};
+
+// results are written here, so that the compiler cannot drop the work
+static volatile double sSink;
+
+// -----------------------------------------------------------------------
+//                          USAGE
+// -----------------------------------------------------------------------
+
+static void usage()
+{
+    printf("p4-bench Version: %s Date: %s\n%s", VERSION, VERSIONDATE,
+           "SYNTAX: p4-bench [-o file] [-t seconds] [-r repetitions]\n"
+           "                [-f filter] directory [system ...]\n"
+           "\tTimes the numerical core on the reference systems in\n"
+           "\tdirectory (quadratic, cubic, degenerate, lyapunov and\n"
+           "\tpiecewise, or those given).  The tables of each system must\n"
+           "\tbe next to its .inp file.\n\n"
+           "\t-o file         write the results to file (default stdout)\n"
+           "\t-t seconds      minimum duration of a measurement (0.2)\n"
+           "\t-r repetitions  number of measurements per benchmark (5)\n"
+           "\t-f filter       only run benchmarks whose name contains\n"
+           "\t\tfilter\n\n"
+           "\tEvery benchmark writes one line of JSON:\n"
+           "\t{\"system\":..., \"benchmark\":..., \"iterations\":...,\n"
+           "\t \"repetitions\":..., \"median_ns\":..., \"min_ns\":...,\n"
+           "\t \"max_ns\":...}\n"
+           "\twith the times of one call, in nanoseconds.\n");
+}
+
+// -----------------------------------------------------------------------
+//                          TIMING
+// -----------------------------------------------------------------------
+
+template <typename OP> static double timeOps(OP &op, unsigned long n)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < n; i++)
+        op(i);
+    std::chrono::duration<double> t{std::chrono::steady_clock::now() - t0};
+    return t.count();
+}
+
+// Calls op(i) for i = 0, 1, ... as many times as fit in the minimum
+// duration, repeats this, and reports the time of one call.
+template <typename OP>
+static void bench(const char *system, const std::string &name, OP op)
+{
+    if (sFilter != nullptr && strstr(name.c_str(), sFilter) == nullptr)
+        return;
+
+    unsigned long n{1};
+    double t;
+    while ((t = timeOps(op, n)) < sMinTime) {
+        if (t < sMinTime / 16)
+            n *= 16;
+        else
+            n = static_cast<unsigned long>(n * 1.2 * sMinTime / t) + 1;
+    }
+
+    std::vector<double> ns;
+    for (int k = 0; k < sRepetitions; k++)
+        ns.push_back(timeOps(op, n) * 1e9 / n);
+    std::sort(ns.begin(), ns.end());
+
+    fprintf(sOutput,
+            "{\"system\":\"%s\",\"benchmark\":\"%s\",\"iterations\":%lu,"
+            "\"repetitions\":%d,\"median_ns\":%.2f,\"min_ns\":%.2f,"
+            "\"max_ns\":%.2f}\n",
+            system, name.c_str(), n, sRepetitions, ns[ns.size() / 2],
+            ns.front(), ns.back());
+    fflush(sOutput);
+}
+
+// -----------------------------------------------------------------------
+//                          BENCHMARKS
+// -----------------------------------------------------------------------
+
+struct p4benchpoint {
+    double x, y;
+};
+
+// points of the plane, and their images on the sphere through R2 and U1
+static std::vector<p4benchpoint> sPoints;
+static std::vector<p4benchpoint> sCylPoints;
+static double sR2Sphere[BENCH_NUMPOINTS][3];
+static double sU1Sphere[BENCH_NUMPOINTS][3];
+
+static void makePoints()
+{
+    std::mt19937 gen{4}; // fixed, so that every run uses the same points
+    std::uniform_real_distribution<double> xy{-3.0, 3.0};
+    std::uniform_real_distribution<double> r{0.0, 1.0};
+    std::uniform_real_distribution<double> theta{0.0, 2 * PI};
+
+    sPoints.clear();
+    sCylPoints.clear();
+    for (int i = 0; i < BENCH_NUMPOINTS; i++) {
+        sPoints.push_back({xy(gen), xy(gen)});
+        sCylPoints.push_back({r(gen), theta(gen)});
+    }
+}
+
+// the images on the sphere depend on the chosen (p,q)
+static void makeSpherePoints()
+{
+    for (int i = 0; i < BENCH_NUMPOINTS; i++) {
+        MATHFUNC(R2_to_sphere)(sPoints[i].x, sPoints[i].y, sR2Sphere[i]);
+        MATHFUNC(U1_to_sphere)
+        (sPoints[i].x / 3, sPoints[i].y, sU1Sphere[i]);
+    }
+}
+
+static const double *point(unsigned long i)
+{
+    return &sPoints[i & (BENCH_NUMPOINTS - 1)].x;
+}
+
+static const double *cylPoint(unsigned long i)
+{
+    return &sCylPoints[i & (BENCH_NUMPOINTS - 1)].x;
+}
+
+static void benchTables(const char *system)
+{
+    QString bare{gThisVF->getbarefilename()};
+    bench(system, "readTables", [&bare](unsigned long) {
+        gVFResults.readTables(bare, false, false);
+    });
+}
+
+static void benchPolynomials(const char *system)
+{
+    P4VFStudy *vf{gVFResults.vf_[0].get()};
+
+    bench(system, "eval_term2", [vf](unsigned long i) {
+        sSink = eval_term2(vf->f_vec_field_[0], point(i));
+    });
+    bench(system, "eval_term2:U1", [vf](unsigned long i) {
+        sSink = eval_term2(vf->vec_field_U1_[0], point(i));
+    });
+    if (vf->vec_field_C_[0] != nullptr) {
+        bench(system, "eval_term3", [vf](unsigned long i) {
+            sSink = eval_term3(vf->vec_field_C_[0], cylPoint(i));
+        });
+    }
+}
+
+static void benchRk78(const char *system)
+{
+    double y[2]{0.3, 0.2};
+    double h{gVFResults.config_step_};
+
+    gVFResults.K_ = 0;
+    bench(system, "rk78", [&y, &h](unsigned long i) {
+        if ((i % BENCH_ORBITSTEPS) == 0) {
+            y[0] = 0.3;
+            y[1] = 0.2;
+            h = gVFResults.config_step_;
+        }
+        rk78(eval_r_vec_field, y, &h, gVFResults.config_hmi_,
+             gVFResults.config_hma_, gVFResults.config_tolerance_);
+        sSink = y[0];
+    });
+}
+
+// One call is one step of the orbit, as in integrate_orbit, starting from a
+// finite point or from a point close to infinity in U1.
+static void benchOrbit(const char *system, const char *where, double x,
+                       double y, void (*to_sphere)(double, double, double *))
+{
+    double start[3], pcoord[3];
+    double hhi{gVFResults.config_step_};
+    int dashes, dir;
+
+    to_sphere(x, y, start);
+    std::string name{gVFResults.plweights_ ? "integrate_lyapunov_orbit"
+                                           : "integrate_poincare_orbit"};
+    bench(system, name + ":" + where,
+          [&start, &pcoord, &hhi, &dashes, &dir](unsigned long i) {
+              if ((i % BENCH_ORBITSTEPS) == 0) {
+                  copy_x_into_y(start, pcoord);
+                  hhi = gVFResults.config_step_;
+              }
+              if (!prepareVfForIntegration(pcoord))
+                  copy_x_into_y(start, pcoord);
+              MATHFUNC(integrate_sphere_orbit)
+              (pcoord[0], pcoord[1], pcoord[2], pcoord, hhi, dashes, dir,
+               gVFResults.config_hmi_, gVFResults.config_hma_);
+              sSink = pcoord[0];
+          });
+}
+
+static void benchVFIndex(const char *system)
+{
+    static const struct {
+        const char *name;
+        int (P4InputVF::*getVFIndex)(const double *);
+    } charts[]{{"getVFIndex_R2", &P4InputVF::getVFIndex_R2},
+               {"getVFIndex_U1", &P4InputVF::getVFIndex_U1},
+               {"getVFIndex_U2", &P4InputVF::getVFIndex_U2},
+               {"getVFIndex_V1", &P4InputVF::getVFIndex_V1},
+               {"getVFIndex_V2", &P4InputVF::getVFIndex_V2}};
+
+    for (const auto &c : charts) {
+        auto f = c.getVFIndex;
+        bench(system, c.name, [f](unsigned long i) {
+            sSink = (gThisVF->*f)(point(i));
+        });
+    }
+    bench(system, "getVFIndex_sphere", [](unsigned long i) {
+        sSink = gThisVF->getVFIndex_sphere(
+            sR2Sphere[i & (BENCH_NUMPOINTS - 1)]);
+    });
+    if (gVFResults.plweights_) {
+        bench(system, "getVFIndex_cyl", [](unsigned long i) {
+            sSink = gThisVF->getVFIndex_cyl(cylPoint(i));
+        });
+    }
+}
+
+// the chart transforms through the pointers set up by
+// setupCoordinateTransformations, as the integrators use them
+static void benchCharts(const char *system)
+{
+    double c[3];
+
+    bench(system, "R2_to_sphere", [&c](unsigned long i) {
+        MATHFUNC(R2_to_sphere)(point(i)[0], point(i)[1], c);
+        sSink = c[0];
+    });
+    bench(system, "sphere_to_R2", [&c](unsigned long i) {
+        const double *p{sR2Sphere[i & (BENCH_NUMPOINTS - 1)]};
+        MATHFUNC(sphere_to_R2)(p[0], p[1], p[2], c);
+        sSink = c[0];
+    });
+    bench(system, "U1_to_sphere", [&c](unsigned long i) {
+        MATHFUNC(U1_to_sphere)(point(i)[0] / 3, point(i)[1], c);
+        sSink = c[0];
+    });
+    bench(system, "sphere_to_U1", [&c](unsigned long i) {
+        const double *p{sU1Sphere[i & (BENCH_NUMPOINTS - 1)]};
+        MATHFUNC(sphere_to_U1)(p[0], p[1], p[2], c);
+        sSink = c[0];
+    });
+    bench(system, "V1_to_sphere", [&c](unsigned long i) {
+        MATHFUNC(V1_to_sphere)(point(i)[0] / 3, point(i)[1], c);
+        sSink = c[0];
+    });
+    if (gVFResults.plweights_) {
+        bench(system, "cylinder_to_plsphere", [&c](unsigned long i) {
+            cylinder_to_plsphere(cylPoint(i)[0], cylPoint(i)[1], c);
+            sSink = c[0];
+        });
+    }
+}
+
+// the transformations back from the charts of the blow-ups of all
+// degenerate points, as used when integrating their separatrices
+static void benchBlowUp(const char *system)
+{
+    std::vector<P4Blowup::blow_up_points *> blowups;
+    for (const auto &vf : gVFResults.vf_)
+        for (auto de = vf->firstDePoint_; de != nullptr; de = de->next_de)
+            for (auto b = de->blow_up; b != nullptr;
+                 b = b->next_blow_up_point)
+                blowups.push_back(b);
+    if (blowups.empty())
+        return;
+
+    double c[2];
+    bench(system, "make_transformations", [&blowups, &c](unsigned long i) {
+        auto b = blowups[i % blowups.size()];
+        const double *y{point(i)};
+        make_transformations(b->trans,
+                             b->x0 + (b->a11 * y[0] + b->a12 * y[1]) / 100,
+                             b->y0 + (b->a21 * y[0] + b->a22 * y[1]) / 100,
+                             c);
+        sSink = c[0];
+    });
+}
+
+static bool benchSystem(const char *dir, const char *system)
+{
+    gThisVF->filename_ = QString{"%1/%2.inp"}.arg(dir).arg(system);
+    if (!gThisVF->load()) {
+        fprintf(stderr, "Cannot load %s\n",
+                QFile::encodeName(gThisVF->filename_).constData());
+        return false;
+    }
+    if (!gVFResults.readTables(gThisVF->getbarefilename(), false, false)) {
+        fprintf(stderr, "Cannot read the tables of %s\n", system);
+        return false;
+    }
+
+    // reading the tables resets the transformations of the charts
+    benchTables(system);
+    gVFResults.setupCoordinateTransformations();
+    makeSpherePoints();
+
+    benchPolynomials(system);
+    benchRk78(system);
+    benchOrbit(system, "R2", 0.3, 0.2, gVFResults.R2_to_sphere);
+    benchOrbit(system, "U1", 0.05, 0.3, gVFResults.U1_to_sphere);
+    benchVFIndex(system);
+    benchCharts(system);
+    benchBlowUp(system);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                          MAIN
+// -----------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    int returnvalue{0};
+    int i;
+
+    for (i = 1; i < argc - 1 && argv[i][0] == '-'; i += 2) {
+        if (!strcmp(argv[i], "-o")) {
+            sOutput = fopen(argv[i + 1], "w");
+            if (sOutput == nullptr) {
+                fprintf(stderr, "Cannot write %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-t")) {
+            sMinTime = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-r")) {
+            sRepetitions = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-f")) {
+            sFilter = argv[i + 1];
+        } else {
+            break;
+        }
+    }
+    if (i >= argc || argv[i][0] == '-' || sMinTime <= 0 || sRepetitions < 1) {
+        usage();
+        return -1;
+    }
+
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    gP4platform = "";
+    gP4version = VERSION;
+    gP4versionDate = VERSIONDATE;
+
+    auto app = new QGuiApplication{argc, argv};
+    app->setOrganizationName("P4");
+    app->setOrganizationDomain("gsd.uab.cat");
+    app->setApplicationName("P4");
+
+    readP4Settings();
+    P4Trace::start(qgetenv("P4_TRACE").constData());
+
+    gThisVF = new P4InputVF{};
+    makePoints();
+
+    const char *dir{argv[i++]};
+    if (i == argc) {
+        for (auto system : sSystems)
+            if (!benchSystem(dir, system))
+                returnvalue = 1;
+    } else {
+        for (; i < argc; i++)
+            if (!benchSystem(dir, argv[i]))
+                returnvalue = 1;
+    }
+
+    if (sOutput != stdout)
+        fclose(sOutput);
+
+    delete gThisVF;
+    gThisVF = nullptr;
+    delete app;
+    app = nullptr;
+
+    P4Trace::stop();
+    return returnvalue;
+}
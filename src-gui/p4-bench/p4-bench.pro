@@ -0,0 +1,48 @@
+#  This file is part of P4
+# 
+#  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier,
+#                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+# 
+#  P4 is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU Lesser General Public License as published
+#  by the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+# 
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Lesser General Public License for more details.
+# 
+#  You should have received a copy of the GNU Lesser General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#
+# P4-BENCH PROJECT FILE.  Use qmake to build makefile
+#
+# Micro-benchmarks of the numerical core on the reference systems in
+# systems/, run as: p4-bench systems > results.json
+
+include(../../P4.pri)
+include(../p4/p4core.pri)
+
+CONFIG += qt
+CONFIG += c++14
+CONFIG += console
+
+QMAKE_CXXFLAGS += -std=c++14
+
+unix {
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter
+}
+
+macx {
+    CONFIG -= app_bundle
+    QMAKE_LFLAGS += -L/usr/local/opt/qt/lib
+    QMAKE_CXXFLAGS += -I/usr/local/opt/qt/include -I/usr/local/include
+}
+
+DESTDIR = $$BUILD_DIR/p4/
+
+SOURCES += p4-bench.cpp
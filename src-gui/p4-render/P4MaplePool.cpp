@@ -0,0 +1,238 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4MaplePool.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QStringList>
+
+#include <algorithm>
+
+#include "P4InputVF.hpp"
+#include "P4Trace.hpp"
+#include "file_paths.hpp"
+#include "p4settings.hpp"
+
+P4MaplePool::~P4MaplePool()
+{
+    while (!sessions_.empty())
+        closeSession(sessions_.size() - 1);
+}
+
+void P4MaplePool::setMaxJobs(int n)
+{
+    maxJobs_ = n;
+    startNext();
+}
+
+void P4MaplePool::evaluate(const QString &basename)
+{
+    if (std::find(queue_.begin(), queue_.end(), basename) != queue_.end())
+        return;
+    for (auto const &s : sessions_) {
+        if (s.basename == basename)
+            return;
+    }
+
+    queue_.push_back(basename);
+    startNext();
+}
+
+// -----------------------------------------------------------------------
+//                      SESSIONS
+// -----------------------------------------------------------------------
+
+bool P4MaplePool::startSession()
+{
+    // the scripts come on the standard input
+    auto proc = new QProcess{this};
+    proc->setWorkingDirectory(QDir::currentPath());
+    proc->setProcessChannelMode(QProcess::MergedChannels);
+    QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
+                     &P4MaplePool::onReadyRead);
+    QObject::connect(
+        proc,
+        static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+            &QProcess::finished),
+        this, &P4MaplePool::onProcessFinished);
+
+    proc->start(getMapleExe(), QStringList{"-q"}, QIODevice::ReadWrite);
+    if (!proc->waitForStarted()) {
+        delete proc;
+        return false;
+    }
+    sessions_.push_back({proc, QString{}, nullptr, QByteArray{}, 0});
+    return true;
+}
+
+void P4MaplePool::closeSession(size_t index)
+{
+    session &s = sessions_[index];
+
+    QObject::disconnect(s.process, nullptr, this, nullptr);
+    s.process->kill();
+    s.process->waitForFinished();
+    delete s.process;
+    delete s.log;
+    sessions_.erase(sessions_.begin() + index);
+}
+
+size_t P4MaplePool::findSession(const QObject *process) const
+{
+    size_t i;
+
+    for (i = 0; i < sessions_.size(); i++) {
+        if (sessions_[i].process == process)
+            break;
+    }
+    return i;
+}
+
+void P4MaplePool::startNext()
+{
+    QString basename;
+    size_t i;
+
+    // sessions beyond maxJobs are not needed any more
+    for (i = sessions_.size(); i-- > 0;) {
+        if (static_cast<int>(sessions_.size()) <= maxJobs_)
+            break;
+        if (sessions_[i].basename.isEmpty())
+            closeSession(i);
+    }
+
+    while (!queue_.empty()) {
+        for (i = 0; i < sessions_.size(); i++) {
+            if (sessions_[i].basename.isEmpty())
+                break;
+        }
+        if (i == sessions_.size()) {
+            if (static_cast<int>(sessions_.size()) >= maxJobs_)
+                break;
+            if (startSession())
+                i = sessions_.size() - 1;
+        }
+
+        basename = queue_.front();
+        queue_.pop_front();
+        if (i == sessions_.size() || !feed(i, basename)) {
+            removeFile(basename + ".txt");
+            emit evaluated(basename, false);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      SCRIPTS
+// -----------------------------------------------------------------------
+
+bool P4MaplePool::feed(size_t index, const QString &basename)
+{
+    session &s = sessions_[index];
+    QFile script{basename + ".txt"};
+
+    if (!script.open(QIODevice::ReadOnly))
+        return false;
+
+    // the output of Maple is kept next to the tables, to find out why
+    // an evaluation failed
+    s.log = new QFile{basename + ".log"};
+    s.log->open(QIODevice::WriteOnly | QIODevice::Truncate);
+    s.basename = basename;
+    s.line.clear();
+    s.traceStart = P4Trace::now();
+
+    s.process->write(script.readAll());
+    return true;
+}
+
+// The output is copied to the log, and scanned for MAPLE_SESSIONDONE.
+void P4MaplePool::onReadyRead()
+{
+    size_t index{findSession(sender())};
+    if (index == sessions_.size())
+        return;
+    session &s = sessions_[index];
+    QByteArray data{s.process->readAllStandardOutput()};
+    QByteArray line;
+
+    // the banner, or what Maple says after a script
+    if (s.basename.isEmpty())
+        return;
+
+    s.log->write(data);
+    for (auto c : data) {
+        if (c != '\n') {
+            s.line.append(c);
+            continue;
+        }
+        line = s.line.trimmed();
+        s.line.clear();
+        // not the echo of the printf, where a quote follows
+        if (line.contains(MAPLE_SESSIONDONE " ")) {
+            // s is not used any more: the next script may already be fed
+            done(index, line.endsWith(MAPLE_SESSIONDONE " 0"));
+            return;
+        }
+    }
+}
+
+void P4MaplePool::done(size_t index, bool ok)
+{
+    session &s = sessions_[index];
+    QString basename{s.basename};
+
+    P4Trace::completeAsync("Maple", "maple", P4Trace::newId(), s.traceStart);
+    delete s.log;
+    s.log = nullptr;
+    s.basename.clear();
+
+    removeFile(basename + ".txt");
+    emit evaluated(basename, ok);
+
+    startNext();
+}
+
+// Maple has ended: a script that was running has failed, and the session is
+// started again when a script needs it.
+void P4MaplePool::onProcessFinished()
+{
+    size_t index{findSession(sender())};
+    if (index == sessions_.size())
+        return;
+    session &s = sessions_[index];
+    QString basename{s.basename};
+
+    if (!basename.isEmpty())
+        P4Trace::completeAsync("Maple", "maple", P4Trace::newId(),
+                               s.traceStart);
+    if (s.log != nullptr)
+        s.log->write(s.process->readAllStandardOutput());
+    delete s.log;
+    s.process->deleteLater();
+    sessions_.erase(sessions_.begin() + index);
+
+    if (!basename.isEmpty()) {
+        removeFile(basename + ".txt");
+        emit evaluated(basename, false);
+    }
+    startNext();
+}
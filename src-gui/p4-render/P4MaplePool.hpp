@@ -0,0 +1,85 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QString>
+
+#include <deque>
+#include <vector>
+
+class QFile;
+class QProcess;
+
+// Runs the Maple scripts written by P4InputVF::prepare, at most maxJobs at
+// the same time.  A script that is already queued or running is not added
+// twice.  evaluated is emitted when the script has ended; whether the tables
+// are complete is for the caller to check.
+//
+// Maple is started once for every job that runs at the same time and is kept
+// open: the scripts are fed to it on its standard input, so they must be
+// written with P4InputVF::sessionScripts_ set.  Every script still starts
+// with restart, so nothing is left from the one before, but the start-up of
+// Maple is paid only once.  A session in which Maple ends is started again
+// for the next script.
+
+class P4MaplePool : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit P4MaplePool(QObject *parent = nullptr) : QObject{parent} {}
+    ~P4MaplePool();
+
+    // sessions beyond n are closed once they are idle
+    void setMaxJobs(int n);
+    int maxJobs() const { return maxJobs_; }
+
+    // runs basename.txt; the output of Maple goes to basename.log
+    void evaluate(const QString &basename);
+
+  signals:
+    void evaluated(const QString &basename, bool ok);
+
+  private slots:
+    void onReadyRead();
+    void onProcessFinished();
+
+  private:
+    struct session {
+        QProcess *process;
+        QString basename;     // script that is running, empty if idle
+        QFile *log;           // its basename.log
+        QByteArray line;      // the last line of the output, as far as read
+        long long traceStart; // see P4Trace
+    };
+    std::vector<session> sessions_;
+    std::deque<QString> queue_;
+    int maxJobs_{1};
+
+    void startNext();
+    bool startSession();
+    bool feed(size_t index, const QString &basename);
+    void done(size_t index, bool ok);
+    void closeSession(size_t index);
+    size_t findSession(const QObject *process) const;
+};
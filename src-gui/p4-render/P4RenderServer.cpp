@@ -0,0 +1,407 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4RenderServer.hpp"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QtEndian>
+
+#include <cstring>
+
+#include "P4InputVF.hpp"
+#include "P4MaplePool.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4Sweep.hpp"
+#include "P4TrajectoryStore.hpp"
+#include "math_p4.hpp"
+#include "p4-render.hpp"
+#include "structures.hpp"
+
+// a request that does not end after this many bytes is dropped
+#define RPC_MAXLINE (1 << 20)
+
+P4RenderServer::P4RenderServer(P4MaplePool *pool, QObject *parent)
+    : QObject{parent}, server_{new QLocalServer{this}}, pool_{pool}
+{
+    QObject::connect(server_, &QLocalServer::newConnection, this,
+                     &P4RenderServer::onNewConnection);
+}
+
+bool P4RenderServer::listen(const QString &name)
+{
+    // a socket left behind by a server that crashed
+    QLocalServer::removeServer(name);
+    return server_->listen(name);
+}
+
+// -----------------------------------------------------------------------
+//                      CONNECTIONS
+// -----------------------------------------------------------------------
+
+void P4RenderServer::onNewConnection()
+{
+    QLocalSocket *socket;
+
+    while ((socket = server_->nextPendingConnection()) != nullptr) {
+        QObject::connect(socket, &QLocalSocket::readyRead, this,
+                         &P4RenderServer::onReadyRead);
+        QObject::connect(socket, &QLocalSocket::disconnected, socket,
+                         &QObject::deleteLater);
+    }
+}
+
+void P4RenderServer::onReadyRead()
+{
+    auto socket = qobject_cast<QLocalSocket *>(sender());
+    if (socket == nullptr)
+        return;
+
+    while (socket->canReadLine())
+        handleRequest(socket, socket->readLine().trimmed());
+
+    if (socket->bytesAvailable() > RPC_MAXLINE) {
+        replyError(socket, QJsonValue{}, RPC_INVALIDREQUEST,
+                   "request too long");
+        socket->disconnectFromServer();
+    }
+}
+
+void P4RenderServer::reply(QLocalSocket *socket, const QJsonValue &id,
+                           const QJsonValue &result,
+                           const std::vector<QByteArray> &frames)
+{
+    QJsonObject response{
+        {"jsonrpc", "2.0"}, {"id", id}, {"result", result}};
+    quint32 length;
+
+    socket->write(QJsonDocument{response}.toJson(QJsonDocument::Compact));
+    socket->write("\n");
+    for (auto const &frame : frames) {
+        length = qToLittleEndian(static_cast<quint32>(frame.size()));
+        socket->write(reinterpret_cast<const char *>(&length),
+                      sizeof(length));
+        socket->write(frame);
+    }
+    socket->flush();
+}
+
+void P4RenderServer::replyError(QLocalSocket *socket, const QJsonValue &id,
+                                int code, const QString &message)
+{
+    QJsonObject response{
+        {"jsonrpc", "2.0"},
+        {"id", id},
+        {"error", QJsonObject{{"code", code}, {"message", message}}}};
+
+    socket->write(QJsonDocument{response}.toJson(QJsonDocument::Compact));
+    socket->write("\n");
+    socket->flush();
+}
+
+// -----------------------------------------------------------------------
+//                      REQUESTS
+// -----------------------------------------------------------------------
+
+void P4RenderServer::handleRequest(QLocalSocket *socket,
+                                   const QByteArray &line)
+{
+    QJsonParseError err;
+    QJsonDocument doc;
+    QJsonObject request, params;
+    QJsonValue id;
+    QString method;
+
+    if (line.isEmpty())
+        return;
+
+    doc = QJsonDocument::fromJson(line, &err);
+    if (err.error != QJsonParseError::NoError) {
+        replyError(socket, QJsonValue{}, RPC_PARSEERROR, err.errorString());
+        return;
+    }
+    if (!doc.isObject()) {
+        replyError(socket, QJsonValue{}, RPC_INVALIDREQUEST,
+                   "invalid request");
+        return;
+    }
+    request = doc.object();
+    id = request["id"];
+    method = request["method"].toString();
+    params = request["params"].toObject();
+    if (method.isEmpty()) {
+        replyError(socket, id, RPC_INVALIDREQUEST, "invalid request");
+        return;
+    }
+
+    if (method == "evaluate") {
+        evaluate(socket, id, params);
+        return;
+    }
+
+    if (method == "maplejobs") {
+        int n{params["n"].toInt()};
+        if (n < 1) {
+            replyError(socket, id, RPC_INVALIDPARAMS, "expected n >= 1");
+            return;
+        }
+        pool_->setMaxJobs(n);
+        reply(socket, id, n);
+        return;
+    }
+
+    if (method == "shutdown") {
+        reply(socket, id, true);
+        socket->waitForBytesWritten(1000);
+        QCoreApplication::quit();
+        return;
+    }
+
+    if (method == "load") {
+        QString file{params["file"].toString()};
+        study_ = "";
+        if (file.isEmpty() || !loadInput(file)) {
+            replyError(socket, id, RPC_FAILED, "cannot load " + file);
+            return;
+        }
+        if (!loadStudy()) {
+            replyError(socket, id, RPC_FAILED,
+                       "cannot read the computation results of " + file);
+            return;
+        }
+        study_ = file;
+        reply(socket, id, summary());
+        return;
+    }
+
+    // the other methods work on the study that has been loaded
+    if (method != "summary" && method != "run" && method != "orbit" &&
+        method != "limitcycles") {
+        replyError(socket, id, RPC_METHODNOTFOUND,
+                   "unknown method " + method);
+        return;
+    }
+    if (study_.isEmpty()) {
+        replyError(socket, id, RPC_NOSTUDY, "no study has been loaded");
+        return;
+    }
+
+    if (method == "summary") {
+        reply(socket, id, summary());
+        return;
+    }
+
+    if (method == "run") {
+        QJsonArray commands{params["commands"].toArray()};
+        for (int i = 0; i < commands.size(); i++) {
+            if (!executeJobLine("request", i + 1,
+                                commands[i].toString())) {
+                replyError(socket, id, RPC_FAILED, lastJobError());
+                return;
+            }
+        }
+        reply(socket, id, summary());
+        return;
+    }
+
+    if (method == "orbit") {
+        P4Orbits::orbits *last{gVFResults.currentOrbit_};
+        QString command{"orbit " +
+                        QString::number(params["x"].toDouble(), 'g', 17) +
+                        " " +
+                        QString::number(params["y"].toDouble(), 'g', 17) +
+                        " " + params["direction"].toString("both")};
+        if (!params["x"].isDouble() || !params["y"].isDouble()) {
+            replyError(socket, id, RPC_INVALIDPARAMS, "expected x and y");
+            return;
+        }
+        if (!executeJobLine("request", 1, command)) {
+            replyError(socket, id, RPC_FAILED, lastJobError());
+            return;
+        }
+        if (gVFResults.currentOrbit_ == last) {
+            replyError(socket, id, RPC_FAILED, "orbit not started");
+            return;
+        }
+        QByteArray points{encodePoints(gVFResults.currentOrbit_)};
+        reply(socket, id,
+              QJsonObject{{"frames", 1},
+                          {"points", points.size() / (2 * 8)}},
+              {points});
+        return;
+    }
+
+    if (method == "limitcycles") {
+        static const char *names[]{"x0", "y0", "x1", "y1", "grid"};
+        P4Orbits::orbits *last{gVFResults.firstLimCycle_};
+        QJsonArray cycles;
+        std::vector<QByteArray> frames;
+        QString command{"limitcycles"};
+
+        for (auto name : names) {
+            if (!params[name].isDouble()) {
+                replyError(socket, id, RPC_INVALIDPARAMS,
+                           QString{"expected "} + name);
+                return;
+            }
+            command += " " + QString::number(params[name].toDouble(), 'g', 17);
+        }
+        while (last != nullptr && last->next != nullptr)
+            last = last->next;
+
+        if (!executeJobLine("request", 1, command)) {
+            replyError(socket, id, RPC_FAILED, lastJobError());
+            return;
+        }
+
+        // the limit cycles that were found are added at the end of the list
+        for (auto lc = (last != nullptr) ? last->next
+                                         : gVFResults.firstLimCycle_;
+             lc != nullptr; lc = lc->next) {
+            frames.push_back(encodePoints(lc));
+            cycles.append(frames.back().size() / (2 * 8));
+        }
+        reply(socket, id,
+              QJsonObject{{"frames", static_cast<int>(frames.size())},
+                          {"cycles", cycles}},
+              frames);
+        return;
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      EVALUATE
+// -----------------------------------------------------------------------
+
+// The parameter values are written into a sweep of one point, which takes
+// care of the cache and of running Maple in the pool.  The reply is sent
+// when the point has been evaluated; in the meantime other requests are
+// handled.
+void P4RenderServer::evaluate(QLocalSocket *socket, const QJsonValue &id,
+                              const QJsonObject &params)
+{
+    QString file{params["file"].toString()};
+    QJsonObject values{params["parameters"].toObject()};
+    P4Sweep *sweep;
+    bool ok{true};
+
+    if (file.isEmpty() || !loadInput(file)) {
+        replyError(socket, id, RPC_FAILED, "cannot load " + file);
+        if (!study_.isEmpty())
+            loadInput(study_);
+        return;
+    }
+
+    sweep = new P4Sweep{pool_, this};
+    for (auto it = values.begin(); it != values.end() && ok; ++it) {
+        double v{it.value().toDouble()};
+        ok = it.value().isDouble() && sweep->addParameter(it.key(), v, v, 1);
+    }
+    if (!ok) {
+        replyError(socket, id, RPC_INVALIDPARAMS,
+                   "unknown parameter or invalid value");
+    } else {
+        sweep->setCacheDir(
+            params["cache"].toString(gThisVF->getbarefilename() + "_cache"));
+
+        QPointer<QLocalSocket> client{socket};
+        QObject::connect(
+            sweep, &P4Sweep::pointEvaluated, this,
+            [this, client, id, sweep](int index) {
+                const P4Sweep::point &pt = sweep->points()[index];
+                if (client == nullptr)
+                    return;
+                if (pt.status == P4SweepStatus::sweep_failed)
+                    replyError(client, id, RPC_FAILED,
+                               "evaluation failed, see " + pt.basename +
+                                   ".log");
+                else
+                    reply(client, id,
+                          QJsonObject{
+                              {"basename", pt.basename},
+                              {"status",
+                               (pt.status == P4SweepStatus::sweep_cached)
+                                   ? "cached"
+                                   : "evaluated"}});
+            });
+        QObject::connect(sweep, &P4Sweep::finished, sweep,
+                         &QObject::deleteLater);
+        ok = sweep->start();
+        if (!ok)
+            replyError(socket, id, RPC_FAILED,
+                       "cannot write the input files of the evaluation");
+    }
+    if (!ok)
+        delete sweep;
+
+    // gThisVF must again describe the study in gVFResults
+    if (!study_.isEmpty())
+        loadInput(study_);
+}
+
+// -----------------------------------------------------------------------
+//                      HELPERS
+// -----------------------------------------------------------------------
+
+bool P4RenderServer::loadInput(const QString &file)
+{
+    gThisVF->filename_ = file;
+    return gThisVF->load();
+}
+
+QJsonObject P4RenderServer::summary() const
+{
+    int counts[STUDY_NUMCOUNTS];
+    QJsonObject result;
+    int k;
+
+    summarizeStudy(counts);
+    for (k = 0; k < STUDY_NUMCOUNTS; k++)
+        result.insert(studyCountName(k), counts[k]);
+    return result;
+}
+
+// Converts the points of the orbit to view coordinates, as little endian
+// doubles.
+QByteArray P4RenderServer::encodePoints(const P4Orbits::orbits *orbit)
+{
+    QByteArray buf;
+
+    auto add = [&buf](const double *pcoord) {
+        double ucoord[2];
+        quint64 bits;
+        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2],
+                                      ucoord);
+        for (auto u : ucoord) {
+            memcpy(&bits, &u, sizeof(bits));
+            bits = qToLittleEndian(bits);
+            buf.append(reinterpret_cast<const char *>(&bits), sizeof(bits));
+        }
+    };
+
+    add(orbit->pcoord);
+    P4CurveReader r{orbit->firstpt, true};
+    for (auto pt = r.next(); pt != nullptr; pt = r.next())
+        add(pt->pcoord);
+    return buf;
+}
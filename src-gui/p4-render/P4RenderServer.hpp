@@ -0,0 +1,112 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+
+class P4MaplePool;
+
+namespace P4Orbits
+{
+struct orbits;
+}
+
+// error codes of JSON-RPC 2.0, and our own
+#define RPC_PARSEERROR -32700
+#define RPC_INVALIDREQUEST -32600
+#define RPC_METHODNOTFOUND -32601
+#define RPC_INVALIDPARAMS -32602
+#define RPC_FAILED -32000   // the request could not be carried out
+#define RPC_NOSTUDY -32001  // load a study first
+
+// Server mode of p4-render: p4-render -d socket.  Clients connect to the
+// local socket and send JSON-RPC 2.0 requests, one per line, and get one
+// line back for every request, followed by the binary frames that its result
+// announces.  The methods are:
+//
+//   evaluate {file, parameters: {label: value, ...}, cache: directory}
+//       Evaluates the vector field with Maple, with other values of its
+//       parameters.  The result is cached as in a sweep of p4-render, in
+//       file_cache by default.  Result: {basename, status}; load then
+//       reads basename.inp.  Evaluations run at the same time in the Maple
+//       sessions of P4MaplePool, at most maplejobs of them, and are
+//       answered as soon as they are done.
+//   load {file}
+//       Reads the tables of file.inp.  Result: the number of singularities
+//       of each kind, as in atlas.csv.
+//   run {commands: ["separatrices", "output a.png", ...]}
+//       Executes lines of a job file on the loaded study.  Result: as load.
+//   orbit {x, y, direction}
+//       Integrates an orbit, direction is forward, backward or both.
+//       Result: {frames: 1, points: n}, the orbit is in the frame.
+//   limitcycles {x0, y0, x1, y1, grid}
+//       Result: {frames: k, cycles: [n, ...]}, one frame for every limit
+//       cycle found, n is its number of points.
+//   maplejobs {n}
+//   shutdown
+//
+// A frame is its length in bytes, as a little endian 32 bit integer, and the
+// points: x and y in view coordinates for every point, as little endian
+// doubles.  The frames come right after the line of their result, before
+// any other reply.  All but evaluate work on the study that was loaded last,
+// and are carried out one after the other: the results of the study are kept
+// in the globals gThisVF and gVFResults.
+
+class P4RenderServer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit P4RenderServer(P4MaplePool *pool, QObject *parent = nullptr);
+
+    bool listen(const QString &name);
+
+  private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+  private:
+    QLocalServer *server_;
+    P4MaplePool *pool_;
+    QString study_; // .inp file of the study in gVFResults, if any
+
+    void handleRequest(QLocalSocket *socket, const QByteArray &line);
+    void reply(QLocalSocket *socket, const QJsonValue &id,
+               const QJsonValue &result,
+               const std::vector<QByteArray> &frames = {});
+    void replyError(QLocalSocket *socket, const QJsonValue &id, int code,
+                    const QString &message);
+
+    void evaluate(QLocalSocket *socket, const QJsonValue &id,
+                  const QJsonObject &params);
+    bool loadInput(const QString &file);
+    QJsonObject summary() const;
+    static QByteArray encodePoints(const P4Orbits::orbits *orbit);
+};
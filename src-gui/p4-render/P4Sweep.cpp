@@ -0,0 +1,223 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4Sweep.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+
+#include "P4InputVF.hpp"
+#include "P4MaplePool.hpp"
+#include "custom.hpp"
+
+P4Sweep::P4Sweep(P4MaplePool *pool, QObject *parent)
+    : QObject{parent}, pool_{pool}
+{
+    QObject::connect(pool_, &P4MaplePool::evaluated, this,
+                     &P4Sweep::onEvaluated);
+}
+
+bool P4Sweep::addParameter(const QString &label, double v0, double v1, int n)
+{
+    unsigned int k;
+
+    if (n < 1 || !points_.empty())
+        return false;
+
+    for (k = 0; k < gThisVF->numParams_; k++) {
+        if (gThisVF->parlabel_[k] == label)
+            break;
+    }
+    if (k == gThisVF->numParams_)
+        return false;
+
+    params_.push_back({label, static_cast<int>(k), v0, v1, n});
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                      PREPARE
+// -----------------------------------------------------------------------
+
+// As P4InputVF::checkevaluated: the tables are there, and are not older
+// than the .inp file.  The type of study is the one of the sweep, which
+// need not be the one of gThisVF by the time Maple is done.
+bool P4Sweep::isEvaluated(const QString &basename) const
+{
+    QFileInfo inp{basename + ".inp"};
+    auto isnewer = [&inp, &basename](const char *suffix) {
+        QFileInfo fi{basename + suffix};
+        return fi.exists() && fi.lastModified() >= inp.lastModified();
+    };
+
+    if (!inp.exists() || !isnewer("_vec.tab"))
+        return false;
+    if (typeofstudy_ != P4TypeOfStudy::typeofstudy_inf &&
+        !isnewer("_fin.tab"))
+        return false;
+    if ((typeofstudy_ == P4TypeOfStudy::typeofstudy_inf ||
+         typeofstudy_ == P4TypeOfStudy::typeofstudy_all) &&
+        !isnewer("_inf.tab"))
+        return false;
+    return true;
+}
+
+// Sets the parameters of gThisVF to the values of the point, and writes the
+// .inp file and the Maple script, unless the point has been evaluated
+// before.  The name of the files is the hash of the original .inp file and
+// the values.
+bool P4Sweep::preparePoint(point &pt, const QByteArray &base)
+{
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    QString value;
+    int k;
+
+    hash.addData(base);
+    for (k = 0; k < numParams(); k++) {
+        value = QString::number(pt.value[k], 'g', 15);
+        for (auto &pv : gThisVF->parvalue_)
+            pv[params_[k].parindex] = value;
+        hash.addData((params_[k].label + "=" + value + "\n").toUtf8());
+    }
+
+    pt.basename = cacheDir_ + QDir::separator() +
+                  QString::fromLatin1(hash.result().toHex());
+    gThisVF->filename_ = pt.basename + ".inp";
+
+    if (isEvaluated(pt.basename)) {
+        pt.status = P4SweepStatus::sweep_cached;
+        return true;
+    }
+
+    if (!gThisVF->save()) {
+        pt.status = P4SweepStatus::sweep_failed;
+        return false;
+    }
+    gThisVF->prepare();
+    pt.status = P4SweepStatus::sweep_pending;
+    return true;
+}
+
+bool P4Sweep::start()
+{
+    QByteArray base;
+    int numpoints{1};
+    int i, k, r;
+
+    if (!points_.empty())
+        return false;
+
+    QFile file{gThisVF->getfilename()};
+    if (!file.open(QFile::ReadOnly))
+        return false;
+    base = file.readAll();
+    file.close();
+
+    if (!QDir{}.mkpath(cacheDir_))
+        return false;
+
+    typeofstudy_ = gThisVF->typeofstudy_;
+    QString savedfilename{gThisVF->filename_};
+    auto savedvalues = gThisVF->parvalue_;
+
+    for (auto const &p : params_)
+        numpoints *= p.n;
+    points_.resize(numpoints);
+
+    // the first parameter varies fastest
+    for (i = 0; i < numpoints; i++) {
+        point &pt = points_[i];
+        pt.index.resize(params_.size());
+        pt.value.resize(params_.size());
+        r = i;
+        for (k = 0; k < numParams(); k++) {
+            const parameter &p = params_[k];
+            pt.index[k] = r % p.n;
+            r /= p.n;
+            pt.value[k] = (p.n == 1)
+                              ? p.v0
+                              : p.v0 + (p.v1 - p.v0) * pt.index[k] / (p.n - 1);
+        }
+        preparePoint(pt, base);
+    }
+
+    gThisVF->filename_ = savedfilename;
+    gThisVF->parvalue_ = savedvalues;
+
+    // points are reported from the event loop, also when all are cached
+    QTimer::singleShot(0, this, &P4Sweep::run);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                      EVALUATE
+// -----------------------------------------------------------------------
+
+// Points that are cached are reported first, while Maple evaluates the
+// others.
+void P4Sweep::run()
+{
+    int i, n{static_cast<int>(points_.size())};
+
+    for (i = 0; i < n; i++) {
+        if (points_[i].status == P4SweepStatus::sweep_pending) {
+            points_[i].status = P4SweepStatus::sweep_running;
+            pool_->evaluate(points_[i].basename);
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if (points_[i].status != P4SweepStatus::sweep_running)
+            done(i, points_[i].status);
+    }
+}
+
+void P4Sweep::onEvaluated(const QString &basename, bool ok)
+{
+    int i, n{static_cast<int>(points_.size())};
+
+    // the same point may appear more than once in a sweep
+    for (i = 0; i < n; i++) {
+        point &pt = points_[i];
+        if (pt.status != P4SweepStatus::sweep_running ||
+            pt.basename != basename)
+            continue;
+
+        if (ok && isEvaluated(pt.basename))
+            done(i, P4SweepStatus::sweep_evaluated);
+        else
+            done(i, P4SweepStatus::sweep_failed);
+    }
+}
+
+bool P4Sweep::isFinished() const
+{
+    return numDone_ == static_cast<int>(points_.size());
+}
+
+void P4Sweep::done(int index, int status)
+{
+    points_[index].status = status;
+    numDone_++;
+    emit pointEvaluated(index);
+    if (isFinished())
+        emit finished();
+}
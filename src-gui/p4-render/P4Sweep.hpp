@@ -0,0 +1,96 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include <QString>
+
+#include <vector>
+
+class P4MaplePool;
+
+namespace P4SweepStatus
+{
+enum { sweep_pending, sweep_running, sweep_evaluated, sweep_cached,
+       sweep_failed };
+}
+
+// Evaluates the vector field of gThisVF for every point of a grid in the
+// space of its parameters.  Every point is saved as an .inp file in the
+// cache directory, named after a hash of its contents, so that points that
+// have been evaluated before are not evaluated again.  The evaluations run
+// in the Maple pool; pointEvaluated is emitted as each point finishes, so
+// that it can be plotted while others are evaluated.  A sweep without
+// parameters has one point: the vector field as it is.
+
+class P4Sweep : public QObject
+{
+    Q_OBJECT
+
+  public:
+    struct point {
+        std::vector<int> index;
+        std::vector<double> value;
+        QString basename; // of the .inp file in the cache directory
+        int status;
+    };
+
+    P4Sweep(P4MaplePool *pool, QObject *parent = nullptr);
+
+    // vary the parameter label over n values from v0 to v1
+    bool addParameter(const QString &label, double v0, double v1, int n);
+    void setCacheDir(const QString &dir) { cacheDir_ = dir; }
+
+    bool isEmpty() const { return params_.empty(); }
+    int numParams() const { return static_cast<int>(params_.size()); }
+    const QString &parameterLabel(int k) const { return params_[k].label; }
+    const std::vector<point> &points() const { return points_; }
+
+    // writes the .inp files of all points, and starts evaluating them
+    bool start();
+    bool isFinished() const;
+
+  signals:
+    void pointEvaluated(int index);
+    void finished();
+
+  private slots:
+    void run();
+    void onEvaluated(const QString &basename, bool ok);
+
+  private:
+    struct parameter {
+        QString label;
+        int parindex; // index in gThisVF->parlabel_
+        double v0, v1;
+        int n;
+    };
+    std::vector<parameter> params_;
+    std::vector<point> points_;
+    QString cacheDir_;
+    P4MaplePool *pool_;
+    int typeofstudy_;
+    int numDone_{0};
+
+    bool isEvaluated(const QString &basename) const;
+    bool preparePoint(point &pt, const QByteArray &base);
+    void done(int index, int status);
+};
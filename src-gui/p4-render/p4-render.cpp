@@ -0,0 +1,1058 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// p4-render: draws the phase portrait of a vector field that has already
+// been evaluated (the .inp file and its _fin.tab/_inf.tab tables), without
+// opening any window.  What to integrate and where to write the result is
+// read from a job file, see the description in usage().  The job can also
+// be repeated for every point of a grid of parameter values, which gives an
+// atlas of portraits, see runSweep().  For regression tests, the geometry
+// that was computed can be dumped as text and the duration and memory use
+// of every command recorded, see replay/run-replay.
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QGuiApplication>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "P4InputVF.hpp"
+#include "P4IntStats.hpp"
+#include "P4MaplePool.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4PlotCanvas.hpp"
+#include "P4RenderServer.hpp"
+#include "P4Sweep.hpp"
+#include "P4Trace.hpp"
+#include "P4TrajectoryStore.hpp"
+#include "P4VFStudy.hpp"
+#include "custom.hpp"
+#include "main.hpp"
+#include "p4-render.hpp"
+#include "math_limitcycles.hpp"
+#include "math_orbits.hpp"
+#include "math_p4.hpp"
+#include "math_separatrice.hpp"
+#include "math_streamlines.hpp"
+#include "p4settings.hpp"
+#include "plot_tools.hpp"
+#include "structures.hpp"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#else
+#include "../version.h"
+#endif
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+
+// the same globals as in p4, the core sources refer to them
+QString gP4version;
+QString gP4versionDate;
+QString gP4platform;
+
+bool gActionOnlyPrepareFile = false;
+bool gActionSaveAll = DEFAULTSAVEALL;
+
+QString gCmdLineFilename;
+bool gCmdLineAutoEvaluate{false};
+bool gCmdLineAutoPlot{false};
+bool gCmdLineAutoExit{false};
+
+P4ParentStudy gVFResults;
+P4InputVF *gThisVF{nullptr};
+
+static P4PlotCanvas *sCanvas{nullptr};
+
+// zoom window requested in the job file
+static bool sIsZoom{false};
+static double sZoomX0, sZoomY0, sZoomX1, sZoomY1;
+
+// resolution of the thumbnails of an atlas (DPI, for a width of 15 cm)
+#define SWEEP_THUMBNAILRES 48
+
+// the commands of the job file, except those that set up a sweep
+struct p4jobcommand {
+    int line;
+    std::vector<std::string> args;
+};
+static std::vector<p4jobcommand> sJob;
+
+static const char *sJobName;
+static int sJobLine;
+static QString sLastError;
+
+// when sweeping, the output files of each point are told apart by a suffix
+static QString sOutputSuffix;
+static QString sAtlasDir;
+
+// evaluate the vector field with Maple before the job is executed
+static bool sEvaluate{false};
+
+// the duration and peak memory use of every stage are written here
+static FILE *sProfile{nullptr};
+
+// -----------------------------------------------------------------------
+//                          USAGE
+// -----------------------------------------------------------------------
+
+static void usage()
+{
+    printf("p4-render Version: %s Date: %s\n%s", VERSION, VERSIONDATE,
+           "SYNTAX: p4-render file.inp jobfile\n"
+           "        p4-render -d socket\n"
+           "\tLoads file.inp and the tables written by its evaluation, and\n"
+           "\texecutes the commands of the job file, one per line.  Empty\n"
+           "\tlines and everything after '#' are ignored.\n\n"
+           "\tview sphere|plane|U1|U2|V1|V2\n"
+           "\twindow x0 y0 x1 y1       range of a planar view\n"
+           "\tprojection p             projection of the Poincare sphere\n"
+           "\tzoom x0 y0 x1 y1         only draw this part of the view\n"
+           "\tstep h | intpoints n | tolerance t | hmin h | hmax h\n"
+           "\t\t(these must come before the commands below)\n\n"
+           "\tseparatrices             integrate all separatrices\n"
+           "\torbit x y [forward|backward|both]\n"
+           "\tlimitcycles x0 y0 x1 y1 grid\n"
+           "\tautofill separation      evenly spaced orbits (pixels)\n"
+           "\tstats [file]             integration statistics of the last\n"
+           "\t\tcurve and of the whole run, to stdout or to file\n"
+           "\toutput file [bw] [resolution dpi] [linewidth mm]"
+           " [symbolsize mm]\n"
+           "\t\twrites what is drawn so far, the format follows from the\n"
+           "\t\textension: .eps, .png, .tif, .jpg, .svg, .pdf or .fig\n\n"
+           "\tsweep label v0 v1 n       repeat the job for n values of the\n"
+           "\t\tparameter, in between v0 and v1; several parameters\n"
+           "\t\tcan vary.  Every point is evaluated by Maple first.\n"
+           "\tmaplejobs n              number of evaluations at a time\n"
+           "\tatlas directory          where the thumbnails and atlas.csv\n"
+           "\t\tof the sweep are written (default: file_atlas).  The\n"
+           "\t\tevaluations are cached in its subdirectory cache.\n\n"
+           "\tevaluate                 evaluate the vector field with Maple\n"
+           "\t\tfirst, instead of reading the tables of an earlier run\n"
+           "\tprofile file             append the wall time (ms) and the peak\n"
+           "\t\tmemory use (kB) after every stage to file, as CSV\n"
+           "\tdump file                writes the number of singularities of\n"
+           "\t\teach kind, and for every curve that is drawn its number\n"
+           "\t\tof points, end points, bounding box and length\n\n"
+           "\tThe exit value is 0 on success.  The Maple executable of the\n"
+           "\tsettings can be overridden with the environment variable\n"
+           "\tP4_MAPLE.  It is started as \"maple -q\" and kept running,\n"
+           "\tthe scripts are given on its standard input.\n\n"
+           "\tWith -d, p4-render keeps running and accepts JSON-RPC requests\n"
+           "\ton the local socket, see P4RenderServer.hpp.\n");
+}
+
+static void jobError(const char *msg)
+{
+    fprintf(stderr, "%s(%d): %s\n", sJobName, sJobLine, msg);
+    sLastError = msg;
+}
+
+const QString &lastJobError() { return sLastError; }
+
+// -----------------------------------------------------------------------
+//                          CANVAS
+// -----------------------------------------------------------------------
+
+// The canvas is created by the first command that draws, after the view
+// has been set up.  It has the size of a new plot window of p4, which the
+// printouts are scaled from.
+static P4PlotCanvas *getCanvas()
+{
+    if (sCanvas != nullptr)
+        return sCanvas;
+
+    gVFResults.setupCoordinateTransformations();
+
+    plot_l = spherePlotLine;
+    plot_p = spherePlotPoint;
+
+    sCanvas = new P4PlotCanvas{sIsZoom, sZoomX0, sZoomY0, sZoomX1, sZoomY1};
+    sCanvas->setCanvasSize(640, 480, 96 / 25.4);
+    sCanvas->setupView();
+    return sCanvas;
+}
+
+// -----------------------------------------------------------------------
+//                          OUTPUT
+// -----------------------------------------------------------------------
+
+static int printMethodOf(const QString &fname, QString &ext)
+{
+    static const struct {
+        const char *ext;
+        const char *written; // extension of the file that is written
+        int method;
+    } formats[]{{".eps", ".eps", P4PRINT_EPSIMAGE},
+                {".png", ".png", P4PRINT_PNGIMAGE},
+                {".tif", ".tif", P4PRINT_TIFFIMAGE},
+                {".tiff", ".tif", P4PRINT_TIFFIMAGE},
+                {".jpg", ".jpg", P4PRINT_JPEGIMAGE},
+                {".jpeg", ".jpg", P4PRINT_JPEGIMAGE},
+                {".svg", ".svg", P4PRINT_SVGIMAGE},
+                {".pdf", ".pdf", P4PRINT_PDFIMAGE},
+                {".fig", ".fig", P4PRINT_XFIGIMAGE}};
+
+    for (auto const &f : formats) {
+        if (fname.endsWith(f.ext, Qt::CaseInsensitive)) {
+            ext = f.written;
+            return f.method;
+        }
+    }
+    return P4PRINT_NONE;
+}
+
+// The print routines name the file after the vector field, so it is
+// renamed afterwards.
+static bool writeOutput(const QString &fname, bool bw, int res, double lw,
+                        double ss)
+{
+    QString ext;
+    int method{printMethodOf(fname, ext)};
+
+    if (method == P4PRINT_NONE) {
+        jobError("unknown output format");
+        return false;
+    }
+
+    QString written{gThisVF->getbarefilename() + ext};
+    QString target{fname};
+    P4PlotCanvas *canvas{getCanvas()};
+
+    if (!sOutputSuffix.isEmpty()) {
+        int dot{fname.lastIndexOf('.')};
+        target = fname.left(dot) + sOutputSuffix + fname.mid(dot);
+    }
+
+    QFile::remove(written);
+    if (!canvas->preparePrinting(method, bw, res, lw, ss)) {
+        jobError(canvas->printError().isEmpty()
+                     ? "cannot write the output file"
+                     : qPrintable(canvas->printError()));
+        return false;
+    }
+    canvas->print();
+    if (!canvas->finishPrinting()) {
+        jobError(qPrintable(canvas->printError()));
+        return false;
+    }
+
+    if (!QFile::exists(written)) {
+        jobError("cannot write the output file");
+        return false;
+    }
+    if (written != target) {
+        QFile::remove(target);
+        if (!QFile::rename(written, target)) {
+            jobError("cannot rename the output file");
+            return false;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                          DUMP
+// -----------------------------------------------------------------------
+
+// One line per curve: the number of points, the first and the last point,
+// the bounding box and the length, all in the coordinates of the view.
+static void dumpCurve(FILE *fp, const char *kind,
+                      P4Orbits::orbits_points *points)
+{
+    double uc[2], prev[2], first[2];
+    double xmin, ymin, xmax, ymax, length{0};
+    int n{0};
+
+    P4CurveReader r{points, true};
+    for (auto p = r.next(); p != nullptr; p = r.next()) {
+        MATHFUNC(sphere_to_viewcoord)(p->pcoord[0], p->pcoord[1], p->pcoord[2],
+                                      uc);
+        if (n == 0) {
+            first[0] = xmin = xmax = uc[0];
+            first[1] = ymin = ymax = uc[1];
+        } else {
+            xmin = std::min(xmin, uc[0]);
+            ymin = std::min(ymin, uc[1]);
+            xmax = std::max(xmax, uc[0]);
+            ymax = std::max(ymax, uc[1]);
+            length += std::hypot(uc[0] - prev[0], uc[1] - prev[1]);
+        }
+        prev[0] = uc[0];
+        prev[1] = uc[1];
+        n++;
+    }
+    if (n == 0)
+        return;
+    fprintf(fp, "%s %d %.6g %.6g %.6g %.6g %.6g %.6g %.6g %.6g %.6g\n", kind,
+            n, first[0], first[1], prev[0], prev[1], xmin, ymin, xmax, ymax,
+            length);
+}
+
+// Writes what has been computed, to compare it with an earlier run.  The
+// curves come in the order in which P4PlotCanvas prints them.
+static bool dumpGeometry(const char *fname)
+{
+    int counts[STUDY_NUMCOUNTS]{0, 0, 0, 0, 0, 0, 0, 0, 0};
+    FILE *fp;
+    int k;
+
+    fp = fopen(fname, "wt");
+    if (fp == nullptr) {
+        jobError("cannot write the dump");
+        return false;
+    }
+    getCanvas();
+
+    summarizeStudy(counts);
+    fprintf(fp, "# points");
+    for (k = 0; k < STUDY_NUMCOUNTS; k++)
+        fprintf(fp, " %s", studyCountName(k));
+    fprintf(fp, "\npoints");
+    for (auto c : counts)
+        fprintf(fp, " %d", c);
+    fprintf(fp, "\n# kind points x0 y0 x1 y1 xmin ymin xmax ymax length\n");
+
+    for (auto const &vf : gVFResults.vf_) {
+        for (auto p = vf->firstSaddlePoint_; p != nullptr; p = p->next_saddle)
+            for (auto s = p->separatrices; s != nullptr; s = s->next_sep)
+                dumpCurve(fp, "separatrix", s->first_sep_point);
+        for (auto p = vf->firstSePoint_; p != nullptr; p = p->next_se)
+            for (auto s = p->separatrices; s != nullptr; s = s->next_sep)
+                dumpCurve(fp, "separatrix", s->first_sep_point);
+        for (auto p = vf->firstDePoint_; p != nullptr; p = p->next_de)
+            for (auto b = p->blow_up; b != nullptr; b = b->next_blow_up_point)
+                dumpCurve(fp, "separatrix", b->first_sep_point);
+    }
+    for (auto o = gVFResults.firstOrbit_; o != nullptr; o = o->next)
+        dumpCurve(fp, "orbit", o->firstpt);
+    for (auto o = gVFResults.firstLimCycle_; o != nullptr; o = o->next)
+        dumpCurve(fp, "limitcycle", o->firstpt);
+
+    fclose(fp);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                          PROFILE
+// -----------------------------------------------------------------------
+
+// peak resident set size of the process until now, in kB
+static long peakMemory()
+{
+#ifdef Q_OS_WIN
+    return 0;
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss / 1024; // in bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static void profileStage(const char *stage,
+                         std::chrono::steady_clock::time_point t0)
+{
+    if (sProfile == nullptr)
+        return;
+
+    std::chrono::duration<double, std::milli> t{
+        std::chrono::steady_clock::now() - t0};
+    fprintf(sProfile, "%s,%d,%.3f,%ld\n", stage, sJobLine, t.count(),
+            peakMemory());
+    fflush(sProfile);
+}
+
+// -----------------------------------------------------------------------
+//                          JOB
+// -----------------------------------------------------------------------
+
+static bool readValue(const char *arg, double &value, double minval,
+                      double maxval)
+{
+    char *end;
+    double v{strtod(arg, &end)};
+
+    if (end == arg || *end != 0 || !std::isfinite(v) || v < minval ||
+        v > maxval)
+        return false;
+    value = v;
+    return true;
+}
+
+static bool readValues(int n, const char **args, double *values)
+{
+    for (int i = 0; i < n; i++) {
+        if (!readValue(args[i], values[i], MIN_FLOAT, MAX_FLOAT)) {
+            jobError("invalid number");
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool executeCommand(int argc, const char **argv)
+{
+    double v[5];
+    int i;
+
+    // commands that set up the view or the integration
+    if (!strcmp(argv[0], "view") || !strcmp(argv[0], "window") ||
+        !strcmp(argv[0], "projection") || !strcmp(argv[0], "zoom") ||
+        !strcmp(argv[0], "step") || !strcmp(argv[0], "intpoints") ||
+        !strcmp(argv[0], "tolerance") || !strcmp(argv[0], "hmin") ||
+        !strcmp(argv[0], "hmax")) {
+        if (sCanvas != nullptr) {
+            jobError("the view must be set up before anything is drawn");
+            return false;
+        }
+    }
+
+    if (!strcmp(argv[0], "view") && argc == 2) {
+        static const struct {
+            const char *name;
+            int type;
+        } views[]{{"sphere", P4TypeOfView::typeofview_sphere},
+                  {"plane", P4TypeOfView::typeofview_plane},
+                  {"U1", P4TypeOfView::typeofview_U1},
+                  {"U2", P4TypeOfView::typeofview_U2},
+                  {"V1", P4TypeOfView::typeofview_V1},
+                  {"V2", P4TypeOfView::typeofview_V2}};
+        for (auto const &vw : views) {
+            if (!strcmp(argv[1], vw.name)) {
+                gVFResults.typeofview_ = vw.type;
+                return true;
+            }
+        }
+        jobError("unknown type of view");
+        return false;
+    }
+
+    if ((!strcmp(argv[0], "window") || !strcmp(argv[0], "zoom")) &&
+        argc == 5) {
+        if (!readValues(argc - 1, argv + 1, v))
+            return false;
+        if (v[0] == v[2] || v[1] == v[3]) {
+            jobError("empty window");
+            return false;
+        }
+        if (!strcmp(argv[0], "window")) {
+            gVFResults.xmin_ = std::min(v[0], v[2]);
+            gVFResults.ymin_ = std::min(v[1], v[3]);
+            gVFResults.xmax_ = std::max(v[0], v[2]);
+            gVFResults.ymax_ = std::max(v[1], v[3]);
+        } else {
+            sIsZoom = true;
+            sZoomX0 = std::min(v[0], v[2]);
+            sZoomY0 = std::min(v[1], v[3]);
+            sZoomX1 = std::max(v[0], v[2]);
+            sZoomY1 = std::max(v[1], v[3]);
+        }
+        return true;
+    }
+
+    if (argc == 2) {
+        static const struct {
+            const char *name;
+            double *value;
+            double minval, maxval;
+        } params[]{
+            {"projection", &gVFResults.config_projection_, MIN_PROJECTION,
+             MAX_PROJECTION},
+            {"step", &gVFResults.config_step_, MIN_HMI, MAX_HMA},
+            {"tolerance", &gVFResults.config_tolerance_, MIN_TOLERANCE,
+             MAX_TOLERANCE},
+            {"hmin", &gVFResults.config_hmi_, MIN_HMI, MAX_HMI},
+            {"hmax", &gVFResults.config_hma_, MIN_HMA, MAX_HMA}};
+        for (auto const &p : params) {
+            if (!strcmp(argv[0], p.name)) {
+                if (!readValue(argv[1], *p.value, p.minval, p.maxval)) {
+                    jobError("value out of range");
+                    return false;
+                }
+                if (p.value == &gVFResults.config_step_)
+                    gVFResults.config_currentstep_ = gVFResults.config_step_;
+                return true;
+            }
+        }
+        if (!strcmp(argv[0], "intpoints")) {
+            if (!readValue(argv[1], v[0], MIN_INTPOINTS, MAX_INTPOINTS)) {
+                jobError("value out of range");
+                return false;
+            }
+            gVFResults.config_intpoints_ = static_cast<int>(v[0]);
+            return true;
+        }
+        if (!strcmp(argv[0], "autofill")) {
+            if (!readValue(argv[1], v[0], MIN_AUTOFILLSEP, MAX_AUTOFILLSEP)) {
+                jobError("value out of range");
+                return false;
+            }
+            autoFillOrbits(getCanvas(), v[0]);
+            return true;
+        }
+    }
+
+    if (!strcmp(argv[0], "separatrices") && argc == 1) {
+        P4PlotCanvas *sphere{getCanvas()};
+        sphere->prepareDrawing(P4SphereLayers::layer_separatrices);
+        plot_all_sep(sphere);
+        sphere->finishDrawing();
+        return true;
+    }
+
+    if (!strcmp(argv[0], "limitcycles") && argc == 6) {
+        if (!readValues(argc - 1, argv + 1, v))
+            return false;
+
+        P4PlotCanvas *sphere{getCanvas()};
+        sphere->prepareDrawing(P4SphereLayers::layer_limit_cycles);
+        searchLimitCycle(sphere, v[0], v[1], v[2], v[3], v[4]);
+        sphere->finishDrawing();
+        return true;
+    }
+
+    if (!strcmp(argv[0], "orbit") && (argc == 3 || argc == 4)) {
+        bool forwards{true}, backwards{true};
+        if (!readValues(2, argv + 1, v))
+            return false;
+        if (argc == 4) {
+            if (!strcmp(argv[3], "forward")) {
+                backwards = false;
+            } else if (!strcmp(argv[3], "backward")) {
+                forwards = false;
+            } else if (strcmp(argv[3], "both")) {
+                jobError("expected forward, backward or both");
+                return false;
+            }
+        }
+
+        P4PlotCanvas *sphere{getCanvas()};
+        sphere->prepareDrawing(P4SphereLayers::layer_orbits);
+        if (startOrbit(sphere, v[0], v[1], true)) {
+            if (forwards)
+                integrateOrbit(sphere, 1);
+            if (backwards)
+                integrateOrbit(sphere, -1);
+        } else {
+            fprintf(stderr, "%s(%d): orbit not started\n", sJobName,
+                    sJobLine);
+        }
+        sphere->finishDrawing();
+        return true;
+    }
+
+    if (!strcmp(argv[0], "stats") && (argc == 1 || argc == 2)) {
+        FILE *fp{stdout};
+        if (argc == 2 && (fp = fopen(argv[1], "w")) == nullptr) {
+            jobError("cannot write the statistics");
+            return false;
+        }
+        P4IntStats::dump(fp);
+        if (fp != stdout)
+            fclose(fp);
+        return true;
+    }
+
+    if (!strcmp(argv[0], "dump") && argc == 2)
+        return dumpGeometry(argv[1]);
+
+    if (!strcmp(argv[0], "output") && argc >= 2) {
+        bool bw{false};
+        int res{DEFAULT_RESOLUTION};
+        double lw{DEFAULT_LINEWIDTH}, ss{DEFAULT_SYMBOLSIZE};
+
+        for (i = 2; i < argc; i++) {
+            if (!strcmp(argv[i], "bw")) {
+                bw = true;
+                continue;
+            }
+            if (i + 1 < argc && !strcmp(argv[i], "resolution") &&
+                readValue(argv[i + 1], v[0], MIN_RESOLUTION, MAX_RESOLUTION)) {
+                res = static_cast<int>(v[0]);
+                i++;
+                continue;
+            }
+            if (i + 1 < argc && !strcmp(argv[i], "linewidth") &&
+                readValue(argv[i + 1], lw, MIN_LINEWIDTH, MAX_LINEWIDTH)) {
+                i++;
+                continue;
+            }
+            if (i + 1 < argc && !strcmp(argv[i], "symbolsize") &&
+                readValue(argv[i + 1], ss, MIN_SYMBOLSIZE, MAX_SYMBOLSIZE)) {
+                i++;
+                continue;
+            }
+            jobError("invalid output option");
+            return false;
+        }
+        return writeOutput(argv[1], bw, res, lw, ss);
+    }
+
+    jobError("unknown command or wrong number of arguments");
+    return false;
+}
+
+// Reads the job file into sJob.  The commands that set up a sweep are
+// executed right away.
+static bool readJob(const char *jobname, P4Sweep &sweep, P4MaplePool &pool)
+{
+    FILE *fp;
+    char buf[2560];
+    char *p;
+    p4jobcommand cmd;
+    double v[3];
+    bool ok{true};
+
+    fp = fopen(jobname, "rt");
+    if (fp == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", jobname);
+        return false;
+    }
+
+    sJobName = jobname;
+    sJobLine = 0;
+    while (ok && fgets(buf, sizeof(buf), fp) != nullptr) {
+        sJobLine++;
+        if ((p = strchr(buf, '#')) != nullptr)
+            *p = 0;
+
+        cmd.line = sJobLine;
+        cmd.args.clear();
+        for (p = strtok(buf, " \t\r\n"); p != nullptr;
+             p = strtok(nullptr, " \t\r\n"))
+            cmd.args.push_back(p);
+        if (cmd.args.empty())
+            continue;
+
+        const auto &args = cmd.args;
+        int argc{static_cast<int>(args.size())};
+        if (args[0] == "sweep") {
+            if (argc != 5 || !readValue(args[2].c_str(), v[0], MIN_FLOAT,
+                                        MAX_FLOAT) ||
+                !readValue(args[3].c_str(), v[1], MIN_FLOAT, MAX_FLOAT) ||
+                !readValue(args[4].c_str(), v[2], 1, MAX_INTPOINTS)) {
+                jobError("expected sweep label v0 v1 n");
+                ok = false;
+            } else if (!sweep.addParameter(args[1].c_str(), v[0], v[1],
+                                           static_cast<int>(v[2]))) {
+                jobError("unknown parameter");
+                ok = false;
+            }
+        } else if (args[0] == "maplejobs") {
+            if (argc != 2 || !readValue(args[1].c_str(), v[0], 1, 1024)) {
+                jobError("expected maplejobs n");
+                ok = false;
+            } else {
+                pool.setMaxJobs(static_cast<int>(v[0]));
+            }
+        } else if (args[0] == "atlas") {
+            if (argc != 2) {
+                jobError("expected atlas directory");
+                ok = false;
+            } else {
+                sAtlasDir = args[1].c_str();
+            }
+        } else if (args[0] == "evaluate") {
+            sEvaluate = true;
+        } else if (args[0] == "profile") {
+            if (argc != 2) {
+                jobError("expected profile file");
+                ok = false;
+            } else if (sProfile == nullptr) {
+                sProfile = fopen(args[1].c_str(), "wt");
+                if (sProfile == nullptr) {
+                    jobError("cannot write the profile");
+                    ok = false;
+                } else {
+                    fprintf(sProfile, "stage,line,wall_ms,peak_rss_kb\n");
+                }
+            }
+        } else {
+            sJob.push_back(cmd);
+        }
+    }
+
+    fclose(fp);
+    return ok;
+}
+
+static bool executeJob()
+{
+    std::vector<const char *> argv;
+
+    for (auto const &cmd : sJob) {
+        sJobLine = cmd.line;
+        argv.clear();
+        for (auto const &a : cmd.args)
+            argv.push_back(a.c_str());
+        auto t0 = std::chrono::steady_clock::now();
+        if (!executeCommand(static_cast<int>(argv.size()), argv.data()))
+            return false;
+        profileStage(argv[0], t0);
+    }
+    return true;
+}
+
+bool executeJobLine(const char *name, int line, const QString &command)
+{
+    std::vector<std::string> args;
+    std::vector<const char *> argv;
+
+    sJobName = name;
+    sJobLine = line;
+    sLastError = "";
+
+    for (auto const &a : command.simplified().split(' '))
+        args.push_back(a.toLocal8Bit().data());
+    for (auto const &a : args)
+        argv.push_back(a.c_str());
+    if (argv.empty() || args[0].empty()) {
+        jobError("empty command");
+        return false;
+    }
+    return executeCommand(static_cast<int>(argv.size()), argv.data());
+}
+
+bool loadStudy()
+{
+    delete sCanvas;
+    sCanvas = nullptr;
+    sIsZoom = false;
+
+    if (!gVFResults.readTables(gThisVF->getbarefilename(), false, false))
+        return false;
+    gVFResults.readArbitraryCurve(gThisVF->getbarefilename());
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                          SUMMARY
+// -----------------------------------------------------------------------
+
+const char *studyCountName(int k)
+{
+    static const char *names[STUDY_NUMCOUNTS]{
+        "saddles",     "stable_nodes",  "unstable_nodes",
+        "stable_foci", "unstable_foci", "weak_foci",
+        "semi_elementary", "non_elementary", "limit_cycles"};
+    return names[k];
+}
+
+// number of singularities in the list that are drawn, see P4PlotCanvas::printPoints
+template <typename T, typename PRED>
+static int countPoints(const T *p, T *T::*next, PRED pred)
+{
+    int n{0};
+
+    for (; p != nullptr; p = p->*next) {
+        if ((p->position == P4Singularities::position_standalone ||
+             p->position == P4Singularities::position_coinciding_main) &&
+            pred(p))
+            n++;
+    }
+    return n;
+}
+
+void summarizeStudy(int *counts)
+{
+    using namespace P4Singularities;
+    auto all = [](const void *) { return true; };
+    int k;
+
+    for (k = 0; k < STUDY_NUMCOUNTS; k++)
+        counts[k] = 0;
+
+    for (auto const &vf : gVFResults.vf_) {
+        counts[0] += countPoints(vf->firstSaddlePoint_, &saddle::next_saddle,
+                                 all);
+        counts[1] +=
+            countPoints(vf->firstNodePoint_, &node::next_node,
+                        [](const node *p) { return p->stable == -1; });
+        counts[2] +=
+            countPoints(vf->firstNodePoint_, &node::next_node,
+                        [](const node *p) { return p->stable != -1; });
+        counts[3] += countPoints(
+            vf->firstSfPoint_, &strong_focus::next_sf,
+            [](const strong_focus *p) { return p->stable == -1; });
+        counts[4] += countPoints(
+            vf->firstSfPoint_, &strong_focus::next_sf,
+            [](const strong_focus *p) { return p->stable != -1; });
+        counts[5] += countPoints(vf->firstWfPoint_, &weak_focus::next_wf, all);
+        counts[6] +=
+            countPoints(vf->firstSePoint_, &semi_elementary::next_se, all);
+        counts[7] += countPoints(vf->firstDePoint_, &degenerate::next_de, all);
+    }
+    for (auto lc = gVFResults.firstLimCycle_; lc != nullptr; lc = lc->next)
+        counts[8]++;
+}
+
+// Plots the point of the sweep that has just been evaluated, and adds its
+// line to the summary.
+static bool renderPoint(const P4Sweep &sweep, int index, FILE *summary)
+{
+    const P4Sweep::point &pt = sweep.points()[index];
+    int counts[STUDY_NUMCOUNTS]{0, 0, 0, 0, 0, 0, 0, 0, 0};
+    bool ok{true};
+    int k;
+
+    static const char *statusnames[]{"pending", "running", "evaluated",
+                                     "cached", "failed"};
+    int status{pt.status};
+
+    if (status != P4SweepStatus::sweep_failed) {
+        gThisVF->filename_ = pt.basename + ".inp";
+        if (!loadStudy()) {
+            status = P4SweepStatus::sweep_failed;
+        } else {
+            sOutputSuffix = QString{"_%1"}.arg(index);
+            ok = executeJob();
+            sOutputSuffix = "";
+            if (ok)
+                ok = writeOutput(QString{"%1/point_%2.png"}
+                                     .arg(sAtlasDir)
+                                     .arg(index),
+                                 false, SWEEP_THUMBNAILRES, DEFAULT_LINEWIDTH,
+                                 DEFAULT_SYMBOLSIZE);
+
+            summarizeStudy(counts);
+
+            delete sCanvas;
+            sCanvas = nullptr;
+        }
+    }
+
+    fprintf(summary, "%d", index);
+    for (k = 0; k < sweep.numParams(); k++)
+        fprintf(summary, ",%d,%.15g", pt.index[k], pt.value[k]);
+    fprintf(summary, ",%s", statusnames[status]);
+    for (auto c : counts)
+        fprintf(summary, ",%d", c);
+    fprintf(summary, ",%s\n",
+            status == P4SweepStatus::sweep_failed
+                ? ""
+                : QString{"point_%1.png"}.arg(index).toLocal8Bit().data());
+    fflush(summary);
+
+    fprintf(stderr, "point %d/%d: %s\n", index + 1,
+            static_cast<int>(sweep.points().size()), statusnames[status]);
+    return ok && status != P4SweepStatus::sweep_failed;
+}
+
+// Evaluates every point of the sweep, and executes the job for each of them
+// as soon as it is evaluated.  The atlas directory receives a thumbnail of
+// every point and atlas.csv, with the number of singularities of each kind
+// and the number of limit cycles that were found.
+static bool runSweep(P4Sweep &sweep)
+{
+    FILE *summary;
+    QEventLoop loop;
+    bool ok{true};
+    int k;
+
+    if (sAtlasDir.isEmpty())
+        sAtlasDir = gThisVF->getbarefilename() + "_atlas";
+    if (!QDir{}.mkpath(sAtlasDir)) {
+        fprintf(stderr, "Cannot create %s\n", sAtlasDir.toLocal8Bit().data());
+        return false;
+    }
+    sweep.setCacheDir(sAtlasDir + QDir::separator() + "cache");
+
+    summary = fopen(QFile::encodeName(sAtlasDir + "/atlas.csv"), "wt");
+    if (summary == nullptr) {
+        fprintf(stderr, "Cannot create atlas.csv\n");
+        return false;
+    }
+    fprintf(summary, "point");
+    for (k = 0; k < sweep.numParams(); k++)
+        fprintf(summary, ",%s_index,%s",
+                sweep.parameterLabel(k).toLocal8Bit().data(),
+                sweep.parameterLabel(k).toLocal8Bit().data());
+    fprintf(summary, ",status");
+    for (k = 0; k < STUDY_NUMCOUNTS; k++)
+        fprintf(summary, ",%s", studyCountName(k));
+    fprintf(summary, ",thumbnail\n");
+
+    QObject::connect(&sweep, &P4Sweep::pointEvaluated, [&](int index) {
+        if (!renderPoint(sweep, index, summary))
+            ok = false;
+    });
+    QObject::connect(&sweep, &P4Sweep::finished, &loop, &QEventLoop::quit);
+
+    if (!sweep.start()) {
+        fprintf(stderr, "Cannot prepare the points of the sweep\n");
+        fclose(summary);
+        return false;
+    }
+    loop.exec();
+
+    fclose(summary);
+    return ok;
+}
+
+// Evaluates the vector field with Maple if the job asks for it, and reads
+// the tables.
+static bool prepareStudy(const char *fname, P4MaplePool &pool)
+{
+    QEventLoop loop;
+    QString basename{gThisVF->getbarefilename()};
+    bool done{false}, ok{false};
+
+    sJobLine = 0;
+    if (sEvaluate) {
+        auto t0 = std::chrono::steady_clock::now();
+        auto connection = QObject::connect(
+            &pool, &P4MaplePool::evaluated,
+            [&](const QString &name, bool success) {
+                if (name == basename) {
+                    done = true;
+                    ok = success;
+                    loop.quit();
+                }
+            });
+        gThisVF->prepare();
+        pool.evaluate(basename);
+        if (!done)
+            loop.exec();
+        QObject::disconnect(connection);
+        if (!ok) {
+            fprintf(stderr, "Cannot evaluate %s, see %s.log\n", fname,
+                    QFile::encodeName(basename).constData());
+            return false;
+        }
+        profileStage("evaluate", t0);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!loadStudy()) {
+        fprintf(stderr, "Cannot read computation results of %s.\n"
+                        "Please evaluate the vector field first.\n",
+                fname);
+        return false;
+    }
+    profileStage("load", t0);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//          Main function
+// -----------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    int returnvalue{0};
+
+    if (argc != 3) {
+        usage();
+        return -1;
+    }
+
+    // no display is needed to draw into images and files
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    gP4platform = "";
+    gP4version = VERSION;
+    gP4versionDate = VERSIONDATE;
+
+    auto app = new QGuiApplication{argc, argv};
+    app->setOrganizationName("P4");
+    app->setOrganizationDomain("gsd.uab.cat");
+    app->setApplicationName("P4");
+
+    // colours and paths as in p4; the defaults are used if there are none
+    readP4Settings();
+    auto maple = qgetenv("P4_MAPLE");
+    if (!maple.isEmpty())
+        setMapleExe(QFile::decodeName(maple));
+
+    // timeline of the evaluation and the plotting, see P4Trace
+    auto tracefile = qgetenv("P4_TRACE");
+    if (tracefile.isEmpty())
+        tracefile = QFile::encodeName(getP4TraceFile());
+    P4Trace::start(tracefile.constData());
+
+    gThisVF = new P4InputVF{};
+    gThisVF->sessionScripts_ = true; // they are run by P4MaplePool
+    auto pool = new P4MaplePool{};
+    pool->setMaxJobs(QThread::idealThreadCount());
+
+    if (!strcmp(argv[1], "-d")) {
+        auto server = new P4RenderServer{pool};
+        if (!server->listen(argv[2])) {
+            fprintf(stderr, "Cannot listen on %s\n", argv[2]);
+            returnvalue = -1;
+        } else {
+            returnvalue = app->exec();
+        }
+        delete server;
+        server = nullptr;
+    } else {
+        gThisVF->filename_ = argv[1];
+        auto sweep = new P4Sweep{pool};
+
+        if (!gThisVF->load()) {
+            fprintf(stderr, "Cannot load %s\n", argv[1]);
+            returnvalue = -1;
+        } else if (!readJob(argv[2], *sweep, *pool)) {
+            returnvalue = 1;
+        } else if (!sweep->isEmpty()) {
+            if (!runSweep(*sweep))
+                returnvalue = 1;
+        } else if (!prepareStudy(argv[1], *pool)) {
+            returnvalue = -1;
+        } else if (!executeJob()) {
+            returnvalue = 1;
+        }
+
+        delete sweep;
+        sweep = nullptr;
+    }
+
+    if (sProfile != nullptr)
+        fclose(sProfile);
+
+    delete sCanvas;
+    sCanvas = nullptr;
+    delete pool;
+    pool = nullptr;
+
+    delete gThisVF;
+    gThisVF = nullptr;
+    delete app;
+    app = nullptr;
+
+    P4Trace::stop();
+    return returnvalue;
+}
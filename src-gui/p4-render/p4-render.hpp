@@ -0,0 +1,40 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+
+// Parts of p4-render.cpp that are shared with the server mode, see
+// P4RenderServer.
+
+// number of singularities of each kind and of limit cycles, in the order of
+// studyCountName
+#define STUDY_NUMCOUNTS 9
+
+const char *studyCountName(int k);
+void summarizeStudy(int *counts);
+
+// reads the tables of the vector field of gThisVF, and drops what has been
+// drawn of the previous one
+bool loadStudy();
+
+// executes a line of a job file; name and line are used in error messages
+bool executeJobLine(const char *name, int line, const QString &command);
+const QString &lastJobError();
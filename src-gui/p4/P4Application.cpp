@@ -112,6 +112,22 @@ void P4Application::signalEvaluated(int exitCode)
     }
 }
 
+// Maple is still studying the finite region
+void P4Application::signalSingularityEvaluated()
+{
+    auto e = new P4Event{
+        static_cast<QEvent::Type>(TYPE_SIGNAL_SINGULARITYEVALUATED), nullptr};
+    gP4app->postEvent(gP4startDlg, e);
+}
+
+// Maple is still studying infinity
+void P4Application::signalFiniteEvaluated()
+{
+    auto e = new P4Event{
+        static_cast<QEvent::Type>(TYPE_SIGNAL_FINITEEVALUATED), nullptr};
+    gP4app->postEvent(gP4startDlg, e);
+}
+
 void P4Application::signalGcfEvaluated(int exitCode)
 {
     gThisVF->evaluated_ = true;
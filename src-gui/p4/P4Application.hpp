@@ -25,12 +25,6 @@
 
 #include <memory>
 
-#ifdef Q_OS_WIN
-#define USERPLATFORM "WINDOWS"
-#else
-#define USERPLATFORM "LINUX"
-#endif
-
 class QFont;
 
 class P4Application : public QApplication
@@ -50,6 +44,8 @@ class P4Application : public QApplication
 
   public slots:
     void signalEvaluated(int);
+    void signalSingularityEvaluated();
+    void signalFiniteEvaluated();
     void signalGcfEvaluated(int);
     void signalCurveEvaluated(int);
     void signalSeparatingCurvesEvaluated(int);
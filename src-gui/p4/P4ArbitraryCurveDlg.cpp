@@ -135,6 +135,9 @@ P4ArbitraryCurveDlg::P4ArbitraryCurveDlg(P4PlotWnd *plt, P4Sphere *sp)
                      &P4ArbitraryCurveDlg::onBtnDelLast);
     QObject::connect(btnDelAll_, &QPushButton::clicked, this,
                      &P4ArbitraryCurveDlg::onBtnDelAll);
+    QObject::connect(gThisVF, &P4InputVF::arbitraryCurveEvaluationFinished,
+                     this,
+                     &P4ArbitraryCurveDlg::finishArbitraryCurveEvaluation);
 
     // finishing
 
@@ -183,7 +186,6 @@ void P4ArbitraryCurveDlg::onBtnEvaluate()
 
     // FIRST: create filename_veccurve.tab for transforming the curve QString to
     // a list of P4Polynom::term2
-    gThisVF->setArbitraryCurveDlg(this);
     gThisVF->evaluateArbitraryCurveTable();
     btnPlot_->setEnabled(true);
 }
@@ -213,7 +215,6 @@ void P4ArbitraryCurveDlg::onBtnPlot()
 
     btnPlot_->setEnabled(false);
 
-    gThisVF->setArbitraryCurveDlg(this);
     if (!evalArbitraryCurveStart(mainSphere_, dashes, precis, points)) {
         btnPlot_->setEnabled(true);
         QMessageBox::critical(this, "P4",
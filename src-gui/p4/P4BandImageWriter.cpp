@@ -0,0 +1,368 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4BandImageWriter.hpp"
+
+#include <cmath>
+#include <cstring>
+
+// size of the buffer receiving compressed PNG data, which becomes one IDAT
+// chunk when full
+#define PNG_IDATSIZE 65536
+
+// number of rows per TIFF strip
+#define TIFF_STRIPROWS 32
+
+static void put16be(std::vector<unsigned char> &v, unsigned long x)
+{
+    v.push_back((x >> 8) & 0xFF);
+    v.push_back(x & 0xFF);
+}
+
+static void put32be(std::vector<unsigned char> &v, unsigned long x)
+{
+    put16be(v, (x >> 16) & 0xFFFF);
+    put16be(v, x & 0xFFFF);
+}
+
+static void put16le(std::vector<unsigned char> &v, unsigned long x)
+{
+    v.push_back(x & 0xFF);
+    v.push_back((x >> 8) & 0xFF);
+}
+
+static void put32le(std::vector<unsigned char> &v, unsigned long x)
+{
+    put16le(v, x & 0xFFFF);
+    put16le(v, (x >> 16) & 0xFFFF);
+}
+
+P4BandImageWriter::~P4BandImageWriter()
+{
+    if (fp_ != nullptr) {
+        if (format_ == P4ImageFormat::png)
+            deflateEnd(&zs_);
+        fclose(fp_);
+        fp_ = nullptr;
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      OPEN
+// -----------------------------------------------------------------------
+
+bool P4BandImageWriter::open(const char *filename, int format, int width,
+                             int height, double dpi)
+{
+    static const unsigned char pngSignature[8]{137, 80, 78, 71,
+                                               13,  10, 26, 10};
+    std::vector<unsigned char> hdr;
+
+    if (fp_ != nullptr || width <= 0 || height <= 0)
+        return false;
+
+    fp_ = fopen(filename, "wb");
+    if (fp_ == nullptr)
+        return false;
+
+    format_ = format;
+    width_ = width;
+    height_ = height;
+    rowsWritten_ = 0;
+    dpi_ = dpi;
+    failed_ = false;
+
+    if (format_ == P4ImageFormat::png) {
+        fwrite(pngSignature, 1, sizeof(pngSignature), fp_);
+
+        put32be(hdr, width_);
+        put32be(hdr, height_);
+        hdr.push_back(8); // bit depth
+        hdr.push_back(2); // colour type: RGB
+        hdr.push_back(0); // compression
+        hdr.push_back(0); // filter method
+        hdr.push_back(0); // no interlace
+        writePngChunk("IHDR", hdr.data(), hdr.size());
+
+        if (dpi_ > 0) {
+            // pixels per metre
+            hdr.clear();
+            put32be(hdr, std::lround(dpi_ / 0.0254));
+            put32be(hdr, std::lround(dpi_ / 0.0254));
+            hdr.push_back(1);
+            writePngChunk("pHYs", hdr.data(), hdr.size());
+        }
+
+        memset(&zs_, 0, sizeof(zs_));
+        if (deflateInit(&zs_, Z_DEFAULT_COMPRESSION) != Z_OK) {
+            fclose(fp_);
+            fp_ = nullptr;
+            return false;
+        }
+        zbuf_.resize(PNG_IDATSIZE);
+        row_.resize(1 + 3 * width_);
+    } else {
+        // header; the offset of the directory is filled in by close()
+        hdr.push_back('I');
+        hdr.push_back('I');
+        put16le(hdr, 42);
+        put32le(hdr, 0);
+        fwrite(hdr.data(), 1, hdr.size(), fp_);
+
+        rowsPerStrip_ = TIFF_STRIPROWS;
+        strip_.clear();
+        strip_.reserve(rowsPerStrip_ * 3 * width_);
+        stripRows_ = 0;
+        stripOffsets_.clear();
+        stripByteCounts_.clear();
+    }
+
+    return !ferror(fp_);
+}
+
+// -----------------------------------------------------------------------
+//                      WRITEROWS
+// -----------------------------------------------------------------------
+
+bool P4BandImageWriter::writeRows(const unsigned char *rgb, int stride,
+                                  int nrows)
+{
+    int i, j;
+
+    if (fp_ == nullptr || failed_ || rowsWritten_ + nrows > height_)
+        return false;
+
+    for (j = 0; j < nrows; j++, rgb += stride) {
+        if (format_ == P4ImageFormat::png) {
+            // "Sub" filter: store the difference with the pixel to the left
+            row_[0] = 1;
+            for (i = 0; i < 3; i++)
+                row_[1 + i] = rgb[i];
+            for (i = 3; i < 3 * width_; i++)
+                row_[1 + i] = rgb[i] - rgb[i - 3];
+
+            zs_.next_in = row_.data();
+            zs_.avail_in = row_.size();
+            if (!deflateRows(Z_NO_FLUSH))
+                failed_ = true;
+        } else {
+            strip_.insert(strip_.end(), rgb, rgb + 3 * width_);
+            if (++stripRows_ == rowsPerStrip_)
+                flushTiffStrip();
+        }
+    }
+    rowsWritten_ += nrows;
+
+    if (ferror(fp_))
+        failed_ = true;
+    return !failed_;
+}
+
+// -----------------------------------------------------------------------
+//                      CLOSE
+// -----------------------------------------------------------------------
+
+bool P4BandImageWriter::close()
+{
+    bool result;
+
+    if (fp_ == nullptr)
+        return false;
+
+    result = !failed_ && rowsWritten_ == height_;
+
+    if (format_ == P4ImageFormat::png) {
+        zs_.next_in = nullptr;
+        zs_.avail_in = 0;
+        if (!deflateRows(Z_FINISH))
+            result = false;
+        deflateEnd(&zs_);
+        writePngChunk("IEND", nullptr, 0);
+    } else {
+        if (!finishTiff())
+            result = false;
+    }
+
+    if (ferror(fp_))
+        result = false;
+    if (fclose(fp_) != 0)
+        result = false;
+    fp_ = nullptr;
+
+    return result;
+}
+
+// -----------------------------------------------------------------------
+//                      PNG
+// -----------------------------------------------------------------------
+
+void P4BandImageWriter::writePngChunk(const char *type,
+                                      const unsigned char *data,
+                                      unsigned long len)
+{
+    std::vector<unsigned char> v;
+    uLong crc;
+
+    put32be(v, len);
+    fwrite(v.data(), 1, 4, fp_);
+    fwrite(type, 1, 4, fp_);
+    if (len > 0)
+        fwrite(data, 1, len, fp_);
+
+    crc = crc32(0L, reinterpret_cast<const Bytef *>(type), 4);
+    if (len > 0)
+        crc = crc32(crc, data, len);
+    v.clear();
+    put32be(v, crc);
+    fwrite(v.data(), 1, 4, fp_);
+}
+
+bool P4BandImageWriter::deflateRows(int flush)
+{
+    int ret;
+
+    do {
+        zs_.next_out = zbuf_.data();
+        zs_.avail_out = zbuf_.size();
+        ret = deflate(&zs_, flush);
+        if (ret == Z_STREAM_ERROR)
+            return false;
+        if (zs_.avail_out < zbuf_.size())
+            writePngChunk("IDAT", zbuf_.data(),
+                          zbuf_.size() - zs_.avail_out);
+    } while (zs_.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                      TIFF
+// -----------------------------------------------------------------------
+
+void P4BandImageWriter::flushTiffStrip()
+{
+    uLongf len;
+    std::vector<unsigned char> buf;
+
+    if (stripRows_ == 0)
+        return;
+
+    len = compressBound(strip_.size());
+    buf.resize(len);
+    if (compress(buf.data(), &len, strip_.data(), strip_.size()) != Z_OK) {
+        failed_ = true;
+        return;
+    }
+
+    stripOffsets_.push_back(ftell(fp_));
+    stripByteCounts_.push_back(len);
+    fwrite(buf.data(), 1, len, fp_);
+
+    strip_.clear();
+    stripRows_ = 0;
+}
+
+// Writes the directory after the image data, and points the header to it.
+bool P4BandImageWriter::finishTiff()
+{
+    std::vector<unsigned char> extra, ifd;
+    unsigned long base, offBits, offXRes, offYRes, offOffsets, offCounts;
+    unsigned long offIfd;
+    unsigned long nstrips, res;
+
+    flushTiffStrip();
+    if (failed_)
+        return false;
+
+    base = ftell(fp_);
+    if (base & 1) {
+        fputc(0, fp_);
+        base++;
+    }
+    nstrips = stripOffsets_.size();
+    res = (dpi_ > 0) ? std::lround(dpi_) : 72;
+
+    // values that do not fit in the 4 bytes of a directory entry
+    offBits = base + extra.size();
+    put16le(extra, 8);
+    put16le(extra, 8);
+    put16le(extra, 8);
+    offXRes = base + extra.size();
+    put32le(extra, res);
+    put32le(extra, 1);
+    offYRes = base + extra.size();
+    put32le(extra, res);
+    put32le(extra, 1);
+    offOffsets = base + extra.size();
+    if (nstrips > 1)
+        for (auto o : stripOffsets_)
+            put32le(extra, o);
+    offCounts = base + extra.size();
+    if (nstrips > 1)
+        for (auto c : stripByteCounts_)
+            put32le(extra, c);
+    offIfd = base + extra.size();
+    if (nstrips == 1) {
+        offOffsets = stripOffsets_[0];
+        offCounts = stripByteCounts_[0];
+    }
+
+    // entries, in increasing order of tag: tag, type (3 = SHORT, 4 = LONG,
+    // 5 = RATIONAL), count and value or offset
+    const unsigned long entries[][4]{
+        {256, 4, 1, static_cast<unsigned long>(width_)}, // ImageWidth
+        {257, 4, 1, static_cast<unsigned long>(height_)}, // ImageLength
+        {258, 3, 3, offBits},                   // BitsPerSample
+        {259, 3, 1, 8},                         // Compression: deflate
+        {262, 3, 1, 2},                         // Photometric: RGB
+        {273, 4, nstrips, offOffsets},          // StripOffsets
+        {277, 3, 1, 3},                         // SamplesPerPixel
+        {278, 4, 1, static_cast<unsigned long>(rowsPerStrip_)},
+        {279, 4, nstrips, offCounts},           // StripByteCounts
+        {282, 5, 1, offXRes},                   // XResolution
+        {283, 5, 1, offYRes},                   // YResolution
+        {296, 3, 1, 2}};                        // ResolutionUnit: inch
+    const int numEntries{sizeof(entries) / sizeof(entries[0])};
+
+    put16le(ifd, numEntries);
+    for (auto const &e : entries) {
+        put16le(ifd, e[0]);
+        put16le(ifd, e[1]);
+        put32le(ifd, e[2]);
+        if (e[1] == 3 && e[2] == 1) {
+            // a single SHORT is left-justified in the value field
+            put16le(ifd, e[3]);
+            put16le(ifd, 0);
+        } else {
+            put32le(ifd, e[3]);
+        }
+    }
+    put32le(ifd, 0); // no next directory
+
+    fwrite(extra.data(), 1, extra.size(), fp_);
+    fwrite(ifd.data(), 1, ifd.size(), fp_);
+
+    extra.clear();
+    put32le(extra, offIfd);
+    fseek(fp_, 4, SEEK_SET);
+    fwrite(extra.data(), 1, 4, fp_);
+    fseek(fp_, 0, SEEK_END);
+
+    return !ferror(fp_);
+}
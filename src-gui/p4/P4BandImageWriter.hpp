@@ -0,0 +1,74 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include <zlib.h>
+
+namespace P4ImageFormat
+{
+enum { png = 0, tiff = 1 };
+}
+
+// Writes an RGB image (8 bits per channel) to a PNG or TIFF file from top to
+// bottom, a few rows at a time, so that the whole image never has to be held
+// in memory.  Both formats are deflate compressed with zlib.
+
+class P4BandImageWriter
+{
+  public:
+    P4BandImageWriter() {}
+    ~P4BandImageWriter();
+
+    bool open(const char *filename, int format, int width, int height,
+              double dpi);
+    // rgb holds nrows rows of 3*width bytes, stride bytes apart
+    bool writeRows(const unsigned char *rgb, int stride, int nrows);
+    bool close();
+
+  private:
+    FILE *fp_{nullptr};
+    int format_;
+    int width_;
+    int height_;
+    int rowsWritten_;
+    double dpi_;
+    bool failed_;
+
+    // PNG: one deflate stream over all rows, each prefixed by a filter byte
+    z_stream zs_;
+    std::vector<unsigned char> zbuf_;
+    std::vector<unsigned char> row_;
+
+    // TIFF: rows are gathered and compressed in strips of rowsPerStrip_
+    int rowsPerStrip_;
+    std::vector<unsigned char> strip_;
+    int stripRows_;
+    std::vector<unsigned long> stripOffsets_;
+    std::vector<unsigned long> stripByteCounts_;
+
+    void writePngChunk(const char *type, const unsigned char *data,
+                       unsigned long len);
+    bool deflateRows(int flush);
+    void flushTiffStrip();
+    bool finishTiff();
+};
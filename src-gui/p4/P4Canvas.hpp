@@ -0,0 +1,92 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+class P4RefineJob;
+
+// Layers of the plot, from bottom to top.  Each layer is retained in its own
+// display list.
+namespace P4SphereLayers
+{
+enum {
+    layer_flow_field = 0,
+    layer_line_at_infinity,
+    layer_separating_curves,
+    layer_separatrices,
+    layer_gcf,
+    layer_arbitrary_curves,
+    layer_isoclines,
+    layer_orbits,
+    layer_limit_cycles,
+    layer_points,
+    numLayers
+};
+}
+
+// What the math routines draw on.  They integrate the curves and hand the
+// points, in world coordinates, to a canvas; how these end up on screen or
+// paper is up to the implementation (P4Sphere for the plot and zoom windows).
+//
+// Every canvas is kept in sM_canvasList.  The plot functions hand each
+// primitive to all of them, so that the canvases recording the same layer
+// share one walk of the curves (see P4Sphere::recordLayer).
+class P4Canvas
+{
+  public:
+    P4Canvas();
+    virtual ~P4Canvas();
+    P4Canvas(const P4Canvas &) = delete;
+    P4Canvas &operator=(const P4Canvas &) = delete;
+
+    static std::vector<P4Canvas *> sM_canvasList;
+
+    double x0_{0}, y0_{0}; // world-coordinates of upper-left corner
+    double x1_{0}, y1_{0}; // world-coordinates of upper-right corner
+    double dx_{0};         // x1-x0
+    double dy_{0};         // y1-y0
+    int w_{0};             // width in pixels
+    int h_{0};             // height in pixels
+
+    // a zoom window shows part of the plot, so it needs the exact points
+    virtual bool isZoom() const = 0;
+    // where to leave the steps that cross the window, to integrate them
+    // again (see math_refine), or nullptr if curves are not refined
+    virtual P4RefineJob *refineJob() = 0;
+    // takes the primitives that are being plotted now
+    virtual bool isDrawing() const = 0;
+
+    // primitives in world coordinates, clipped to the window
+    virtual void drawPoint(double x, double y, int color) = 0;
+    virtual void drawLine(double x1, double y1, double x2, double y2,
+                          int color) = 0;
+    virtual void printPoint(double x, double y, int color) = 0;
+    virtual void printLine(double x1, double y1, double x2, double y2,
+                           int color) = 0;
+
+    // draw on top of what is shown, adding to the given layer
+    virtual void prepareDrawing(int layer) = 0;
+    virtual void finishDrawing() = 0;
+
+    // the data changed: walk all layers, or only one, again
+    virtual void refresh() = 0;
+    virtual void refreshLayer(int layer) = 0;
+};
@@ -0,0 +1,121 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4DisplayList.hpp"
+
+#include <QPainter>
+#include <QPoint>
+#include <QVector>
+
+#include <utility>
+
+#include "color.hpp"
+
+// Tolerance of the simplification of polylines, in pixels.
+#define P4_POLYLINE_TOLERANCE 0.5
+
+// The loop is written so that it needs no branches the compiler cannot turn
+// into selects (the direction of the y-axis is folded into sgn and off),
+// and -fopenmp-simd makes it honour the pragma.
+void P4WinTransform::coWin(const double *x, const double *y, int n, int *wx,
+                           int *wy) const
+{
+    const int sgn{reverseYAxis ? 1 : -1};
+    const int off{reverseYAxis ? 0 : h - 1};
+
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+        int iwx{roundPixel((x[i] - x0) * sx)};
+        int iwy{roundPixel((y[i] - y0) * sy)};
+        wx[i] = (iwx >= w) ? w - 1 : iwx;
+        wy[i] = off + sgn * ((iwy >= h) ? h - 1 : iwy);
+    }
+}
+
+void P4DisplayList::clear()
+{
+    runs_.clear();
+    symbols_.clear();
+}
+
+bool P4DisplayList::empty() const
+{
+    return runs_.empty() && symbols_.empty();
+}
+
+void P4DisplayList::addLine(double x1, double y1, double x2, double y2,
+                            int color)
+{
+    if (runs_.empty() || runs_.back().points || runs_.back().color != color ||
+        runs_.back().x.back() != x1 || runs_.back().y.back() != y1) {
+        runs_.push_back(run{color, false, {x1}, {y1}});
+    }
+    runs_.back().x.push_back(x2);
+    runs_.back().y.push_back(y2);
+}
+
+void P4DisplayList::addPoint(double x, double y, int color)
+{
+    if (runs_.empty() || !runs_.back().points || runs_.back().color != color)
+        runs_.push_back(run{color, true, {}, {}});
+    runs_.back().x.push_back(x);
+    runs_.back().y.push_back(y);
+}
+
+void P4DisplayList::addSymbol(double x, double y,
+                              void (*plot)(QPainter *, int, int))
+{
+    symbols_.push_back(symbol{QPointF{x, y}, plot});
+}
+
+void P4DisplayList::replay(QPainter *p, const P4WinTransform &t,
+                           const std::atomic<bool> *cancel) const
+{
+    std::vector<int> wx, wy;
+    QVector<QPoint> win;
+
+    for (auto const &r : runs_) {
+        if (cancel != nullptr && *cancel)
+            return;
+
+        int n{static_cast<int>(r.x.size())};
+        wx.resize(n);
+        wy.resize(n);
+        t.coWin(r.x.data(), r.y.data(), n, wx.data(), wy.data());
+
+        // points that fall in the same pixel are merged right away
+        win.resize(0);
+        for (int i = 0; i < n; i++) {
+            QPoint w{wx[i], wy[i]};
+            if (win.isEmpty() || win.last() != w)
+                win.append(w);
+        }
+
+        p->setPen(P4Colours::p4XfigColour(r.color));
+        if (r.points || win.size() == 1) {
+            p->drawPoints(win.constData(), win.size());
+        } else {
+            simplifyPolyline(win, P4_POLYLINE_TOLERANCE);
+            p->drawPolyline(win.constData(), win.size());
+        }
+    }
+
+    for (auto const &s : symbols_)
+        (*s.plot)(p, t.coWinX(s.pos.x()), t.coWinY(s.pos.y()));
+}
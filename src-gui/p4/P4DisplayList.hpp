@@ -0,0 +1,159 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+#include <atomic>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+class QPainter;
+
+// Douglas-Peucker simplification in device coordinates: only the points that
+// are farther than tolerance pixels from the chord through their neighbours
+// are kept.  A stack is used instead of recursion, since orbits can have a
+// lot of points.
+template <typename POINT>
+void simplifyPolyline(QVector<POINT> &pts, double tolerance)
+{
+    int n{static_cast<int>(pts.size())};
+    if (n <= 2)
+        return;
+
+    std::vector<bool> keep(n, false);
+    std::vector<std::pair<int, int>> todo{{0, n - 1}};
+    keep[0] = true;
+    keep[n - 1] = true;
+
+    while (!todo.empty()) {
+        int a{todo.back().first}, b{todo.back().second};
+        todo.pop_back();
+
+        double ax{static_cast<double>(pts[a].x())};
+        double ay{static_cast<double>(pts[a].y())};
+        double dx{pts[b].x() - ax}, dy{pts[b].y() - ay};
+        double len2{dx * dx + dy * dy};
+        double worst{tolerance * tolerance};
+        int iworst{-1};
+
+        for (int i = a + 1; i < b; i++) {
+            // distance to the segment [a,b], not to the line through it
+            double px{pts[i].x() - ax}, py{pts[i].y() - ay};
+            double s{(len2 > 0) ? (px * dx + py * dy) / len2 : 0};
+            if (s < 0)
+                s = 0;
+            else if (s > 1)
+                s = 1;
+            px -= s * dx;
+            py -= s * dy;
+            if (px * px + py * py > worst) {
+                worst = px * px + py * py;
+                iworst = i;
+            }
+        }
+        if (iworst >= 0) {
+            keep[iworst] = true;
+            todo.emplace_back(a, iworst);
+            todo.emplace_back(iworst, b);
+        }
+    }
+
+    int k{0};
+    for (int i = 0; i < n; i++) {
+        if (keep[i])
+            pts[k++] = pts[i];
+    }
+    pts.resize(k);
+}
+
+// Maps view coordinates to window coordinates, like P4Sphere::coWinX and
+// coWinY, but with the scale factors worked out beforehand.  It is a copy of
+// the geometry of a sphere, so that a display list can be replayed on a
+// worker thread.
+//
+// Pixels are rounded half away from zero by truncating, as std::round does,
+// but without a call to the library, so that the loop of coWin can be
+// vectorized.
+struct P4WinTransform {
+    double x0, y0; // world-coordinates of upper-left corner
+    double sx, sy; // pixels per unit: (w-1)/dx and (h-1)/dy
+    int w, h;
+    bool reverseYAxis;
+
+    static int roundPixel(double v)
+    {
+        return static_cast<int>(v + std::copysign(0.5, v));
+    }
+
+    int coWinX(double x) const
+    {
+        int iwx{roundPixel((x - x0) * sx)};
+        return (iwx >= w) ? w - 1 : iwx;
+    }
+    int coWinY(double y) const
+    {
+        int iwy{roundPixel((y - y0) * sy)};
+        if (iwy >= h)
+            iwy = h - 1;
+        return reverseYAxis ? iwy : h - 1 - iwy;
+    }
+
+    // coWinX and coWinY of n points at once
+    void coWin(const double *x, const double *y, int n, int *wx,
+               int *wy) const;
+};
+
+// Retained primitives of one layer of a P4Sphere.  They are stored in view
+// coordinates, so that they can be replayed at any window size.  Segments
+// of the same colour that join up are kept in one run, which is replayed
+// with a single drawPolyline.  The coordinates of a run are kept in two
+// separate arrays, which P4WinTransform::coWin maps in one go.
+
+class P4DisplayList
+{
+  public:
+    void clear();
+    bool empty() const;
+
+    void addLine(double x1, double y1, double x2, double y2, int color);
+    void addPoint(double x, double y, int color);
+    void addSymbol(double x, double y, void (*plot)(QPainter *, int, int));
+
+    // replaying stops early when cancel is set from another thread
+    void replay(QPainter *p, const P4WinTransform &t,
+                const std::atomic<bool> *cancel = nullptr) const;
+
+  private:
+    struct run {
+        int color;
+        bool points; // isolated points instead of a polyline
+        std::vector<double> x, y;
+    };
+    struct symbol {
+        QPointF pos;
+        void (*plot)(QPainter *, int, int);
+    };
+
+    std::vector<run> runs_;
+    std::vector<symbol> symbols_;
+};
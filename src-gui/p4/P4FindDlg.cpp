@@ -309,8 +309,6 @@ P4FindDlg::P4FindDlg(P4StartDlg *startdlg)
     // TODO: implement onSaveSignal slot
 
     // finishing
-    gThisVF->setFindDlg(this);
-
     if (gThisVF->evaluating_)
         btn_eval_->setEnabled(false);
 
@@ -370,6 +368,8 @@ void P4FindDlg::onBtnSave()
             this, "P4",
             "Unable to save the input vector field.\n"
             "Please check permissions on the write location.\n");
+    } else {
+        gP4app->signalSaved();
     }
 }
 
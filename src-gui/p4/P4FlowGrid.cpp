@@ -0,0 +1,456 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4FlowGrid.hpp"
+
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "P4InputVF.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4Trace.hpp"
+#include "P4VFStudy.hpp"
+#include "color.hpp"
+#include "custom.hpp"
+#include "math_charts.hpp"
+#include "math_p4.hpp"
+#include "structures.hpp"
+
+// relative step used for the direction and the divergence of the field
+#define FLOWGRID_DIFFSTEP 1e-6
+
+// -----------------------------------------------------------------------
+//                      P4FLATPOLYNOM
+// -----------------------------------------------------------------------
+
+void P4FlatPolynom::set(const P4Polynom::term2 *f)
+{
+    isSet_ = (f != nullptr);
+    numVars_ = 2;
+    maxExp_[0] = maxExp_[1] = maxExp_[2] = 0;
+    exp_.clear();
+    coeff_.clear();
+    for (; f != nullptr; f = f->next_term2) {
+        exp_.push_back(f->exp_x);
+        exp_.push_back(f->exp_y);
+        coeff_.push_back(f->coeff);
+        maxExp_[0] = std::max(maxExp_[0], f->exp_x);
+        maxExp_[1] = std::max(maxExp_[1], f->exp_y);
+    }
+}
+
+void P4FlatPolynom::set(const P4Polynom::term3 *f)
+{
+    isSet_ = (f != nullptr);
+    numVars_ = 3;
+    maxExp_[0] = maxExp_[1] = maxExp_[2] = 0;
+    exp_.clear();
+    coeff_.clear();
+    for (; f != nullptr; f = f->next_term3) {
+        exp_.push_back(f->exp_r);
+        exp_.push_back(f->exp_Co);
+        exp_.push_back(f->exp_Si);
+        coeff_.push_back(f->coeff);
+        maxExp_[0] = std::max(maxExp_[0], f->exp_r);
+        maxExp_[1] = std::max(maxExp_[1], f->exp_Co);
+        maxExp_[2] = std::max(maxExp_[2], f->exp_Si);
+    }
+}
+
+void P4FlatPolynom::evaluate(const double *const *var, double *res, int n,
+                             std::vector<double> &scratch) const
+{
+    double *pw[3];
+    const double *a, *b, *c;
+    int v, e, j, t, size;
+    double co;
+
+    for (j = 0; j < n; j++)
+        res[j] = 0;
+    if (coeff_.empty())
+        return;
+
+    // pw[v][e*n+j] = var[v][j]^e
+    for (size = 0, v = 0; v < numVars_; v++)
+        size += (maxExp_[v] + 1) * n;
+    scratch.resize(size);
+    pw[0] = scratch.data();
+    for (v = 0; v < numVars_; v++) {
+        if (v > 0)
+            pw[v] = pw[v - 1] + (maxExp_[v - 1] + 1) * n;
+        for (j = 0; j < n; j++)
+            pw[v][j] = 1.0;
+        for (e = 1; e <= maxExp_[v]; e++) {
+            double *p{pw[v] + e * n};
+            const double *q{p - n};
+            const double *x{var[v]};
+            for (j = 0; j < n; j++)
+                p[j] = q[j] * x[j];
+        }
+    }
+
+    for (t = 0; t < static_cast<int>(coeff_.size()); t++) {
+        co = coeff_[t];
+        a = pw[0] + exp_[t * numVars_] * n;
+        b = pw[1] + exp_[t * numVars_ + 1] * n;
+        if (numVars_ == 2) {
+            for (j = 0; j < n; j++)
+                res[j] += co * a[j] * b[j];
+        } else {
+            c = pw[2] + exp_[t * numVars_ + 2] * n;
+            for (j = 0; j < n; j++)
+                res[j] += co * a[j] * b[j] * c[j];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      UPDATE
+// -----------------------------------------------------------------------
+
+void P4FlowGrid::update(double x0, double y0, double x1, double y1, int w,
+                        int h, int spacing)
+{
+    std::vector<int> rows;
+    double logspeed;
+
+    if (isValid_ && x0 == x0_ && y0 == y0_ && x1 == x1_ && y1 == y1_ &&
+        w == w_ && h == h_ && spacing == spacing_ &&
+        kindvf_ == gVFResults.config_kindvf_ &&
+        typeofview_ == gVFResults.typeofview_ &&
+        plweights_ == gVFResults.plweights_)
+        return;
+
+    x0_ = x0;
+    y0_ = y0;
+    x1_ = x1;
+    y1_ = y1;
+    w_ = w;
+    h_ = h;
+    spacing_ = spacing;
+    kindvf_ = gVFResults.config_kindvf_;
+    typeofview_ = gVFResults.typeofview_;
+    plweights_ = gVFResults.plweights_;
+    isValid_ = true;
+
+    samples_.clear();
+    minLogSpeed_ = maxLogSpeed_ = maxDivergence_ = 0;
+    if (gThisVF == nullptr || gVFResults.vf_.empty() || w < 2 || h < 2 ||
+        spacing < 1 || x1 == x0 || y1 == y0)
+        return;
+
+    nx_ = std::max(1, w / spacing);
+    ny_ = std::max(1, h / spacing);
+    samples_.resize(nx_ * ny_);
+
+    prepareFields();
+    rows.resize(ny_);
+    std::iota(rows.begin(), rows.end(), 0);
+    QtConcurrent::blockingMap(rows, [this](int &row) { computeRow(row); });
+    fields_.clear();
+
+    bool first{true};
+    for (auto const &s : samples_) {
+        if (!s.valid)
+            continue;
+        logspeed = std::log10(s.speed);
+        if (first) {
+            minLogSpeed_ = maxLogSpeed_ = logspeed;
+            first = false;
+        } else {
+            minLogSpeed_ = std::min(minLogSpeed_, logspeed);
+            maxLogSpeed_ = std::max(maxLogSpeed_, logspeed);
+        }
+        maxDivergence_ = std::max(maxDivergence_, std::fabs(s.divergence));
+    }
+}
+
+void P4FlowGrid::prepareFields()
+{
+    fields_.clear();
+    for (auto const &vf : gVFResults.vf_) {
+        std::vector<chartfield> c(numCharts);
+        c[chart_R2].f[0].set(vf->f_vec_field_[0]);
+        c[chart_R2].f[1].set(vf->f_vec_field_[1]);
+        c[chart_R2].gcf.set(vf->gcf_);
+        c[chart_R2].singinf = false;
+        c[chart_U1].f[0].set(vf->vec_field_U1_[0]);
+        c[chart_U1].f[1].set(vf->vec_field_U1_[1]);
+        c[chart_U1].gcf.set(vf->gcf_U1_);
+        c[chart_U1].singinf = vf->singinf_;
+        c[chart_V1].f[0].set(vf->vec_field_V1_[0]);
+        c[chart_V1].f[1].set(vf->vec_field_V1_[1]);
+        c[chart_V1].gcf.set(vf->gcf_V1_);
+        c[chart_V1].singinf = vf->singinf_;
+        c[chart_U2].f[0].set(vf->vec_field_U2_[0]);
+        c[chart_U2].f[1].set(vf->vec_field_U2_[1]);
+        c[chart_U2].gcf.set(vf->gcf_U2_);
+        c[chart_U2].singinf = vf->singinf_;
+        c[chart_V2].f[0].set(vf->vec_field_V2_[0]);
+        c[chart_V2].f[1].set(vf->vec_field_V2_[1]);
+        c[chart_V2].gcf.set(vf->gcf_V2_);
+        c[chart_V2].singinf = vf->singinf_;
+        c[chart_cyl].f[0].set(vf->vec_field_C_[0]);
+        c[chart_cyl].f[1].set(vf->vec_field_C_[1]);
+        c[chart_cyl].gcf.set(vf->gcf_C_);
+        c[chart_cyl].singinf = false;
+        fields_.push_back(std::move(c));
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      CHARTS
+// -----------------------------------------------------------------------
+
+// Same choice of chart as integrate_poincare_orbit and
+// integrate_lyapunov_orbit.  The chart coordinates are stored in y.
+int P4FlowGrid::chartOf(const double *pcoord, double *y) const
+{
+    double theta;
+
+    if (plweights_) {
+        y[0] = pcoord[1];
+        y[1] = pcoord[2];
+        return (pcoord[0] == 0) ? chart_R2 : chart_cyl;
+    }
+
+    if (pcoord[2] > ZCOORD) {
+        psphere_to_R2(pcoord[0], pcoord[1], pcoord[2], y);
+        return chart_R2;
+    }
+    theta = atan2(fabs(pcoord[1]), fabs(pcoord[0]));
+    if (theta < PI_DIV4 && theta > -PI_DIV4) {
+        if (pcoord[0] > 0) {
+            psphere_to_U1(pcoord[0], pcoord[1], pcoord[2], y);
+            return chart_U1;
+        }
+        psphere_to_V1(pcoord[0], pcoord[1], pcoord[2], y);
+        return chart_V1;
+    }
+    if (pcoord[1] > 0) {
+        psphere_to_U2(pcoord[0], pcoord[1], pcoord[2], y);
+        return chart_U2;
+    }
+    psphere_to_V2(pcoord[0], pcoord[1], pcoord[2], y);
+    return chart_V2;
+}
+
+void P4FlowGrid::chartToView(int chart, const double *y,
+                             double *ucoord) const
+{
+    double pcoord[3];
+
+    switch (chart) {
+    case chart_R2:
+        if (plweights_)
+            R2_to_plsphere(y[0], y[1], pcoord);
+        else
+            R2_to_psphere(y[0], y[1], pcoord);
+        break;
+    case chart_U1:
+        U1_to_psphere(y[0], y[1], pcoord);
+        break;
+    case chart_V1:
+        V1_to_psphere(y[0], y[1], pcoord);
+        break;
+    case chart_U2:
+        U2_to_psphere(y[0], y[1], pcoord);
+        break;
+    case chart_V2:
+        V2_to_psphere(y[0], y[1], pcoord);
+        break;
+    default:
+        cylinder_to_plsphere(y[0], y[1], pcoord);
+        break;
+    }
+    MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], ucoord);
+}
+
+int P4FlowGrid::vfIndexOf(int chart, const double *y) const
+{
+    switch (chart) {
+    case chart_R2:
+        return gThisVF->getVFIndex_R2(y);
+    case chart_U1:
+        return gThisVF->getVFIndex_U1(y);
+    case chart_V1:
+        return gThisVF->getVFIndex_V1(y);
+    case chart_U2:
+        return gThisVF->getVFIndex_U2(y);
+    case chart_V2:
+        return gThisVF->getVFIndex_V2(y);
+    default:
+        return gThisVF->getVFIndex_cyl(y);
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      COMPUTEROW
+// -----------------------------------------------------------------------
+
+// The points of the row are grouped by vector field and chart.  Each group
+// is evaluated in one batch, on five stencils: the points themselves and
+// their neighbours at distance d in both directions, for the divergence.
+void P4FlowGrid::computeRow(int row)
+{
+    P4TraceSpan span{"flow field row", "curves", "row", row};
+    std::vector<std::vector<int>> groups(fields_.size() * numCharts);
+    std::vector<double> chartcoord(2 * nx_), scratch, buf;
+    double pcoord[3], u0[2], u1[2], yy[2], d[2], f[2];
+    double sx{(w_ - 1) / (x1_ - x0_)}, sy{(h_ - 1) / (y1_ - y0_)};
+    double *var[3], *f0, *f1, *g;
+    int i, j, k, c, m, l, n;
+
+    for (i = 0; i < nx_; i++) {
+        sample &s{samples_[row * nx_ + i]};
+        s.u[0] = x0_ + (i + 0.5) * (x1_ - x0_) / nx_;
+        s.u[1] = y0_ + (row + 0.5) * (y1_ - y0_) / ny_;
+        s.valid = false;
+        if (!MATHFUNC(is_valid_viewcoord)(s.u[0], s.u[1], pcoord))
+            continue;
+        c = chartOf(pcoord, &chartcoord[2 * i]);
+        k = vfIndexOf(c, &chartcoord[2 * i]);
+        if (k < 0 && fields_.size() == 1)
+            k = 0;
+        if (k >= 0 && k < static_cast<int>(fields_.size()))
+            groups[k * numCharts + c].push_back(i);
+    }
+
+    for (k = 0; k < static_cast<int>(groups.size()); k++) {
+        auto const &grp = groups[k];
+        if (grp.empty())
+            continue;
+        c = k % numCharts;
+        const chartfield &cf{fields_[k / numCharts][c]};
+
+        m = grp.size();
+        n = 5 * m;
+        buf.resize(6 * n);
+        var[0] = buf.data();
+        var[1] = var[0] + n;
+        var[2] = var[1] + n;
+        f0 = var[2] + n;
+        f1 = f0 + n;
+        g = f1 + n;
+
+        for (j = 0; j < m; j++) {
+            const double *y{&chartcoord[2 * grp[j]]};
+            double dy{FLOWGRID_DIFFSTEP * (1 + fabs(y[0]) + fabs(y[1]))};
+            const double offset[5][2]{
+                {0, 0}, {dy, 0}, {-dy, 0}, {0, dy}, {0, -dy}};
+            for (l = 0; l < 5; l++) {
+                var[0][l * m + j] = y[0] + offset[l][0];
+                var[1][l * m + j] = y[1] + offset[l][1];
+            }
+        }
+        if (c == chart_cyl) {
+            // variables r, cos(theta), sin(theta)
+            for (j = 0; j < n; j++) {
+                var[2][j] = sin(var[1][j]);
+                var[1][j] = cos(var[1][j]);
+            }
+        }
+
+        cf.f[0].evaluate(var, f0, n, scratch);
+        cf.f[1].evaluate(var, f1, n, scratch);
+        if (kindvf_ == INTCONFIG_ORIGINAL && cf.gcf.isSet()) {
+            cf.gcf.evaluate(var, g, n, scratch);
+            for (j = 0; j < n; j++) {
+                f0[j] *= g[j];
+                f1[j] *= g[j];
+            }
+        }
+        if (kindvf_ == INTCONFIG_ORIGINAL && cf.singinf) {
+            for (j = 0; j < n; j++) {
+                f0[j] *= var[1][j];
+                f1[j] *= var[1][j];
+            }
+        }
+
+        for (j = 0; j < m; j++) {
+            sample &s{samples_[row * nx_ + grp[j]]};
+            const double *y{&chartcoord[2 * grp[j]]};
+            double dy{FLOWGRID_DIFFSTEP * (1 + fabs(y[0]) + fabs(y[1]))};
+
+            f[0] = f0[j];
+            f[1] = f1[j];
+            s.speed = std::hypot(f[0], f[1]);
+            if (s.speed == 0 || !std::isfinite(s.speed))
+                continue;
+            s.divergence = (f0[m + j] - f0[2 * m + j] + f1[3 * m + j] -
+                            f1[4 * m + j]) /
+                           (2 * dy);
+
+            // follow the flow over a short distance in the chart, and
+            // measure the result in window pixels
+            yy[0] = y[0] + dy * f[0] / s.speed;
+            yy[1] = y[1] + dy * f[1] / s.speed;
+            chartToView(c, y, u0);
+            chartToView(c, yy, u1);
+            d[0] = (u1[0] - u0[0]) * sx;
+            d[1] = (u1[1] - u0[1]) * sy;
+            double len{std::hypot(d[0], d[1])};
+            if (len == 0 || !std::isfinite(len) ||
+                !std::isfinite(s.divergence))
+                continue;
+            s.dir[0] = d[0] / len;
+            s.dir[1] = d[1] / len;
+            s.valid = true;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+//                      SAMPLECOLOUR
+// -----------------------------------------------------------------------
+
+int P4FlowGrid::sampleColour(const sample &s, int typeofflowfield) const
+{
+    // from slow to fast
+    static const int speedColours[]{
+        P4Colours::blue1, P4Colours::blue3, P4Colours::cyan2,
+        P4Colours::green2, P4Colours::gold, P4Colours::red3, P4Colours::red};
+    // from contracting to expanding
+    static const int divergenceColours[]{
+        P4Colours::blue,     P4Colours::blue3, P4Colours::cyan3,
+        P4Colours::darkgray, P4Colours::pink3, P4Colours::red3,
+        P4Colours::red};
+    const int n{sizeof(speedColours) / sizeof(speedColours[0])};
+    double t;
+
+    if (typeofflowfield == P4TypeOfFlowField::flowfield_speed) {
+        if (maxLogSpeed_ <= minLogSpeed_)
+            return speedColours[n / 2];
+        t = (std::log10(s.speed) - minLogSpeed_) /
+            (maxLogSpeed_ - minLogSpeed_);
+        return speedColours[std::max(0, std::min(n - 1,
+                                                 static_cast<int>(t * n)))];
+    }
+    if (typeofflowfield == P4TypeOfFlowField::flowfield_divergence) {
+        if (maxDivergence_ <= 0)
+            return divergenceColours[n / 2];
+        t = (s.divergence / maxDivergence_ + 1) / 2;
+        return divergenceColours[std::max(
+            0, std::min(n - 1, static_cast<int>(t * n)))];
+    }
+    return P4ColourSettings::colour_orbit;
+}
@@ -0,0 +1,126 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace P4Polynom
+{
+struct term2;
+struct term3;
+} // namespace P4Polynom
+
+namespace P4TypeOfFlowField
+{
+enum {
+    flowfield_none = 0,  // no direction field
+    flowfield_arrows,    // arrows in the colour of the orbits
+    flowfield_speed,     // arrows coloured by the speed of the field
+    flowfield_divergence // arrows coloured by the divergence of the field
+};
+}
+
+// A polynomial stored as flat arrays of exponents and coefficients, so that
+// it is evaluated on a batch of points at once.  The powers of the variables
+// are tabulated for the whole batch, and every term is then one loop over
+// the batch that the compiler can vectorize.
+class P4FlatPolynom
+{
+  public:
+    void set(const P4Polynom::term2 *f); // variables x and y
+    void set(const P4Polynom::term3 *f); // variables r, cos(t) and sin(t)
+    bool isSet() const { return isSet_; }
+
+    // res[j] = f(var[0][j], var[1][j], ...) for 0 <= j < n
+    void evaluate(const double *const *var, double *res, int n,
+                  std::vector<double> &scratch) const;
+
+  private:
+    bool isSet_{false};
+    int numVars_{0};
+    int maxExp_[3]{0, 0, 0};
+    std::vector<int> exp_; // numVars_ exponents per term
+    std::vector<double> coeff_;
+};
+
+// Direction of the vector field on a grid that is aligned with the window
+// of a sphere.  Every grid point is taken to the chart in which orbits are
+// integrated there (R2, U1, V1, U2 or V2 on the Poincare sphere, R2 or the
+// cylinder on the Poincare-Lyapunov sphere), and the field of the region it
+// belongs to is evaluated.  The rows of the grid are shared among threads.
+// The grid is kept until the view, the window or the field changes.
+class P4FlowGrid
+{
+  public:
+    struct sample {
+        double u[2];   // view coordinates of the grid point
+        double dir[2]; // unit direction of the flow, in window pixels
+        double speed;  // norm of the field in its chart
+        double divergence;
+        bool valid;
+    };
+
+    // (x0,y0)-(x1,y1) is the visible part of the view, shown in a window of
+    // w x h pixels, with grid points spacing pixels apart
+    void update(double x0, double y0, double x1, double y1, int w, int h,
+                int spacing);
+    void invalidate() { isValid_ = false; }
+
+    const std::vector<sample> &samples() const { return samples_; }
+    // colour of an arrow for the given P4TypeOfFlowField
+    int sampleColour(const sample &s, int typeofflowfield) const;
+
+  private:
+    // charts in which orbits are integrated
+    enum {
+        chart_R2 = 0,
+        chart_U1,
+        chart_V1,
+        chart_U2,
+        chart_V2,
+        chart_cyl,
+        numCharts
+    };
+
+    struct chartfield {
+        P4FlatPolynom f[2];
+        P4FlatPolynom gcf;
+        bool singinf;
+    };
+
+    bool isValid_{false};
+    double x0_, y0_, x1_, y1_;
+    int w_, h_, spacing_;
+    int kindvf_, typeofview_;
+    bool plweights_;
+
+    int nx_{0}, ny_{0};
+    std::vector<sample> samples_;
+    std::vector<std::vector<chartfield>> fields_; // per field, per chart
+
+    double minLogSpeed_{0}, maxLogSpeed_{0};
+    double maxDivergence_{0};
+
+    void prepareFields();
+    void computeRow(int row);
+    int chartOf(const double *pcoord, double *y) const;
+    int vfIndexOf(int chart, const double *y) const;
+    void chartToView(int chart, const double *y, double *ucoord) const;
+};
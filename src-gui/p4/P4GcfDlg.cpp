@@ -108,6 +108,8 @@ P4GcfDlg::P4GcfDlg(P4PlotWnd *plt, P4Sphere *sp)
     // connections
     QObject::connect(btn_evaluate_, &QPushButton::clicked, this,
                      &P4GcfDlg::onbtn_evaluate);
+    QObject::connect(gThisVF, &P4InputVF::gcfEvaluationFinished, this,
+                     &P4GcfDlg::finishGcfEvaluation);
 
     // finishing
     setP4WindowTitle(this, "GCF Plot");
@@ -177,7 +179,6 @@ void P4GcfDlg::onbtn_evaluate()
 
     btn_evaluate_->setEnabled(false);
 
-    gThisVF->setGcfDlg(this);
     result = evalGcfStart(mainSphere_, dashes, precis, points);
     if (!result) {
         btn_evaluate_->setEnabled(true);
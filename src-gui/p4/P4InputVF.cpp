@@ -26,27 +26,17 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QLabel>
 #include <QMetaObject>
 #include <QProcess>
-#include <QPushButton>
 #include <QSettings>
-#include <QTextEdit>
 #include <QTextStream>
 #include <QTimer>
-#include <QVBoxLayout>
-#include <QWidget>
 #include <QtGlobal>
 
-#include "P4Application.hpp"
-#include "P4ArbitraryCurveDlg.hpp"
 #include "P4Event.hpp"
-#include "P4FindDlg.hpp"
-#include "P4GcfDlg.hpp"
-#include "P4IsoclinesDlg.hpp"
+#include "P4IntStats.hpp"
+#include "P4Trace.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4ProcessWnd.hpp"
-#include "P4StartDlg.hpp"
 #include "P4VFStudy.hpp"
 #include "file_paths.hpp"
 #include "main.hpp"
@@ -928,6 +918,11 @@ QString P4InputVF::getfilename_separatingcurveresults() const
     return getbarefilename().append("_sepcurves.tab");
 }
 
+QString P4InputVF::getfilename_session() const
+{
+    return getbarefilename().append(".p4s");
+}
+
 // -----------------------------------------------------------------------
 //          P4InputVF::fileExists
 // -----------------------------------------------------------------------
@@ -1444,12 +1439,17 @@ void P4InputVF::prepareFile(QTextStream &fp, bool prepareforcurves)
     user_exeprefix = "";
 #endif
     mainmaple += MAINMAPLEFILE;
+    // Maple calls user_lypexe when no precision (0 digits) is requested.
+    // lyapunov computes in doubles, and passes a weak focus on to
+    // lyapunov_mpf only when the sign of one of its constants is in doubt;
+    // lyapunov_mpf certifies the signs with interval arithmetic, which is
+    // much slower, so it is only called directly when asked for.
 #ifdef Q_WS_WIN
-    user_lypexe = "lyapunov.exe";
+    user_lypexe = getCertifyLyapunov() ? "lyapunov_mpf.exe" : "lyapunov.exe";
     user_lypexe_mpf = "lyapunov_mpf.exe";
     user_sepexe = "separatrice.exe";
 #else
-    user_lypexe = "lyapunov";
+    user_lypexe = getCertifyLyapunov() ? "lyapunov_mpf" : "lyapunov";
     user_lypexe_mpf = "lyapunov_mpf";
     user_sepexe = "separatrice";
 #endif
@@ -1527,20 +1527,20 @@ void P4InputVF::prepareFile(QTextStream &fp, bool prepareforcurves)
               "  printf( \"! Error (\%a) \%a\\n\", lastexception[1], "
               "StringTools:-FormatMessage(lastexception[2..-1]) );\n"
               "finally:\n"
-              "  closeallfiles();\n"
-              "  if normalexit=0 then\n"
-              "    `quit`(0);\n"
-              "  else\n"
-              "    `quit(1)`\n"
-              "  end if:\n"
-              "end try:\n";
+              "  closeallfiles();\n";
     } else {
         fp << "try p4main() catch:\n"
               "  printf( \"! Error (\%a) \%a\\n\", lastexception[1], "
               "StringTools:-FormatMessage(lastexception[2..-1]) );\n"
               "finally:\n"
-              "  closeallfiles();\n"
-              "  if normalexit=0 then\n"
+              "  closeallfiles();\n";
+    }
+    if (sessionScripts_) {
+        fp << "  printf( \"%s %d\\n\", \"" MAPLE_SESSIONDONE "\", "
+              "`if`(normalexit=0, 0, 1) );\n"
+              "end try:\n";
+    } else {
+        fp << "  if normalexit=0 then\n"
               "    `quit`(0);\n"
               "  else\n"
               "    `quit(1)`\n"
@@ -1740,16 +1740,7 @@ void P4InputVF::evaluate()
     else
         s = s.append(" \"").append(filedotmpl).append("\"");
 
-    if (outputWindow_ == nullptr)
-        createProcessWindow();
-    else {
-        outputWindow_->appendText(
-            "\n\n--------------------------------------------------------------"
-            "-----------------\n\n");
-        outputWindow_->enableTerminateProcessButton(true);
-        outputWindow_->show();
-        outputWindow_->raise();
-    }
+    emit processStarted();
 
     auto proc = new QProcess{this};
     proc->setWorkingDirectory(QDir::currentPath());
@@ -1757,7 +1748,7 @@ void P4InputVF::evaluate()
     evalProcessFinishedConnection_ =
         new QMetaObject::Connection{QObject::connect(
             proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-            gP4app, &P4Application::signalEvaluated)};
+            this, &P4InputVF::evaluated)};
     QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                      &P4InputVF::readProcessStdout);
 #ifdef QT_QPROCESS_OLD
@@ -1772,7 +1763,9 @@ void P4InputVF::evaluate()
 
     processFailed_ = false;
     QString pa = "External Command: " + getMapleExe() + " " + filedotmpl;
-    outputWindow_->appendText(pa);
+    emit processOutput(pa);
+    evalTraceName_ = "Maple evaluate";
+    evalTraceStart_ = P4Trace::now();
     proc->start(getMapleExe(), QStringList(filedotmpl), QIODevice::ReadWrite);
 
     if (proc->state() != QProcess::Running &&
@@ -1782,12 +1775,14 @@ void P4InputVF::evaluate()
         proc = nullptr;
         evalFile_ = "";
         evalFile2_ = "";
-        gP4app->signalEvaluated(-1);
-        outputWindow_->enableTerminateProcessButton(false);
+        emit evaluated(-1);
+        emit processStopped();
     } else {
         evalProcess_ = proc;
         evalFile_ = std::move(filedotmpl);
         evalFile2_ = "";
+        numFiniteDone_ = 0;
+        evalOutputLine_.clear();
         evaluating_ = true;
         evaluatingGcf_ = false;
         evaluatingPiecewiseConfig_ = false;
@@ -1816,41 +1811,33 @@ void P4InputVF::evaluateArbitraryCurveTable()
     else
         s = s.append(" \"").append(filedotmpl).append("\"");
 
-    /* Here a window for displaying the output text of the Maple process
-     * is created */
-    if (outputWindow_ == nullptr)
-        createProcessWindow();
-    else {
-        outputWindow_->appendText(
-            "\n\n-----------------------------------------"
-            "---------------------"
-            "-----------------\n\n");
-        outputWindow_->enableTerminateProcessButton(true);
-        outputWindow_->show();
-        outputWindow_->raise();
-    }
+    /* Here the window for displaying the output text of the Maple process
+     * is shown */
+    emit processStarted();
 
     auto proc = new QProcess{this};
     proc->setWorkingDirectory(QDir::currentPath());
     evalProcessFinishedConnection_ =
         new QMetaObject::Connection{QObject::connect(
             proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-            gP4app, &P4Application::signalCurveEvaluated)};
+            this, &P4InputVF::curveEvaluated)};
     QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                      &P4InputVF::readProcessStdout);
 #ifdef QT_QPROCESS_OLD
     QObject::connect(proc,
                      static_cast<void (QProcess::*)(QProcess::ProcessError)>(
                          &QProcess::error),
-                     gP4app, &P4Application::catchProcessError);
+                     this, &P4InputVF::catchProcessError);
 #else
-    QObject::connect(proc, &QProcess::errorOccurred, gP4app,
-                     &P4Application::catchProcessError);
+    QObject::connect(proc, &QProcess::errorOccurred, this,
+                     &P4InputVF::catchProcessError);
 #endif
 
     processFailed_ = false;
     QString pa = "External Command: " + getMapleExe() + " " + filedotmpl;
-    outputWindow_->appendText(pa);
+    emit processOutput(pa);
+    evalTraceName_ = "Maple arbitrary curve table";
+    evalTraceStart_ = P4Trace::now();
     proc->start(getMapleExe(), QStringList(filedotmpl), QIODevice::ReadWrite);
 
     if (proc->state() != QProcess::Running &&
@@ -1860,8 +1847,8 @@ void P4InputVF::evaluateArbitraryCurveTable()
         proc = nullptr;
         evalFile_ = "";
         evalFile2_ = "";
-        gP4app->signalEvaluated(-1);
-        outputWindow_->enableTerminateProcessButton(false);
+        emit evaluated(-1);
+        emit processStopped();
     } else {
         evalProcess_ = proc;
         evalFile_ = std::move(filedotmpl);
@@ -1903,19 +1890,9 @@ void P4InputVF::evaluateIsoclinesTable()
         } else
             s = s.append(filedotmpl);
 
-        /* Here a window for displaying the output text of the Maple process
-         * is created */
-        if (outputWindow_ == nullptr)
-            createProcessWindow();
-        else {
-            outputWindow_->appendText(
-                "\n\n--------------------------------------"
-                "-----------------------------------------"
-                "\n\n");
-            outputWindow_->enableTerminateProcessButton(true);
-            outputWindow_->show();
-            outputWindow_->raise();
-        }
+        /* Here the window for displaying the output text of the Maple
+         * process is shown */
+        emit processStarted();
 
         QProcess *proc;
         if (evalProcess_ != nullptr) { // re-use process of last GCF
@@ -1925,14 +1902,14 @@ void P4InputVF::evaluateIsoclinesTable()
                 new QMetaObject::Connection{QObject::connect(
                     proc,
                     static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                    gP4app, &P4Application::signalCurveEvaluated)};
+                    this, &P4InputVF::curveEvaluated)};
         } else {
             proc = new QProcess{this};
             evalProcessFinishedConnection_ =
                 new QMetaObject::Connection{QObject::connect(
                     proc,
                     static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                    gP4app, &P4Application::signalCurveEvaluated)};
+                    this, &P4InputVF::curveEvaluated)};
             QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                              &P4InputVF::readProcessStdout);
 #ifdef QT_QPROCESS_OLD
@@ -1940,10 +1917,10 @@ void P4InputVF::evaluateIsoclinesTable()
                 proc,
                 static_cast<void (QProcess::*)(QProcess::ProcessError)>(
                     &QProcess::error),
-                gP4app, &P4Application::catchProcessError);
+                this, &P4InputVF::catchProcessError);
 #else
-            QObject::connect(proc, &QProcess::errorOccurred, gP4app,
-                             &P4Application::catchProcessError);
+            QObject::connect(proc, &QProcess::errorOccurred, this,
+                             &P4InputVF::catchProcessError);
 #endif
         }
 
@@ -1954,7 +1931,9 @@ void P4InputVF::evaluateIsoclinesTable()
         pa += getMapleExe();
         pa += " ";
         pa += filedotmpl;
-        outputWindow_->appendText(pa);
+        emit processOutput(pa);
+        evalTraceName_ = "Maple isoclines table";
+        evalTraceStart_ = P4Trace::now();
         proc->start(getMapleExe(), QStringList(filedotmpl),
                     QIODevice::ReadWrite);
 
@@ -1967,8 +1946,8 @@ void P4InputVF::evaluateIsoclinesTable()
             evalProcess_ = nullptr;
             evalFile_ = "";
             evalFile2_ = "";
-            gP4app->signalEvaluated(-1);
-            outputWindow_->enableTerminateProcessButton(false);
+            emit evaluated(-1);
+            emit processStopped();
         } else {
             evalProcess_ = proc;
             evalFile_ = std::move(filedotmpl);
@@ -2007,6 +1986,14 @@ void P4InputVF::catchProcessError(QProcess::ProcessError prerr)
 // -----------------------------------------------------------------------
 void P4InputVF::finishEvaluation(int exitCode)
 {
+    P4TraceSpan span{"finishEvaluation", "study"};
+
+    if (evalTraceStart_ >= 0) {
+        P4Trace::completeAsync(evalTraceName_, "maple", P4Trace::newId(),
+                               evalTraceStart_);
+        evalTraceStart_ = -1;
+    }
+
     if (!evalFile_.isNull() && evalFile_ != "") {
         removeFile(evalFile_);
         evalFile_ = "";
@@ -2017,46 +2004,40 @@ void P4InputVF::finishEvaluation(int exitCode)
         evalFile2_ = "";
     }
 
-    if (outputWindow_ != nullptr)
-        outputWindow_->enableTerminateProcessButton(false);
+    emit processStopped();
 
     if (evalProcess_ != nullptr) {
-        if (outputWindow_ != nullptr) {
-            outputWindow_->show();
-            outputWindow_->raise();
-            QString buf{"\n------------------------------------------------"
-                        "------------"
-                        "-------------------\n"};
-            outputWindow_->appendText(buf);
-            if (evalProcess_ != nullptr) {
-                if (evalProcess_->state() == QProcess::Running) {
-                    evalProcess_->terminate();
+        QString buf{"\n------------------------------------------------"
+                    "------------"
+                    "-------------------\n"};
+        emit processOutput(buf);
+        if (evalProcess_ != nullptr) {
+            if (evalProcess_->state() == QProcess::Running) {
+                evalProcess_->terminate();
 #if QT_VERSION < QT_VERSION_CHECK(5, 5, 0)
-                    QTimer::singleShot(5000, evalProcess_, SLOT(kill));
+                QTimer::singleShot(5000, evalProcess_, SLOT(kill));
 #else
-                    QTimer::singleShot(5000, evalProcess_, &QProcess::kill);
+                QTimer::singleShot(5000, evalProcess_, &QProcess::kill);
 #endif
-                    buf = "Kill signal sent to process.\n";
-                } else {
-                    if (!processFailed_)
-                        buf.sprintf("The process finished normally (%d)\n",
-                                    evalProcess_->exitCode());
-                    else {
-                        buf.sprintf("The process stopped abnormally (%d : ",
-                                    evalProcess_->exitCode());
-                        buf += processError_;
-                        buf += ")\n";
-                    }
-                }
+                buf = "Kill signal sent to process.\n";
             } else {
-                if (processFailed_)
-                    buf =
-                        "The following error occured: " + processError_ + "\n";
-                else
-                    buf = "";
+                if (!processFailed_)
+                    buf.sprintf("The process finished normally (%d)\n",
+                                evalProcess_->exitCode());
+                else {
+                    buf.sprintf("The process stopped abnormally (%d : ",
+                                evalProcess_->exitCode());
+                    buf += processError_;
+                    buf += ")\n";
+                }
             }
-            outputWindow_->appendText(buf);
+        } else {
+            if (processFailed_)
+                buf = "The following error occured: " + processError_ + "\n";
+            else
+                buf = "";
         }
+        emit processOutput(buf);
     }
 
     if (evaluatingGcf_)
@@ -2075,9 +2056,7 @@ void P4InputVF::finishEvaluation(int exitCode)
 void P4InputVF::finishGcfEvaluation()
 {
     evaluatingGcf_ = false;
-    if (gcfDlg_ != nullptr) {
-        gcfDlg_->finishGcfEvaluation();
-    }
+    emit gcfEvaluationFinished();
 }
 
 // -----------------------------------------------------------------------
@@ -2086,9 +2065,7 @@ void P4InputVF::finishGcfEvaluation()
 void P4InputVF::finishArbitraryCurveEvaluation()
 {
     evaluatingArbitraryCurve_ = false;
-    if (arbitraryCurveDlg_ != nullptr) {
-        arbitraryCurveDlg_->finishArbitraryCurveEvaluation();
-    }
+    emit arbitraryCurveEvaluationFinished();
 }
 
 // -----------------------------------------------------------------------
@@ -2097,9 +2074,7 @@ void P4InputVF::finishArbitraryCurveEvaluation()
 void P4InputVF::finishIsoclinesEvaluation()
 {
     evaluatingIsoclines_ = false;
-    if (isoclinesDlg_ != nullptr) {
-        isoclinesDlg_->finishIsoclinesEvaluation();
-    }
+    emit isoclinesEvaluationFinished();
 }
 
 // -----------------------------------------------------------------------
@@ -2107,6 +2082,7 @@ void P4InputVF::finishIsoclinesEvaluation()
 // -----------------------------------------------------------------------
 void P4InputVF::prepare()
 {
+    P4TraceSpan span{"prepare", "maple"};
     auto filedotmpl = getmaplefilename();
     QFile file{QFile::encodeName(filedotmpl)};
     if (file.open(QFile::WriteOnly)) {
@@ -2159,7 +2135,7 @@ void P4InputVF::readProcessStdout()
     QByteArray line;
     int i, j;
 
-    if (evalProcess_ == nullptr || outputWindow_ == nullptr)
+    if (evalProcess_ == nullptr)
         return;
 
     while (1) {
@@ -2180,12 +2156,61 @@ void P4InputVF::readProcessStdout()
                 line = t.left(i);
                 t = t.mid(i + 1);
             }
-            outputWindow_->appendText(line);
+            emit processOutput(line);
+            checkProcessLine(line);
             i = t.indexOf('\n');
             j = t.indexOf('\r');
         }
-        if (t.length() != 0)
-            outputWindow_->appendText(t);
+        if (t.length() != 0) {
+            emit processOutput(t);
+            evalOutputLine_ += t;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+//          P4InputVF::checkProcessLine
+// -----------------------------------------------------------------------
+// Maple reports when the tables of the finite region are complete, so that
+// they can be plotted while infinity is still being studied.  This is only
+// worth it when there is a study at infinity to wait for, and only the whole
+// sphere (typeofstudy_all) is split this way; the other studies, and the
+// study of infinity itself, are plotted when Maple has finished.
+//
+// Before that, Maple reports every finite singularity once its record is
+// written, in all studies but the one of infinity, so that the singularities
+// are shown one by one as they are found.
+//
+// The reports are printed by the Maple library p4.m, which has to be built
+// again from src-mpl with Maple (make -f MakeTexMaple).  A p4.m built before
+// never prints them, and the study is then plotted at the end as before.
+void P4InputVF::checkProcessLine(const QByteArray &line)
+{
+    QByteArray whole{evalOutputLine_ + line};
+
+    evalOutputLine_.clear();
+    whole = whole.trimmed();
+    if (whole != MAPLE_FINITEDONE && whole != MAPLE_SINGULARITYDONE)
+        return;
+
+    if (!evaluating_ || evaluatingGcf_ || evaluatingArbitraryCurve_ ||
+        evaluatingIsoclines_ || evaluatingPiecewiseConfig_)
+        return;
+
+    if (whole == MAPLE_SINGULARITYDONE) {
+        if (typeofstudy_ != P4TypeOfStudy::typeofstudy_inf) {
+            P4Trace::instant("singularity done", "maple");
+            emit singularityEvaluated();
+        }
+        return;
+    }
+
+    if (typeofstudy_ != P4TypeOfStudy::typeofstudy_all)
+        return;
+
+    if (++numFiniteDone_ == numVF_) {
+        P4Trace::instant("finite region done", "maple");
+        emit finiteEvaluated();
     }
 }
 
@@ -2200,7 +2225,7 @@ void P4InputVF::onTerminateButton()
             QString buf{"\n------------------------------------------------"
                         "------------"
                         "-------------------\n"};
-            outputWindow_->appendText(buf);
+            emit processOutput(buf);
             evalProcess_->terminate();
 #if QT_VERSION < QT_VERSION_CHECK(5, 5, 0)
             QTimer::singleShot(2000, evalProcess_, SLOT(kill));
@@ -2208,32 +2233,13 @@ void P4InputVF::onTerminateButton()
             QTimer::singleShot(2000, evalProcess_, &QProcess::kill);
 #endif
             buf = "Kill signal sent to process.\n";
-            outputWindow_->appendText(buf);
+            emit processOutput(buf);
             processFailed_ = true;
             processError_ = "Terminated by user";
         }
     }
 }
 
-// -----------------------------------------------------------------------
-//          P4InputVF::createProcessWindow
-// -----------------------------------------------------------------------
-void P4InputVF::createProcessWindow()
-{
-    if (outputWindow_ != nullptr) {
-        if (outputWindow_->isVisible() == false)
-            outputWindow_->show();
-        outputWindow_->activateWindow();
-        outputWindow_->raise();
-        return;
-    }
-
-    outputWindow_ = new P4ProcessWnd{};
-
-    QObject::connect(outputWindow_, &P4ProcessWnd::terminateSignal, this,
-                     &P4InputVF::onTerminateButton);
-}
-
 // -----------------------------------------------------------------------
 //          P4InputVF::evaluateGcf
 // -----------------------------------------------------------------------
@@ -2244,16 +2250,7 @@ bool P4InputVF::evaluateGcf()
     // QString s = getMapleExe().append("
     // \"").append(filedotmpl).append("\"");
 
-    if (outputWindow_ == nullptr)
-        createProcessWindow();
-    else {
-        outputWindow_->appendText(
-            "\n\n------------------------------------------"
-            "-------------------------------------\n\n");
-        outputWindow_->enableTerminateProcessButton(true);
-        outputWindow_->show();
-        outputWindow_->raise();
-    }
+    emit processStarted();
 
     QProcess *proc;
     if (evalProcess_ != nullptr) { // re-use process of last GCF
@@ -2262,21 +2259,21 @@ bool P4InputVF::evaluateGcf()
         evalProcessFinishedConnection_ =
             new QMetaObject::Connection{QObject::connect(
                 proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                gP4app, &P4Application::signalCurveEvaluated)};
+                this, &P4InputVF::curveEvaluated)};
     } else {
         proc = new QProcess{this};
         QObject::connect(
             proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-            gP4app, &P4Application::signalCurveEvaluated);
+            this, &P4InputVF::curveEvaluated);
 #ifdef QT_QPROCESS_OLD
         QObject::connect(
             proc,
             static_cast<void (QProcess::*)(QProcess::ProcessError)>(
                 &QProcess::error),
-            gP4app, &P4Application::catchProcessError);
+            this, &P4InputVF::catchProcessError);
 #else
-        QObject::connect(proc, &QProcess::errorOccurred, gP4app,
-                         &P4Application::catchProcessError);
+        QObject::connect(proc, &QProcess::errorOccurred, this,
+                         &P4InputVF::catchProcessError);
 #endif
         QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                          &P4InputVF::readProcessStdout);
@@ -2289,7 +2286,9 @@ bool P4InputVF::evaluateGcf()
     pa += getMapleExe();
     pa += " ";
     pa += filedotmpl;
-    outputWindow_->appendText(pa);
+    emit processOutput(pa);
+    evalTraceName_ = "Maple gcf";
+    evalTraceStart_ = P4Trace::now();
     proc->start(getMapleExe(), QStringList(filedotmpl), QIODevice::ReadWrite);
     if (proc->state() != QProcess::Running &&
         proc->state() != QProcess::Starting) {
@@ -2300,8 +2299,8 @@ bool P4InputVF::evaluateGcf()
         evalProcess_ = nullptr;
         evalFile_ = "";
         evalFile2_ = "";
-        gP4app->signalCurveEvaluated(-1);
-        outputWindow_->enableTerminateProcessButton(false);
+        emit curveEvaluated(-1);
+        emit processStopped();
         return false;
     } else {
         evalProcess_ = proc;
@@ -2504,16 +2503,7 @@ bool P4InputVF::evaluateArbitraryCurve()
         s = s.append(" \"").append(filedotmpl).append("\"");
     }
 
-    if (outputWindow_ == nullptr)
-        createProcessWindow();
-    else {
-        outputWindow_->appendText(
-            "\n\n------------------------------------------"
-            "-------------------------------------\n\n");
-        outputWindow_->enableTerminateProcessButton(true);
-        outputWindow_->show();
-        outputWindow_->raise();
-    }
+    emit processStarted();
 
     QProcess *proc;
     // re-use process of last GCF
@@ -2523,22 +2513,22 @@ bool P4InputVF::evaluateArbitraryCurve()
         evalProcessFinishedConnection_ =
             new QMetaObject::Connection{QObject::connect(
                 proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                gP4app, &P4Application::signalCurveEvaluated)};
+                this, &P4InputVF::curveEvaluated)};
     } else {
         proc = new QProcess{this};
         evalProcessFinishedConnection_ =
             new QMetaObject::Connection{QObject::connect(
                 proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                gP4app, &P4Application::signalCurveEvaluated)};
+                this, &P4InputVF::curveEvaluated)};
 #ifdef QT_QPROCESS_OLD
         QObject::connect(
             proc,
             static_cast<void (QProcess::*)(QProcess::ProcessError)>(
                 &QProcess::error),
-            gP4app, &P4Application::catchProcessError);
+            this, &P4InputVF::catchProcessError);
 #else
-        QObject::connect(proc, &QProcess::errorOccurred, gP4app,
-                         &P4Application::catchProcessError);
+        QObject::connect(proc, &QProcess::errorOccurred, this,
+                         &P4InputVF::catchProcessError);
 #endif
         QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                          &P4InputVF::readProcessStdout);
@@ -2551,7 +2541,9 @@ bool P4InputVF::evaluateArbitraryCurve()
     pa += getMapleExe();
     pa += " ";
     pa += filedotmpl;
-    outputWindow_->appendText(pa);
+    emit processOutput(pa);
+    evalTraceName_ = "Maple arbitrary curve";
+    evalTraceStart_ = P4Trace::now();
     proc->start(getMapleExe(), QStringList(filedotmpl), QIODevice::ReadWrite);
     if (proc->state() != QProcess::Running &&
         proc->state() != QProcess::Starting) {
@@ -2562,8 +2554,8 @@ bool P4InputVF::evaluateArbitraryCurve()
         evalProcess_ = nullptr;
         evalFile_ = "";
         evalFile2_ = "";
-        gP4app->signalCurveEvaluated(-1);
-        outputWindow_->enableTerminateProcessButton(false);
+        emit curveEvaluated(-1);
+        emit processStopped();
         return false;
     } else {
         evalProcess_ = proc;
@@ -2772,16 +2764,7 @@ bool P4InputVF::evaluateIsoclines()
     } else
         s = s.append(filedotmpl);
 
-    if (outputWindow_ == nullptr)
-        createProcessWindow();
-    else {
-        outputWindow_->appendText(
-            "\n\n------------------------------------------"
-            "-------------------------------------\n\n");
-        outputWindow_->enableTerminateProcessButton(true);
-        outputWindow_->show();
-        outputWindow_->raise();
-    }
+    emit processStarted();
 
     QProcess *proc;
     if (evalProcess_ != nullptr) { // re-use process of last GCF
@@ -2790,22 +2773,22 @@ bool P4InputVF::evaluateIsoclines()
         evalProcessFinishedConnection_ =
             new QMetaObject::Connection{QObject::connect(
                 proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                gP4app, &P4Application::signalCurveEvaluated)};
+                this, &P4InputVF::curveEvaluated)};
     } else {
         proc = new QProcess{this};
         evalProcessFinishedConnection_ =
             new QMetaObject::Connection{QObject::connect(
                 proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-                gP4app, &P4Application::signalCurveEvaluated)};
+                this, &P4InputVF::curveEvaluated)};
 #ifdef QT_QPROCESS_OLD
         QObject::connect(
             proc,
             static_cast<void (QProcess::*)(QProcess::ProcessError)>(
                 &QProcess::error),
-            gP4app, &P4Application::catchProcessError);
+            this, &P4InputVF::catchProcessError);
 #else
-        QObject::connect(proc, &QProcess::errorOccurred, gP4app,
-                         &P4Application::catchProcessError);
+        QObject::connect(proc, &QProcess::errorOccurred, this,
+                         &P4InputVF::catchProcessError);
 #endif
         QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                          &P4InputVF::readProcessStdout);
@@ -2818,7 +2801,9 @@ bool P4InputVF::evaluateIsoclines()
     pa += getMapleExe();
     pa += " ";
     pa += filedotmpl;
-    outputWindow_->appendText(pa);
+    emit processOutput(pa);
+    evalTraceName_ = "Maple isoclines";
+    evalTraceStart_ = P4Trace::now();
     proc->start(getMapleExe(), QStringList(filedotmpl), QIODevice::ReadWrite);
     if (proc->state() != QProcess::Running &&
         proc->state() != QProcess::Starting) {
@@ -2829,8 +2814,8 @@ bool P4InputVF::evaluateIsoclines()
         evalProcess_ = nullptr;
         evalFile_ = "";
         evalFile2_ = "";
-        gP4app->signalCurveEvaluated(-1);
-        outputWindow_->enableTerminateProcessButton(false);
+        emit curveEvaluated(-1);
+        emit processStopped();
         return false;
     } else {
         evalProcess_ = proc;
@@ -3380,16 +3365,7 @@ bool P4InputVF::evaluateSeparatingCurves()
     else
         s = s.append(" \"").append(filedotmpl).append("\"");
 
-    if (outputWindow_ == nullptr)
-        createProcessWindow();
-    else {
-        outputWindow_->appendText(
-            "\n\n------------------------------------------"
-            "-------------------------------------\n\n");
-        outputWindow_->enableTerminateProcessButton(true);
-        outputWindow_->show();
-        outputWindow_->raise();
-    }
+    emit processStarted();
 
     auto proc = new QProcess{this};
 
@@ -3398,22 +3374,24 @@ bool P4InputVF::evaluateSeparatingCurves()
     evalProcessFinishedConnection_ =
         new QMetaObject::Connection{QObject::connect(
             proc, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
-            gP4app, &P4Application::signalSeparatingCurvesEvaluated)};
+            this, &P4InputVF::separatingCurvesEvaluated)};
 #ifdef QT_QPROCESS_OLD
     QObject::connect(proc,
                      static_cast<void (QProcess::*)(QProcess::ProcessError)>(
                          &QProcess::error),
-                     gP4app, &P4Application::catchProcessError);
+                     this, &P4InputVF::catchProcessError);
 #else
-    QObject::connect(proc, &QProcess::errorOccurred, gP4app,
-                     &P4Application::catchProcessError);
+    QObject::connect(proc, &QProcess::errorOccurred, this,
+                     &P4InputVF::catchProcessError);
 #endif
     QObject::connect(proc, &QProcess::readyReadStandardOutput, this,
                      &P4InputVF::readProcessStdout);
 
     processFailed_ = false;
     QString pa{"External Command: " + getMapleExe() + " " + filedotmpl};
-    outputWindow_->appendText(pa);
+    emit processOutput(pa);
+    evalTraceName_ = "Maple separating curves";
+    evalTraceStart_ = P4Trace::now();
     proc->start(getMapleExe(), QStringList(filedotmpl), QIODevice::ReadWrite);
 
     if (proc->state() != QProcess::Running &&
@@ -3425,8 +3403,8 @@ bool P4InputVF::evaluateSeparatingCurves()
         evalProcess_ = nullptr;
         evalFile_ = "";
         evalFile2_ = "";
-        gP4app->signalEvaluated(-1);
-        outputWindow_->enableTerminateProcessButton(false);
+        emit evaluated(-1);
+        emit processStopped();
         return false;
     } else {
         evalProcess_ = proc;
@@ -3445,10 +3423,7 @@ bool P4InputVF::evaluateSeparatingCurves()
 void P4InputVF::finishSeparatingCurvesEvaluation()
 {
     evaluatingPiecewiseConfig_ = false;
-    auto e = new P4Event{
-        static_cast<QEvent::Type>(TYPE_SIGNAL_SEPARATINGCURVESEVALUATED),
-        nullptr};
-    gP4app->postEvent(gP4startDlg, e);
+    emit separatingCurvesEvaluationFinished();
 }
 
 // -----------------------------------------------------------------------
@@ -3711,6 +3686,7 @@ void P4InputVF::resampleIsoclines(int i)
 // and is assumed to be in a ball with small radius.
 int P4InputVF::getVFIndex_R2(const double *ucoord)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     for (auto i : vfRegions_) {
         if (isInsideRegion_R2(i.signs, ucoord))
             return i.vfIndex;
@@ -3818,6 +3794,7 @@ int P4InputVF::getVFIndex_plsphere(const double *pcoord)
 // coordinate.
 int P4InputVF::getVFIndex_cyl(const double *y)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     for (auto i : vfRegions_) {
         if (isInsideRegion_cyl(i.signs, y))
             return i.vfIndex;
@@ -3838,6 +3815,7 @@ int P4InputVF::getVFIndex_cyl(const double *y)
 // If z2<0, we are inside the chart VV1.
 int P4InputVF::getVFIndex_U1(const double *y)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     for (auto i : vfRegions_) {
         if (isInsideRegion_U1(i.signs, y))
             return i.vfIndex;
@@ -3858,6 +3836,7 @@ int P4InputVF::getVFIndex_U1(const double *y)
 // If z2<0, we are inside the chart UU1.
 int P4InputVF::getVFIndex_V1(const double *y)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     for (auto i : vfRegions_) {
         if (isInsideRegion_V1(i.signs, y))
             return i.vfIndex;
@@ -3878,6 +3857,7 @@ int P4InputVF::getVFIndex_V1(const double *y)
 // If z2<0, we are inside the chart VV2.
 int P4InputVF::getVFIndex_U2(const double *y)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     for (auto i : vfRegions_) {
         if (isInsideRegion_U2(i.signs, y))
             return i.vfIndex;
@@ -3899,6 +3879,7 @@ int P4InputVF::getVFIndex_U2(const double *y)
 // If z2<0, we are inside the chart UU2.
 int P4InputVF::getVFIndex_V2(const double *y)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     for (auto i : vfRegions_) {
         if (isInsideRegion_V2(i.signs, y))
             return i.vfIndex;
@@ -3934,6 +3915,7 @@ int P4InputVF::getVFIndex_V2(const double *y)
 // Note: these charts are only used when p=q=1.
 int P4InputVF::getVFIndex_UU1(const double *yy)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     double y[2];
     y[0] = -yy[0];
     y[1] = -yy[1];
@@ -3942,6 +3924,7 @@ int P4InputVF::getVFIndex_UU1(const double *yy)
 
 int P4InputVF::getVFIndex_UU2(const double *yy)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     double y[2];
     y[0] = -yy[0];
     y[1] = -yy[1];
@@ -3950,6 +3933,7 @@ int P4InputVF::getVFIndex_UU2(const double *yy)
 
 int P4InputVF::getVFIndex_VV1(const double *yy)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     double y[2];
     y[0] = -yy[0];
     y[1] = -yy[1];
@@ -3958,17 +3942,10 @@ int P4InputVF::getVFIndex_VV1(const double *yy)
 
 int P4InputVF::getVFIndex_VV2(const double *yy)
 {
+    P4IntStats::count(P4IntCounter::vfindex);
     double y[2];
     y[0] = -yy[0];
     y[1] = -yy[1];
     return getVFIndex_V2(y);
 }
 
-// ---------------------------------------------------------------------
-//          getDataFromDlg
-// ---------------------------------------------------------------------
-void P4InputVF::getDataFromDlg()
-{
-    if (findDlg_ != nullptr)
-        findDlg_->getDataFromDlg();
-}
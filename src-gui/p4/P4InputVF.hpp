@@ -23,12 +23,31 @@
 
 #include <vector>
 
+#include <QByteArray>
 #include <QMetaObject>
 #include <QProcess>
 #include <QString>
 
 #include "custom.hpp"
 
+// line printed by Maple for every piece of the vector field once the tables of
+// the finite region are written, see infinity.tex
+#define MAPLE_FINITEDONE "P4: finite region done"
+
+// line printed by Maple once the record of a finite singularity is complete in
+// its table, see singularity_done in tools.tex
+#define MAPLE_SINGULARITYDONE "P4: singularity done"
+
+// line printed, followed by 0 or 1, at the end of a script for a Maple session
+// that stays open, instead of quitting with that value; see P4MaplePool
+#define MAPLE_SESSIONDONE "P4: script done"
+
+#ifdef Q_OS_WIN
+#define USERPLATFORM "WINDOWS"
+#else
+#define USERPLATFORM "LINUX"
+#endif
+
 /* Check Qt version for compatibility with QProcess::errorOccurred */
 #if QT_VERSION_MINOR < 6
 #define QT_QPROCESS_OLD
@@ -36,16 +55,7 @@
 
 // forward class and struct declarations
 class QProcess;
-class QPushButton;
-class QTextEdit;
 class QTextStream;
-class QWidget;
-
-class P4ArbitraryCurveDlg;
-class P4FindDlg;
-class P4GcfDlg;
-class P4IsoclinesDlg;
-class P4ProcessWnd;
 
 namespace P4Polynom
 {
@@ -117,14 +127,21 @@ class P4InputVF : public QObject
     QString isoclines_;
     int isoclinesVF_{0};
 
+    // the scripts of prepare() end with MAPLE_SESSIONDONE instead of quit
+    bool sessionScripts_{false};
+
     // EVALUATION VARIABLES
     QString evalFile_;
     QString evalFile2_;
     QProcess *evalProcess_{nullptr};
     QMetaObject::Connection *evalProcessFinishedConnection_{nullptr};
-
-    // QT GUI ELEMENTS FIXME need to be public?
-    P4ProcessWnd *outputWindow_{nullptr};
+    // pieces for which Maple has finished the finite region, and the last
+    // line of its output as far as it has been read
+    unsigned int numFiniteDone_{0};
+    QByteArray evalOutputLine_;
+    // start of the Maple process in the timeline, see P4Trace
+    const char *evalTraceName_{nullptr};
+    long long evalTraceStart_{-1};
 
     // PARAMETER LIST
     unsigned int numParams_{0};
@@ -271,11 +288,12 @@ class P4InputVF : public QObject
     // separating curve filename (filename_sepcurves.tab)
     QString getfilename_separatingcurveresults() const;
 
+    // the plot with everything computed so far (filename.p4s), see P4Session
+    QString getfilename_session() const;
+
     // check if a file exists
     static bool fileExists(QString);
 
-    void getDataFromDlg();
-
     // ACTIONS
     bool load();
     bool save();
@@ -303,7 +321,6 @@ class P4InputVF : public QObject
     void prepareFile(QTextStream &, bool); // used by Prepare()
     void prepare();
     void evaluate();
-    void createProcessWindow();
 
     // EVALUATION: gcf
     bool prepareGcf(P4Polynom::term2 *f, double y1, double y2, int precision,
@@ -347,29 +364,29 @@ class P4InputVF : public QObject
     bool prepareIsoclines_LyapunovR2(int precision, int numpoints, int index);
     bool evaluateIsoclines();
 
-    // get and set (observed pointers, so no memory freeing here)
-    P4FindDlg *getFindDlgPtr() const { return findDlg_; }
-    void setFindDlg(P4FindDlg *newdlg) { findDlg_ = newdlg; }
-
-    P4GcfDlg *getGcfDlgPtr() const { return gcfDlg_; }
-    void setGcfDlg(P4GcfDlg *newdlg) { gcfDlg_ = newdlg; }
-
-    P4ArbitraryCurveDlg *getArbitraryCurveDlgPtr() const
-    {
-        return arbitraryCurveDlg_;
-    }
-    void setArbitraryCurveDlg(P4ArbitraryCurveDlg *newdlg)
-    {
-        arbitraryCurveDlg_ = newdlg;
-    }
-
-    P4IsoclinesDlg *getIsoclinesDlgPtr() const { return isoclinesDlg_; }
-    void setIsoclinesDlg(P4IsoclinesDlg *newdlg) { isoclinesDlg_ = newdlg; }
-
   signals:
     void saveSignal();
     void loadSignal();
 
+    // The Maple process and its output, for the window that shows it: a
+    // process is started, prints text, or stops (or failed to start).
+    void processStarted();
+    void processOutput(const QString &text);
+    void processStopped();
+
+    // the process of an evaluation finished (see P4Application), a finite
+    // singularity or the finite region of the study is done, and the curves
+    // have been read
+    void evaluated(int exitCode);
+    void singularityEvaluated();
+    void finiteEvaluated();
+    void curveEvaluated(int exitCode);
+    void separatingCurvesEvaluated(int exitCode);
+    void gcfEvaluationFinished();
+    void arbitraryCurveEvaluationFinished();
+    void isoclinesEvaluationFinished();
+    void separatingCurvesEvaluationFinished();
+
   public slots:
     void finishEvaluation(int);
     void catchProcessError(QProcess::ProcessError);
@@ -381,11 +398,7 @@ class P4InputVF : public QObject
     void finishSeparatingCurvesEvaluation();
 
   private:
-    // P4 GUI ELEMENTS
-    P4FindDlg *findDlg_{nullptr};
-    P4GcfDlg *gcfDlg_{nullptr};
-    P4ArbitraryCurveDlg *arbitraryCurveDlg_{nullptr};
-    P4IsoclinesDlg *isoclinesDlg_{nullptr};
+    void checkProcessLine(const QByteArray &line);
 };
 
 extern P4InputVF *gThisVF;
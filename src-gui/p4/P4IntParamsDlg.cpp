@@ -28,8 +28,10 @@
 #include <QSpinBox>
 
 #include "P4Application.hpp"
+#include "P4IntStats.hpp"
 #include "P4ParentStudy.hpp"
 #include "main.hpp"
+#include "math_refine.hpp"
 
 P4IntParamsDlg::~P4IntParamsDlg() { getDataFromDlg(); }
 
@@ -86,6 +88,14 @@ P4IntParamsDlg::P4IntParamsDlg(QWidget *parent)
 
     btn_reset_ = new QPushButton{"&Reset", this};
 
+#ifdef INTSTATS
+    auto lbl_statstitle = new QLabel{"Statistics:", this};
+    lbl_statstitle->setFont(gP4app->getBoldFont());
+    lbl_stats_ = new QLabel{this};
+    lbl_stats_->setFont(gP4app->getCourierFont());
+    btn_resetstats_ = new QPushButton{"Reset &Statistics", this};
+#endif
+
 #ifdef TOOLTIPS
     btn_org_->setToolTip("Integrate orbits w.r.t. original vector field");
     btn_red_->setToolTip("Integrate orbits w.r.t. reduced vector field,\n"
@@ -104,6 +114,13 @@ P4IntParamsDlg::P4IntParamsDlg(QWidget *parent)
     spin_numpoints_->setToolTip("Number of points to integrate each time");
     btn_reset_->setToolTip(
         "Reset the integration parameters to default values");
+#ifdef INTSTATS
+    lbl_stats_->setToolTip(
+        "Steps of the last orbit or separatrix, and of the whole session.\n"
+        "Many rejected steps or steps at the minimum step size suggest\n"
+        "changing the tolerance or the minimum step size");
+    btn_resetstats_->setToolTip("Start counting the session anew");
+#endif
 #endif
 
     // layout
@@ -170,6 +187,15 @@ P4IntParamsDlg::P4IntParamsDlg(QWidget *parent)
     mainLayout_->addLayout(layout6);
     mainLayout_->addLayout(layout7);
     mainLayout_->addLayout(layout8);
+#ifdef INTSTATS
+    mainLayout_->addWidget(lbl_statstitle);
+    mainLayout_->addWidget(lbl_stats_);
+    auto layout9 = new QHBoxLayout{};
+    layout9->addStretch(1);
+    layout9->addWidget(btn_resetstats_);
+    layout9->addStretch(1);
+    mainLayout_->addLayout(layout9);
+#endif
     mainLayout_->addStretch(0);
 
     setLayout(mainLayout_);
@@ -201,6 +227,12 @@ P4IntParamsDlg::P4IntParamsDlg(QWidget *parent)
 
     QObject::connect(btn_reset_, &QPushButton::clicked, this,
                      &P4IntParamsDlg::on_btn_reset);
+#ifdef INTSTATS
+    QObject::connect(btn_resetstats_, &QPushButton::clicked, this, [this]() {
+        P4IntStats::reset();
+        updateStatistics();
+    });
+#endif
 
     // finishing
     updateDlgData();
@@ -248,6 +280,9 @@ void P4IntParamsDlg::getDataFromDlg()
     if (!changed_)
         return;
 
+    // the render of a zoom window may be refining curves with these
+    stopRefinedCurves();
+
     gVFResults.config_kindvf_ =
         (btn_org_->isChecked()) ? INTCONFIG_ORIGINAL : INTCONFIG_REDUCED;
     gVFResults.config_dashes_ = (btn_dashes_->isChecked()) ? true : false;
@@ -319,6 +354,8 @@ void P4IntParamsDlg::updateDlgData()
 
     btn_org_->setEnabled(true);
     btn_red_->setEnabled(true);
+
+    updateStatistics();
 }
 
 void P4IntParamsDlg::setCurrentStep(double curstep)
@@ -326,6 +363,29 @@ void P4IntParamsDlg::setCurrentStep(double curstep)
     QString buf;
     buf.sprintf("%g", curstep);
     lbl_curstep_->setText(buf);
+
+    updateStatistics();
+}
+
+void P4IntParamsDlg::updateStatistics()
+{
+    QString text, buf;
+    int k;
+
+    if (lbl_stats_ == nullptr)
+        return;
+
+    P4IntCounts c{P4IntStats::curve()}, s{P4IntStats::session()};
+    text.sprintf("%-18s %10s %10s", "", "last", "session");
+    for (k = 0; k < P4IntCounter::numCounters; k++) {
+        buf.sprintf("\n%-18.18s %10lu %10lu", P4IntStats::counterName(k),
+                    c.n[k], s.n[k]);
+        text += buf;
+    }
+    buf.sprintf("\n%-18s %10.3g %10.3g", "time at hmi", c.hmitime,
+                s.hmitime);
+    text += buf;
+    lbl_stats_->setText(text);
 }
 
 void P4IntParamsDlg::on_btn_reset()
@@ -39,6 +39,7 @@ class P4IntParamsDlg : public QWidget
     void getDataFromDlg();
     void updateDlgData();
     void setCurrentStep(double curstep);
+    void updateStatistics();
 
   private:
     bool changed_;
@@ -66,6 +67,10 @@ class P4IntParamsDlg : public QWidget
 
     QSpinBox *spin_numpoints_;
 
+    // counts of P4IntStats, only with INTSTATS
+    QLabel *lbl_stats_{nullptr};
+    QPushButton *btn_resetstats_{nullptr};
+
     bool readFloatField(QLineEdit *, double &, double, double, double);
 
   public slots:
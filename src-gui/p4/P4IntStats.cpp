@@ -0,0 +1,99 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4IntStats.hpp"
+
+std::mutex P4IntStats::sM_blocksMutex;
+std::vector<P4IntStats::block *> P4IntStats::sM_blocks;
+P4IntCounts P4IntStats::sM_curveStart{};
+
+P4IntStats::block &P4IntStats::threadBlock()
+{
+    thread_local block *b{nullptr};
+
+    if (b == nullptr) {
+        b = new block{};
+        std::lock_guard<std::mutex> lock{sM_blocksMutex};
+        sM_blocks.push_back(b);
+    }
+    return *b;
+}
+
+P4IntCounts P4IntStats::session()
+{
+    P4IntCounts result{};
+    int k;
+
+    std::lock_guard<std::mutex> lock{sM_blocksMutex};
+    for (auto b : sM_blocks) {
+        for (k = 0; k < P4IntCounter::numCounters; k++)
+            result.n[k] += b->n[k].load(std::memory_order_relaxed);
+        result.hmitime += b->hmitime.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+P4IntCounts P4IntStats::curve()
+{
+    P4IntCounts result{session()};
+    int k;
+
+    for (k = 0; k < P4IntCounter::numCounters; k++)
+        result.n[k] -= sM_curveStart.n[k];
+    result.hmitime -= sM_curveStart.hmitime;
+    return result;
+}
+
+void P4IntStats::startCurve() { sM_curveStart = session(); }
+
+void P4IntStats::reset()
+{
+    int k;
+
+    std::lock_guard<std::mutex> lock{sM_blocksMutex};
+    for (auto b : sM_blocks) {
+        for (k = 0; k < P4IntCounter::numCounters; k++)
+            b->n[k].store(0, std::memory_order_relaxed);
+        b->hmitime.store(0, std::memory_order_relaxed);
+    }
+    sM_curveStart = P4IntCounts{};
+}
+
+const char *P4IntStats::counterName(int counter)
+{
+    static const char *names[P4IntCounter::numCounters]{
+        "accepted steps",  "rejected steps", "RHS evaluations",
+        "steps at hmi",    "region halvings", "chart switches",
+        "getVFIndex calls"};
+    return names[counter];
+}
+
+void P4IntStats::dump(FILE *fp)
+{
+    P4IntCounts c{curve()}, s{session()};
+    int k;
+
+#ifndef INTSTATS
+    fprintf(fp, "(integration statistics are disabled, see INTSTATS)\n");
+#endif
+    fprintf(fp, "%-26s %14s %14s\n", "", "last curve", "session");
+    for (k = 0; k < P4IntCounter::numCounters; k++)
+        fprintf(fp, "%-26s %14lu %14lu\n", counterName(k), c.n[k], s.n[k]);
+    fprintf(fp, "%-26s %14g %14g\n", "time at hmi", c.hmitime, s.hmitime);
+}
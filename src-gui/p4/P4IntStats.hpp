@@ -0,0 +1,111 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "custom.hpp"
+
+namespace P4IntCounter
+{
+enum {
+    accepted = 0,   // steps of rk78
+    rejected,       // steps of rk78 redone with a smaller step size
+    rhs,            // evaluations of the vector field
+    at_hmi,         // steps accepted at hmi although the error is too large
+    halvings,       // steps redone because they left the region of the VF
+    chart_switches, // the integration went on in another chart
+    vfindex,        // calls of P4InputVF::getVFIndex_*
+    numCounters
+};
+}
+
+struct P4IntCounts {
+    unsigned long n[P4IntCounter::numCounters];
+    double hmitime; // integration time covered by the steps at hmi
+};
+
+// Counters of the integration of orbits and separatrices, to tune hmi, hma
+// and the tolerance.  Every thread counts in its own block, so that the
+// streamlines can be integrated in parallel without contention; the blocks
+// are added up when the counts are shown.  Without INTSTATS (see custom.hpp)
+// the counting functions are empty and all counts stay zero.
+
+class P4IntStats
+{
+  public:
+    // charts as in P4Charts, and the cylinder of the Poincare-Lyapunov sphere
+    enum { chart_cylinder = P4Charts::chart_V2 + 1 };
+
+#ifdef INTSTATS
+    static void count(int counter, unsigned long k = 1)
+    {
+        auto &n = threadBlock().n[counter];
+        n.store(n.load(std::memory_order_relaxed) + k,
+                std::memory_order_relaxed);
+    }
+    static void countHmiTime(double t)
+    {
+        auto &h = threadBlock().hmitime;
+        h.store(h.load(std::memory_order_relaxed) + t,
+                std::memory_order_relaxed);
+    }
+    // counts a chart switch when the previous step on this thread was done
+    // in another chart
+    static void useChart(int chart)
+    {
+        block &b = threadBlock();
+        if (b.lastChart != chart && b.lastChart != -1)
+            count(P4IntCounter::chart_switches);
+        b.lastChart = chart;
+    }
+#else
+    static void count(int, unsigned long = 1) {}
+    static void countHmiTime(double) {}
+    static void useChart(int) {}
+#endif
+
+    // counts since the program started, or since reset
+    static P4IntCounts session();
+    // counts since the last orbit or separatrix was started
+    static P4IntCounts curve();
+    static void startCurve();
+    static void reset();
+
+    static const char *counterName(int counter);
+    static void dump(FILE *fp);
+
+  private:
+    struct block {
+        std::atomic<unsigned long> n[P4IntCounter::numCounters];
+        std::atomic<double> hmitime;
+        int lastChart{-1};
+    };
+    static block &threadBlock();
+
+    // blocks of all threads that have counted; they are never deleted, the
+    // counts of a thread that has ended still belong to the session
+    static std::mutex sM_blocksMutex;
+    static std::vector<block *> sM_blocks;
+    static P4IntCounts sM_curveStart;
+};
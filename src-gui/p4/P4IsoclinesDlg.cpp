@@ -31,9 +31,12 @@
 #include <QPushButton>
 #include <QRadioButton>
 
+#include "P4FindDlg.hpp"
+#include "P4InputVF.hpp"
 #include "P4ParentStudy.hpp"
 #include "P4PlotWnd.hpp"
 #include "P4Sphere.hpp"
+#include "P4StartDlg.hpp"
 #include "main.hpp"
 #include "math_isoclines.hpp"
 
@@ -144,6 +147,8 @@ P4IsoclinesDlg::P4IsoclinesDlg(P4PlotWnd *plt, P4Sphere *sp)
                      &P4IsoclinesDlg::onBtnDelAll);
     QObject::connect(btnDelLast_, &QPushButton::clicked, this,
                      &P4IsoclinesDlg::onBtnDelLast);
+    QObject::connect(gThisVF, &P4InputVF::isoclinesEvaluationFinished, this,
+                     &P4IsoclinesDlg::finishIsoclinesEvaluation);
 
     // finishing
 
@@ -189,7 +194,8 @@ void P4IsoclinesDlg::onBtnEvaluate()
         return;
     } else {
         QString val = edt_value_->text();
-        gThisVF->getDataFromDlg();
+        if (gP4startDlg->getFindWindowPtr() != nullptr)
+            gP4startDlg->getFindWindowPtr()->getDataFromDlg();
         val = gThisVF->convertMapleUserParametersLabelsToValues(val);
         val.toDouble(&ok);
         if (!ok) {
@@ -227,7 +233,6 @@ void P4IsoclinesDlg::onBtnEvaluate()
 
     // FIRST: create filename_vecisoclines.tab for transforming the isoclines
     // QString to a list of P4POLYNOM2
-    gThisVF->setIsoclinesDlg(this);
     gThisVF->evaluateIsoclinesTable();
     btnPlot_->setEnabled(true);
     plotwnd_->getDlgData();
@@ -292,7 +297,6 @@ void P4IsoclinesDlg::onBtnPlot()
 
     btnPlot_->setEnabled(false);
 
-    gThisVF->setIsoclinesDlg(this);
 
     result = evalIsoclinesStart(mainSphere_, dashes, precis, points);
     if (!result) {
@@ -320,16 +320,14 @@ void P4LimitCyclesDlg::onbtn_delall()
     gVFResults.firstLimCycle_ = nullptr;
     gVFResults.currentLimCycle_ = nullptr;
 
-    mainSphere_->refresh();
+    mainSphere_->refreshLayer(P4SphereLayers::layer_limit_cycles);
 }
 
 void P4LimitCyclesDlg::onbtn_dellast()
 {
     plotwnd_->getDlgData();
 
-    mainSphere_->prepareDrawing();
     deleteLastLimitCycle(mainSphere_);
-    mainSphere_->finishDrawing();
 
     if (gVFResults.firstLimCycle_ == nullptr) {
         btn_delall_->setEnabled(false);
@@ -337,8 +335,12 @@ void P4LimitCyclesDlg::onbtn_dellast()
     }
 }
 
+// without the progress dialog (p4-render), the search cannot be interrupted
 bool stop_search_limit()
 {
+    if (sLCProgressDlg == nullptr)
+        return false;
+
     gP4app->processEvents();
     if (sLCProgressDlg->wasCanceled())
         return true;
@@ -350,6 +352,6 @@ void write_to_limit_window()
 {
     sLCProgressCount++;
 
-    if (!(sLCProgressDlg->wasCanceled()))
+    if (sLCProgressDlg != nullptr && !(sLCProgressDlg->wasCanceled()))
         sLCProgressDlg->setValue(sLCProgressCount);
 }
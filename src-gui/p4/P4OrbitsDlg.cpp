@@ -24,12 +24,15 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QtConcurrentRun>
 
 #include "P4ParentStudy.hpp"
 #include "P4PlotWnd.hpp"
 #include "P4Sphere.hpp"
+#include "custom.hpp"
 #include "main.hpp"
 #include "math_orbits.hpp"
+#include "math_streamlines.hpp"
 
 P4OrbitsDlg::P4OrbitsDlg(P4PlotWnd *plt, P4Sphere *sp)
     : QWidget(plt, Qt::Tool | Qt::WindowStaysOnTopHint), plotWnd_{plt},
@@ -51,6 +54,11 @@ P4OrbitsDlg::P4OrbitsDlg(P4PlotWnd *plt, P4Sphere *sp)
     btnDelLast_ = new QPushButton{"&Delete Last Orbit", this};
     btnDelAll_ = new QPushButton{"Delete &All Orbits", this};
 
+    edt_sep_ = new QLineEdit{QString::number(DEFAULT_AUTOFILLSEP), this};
+    auto lbl3 = new QLabel{"Se&paration =", this};
+    lbl3->setBuddy(edt_sep_);
+    btnAutoFill_ = new QPushButton{"A&uto-fill", this};
+
 #ifdef TOOLTIPS
     edt_x0_->setToolTip(
         "Start point of orbit.\n"
@@ -66,6 +74,11 @@ P4OrbitsDlg::P4OrbitsDlg(P4PlotWnd *plt, P4Sphere *sp)
         "Continue integrating the orbit in the chosen time direction");
     btnDelLast_->setToolTip("Delete last orbit drawn");
     btnDelAll_->setToolTip("Delete all orbits (separatrices remain)");
+    edt_sep_->setToolTip("Distance in pixels in between the orbits that "
+                         "fill the plot window");
+    btnAutoFill_->setToolTip(
+        "Fill the plot window with evenly spaced orbits, next to the orbits "
+        "that are already there");
 #endif
 
     // layout
@@ -90,9 +103,16 @@ P4OrbitsDlg::P4OrbitsDlg(P4PlotWnd *plt, P4Sphere *sp)
     layout2->addWidget(btnDelAll_);
     layout2->addStretch(0);
 
+    auto layout3 = new QHBoxLayout{};
+    layout3->addWidget(lbl3);
+    layout3->addWidget(edt_sep_);
+    layout3->addWidget(btnAutoFill_);
+    layout3->addStretch(0);
+
     mainLayout_->addLayout(lay00);
     mainLayout_->addLayout(layout1);
     mainLayout_->addLayout(layout2);
+    mainLayout_->addLayout(layout3);
 
     mainLayout_->setSizeConstraint(QLayout::SetFixedSize);
     setLayout(mainLayout_);
@@ -111,6 +131,12 @@ P4OrbitsDlg::P4OrbitsDlg(P4PlotWnd *plt, P4Sphere *sp)
                      &P4OrbitsDlg::onBtnDelAll);
     QObject::connect(btnDelLast_, &QPushButton::clicked, this,
                      &P4OrbitsDlg::onBtnDelLast);
+    QObject::connect(btnAutoFill_, &QPushButton::clicked, this,
+                     &P4OrbitsDlg::onBtnAutoFill);
+
+    fillWatcher_ = new QFutureWatcher<bool>{this};
+    QObject::connect(fillWatcher_, &QFutureWatcher<bool>::finished, this,
+                     &P4OrbitsDlg::onAutoFillFinished);
 
     // finishing
     btnForwards_->setEnabled(false);
@@ -125,6 +151,12 @@ P4OrbitsDlg::P4OrbitsDlg(P4PlotWnd *plt, P4Sphere *sp)
     setP4WindowTitle(this, "Plot Orbits");
 }
 
+P4OrbitsDlg::~P4OrbitsDlg()
+{
+    cancelAutoFill();
+    fillWatcher_->waitForFinished();
+}
+
 void P4OrbitsDlg::setInitialPoint(double x, double y)
 {
     QString bufx;
@@ -172,7 +204,7 @@ void P4OrbitsDlg::onBtnBackwards()
         if (!orbitSelected_)
             return;
 
-        mainSphere_->prepareDrawing();
+        mainSphere_->prepareDrawing(P4SphereLayers::layer_orbits);
         orbitStarted_ =
             startOrbit(mainSphere_, selected_x0_, selected_y0_, true);
         mainSphere_->finishDrawing();
@@ -184,7 +216,7 @@ void P4OrbitsDlg::onBtnBackwards()
     }
 
     if (orbitStarted_) {
-        mainSphere_->prepareDrawing();
+        mainSphere_->prepareDrawing(P4SphereLayers::layer_orbits);
         integrateOrbit(mainSphere_, -1);
         mainSphere_->finishDrawing();
 
@@ -198,7 +230,7 @@ void P4OrbitsDlg::onBtnContinue()
     plotWnd_->getDlgData();
 
     if (orbitStarted_) {
-        mainSphere_->prepareDrawing();
+        mainSphere_->prepareDrawing(P4SphereLayers::layer_orbits);
         integrateOrbit(mainSphere_, 0);
         mainSphere_->finishDrawing();
     }
@@ -213,7 +245,7 @@ void P4OrbitsDlg::onBtnForwards()
         if (!orbitSelected_)
             return;
 
-        mainSphere_->prepareDrawing();
+        mainSphere_->prepareDrawing(P4SphereLayers::layer_orbits);
         orbitStarted_ =
             startOrbit(mainSphere_, selected_x0_, selected_y0_, true);
         mainSphere_->finishDrawing();
@@ -225,7 +257,7 @@ void P4OrbitsDlg::onBtnForwards()
     }
 
     if (orbitStarted_) {
-        mainSphere_->prepareDrawing();
+        mainSphere_->prepareDrawing(P4SphereLayers::layer_orbits);
         integrateOrbit(mainSphere_, 1);
         mainSphere_->finishDrawing();
 
@@ -247,17 +279,16 @@ void P4OrbitsDlg::onBtnDelAll()
     delete gVFResults.firstOrbit_;
     gVFResults.firstOrbit_ = nullptr;
     gVFResults.currentOrbit_ = nullptr;
+    gVFResults.selectedOrbit_ = nullptr;
 
-    mainSphere_->refresh();
+    mainSphere_->refreshLayer(P4SphereLayers::layer_orbits);
 }
 
 void P4OrbitsDlg::onBtnDelLast()
 {
     plotWnd_->getDlgData();
 
-    mainSphere_->prepareDrawing();
     deleteLastOrbit(mainSphere_);
-    mainSphere_->finishDrawing();
 
     orbitStarted_ = false;
     orbitSelected_ = false;
@@ -271,6 +302,87 @@ void P4OrbitsDlg::onBtnDelLast()
     }
 }
 
+// delete the orbit picked with the right mouse button
+void P4OrbitsDlg::onBtnDelSelected()
+{
+    auto orbit = gVFResults.selectedOrbit_;
+    if (orbit == nullptr)
+        return;
+
+    plotWnd_->getDlgData();
+
+    if (orbitStarted_ && orbit == gVFResults.currentOrbit_) {
+        // the orbit that is being integrated cannot be continued
+        orbitStarted_ = false;
+        orbitSelected_ = false;
+        btnForwards_->setEnabled(false);
+        btnBackwards_->setEnabled(false);
+        btnContinue_->setEnabled(false);
+    }
+
+    deleteOrbit(mainSphere_, orbit);
+
+    if (gVFResults.firstOrbit_ == nullptr) {
+        btnDelAll_->setEnabled(false);
+        btnDelLast_->setEnabled(false);
+    }
+}
+
+// The orbits are placed on a worker thread, and only added to the study
+// when they are all there, so the GUI thread is never blocked.
+void P4OrbitsDlg::onBtnAutoFill()
+{
+    bool ok;
+    double sep{edt_sep_->text().toDouble(&ok)};
+
+    if (fill_ != nullptr) {
+        cancelAutoFill();
+        return;
+    }
+
+    plotWnd_->getDlgData();
+
+    if (!ok || sep < MIN_AUTOFILLSEP || sep > MAX_AUTOFILLSEP) {
+        sep = DEFAULT_AUTOFILLSEP;
+        edt_sep_->setText(QString::number(sep));
+    }
+
+    auto fill = std::make_shared<P4AutoFill>(mainSphere_, sep);
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    fill_ = fill;
+    fillCancel_ = cancel;
+    btnAutoFill_->setText("Stop a&uto-fill");
+    fillWatcher_->setFuture(QtConcurrent::run(
+        [fill, cancel]() { return fill->run(cancel.get()); }));
+}
+
+void P4OrbitsDlg::cancelAutoFill()
+{
+    if (fillCancel_ != nullptr)
+        *fillCancel_ = true;
+}
+
+void P4OrbitsDlg::onAutoFillFinished()
+{
+    std::shared_ptr<P4AutoFill> fill{std::move(fill_)};
+
+    fill_.reset();
+    btnAutoFill_->setText("A&uto-fill");
+    if (fill == nullptr || *fillCancel_ || !fillWatcher_->result())
+        return; // cancelled, or stopped with the vector fields
+
+    if (fill->addOrbits(mainSphere_) == 0)
+        return;
+
+    // the orbit that was being integrated is not the last one any more
+    orbitStarted_ = false;
+    btnForwards_->setEnabled(orbitSelected_);
+    btnBackwards_->setEnabled(orbitSelected_);
+    btnContinue_->setEnabled(false);
+    btnDelAll_->setEnabled(true);
+    btnDelLast_->setEnabled(true);
+}
+
 void P4OrbitsDlg::orbitEvent(int i)
 {
     switch (i) {
@@ -289,11 +401,17 @@ void P4OrbitsDlg::orbitEvent(int i)
     case 3:
         onBtnDelAll();
         break;
+    case 4:
+        onBtnDelSelected();
+        break;
     }
 }
 
 void P4OrbitsDlg::reset()
 {
+    // the orbits of an auto-fill were placed in the old window
+    cancelAutoFill();
+
     // finishing
     selected_x0_ = 0;
     selected_y0_ = 0;
@@ -19,14 +19,19 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QWidget>
 
+#include <atomic>
+#include <memory>
+
 class QBoxLayout;
 class QLineEdit;
 class QPushButton;
 
 class P4Sphere;
 class P4PlotWnd;
+class P4AutoFill;
 
 class P4OrbitsDlg : public QWidget
 {
@@ -34,6 +39,7 @@ class P4OrbitsDlg : public QWidget
 
   public:
     P4OrbitsDlg(P4PlotWnd *, P4Sphere *);
+    ~P4OrbitsDlg();
 
     void reset();
 
@@ -47,9 +53,11 @@ class P4OrbitsDlg : public QWidget
     QPushButton *btnDelAll_;
     QPushButton *btnDelLast_;
     QPushButton *btnSelect_;
+    QPushButton *btnAutoFill_;
 
     QLineEdit *edt_x0_;
     QLineEdit *edt_y0_;
+    QLineEdit *edt_sep_;
 
     QBoxLayout *mainLayout_;
 
@@ -59,6 +67,13 @@ class P4OrbitsDlg : public QWidget
     bool orbitStarted_{false};
     bool orbitSelected_{false};
 
+    // the auto-fill that is running on a worker thread, like the render of
+    // P4Sphere; pressing the button again cancels it
+    std::shared_ptr<P4AutoFill> fill_;
+    std::shared_ptr<std::atomic<bool>> fillCancel_;
+    QFutureWatcher<bool> *fillWatcher_;
+    void cancelAutoFill();
+
   public slots:
     void orbitEvent(int);
     void onBtnSelect();
@@ -67,6 +82,9 @@ class P4OrbitsDlg : public QWidget
     void onBtnForwards();
     void onBtnDelAll();
     void onBtnDelLast();
+    void onBtnDelSelected();
+    void onBtnAutoFill();
+    void onAutoFillFinished();
 
     void setInitialPoint(double, double);
 };
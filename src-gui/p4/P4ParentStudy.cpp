@@ -23,19 +23,25 @@
 
 #include <locale.h>
 
+#include "P4PickIndex.hpp"
+#include "P4Trace.hpp"
 #include "P4VFStudy.hpp"
 #include "math_changedir.hpp"
 #include "math_charts.hpp"
 #include "math_orbits.hpp"
 #include "math_p4.hpp"
 #include "math_polynom.hpp"
+#include "math_refine.hpp"
 #include "math_regions.hpp"
 #include "math_separatingcurves.hpp"
 #include "math_separatrice.hpp"
+#include "math_streamlines.hpp"
 
 using namespace P4TypeOfView;
 using namespace P4TypeOfStudy;
 
+thread_local int P4ParentStudy::K_{0};
+
 // -----------------------------------------------------------------------
 //                              P4ParentStudy CONSTRUCTOR
 // -----------------------------------------------------------------------
@@ -63,8 +69,13 @@ P4ParentStudy::P4ParentStudy()
 // -----------------------------------------------------------------------
 void P4ParentStudy::reset()
 {
+    // the renders of zoom windows and an auto-fill may be integrating
+    stopRefinedCurves();
+    stopAutoFill();
     vf_.clear();
     K_ = 0;
+    partial_ = false;
+    singularitiesOnly_ = false;
 
     xmin_ = -1.0;
     xmax_ = 1.0;
@@ -88,11 +99,13 @@ void P4ParentStudy::reset()
     config_dashes_ = DEFAULT_LINESTYLE;
     config_kindvf_ = DEFAULT_INTCONFIG;
     plotVirtualSingularities_ = DEFAULTPLOTVIRTUALSINGULARITIES;
+    flowField_ = P4TypeOfFlowField::flowfield_none;
 
     // delete orbits
     delete firstOrbit_;
     firstOrbit_ = nullptr;
     currentOrbit_ = nullptr;
+    selectedOrbit_ = nullptr;
 
     // delete limit cycles
     delete firstLimCycle_;
@@ -109,6 +122,8 @@ void P4ParentStudy::reset()
     separatingCurves_.clear();
     arbitraryCurves_.clear();
 
+    gPickIndex.invalidate();
+
     config_hma_ = DEFAULT_HMA;
     config_hmi_ = DEFAULT_HMI;
     config_branchhmi_ = DEFAULT_BRANCHHMI;
@@ -169,16 +184,19 @@ bool P4ParentStudy::readPiecewiseData(FILE *fp)
 //          P4ParentStudy::readTables
 // -----------------------------------------------------------------------
 bool P4ParentStudy::readTables(const QString &basename, bool evalpiecewisedata,
-                               bool onlytry)
+                               bool onlytry, bool finiteonly)
 {
+    P4TraceSpan span{"readTables", "study"};
     FILE *fpvec;
     FILE *fpinf;
     FILE *fpfin;
     FILE *fpcurv;
     int p, q, prec;
-    unsigned int v, numcurves, numvf;
+    unsigned int numcurves;
 
     setlocale(LC_ALL, "C");
+    stopRefinedCurves();
+    stopAutoFill();
 
     if (evalpiecewisedata) {
         /*
@@ -257,13 +275,156 @@ bool P4ParentStudy::readTables(const QString &basename, bool evalpiecewisedata,
     fpvec = fopen(QFile::encodeName(basename + "_vec.tab"), "rt");
     if (fpvec == nullptr)
         return false;
+    if (!readVectorTableHeader(fpvec)) {
+        fclose(fpvec);
+        return false;
+    }
 
-    if (fscanf(fpvec, "P5\n%u %u\n", &numvf, &v) != 2) {
+    if (typeofstudy_ != P4TypeOfStudy::typeofstudy_inf) {
+        fpfin = fopen(QFile::encodeName(basename + "_fin.tab"), "rt");
+        if (fpfin == nullptr) {
+            fclose(fpvec);
+            reset();
+            return false;
+        }
+    } else
+        fpfin = nullptr;
+
+    if (typeofstudy_ != P4TypeOfStudy::typeofstudy_one &&
+        typeofstudy_ != P4TypeOfStudy::typeofstudy_fin && !finiteonly) {
+        fpinf = fopen(QFile::encodeName(basename + "_inf.tab"), "rt");
+        if (fpinf == nullptr) {
+            fclose(fpvec);
+            if (fpfin != nullptr)
+                fclose(fpfin);
+            reset();
+            return false;
+        }
+    } else
+        fpinf = nullptr;
+
+    for (unsigned int j = 0; j < gThisVF->numVF_; j++) {
+        if (!vf_[j]->readTables(fpvec, fpfin, fpinf)) {
+            reset();
+            if (fpinf != nullptr)
+                fclose(fpinf);
+            if (fpfin != nullptr)
+                fclose(fpfin);
+            fclose(fpvec);
+            return false;
+        }
+    }
+
+    if (fpinf != nullptr)
+        fclose(fpinf);
+    if (fpfin != nullptr)
+        fclose(fpfin);
+    fclose(fpvec);
+
+    readTables(basename, true, true); // try to read the piecewise curve points
+                                      // as well if they are present on disk
+    // dump(basename);
+    examinePositionsOfSingularities();
+    partial_ = finiteonly;
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//          P4ParentStudy::startReadingSingularities
+// -----------------------------------------------------------------------
+bool P4ParentStudy::startReadingSingularities(const QString &basename)
+{
+    FILE *fpvec;
+
+    setlocale(LC_ALL, "C");
+
+    reset();
+
+    fpvec = fopen(QFile::encodeName(basename + "_vec.tab"), "rt");
+    if (fpvec == nullptr)
+        return false;
+    if (!readVectorTableHeader(fpvec)) {
         fclose(fpvec);
         return false;
     }
+    fclose(fpvec);
+
+    if (typeofstudy_ == P4TypeOfStudy::typeofstudy_inf) {
+        reset();
+        return false;
+    }
+
+    partial_ = true;
+    singularitiesOnly_ = true;
+    singularityOffset_ = 0;
+    singularityVF_ = -1;
+    singularitiesLeft_ = 0;
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//          P4ParentStudy::readNextSingularity
+// -----------------------------------------------------------------------
+// The finite table holds, for every vector field, the number of its
+// singularities followed by their records.  Maple flushes it after each
+// record, so the one just completed is read from where the previous one
+// ended.
+bool P4ParentStudy::readNextSingularity(const QString &basename)
+{
+    FILE *fpfin;
+    bool ok;
+
+    if (!singularitiesOnly_)
+        return false;
+
+    fpfin = fopen(QFile::encodeName(basename + "_fin.tab"), "rt");
+    if (fpfin == nullptr) {
+        reset();
+        return false;
+    }
+
+    ok = (fseek(fpfin, singularityOffset_, SEEK_SET) == 0);
+    while (ok && singularitiesLeft_ <= 0) {
+        // a vector field without singularities has no record
+        if (++singularityVF_ >= static_cast<int>(vf_.size()) ||
+            fscanf(fpfin, "%d", &singularitiesLeft_) != 1 ||
+            singularitiesLeft_ < 0)
+            ok = false;
+    }
+    if (ok)
+        ok = vf_[singularityVF_]->readPoint(fpfin);
+    if (ok) {
+        singularitiesLeft_--;
+        singularityOffset_ = ftell(fpfin);
+    }
+    fclose(fpfin);
+
+    if (!ok) {
+        reset();
+        return false;
+    }
+    examinePositionsOfSingularities();
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//          P4ParentStudy::readVectorTableHeader
+// -----------------------------------------------------------------------
+// The start of the table of the vector field, which Maple writes before it
+// studies any singularity: the pieces, the type of study, the weights and the
+// separating curves.  The vector fields themselves follow.  On failure, the
+// study is reset.
+bool P4ParentStudy::readVectorTableHeader(FILE *fpvec)
+{
+    int p, q;
+    unsigned int v, numvf;
+
+    if (fscanf(fpvec, "P5\n%u %u\n", &numvf, &v) != 2) {
+        reset();
+        return false;
+    }
     if (v != gThisVF->numSeparatingCurves_ || numvf != gThisVF->numVF_) {
-        fclose(fpvec);
+        reset();
         return false;
     }
 
@@ -276,13 +437,11 @@ bool P4ParentStudy::readTables(const QString &basename, bool evalpiecewisedata,
 
     if (fscanf(fpvec, "%d\n%d\n%d\n", &typeofstudy_, &p, &q) != 3) {
         reset();
-        fclose(fpvec);
         return false;
     }
 
     if (p != gThisVF->p_ || q != gThisVF->q_) {
         reset();
-        fclose(fpvec);
         return false;
     }
     p_ = p;
@@ -300,7 +459,6 @@ bool P4ParentStudy::readTables(const QString &basename, bool evalpiecewisedata,
         if (fscanf(fpvec, "%lf %lf %lf %lf", &xmin_, &xmax_, &ymin_, &ymax_) !=
             4) {
             reset();
-            fclose(fpvec);
             return false;
         }
         p_ = q_ = 1;
@@ -313,62 +471,14 @@ bool P4ParentStudy::readTables(const QString &basename, bool evalpiecewisedata,
         separatingCurves_.clear();
         if (!readSeparatingCurve(fpvec)) {
             reset();
-            fclose(fpvec);
             return false;
         }
     }
 
     if (!readPiecewiseData(fpvec)) {
         reset();
-        fclose(fpvec);
         return false;
     }
-
-    if (typeofstudy_ != P4TypeOfStudy::typeofstudy_inf) {
-        fpfin = fopen(QFile::encodeName(basename + "_fin.tab"), "rt");
-        if (fpfin == nullptr) {
-            fclose(fpvec);
-            reset();
-            return false;
-        }
-    } else
-        fpfin = nullptr;
-
-    if (typeofstudy_ != P4TypeOfStudy::typeofstudy_one &&
-        typeofstudy_ != P4TypeOfStudy::typeofstudy_fin) {
-        fpinf = fopen(QFile::encodeName(basename + "_inf.tab"), "rt");
-        if (fpinf == nullptr) {
-            fclose(fpvec);
-            if (fpfin != nullptr)
-                fclose(fpfin);
-            reset();
-            return false;
-        }
-    } else
-        fpinf = nullptr;
-
-    for (unsigned int j = 0; j < gThisVF->numVF_; j++) {
-        if (!vf_[j]->readTables(fpvec, fpfin, fpinf)) {
-            reset();
-            if (fpinf != nullptr)
-                fclose(fpinf);
-            if (fpfin != nullptr)
-                fclose(fpfin);
-            fclose(fpvec);
-            return false;
-        }
-    }
-
-    if (fpinf != nullptr)
-        fclose(fpinf);
-    if (fpfin != nullptr)
-        fclose(fpfin);
-    fclose(fpvec);
-
-    readTables(basename, true, true); // try to read the piecewise curve points
-                                      // as well if they are present on disk
-    // dump(basename);
-    examinePositionsOfSingularities();
     return true;
 }
 
@@ -486,6 +596,9 @@ bool P4ParentStudy::readSeparatingCurve(FILE *fp)
 // -----------------------------------------------------------------------
 void P4ParentStudy::setupCoordinateTransformations()
 {
+    // the refine jobs copied the transformations that are replaced here
+    stopRefinedCurves();
+
     if (!plweights_) {
         U1_to_sphere = U1_to_psphere;
         U2_to_sphere = U2_to_psphere;
@@ -624,13 +737,19 @@ void P4ParentStudy::setupCoordinateTransformations()
 // -----------------------------------------------------------------------
 //          P4ParentStudy::deleteVFs
 // -----------------------------------------------------------------------
-void P4ParentStudy::clearVFs() { vf_.clear(); }
+void P4ParentStudy::clearVFs()
+{
+    stopRefinedCurves();
+    stopAutoFill();
+    vf_.clear();
+}
 
 // -----------------------------------------------------------------------
 //          P4ParentStudy::examinePositionsOfSingularities
 // -----------------------------------------------------------------------
 void P4ParentStudy::examinePositionsOfSingularities()
 {
+    P4TraceSpan span{"examinePositionsOfSingularities", "study"};
     std::vector<positionitem> positions;
     int numpositions{0};
 
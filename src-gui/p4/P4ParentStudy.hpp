@@ -22,6 +22,7 @@
 #include <memory>
 #include <vector>
 
+#include "P4FlowGrid.hpp"
 #include "P4InputVF.hpp"
 #include "P4VFStudy.hpp"
 #include "structures.hpp"
@@ -39,8 +40,9 @@ class P4ParentStudy : public QObject
     ///////////////////
 
     std::vector<std::unique_ptr<P4VFStudy>> vf_;
-    // K_ will be throughout the current vector field selected
-    int K_{0};
+    // K_ will be throughout the current vector field selected.  Each thread
+    // that integrates orbits has its own.
+    static thread_local int K_;
 
     std::vector<P4Curves::curves> separatingCurves_;
 
@@ -48,6 +50,8 @@ class P4ParentStudy : public QObject
     // P4TypeOfView::typeofview_plane or P4TypeOfView::typeofview_sphere
     int typeofview_{P4TypeOfView::typeofview_sphere};
     bool plotVirtualSingularities_{DEFAULTPLOTVIRTUALSINGULARITIES};
+    // direction field in the background, see P4TypeOfFlowField
+    int flowField_{P4TypeOfFlowField::flowfield_none};
     int p_{1};
     int q_{1};
     bool plweights_{false}; // true if p<>1 or q<>1; false if p=q=1
@@ -64,6 +68,18 @@ class P4ParentStudy : public QObject
     double ymin_{-1.0};
     double ymax_{1.0};
 
+    // true while the tables are read before Maple has finished: the
+    // singularities at infinity, or some of the finite ones, are missing
+    bool partial_{false};
+    // true while only the finite singularities studied so far are known: the
+    // vector fields in the charts are not, so nothing can be integrated
+    bool singularitiesOnly_{false};
+    // where readNextSingularity goes on in the finite table: the offset, the
+    // vector field, and the number of its singularities still to be read
+    long singularityOffset_{0};
+    int singularityVF_{-1};
+    int singularitiesLeft_{0};
+
     // curves
     std::vector<P4Curves::curves> arbitraryCurves_;
 
@@ -73,6 +89,8 @@ class P4ParentStudy : public QObject
     // runtime when plotting
     P4Orbits::orbits *currentLimCycle_{nullptr};
     P4Orbits::orbits *currentOrbit_{nullptr};
+    // orbit picked with the right mouse button, not owned
+    P4Orbits::orbits *selectedOrbit_{nullptr};
 
     double selected_ucoord_[2];
 
@@ -118,11 +136,19 @@ class P4ParentStudy : public QObject
 
     bool readPiecewiseData(FILE *);
     void examinePositionsOfSingularities();
-    bool readTables(const QString &, bool, bool);
+    // with finiteonly, the tables at infinity are not read even if the
+    // study has them: they may still be written by Maple
+    bool readTables(const QString &, bool, bool, bool finiteonly = false);
+    // the finite singularities one by one, while Maple studies them: start
+    // reads the start of the table of the vector field, next the record that
+    // Maple has just completed
+    bool startReadingSingularities(const QString &basename);
+    bool readNextSingularity(const QString &basename);
     void dump(const QString &basename);
     void reset();
     void setupCoordinateTransformations();
     bool readSeparatingCurve(FILE *);
+    bool readVectorTableHeader(FILE *);
 
     bool readArbitraryCurve(QString basename);
 
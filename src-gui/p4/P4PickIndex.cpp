@@ -0,0 +1,320 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4PickIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "P4ParentStudy.hpp"
+#include "P4TrajectoryStore.hpp"
+#include "P4VFStudy.hpp"
+#include "custom.hpp"
+#include "math_p4.hpp"
+#include "math_regions.hpp"
+#include "structures.hpp"
+
+// maximum number of cells in each direction
+#define PICKINDEX_MAXCELLS 256
+
+P4PickIndex gPickIndex;
+
+// -----------------------------------------------------------------------
+//                      CELLGRID
+// -----------------------------------------------------------------------
+
+void P4PickIndex::cellgrid::build(
+    const std::vector<std::array<double, 4>> &boxes)
+{
+    double xmin{0}, ymin{0}, xmax{0}, ymax{0};
+    bool first{true};
+
+    for (auto const &b : boxes) {
+        if (!std::isfinite(b[0]) || !std::isfinite(b[1]) ||
+            !std::isfinite(b[2]) || !std::isfinite(b[3]))
+            continue;
+        if (first) {
+            xmin = b[0];
+            ymin = b[1];
+            xmax = b[2];
+            ymax = b[3];
+            first = false;
+        } else {
+            xmin = std::min(xmin, b[0]);
+            ymin = std::min(ymin, b[1]);
+            xmax = std::max(xmax, b[2]);
+            ymax = std::max(ymax, b[3]);
+        }
+    }
+
+    nx = static_cast<int>(std::ceil(std::sqrt(boxes.size())));
+    nx = std::max(1, std::min(nx, PICKINDEX_MAXCELLS));
+    ny = nx;
+    x0 = xmin;
+    y0 = ymin;
+    cw = (xmax > xmin) ? (xmax - xmin) / nx : 1.0;
+    ch = (ymax > ymin) ? (ymax - ymin) / ny : 1.0;
+
+    cells.clear();
+    cells.resize(nx * ny);
+    if (first)
+        return;
+
+    for (int i = 0; i < static_cast<int>(boxes.size()); i++) {
+        auto const &b = boxes[i];
+        if (!std::isfinite(b[0]) || !std::isfinite(b[1]) ||
+            !std::isfinite(b[2]) || !std::isfinite(b[3]))
+            continue;
+        int i1{cellX(b[0])}, i2{cellX(b[2])};
+        int j1{cellY(b[1])}, j2{cellY(b[3])};
+        for (int j = j1; j <= j2; j++)
+            for (int k = i1; k <= i2; k++)
+                cells[j * nx + k].push_back(i);
+    }
+}
+
+int P4PickIndex::cellgrid::cellX(double x) const
+{
+    int i{static_cast<int>(std::floor((x - x0) / cw))};
+    return std::max(0, std::min(i, nx - 1));
+}
+
+int P4PickIndex::cellgrid::cellY(double y) const
+{
+    int j{static_cast<int>(std::floor((y - y0) / ch))};
+    return std::max(0, std::min(j, ny - 1));
+}
+
+// Visit the cells in rings of growing size around the cell of (x,y), and
+// return the index of the item with the smallest distance.  An item that
+// has not been seen in the first r rings lies at least (r-1) cells away, so
+// the search stops when that exceeds the best distance so far, or maxdist.
+// When (x,y) lies outside of the grid, it is clamped to its border: this
+// does not increase the distance to any item.
+template <typename DISTFUNC>
+static int searchRings(const P4PickIndex::cellgrid &grid, double x, double y,
+                       double maxdist, DISTFUNC distance)
+{
+    int best{-1};
+    double bestdist{maxdist};
+    int ci, cj, r, i, j;
+    double d;
+
+    if (grid.cells.empty())
+        return -1;
+
+    ci = grid.cellX(x);
+    cj = grid.cellY(y);
+
+    for (r = 0; r <= std::max(grid.nx, grid.ny); r++) {
+        if ((r - 1) * std::min(grid.cw, grid.ch) > bestdist)
+            break;
+        for (j = cj - r; j <= cj + r; j++) {
+            if (j < 0 || j >= grid.ny)
+                continue;
+            for (i = ci - r; i <= ci + r; i++) {
+                if (i < 0 || i >= grid.nx)
+                    continue;
+                // only the border of the ring
+                if (j != cj - r && j != cj + r && i != ci - r && i != ci + r)
+                    continue;
+                for (auto k : grid.cells[j * grid.nx + i]) {
+                    d = distance(k);
+                    if (std::isnan(d) || !std::isfinite(d))
+                        continue;
+                    if (d < bestdist || (best == -1 && d <= bestdist)) {
+                        bestdist = d;
+                        best = k;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+// -----------------------------------------------------------------------
+//                      BUILD
+// -----------------------------------------------------------------------
+
+void P4PickIndex::addSingularity(int type, void *point, int vfindex,
+                                 int chart, double x0, double y0)
+{
+    singularity s;
+
+    s.type = type;
+    s.point = point;
+    s.vfindex = vfindex;
+    switch (chart) {
+    case P4Charts::chart_R2:
+        MATHFUNC(R2_to_sphere)(x0, y0, s.pcoord);
+        break;
+    case P4Charts::chart_U1:
+        MATHFUNC(U1_to_sphere)(x0, y0, s.pcoord);
+        break;
+    case P4Charts::chart_V1:
+        MATHFUNC(V1_to_sphere)(x0, y0, s.pcoord);
+        break;
+    case P4Charts::chart_U2:
+        MATHFUNC(U2_to_sphere)(x0, y0, s.pcoord);
+        break;
+    case P4Charts::chart_V2:
+        MATHFUNC(V2_to_sphere)(x0, y0, s.pcoord);
+        break;
+    }
+    MATHFUNC(sphere_to_viewcoord)(s.pcoord[0], s.pcoord[1], s.pcoord[2],
+                                  s.ucoord);
+    singularities_.push_back(s);
+}
+
+void P4PickIndex::addSegment(P4Orbits::orbits *orbit, const double *p,
+                             const double *q)
+{
+    double u1[2], u2[2], u3[2], u4[2];
+
+    if (MATHFUNC(sphere_to_viewcoordpair)(p, q, u1, u2, u3, u4)) {
+        segments_.push_back({orbit, u1[0], u1[1], u2[0], u2[1]});
+    } else {
+        segments_.push_back({orbit, u1[0], u1[1], u2[0], u2[1]});
+        segments_.push_back({orbit, u3[0], u3[1], u4[0], u4[1]});
+    }
+}
+
+void P4PickIndex::build()
+{
+    std::vector<std::array<double, 4>> boxes;
+    int vfindex;
+
+    singularities_.clear();
+    segments_.clear();
+
+    for (vfindex = 0; vfindex < static_cast<int>(gVFResults.vf_.size());
+         vfindex++) {
+        auto &vf = gVFResults.vf_[vfindex];
+        for (auto sp = vf->firstSaddlePoint_; sp != nullptr;
+             sp = sp->next_saddle) {
+            if (sp->position != P4Singularities::position_virtual)
+                addSingularity(P4SingularityType::saddle, sp, vfindex,
+                               sp->chart, sp->x0, sp->y0);
+        }
+        for (auto sp = vf->firstSePoint_; sp != nullptr; sp = sp->next_se) {
+            if (sp->position != P4Singularities::position_virtual &&
+                sp->separatrices != nullptr)
+                addSingularity(P4SingularityType::semi_hyperbolic, sp,
+                               vfindex, sp->chart, sp->x0, sp->y0);
+        }
+        for (auto sp = vf->firstDePoint_; sp != nullptr; sp = sp->next_de) {
+            if (sp->position != P4Singularities::position_virtual &&
+                sp->blow_up != nullptr)
+                addSingularity(P4SingularityType::non_elementary, sp,
+                               vfindex, sp->chart, sp->x0, sp->y0);
+        }
+    }
+
+    // the same sequence of lines and points as drawOrbit, with all the points
+    // of the chunks that have been moved out of memory
+    for (auto orbit = gVFResults.firstOrbit_; orbit != nullptr;
+         orbit = orbit->next) {
+        const double *prev{orbit->pcoord};
+        addSegment(orbit, prev, prev);
+        P4CurveReader r{orbit->firstpt, true};
+        for (auto pt = r.next(); pt != nullptr; pt = r.next()) {
+            if (pt->dashes)
+                addSegment(orbit, prev, pt->pcoord);
+            else
+                addSegment(orbit, pt->pcoord, pt->pcoord);
+            prev = pt->pcoord;
+        }
+    }
+
+    boxes.clear();
+    for (auto const &s : singularities_)
+        boxes.push_back({s.ucoord[0], s.ucoord[1], s.ucoord[0], s.ucoord[1]});
+    singularityGrid_.build(boxes);
+
+    boxes.clear();
+    for (auto const &s : segments_)
+        boxes.push_back({std::min(s.x1, s.x2), std::min(s.y1, s.y2),
+                         std::max(s.x1, s.x2), std::max(s.y1, s.y2)});
+    segmentGrid_.build(boxes);
+
+    isValid_ = true;
+}
+
+// -----------------------------------------------------------------------
+//                      QUERIES
+// -----------------------------------------------------------------------
+
+const P4PickIndex::singularity *
+P4PickIndex::nearestSingularity(double x, double y, int vfindex,
+                                double *refpos)
+{
+    int k;
+
+    if (!isValid_)
+        build();
+
+    k = searchRings(singularityGrid_, x, y, HUGE_VAL, [&](int i) {
+        auto &s = singularities_[i];
+        if (s.vfindex != vfindex || !isInTheSameRegion(s.pcoord, refpos))
+            return HUGE_VAL;
+        return std::hypot(x - s.ucoord[0], y - s.ucoord[1]);
+    });
+    if (k == -1)
+        return nullptr;
+    return &singularities_[k];
+}
+
+// distance from (x,y) to the segment; the nearest point is stored in u
+static double segmentDistance(double x, double y, double x1, double y1,
+                              double x2, double y2, double *u)
+{
+    double dx{x2 - x1}, dy{y2 - y1};
+    double len2{dx * dx + dy * dy};
+    double t{0};
+
+    if (len2 > 0) {
+        t = ((x - x1) * dx + (y - y1) * dy) / len2;
+        t = std::max(0.0, std::min(1.0, t));
+    }
+    u[0] = x1 + t * dx;
+    u[1] = y1 + t * dy;
+    return std::hypot(x - u[0], y - u[1]);
+}
+
+P4Orbits::orbits *P4PickIndex::nearestOrbit(double x, double y,
+                                            double maxdist, double *ucoord)
+{
+    int k;
+    double u[2];
+
+    if (!isValid_)
+        build();
+
+    k = searchRings(segmentGrid_, x, y, maxdist, [&](int i) {
+        auto &s = segments_[i];
+        return segmentDistance(x, y, s.x1, s.y1, s.x2, s.y2, u);
+    });
+    if (k == -1)
+        return nullptr;
+
+    auto &s = segments_[k];
+    segmentDistance(x, y, s.x1, s.y1, s.x2, s.y2, ucoord);
+    return s.orbit;
+}
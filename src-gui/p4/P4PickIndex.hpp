@@ -0,0 +1,90 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+namespace P4Orbits
+{
+struct orbits;
+}
+
+// Uniform grid over the view coordinates of the stored orbits and of the
+// singularities that have separatrices, so that the one nearest to a mouse
+// click is found without scanning all of them.  The index is rebuilt from
+// gVFResults when it is queried after it has been invalidated, which must
+// happen whenever these are changed or deleted.
+
+class P4PickIndex
+{
+  public:
+    struct singularity {
+        int type;    // P4SingularityType::saddle, semi_hyperbolic or
+                     // non_elementary
+        void *point; // the corresponding P4Singularities struct
+        int vfindex;
+        double pcoord[3];
+        double ucoord[2];
+    };
+
+    void invalidate() { isValid_ = false; }
+
+    // nearest singularity of vector field vfindex that lies in the same
+    // region as refpos, or nullptr
+    const singularity *nearestSingularity(double x, double y, int vfindex,
+                                          double *refpos);
+
+    // nearest orbit passing within maxdist of (x,y), or nullptr.  The
+    // nearest point on the orbit is returned in ucoord.
+    P4Orbits::orbits *nearestOrbit(double x, double y, double maxdist,
+                                   double *ucoord);
+
+    // grid of the bounding boxes of items, by index
+    struct cellgrid {
+        double x0{0}, y0{0}, cw{1}, ch{1};
+        int nx{0}, ny{0};
+        std::vector<std::vector<int>> cells;
+
+        void build(const std::vector<std::array<double, 4>> &boxes);
+        int cellX(double x) const;
+        int cellY(double y) const;
+    };
+
+  private:
+    struct segment {
+        P4Orbits::orbits *orbit;
+        double x1, y1, x2, y2;
+    };
+
+    bool isValid_{false};
+    std::vector<singularity> singularities_;
+    std::vector<segment> segments_;
+    cellgrid singularityGrid_;
+    cellgrid segmentGrid_;
+
+    void build();
+    void addSingularity(int type, void *point, int vfindex, int chart,
+                        double x0, double y0);
+    void addSegment(P4Orbits::orbits *orbit, const double *p,
+                    const double *q);
+};
+
+extern P4PickIndex gPickIndex;
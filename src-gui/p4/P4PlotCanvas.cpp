@@ -0,0 +1,1390 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4PlotCanvas.hpp"
+
+#include <QPainter>
+#include <QPixmap>
+
+#include <algorithm>
+#include <cmath>
+
+#include "P4BandImageWriter.hpp"
+#include "P4FlowGrid.hpp"
+#include "P4InputVF.hpp"
+#include "P4ParentStudy.hpp"
+#include "custom.hpp"
+#include "main.hpp"
+#include "math_arbitrarycurve.hpp"
+#include "math_charts.hpp"
+#include "math_gcf.hpp"
+#include "math_isoclines.hpp"
+#include "math_orbits.hpp"
+#include "math_p4.hpp"
+#include "math_separatrice.hpp"
+#include "plot_tools.hpp"
+#include "print_bitmap.hpp"
+#include "print_pdf.hpp"
+#include "print_points.hpp"
+#include "print_postscript.hpp"
+#include "print_svg.hpp"
+#include "print_xfig.hpp"
+
+static QPixmap *sP4pixmap;
+static double sP4pixmapDPM{0};
+
+static QString makechartstring(int p, int q, bool isu1v1chart, bool negchart)
+{
+    QString buf;
+
+    if (isu1v1chart) {
+        // make { x = +/- 1/z2^p, y = z1/z2^q }
+
+        if (p != 1 && q != 1)
+            buf.sprintf("{x=%d/z2^%d,y=z1/z2^%d}", (negchart ? -1 : 1), p, q);
+        else if (p == 1 && q != 1)
+            buf.sprintf("{x=%d/z2,y=z1/z2^%d}", (negchart ? -1 : 1), q);
+        else if (p != 1 && q == 1)
+            buf.sprintf("{x=%d/z2^%d,y=z1/z2}", (negchart ? -1 : 1), p);
+        else
+            buf.sprintf("{x=%d/z2,y=z1/z2}", (negchart ? -1 : 1));
+    } else {
+        // make { x = 1/z2^p, y = +/- z1/z2^q }
+
+        if (p != 1 && q != 1)
+            buf.sprintf("{x=z1/z2^%d,y=%d/z2^%d}", p, (negchart ? -1 : 1), q);
+        else if (p == 1 && q != 1)
+            buf.sprintf("{x=z1/z2,y=%d/z2^%d}", (negchart ? -1 : 1), q);
+        else if (p != 1 && q == 1)
+            buf.sprintf("{x=z1/z2^%d,y=%d/z2}", p, (negchart ? -1 : 1));
+        else
+            buf.sprintf("{x=z1/z2,y=%d/z2}", (negchart ? -1 : 1));
+    }
+
+    return buf;
+}
+
+// parameters x1,... are irrelevant if isZoom is false
+P4PlotCanvas::P4PlotCanvas(bool isZoom, double x1, double y1, double x2,
+                           double y2)
+    : iszoom_{isZoom}
+{
+    if (iszoom_) {
+        x0_ = x1;
+        y0_ = y1;
+        x1_ = x2;
+        y1_ = y2;
+    }
+}
+
+void P4PlotCanvas::setCanvasSize(int width, int height, double pixelsPerMM)
+{
+    w_ = width;
+    h_ = height;
+    horPixelsPerMM_ = pixelsPerMM;
+    verPixelsPerMM_ = pixelsPerMM;
+}
+
+// The part of the view of gVFResults that is shown: the whole view, or
+// the window given to the constructor if this is a zoom.
+void P4PlotCanvas::setupView()
+{
+    spherebgcolor_ = P4ColourSettings::colour_background;
+
+    if (!iszoom_) {
+        switch (gVFResults.typeofview_) {
+        case P4TypeOfView::typeofview_plane:
+        case P4TypeOfView::typeofview_U1:
+        case P4TypeOfView::typeofview_U2:
+        case P4TypeOfView::typeofview_V1:
+        case P4TypeOfView::typeofview_V2:
+            x0_ = gVFResults.xmin_;
+            y0_ = gVFResults.ymin_;
+            x1_ = gVFResults.xmax_;
+            y1_ = gVFResults.ymax_;
+            break;
+        case P4TypeOfView::typeofview_sphere:
+            x0_ = -1.1;
+            y0_ = -1.1;
+            x1_ = 1.1;
+            y1_ = 1.1;
+            break;
+        }
+    }
+
+    dx_ = x1_ - x0_;
+    dy_ = y1_ - y0_;
+
+    // double idealhd{std::round(w_ / dx_ * dy_)};
+
+    switch (gVFResults.typeofview_) {
+    case P4TypeOfView::typeofview_plane:
+        chartstring_ = "";
+        break;
+    case P4TypeOfView::typeofview_sphere:
+        chartstring_ = "";
+        break;
+    case P4TypeOfView::typeofview_U1:
+        chartstring_ =
+            makechartstring(gVFResults.p_, gVFResults.q_, true, false);
+        break;
+    case P4TypeOfView::typeofview_U2:
+        chartstring_ =
+            makechartstring(gVFResults.p_, gVFResults.q_, false, false);
+        break;
+    case P4TypeOfView::typeofview_V1:
+        chartstring_ =
+            makechartstring(gVFResults.p_, gVFResults.q_, true, true);
+        break;
+    case P4TypeOfView::typeofview_V2:
+        chartstring_ =
+            makechartstring(gVFResults.p_, gVFResults.q_, false, true);
+        break;
+    }
+}
+
+double P4PlotCanvas::coWorldX(int x)
+{
+    double wx{static_cast<double>(x) / (w_ - 1)};
+    return (wx * dx_ + x0_);
+}
+
+double P4PlotCanvas::coWorldY(int y)
+{
+    double wy{static_cast<double>(h_ - 1 - y) / (h_ - 1)};
+
+    return (wy * dy_ + y0_);
+}
+
+int P4PlotCanvas::coWinH(double deltax)
+{
+    double wx{deltax / dx_ * (w_ - 1)};
+
+    return static_cast<int>(std::round(wx));
+}
+
+int P4PlotCanvas::coWinV(double deltay)
+{
+    double wy{deltay / dy_ * (h_ - 1)};
+
+    return static_cast<int>(std::round(wy));
+}
+
+int P4PlotCanvas::coWinX(double x)
+{
+    double wx{(x - x0_) / dx_ * (w_ - 1)};
+    int iwx{static_cast<int>(std::round(wx))};
+
+    if (iwx >= w_)
+        iwx = w_ - 1;
+
+    return iwx;
+}
+
+int P4PlotCanvas::coWinY(double y)
+{
+    double wy{(y - y0_) / dy_ * (h_ - 1)};
+    int iwy{static_cast<int>(std::round(wy))};
+
+    if (iwy >= h_)
+        iwy = h_ - 1;
+
+    // on screen: vertical axis orientation is reversed
+    return (reverseYAxis_) ? iwy : h_ - 1 - iwy;
+}
+
+bool P4PlotCanvas::getChartPos(int chart, double x0_, double y0_, double *pos)
+{
+    double pcoord[3];
+
+    switch (chart) {
+    case P4Charts::chart_R2:
+        MATHFUNC(finite_to_viewcoord)(x0_, y0_, pos);
+        break;
+    case P4Charts::chart_U1:
+        MATHFUNC(U1_to_sphere)(x0_, 0, pcoord);
+        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
+        break;
+    case P4Charts::chart_U2:
+        MATHFUNC(U2_to_sphere)(x0_, 0, pcoord);
+        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
+        break;
+    case P4Charts::chart_V1:
+        MATHFUNC(V1_to_sphere)(x0_, 0, pcoord);
+        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
+        break;
+    case P4Charts::chart_V2:
+        MATHFUNC(V2_to_sphere)(x0_, 0, pcoord);
+        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
+        break;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                          DRAWING
+// -----------------------------------------------------------------------
+
+// Nothing is shown, so there is nothing to draw: the curves are only
+// printed, from the data of the study.
+
+bool P4PlotCanvas::isZoom() const { return iszoom_; }
+
+P4RefineJob *P4PlotCanvas::refineJob() { return nullptr; }
+
+bool P4PlotCanvas::isDrawing() const { return false; }
+
+void P4PlotCanvas::drawPoint(double x, double y, int color) {}
+
+void P4PlotCanvas::drawLine(double x1, double y1, double x2, double y2,
+                            int color)
+{
+}
+
+void P4PlotCanvas::prepareDrawing(int layer) {}
+
+void P4PlotCanvas::finishDrawing() {}
+
+void P4PlotCanvas::refresh() {}
+
+void P4PlotCanvas::refreshLayer(int layer) {}
+
+// -----------------------------------------------------------------------
+//                          PLOT TOOLS
+// -----------------------------------------------------------------------
+
+std::vector<P4POLYLINES> P4PlotCanvas::produceEllipse(double cx, double cy,
+                                                      double a, double b,
+                                                      bool dotted, double resa,
+                                                      double resb)
+{
+    // this is an exact copy of the plotEllipse routine, except that output
+    // is stored in a list of points that is dynamically allocated.
+
+    double theta{0}, t1, t2, e, R, x, y, c, prevx{0}, prevy{0};
+    bool d{false};
+    bool doton{true};
+    int dotcount{0};
+    std::vector<P4POLYLINES> result;
+
+    R = (resa < resb) ? resa : resb;
+    if (R < 1.0)
+        R = 1.0; // protection
+    e = 2 * acos(1.0 - 0.5 / R);
+    if (R * sin(e) > 1.0)
+        e = asin(1.0 / R);
+
+    while (theta < TWOPI) {
+        c = (x0_ - cx) / a;
+        if (c > -1.0 && c < 1.0) {
+            t1 = acos(c);
+            t2 = TWOPI - t1;
+            if (theta >= t1 && theta < t2) {
+                theta = t2 + e / 4;
+                d = false;
+                continue;
+            }
+        }
+        c = (x1_ - cx) / a;
+        if (c > -1.0 && c < 1.0) {
+            t1 = acos(c);
+            t2 = TWOPI - t1;
+            if (theta < t1) {
+                theta = t1 + e / 4;
+                d = false;
+                continue;
+            }
+            if (theta >= t2) {
+                theta = TWOPI + e / 4;
+                d = false;
+                break;
+            }
+        }
+        c = (y0_ - cy) / b;
+        if (c > -1.0 && c < 1.0) {
+            t1 = asin(c);
+            t2 = PI - t1;
+            if (t1 < 0) {
+                t2 = t1 + TWOPI;
+                t1 = PI - t1;
+                if (theta >= t1 && theta < t2) {
+                    theta = t2 + e / 4;
+                    d = false;
+                    continue;
+                }
+            } else {
+                if (theta < t1) {
+                    theta = t1 + e / 4;
+                    d = false;
+                    continue;
+                }
+                if (theta >= t2) {
+                    theta = TWOPI + e / 4;
+                    d = false;
+                    break;
+                }
+            }
+        }
+        c = (y1_ - cy) / b;
+        if (c > -1.0 && c < 1.0) {
+            t1 = asin(c);
+            t2 = PI - t1;
+            if (t1 < 0) {
+                t2 = t1 + TWOPI;
+                t1 = PI - t1;
+                if (theta < t1) {
+                    theta = t1 + e / 4;
+                    d = false;
+                    continue;
+                }
+                if (theta >= t2) {
+                    theta = TWOPI;
+                    d = false;
+                    break;
+                }
+            } else {
+                if (theta >= t1 && theta < t2) {
+                    theta = t2 + e / 4;
+                    d = false;
+                    continue;
+                }
+            }
+        }
+
+        x = cx + a * cos(theta);
+        y = cy + b * sin(theta);
+        theta += e;
+
+        // (x,y) is inside view
+
+        if (!d) {
+            if (doton) {
+                d = true;
+                prevx = x;
+                prevy = y;
+                dotcount = 0;
+                doton = true;
+            } else {
+                if (++dotcount > 7 && dotted) {
+                    d = false;
+                    doton = !doton;
+                    dotcount = 0;
+                }
+            }
+        } else {
+            if (doton) {
+                result.emplace_back(prevx, prevy, x, y);
+                prevx = x;
+                prevy = y;
+            }
+            if (++dotcount > 7 && dotted) {
+                d = false;
+                doton = (doton) ? false : true;
+                dotcount = 0;
+            }
+        }
+    }
+    return result;
+}
+
+// Arrows of length len (in pixels) along the flow, centred at the points of
+// the grid, drawn with the given line function.
+void P4PlotCanvas::drawFlowField(const P4FlowGrid &grid, double len,
+                                 void (P4Canvas::*line)(double, double, double,
+                                                        double, int))
+{
+    double sx{(w_ - 1) / dx_}, sy{(h_ - 1) / dy_};
+    double ax, ay, bx, by, tx, ty;
+    double head{len / 3};
+    int color;
+
+    for (auto const &s : grid.samples()) {
+        if (!s.valid)
+            continue;
+        color = grid.sampleColour(s, gVFResults.flowField_);
+
+        // one pixel along and across the flow, in view coordinates
+        ax = s.dir[0] / sx;
+        ay = s.dir[1] / sy;
+        bx = -s.dir[1] / sx;
+        by = s.dir[0] / sy;
+
+        tx = s.u[0] + ax * len / 2;
+        ty = s.u[1] + ay * len / 2;
+        (this->*line)(s.u[0] - ax * len / 2, s.u[1] - ay * len / 2, tx, ty,
+                      color);
+        (this->*line)(tx, ty, tx - ax * head + bx * head / 2,
+                      ty - ay * head + by * head / 2, color);
+        (this->*line)(tx, ty, tx - ax * head - bx * head / 2,
+                      ty - ay * head - by * head / 2, color);
+    }
+}
+
+//---------------------------------------------------------------------
+//                  PRINTING METHODS
+//---------------------------------------------------------------------
+void P4PlotCanvas::printPoint(const P4Singularities::saddle *p)
+{
+    // qDebug() << "print point saddle";
+    double pos[2];
+
+    getChartPos(p->chart, p->x0, p->y0, pos);
+    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+        return;
+
+    switch (p->position) {
+    case P4Singularities::position_virtual:
+        print_virtualsaddle(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case P4Singularities::position_coinciding:
+        break;
+    case P4Singularities::position_coinciding_virtual:
+        break;
+    case P4Singularities::position_coinciding_main:
+        print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    default:
+        print_saddle(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    }
+}
+
+void P4PlotCanvas::printPoint(const P4Singularities::node *p)
+{
+    // qDebug() << "print point node";
+    double pos[2];
+
+    getChartPos(p->chart, p->x0, p->y0, pos);
+
+    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+        return;
+
+    if (p->stable == -1) {
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualstablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_stablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+    } else {
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualunstablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_unstablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+    }
+}
+
+void P4PlotCanvas::printPoint(const P4Singularities::weak_focus *p)
+{
+    // qDebug() << "print point weak focus";
+    double pos[2];
+
+    getChartPos(p->chart, p->x0, p->y0, pos);
+
+    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+        return;
+
+    switch (p->type) {
+    case P4SingularityStability::stable:
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualstableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_stableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+        break;
+    case P4SingularityStability::unstable:
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualunstableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_unstableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+        break;
+    case P4SingularityStability::center:
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualcenter(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_center(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+        break;
+    default:
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualweakfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_weakfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+        break;
+    }
+}
+
+void P4PlotCanvas::printPoint(const P4Singularities::strong_focus *p)
+{
+    // qDebug() << "print point strong focus";
+    double pos[2];
+
+    getChartPos(p->chart, p->x0, p->y0, pos);
+
+    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+        return;
+
+    if (p->stable == -1) {
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualstablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_stablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+    } else {
+        switch (p->position) {
+        case P4Singularities::position_virtual:
+            print_virtualunstablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case P4Singularities::position_coinciding:
+            break;
+        case P4Singularities::position_coinciding_virtual:
+            break;
+        case P4Singularities::position_coinciding_main:
+            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        default:
+            print_unstablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+    }
+}
+
+void P4PlotCanvas::printPoint(const P4Singularities::degenerate *p)
+{
+    // qDebug() << "print point degenerate";
+    double pos[2];
+
+    getChartPos(p->chart, p->x0, p->y0, pos);
+
+    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+        return;
+
+    switch (p->position) {
+    case P4Singularities::position_virtual:
+        print_virtualdegen(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case P4Singularities::position_coinciding:
+        break;
+    case P4Singularities::position_coinciding_virtual:
+        break;
+    case P4Singularities::position_coinciding_main:
+        print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    default:
+        print_degen(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    }
+}
+
+void P4PlotCanvas::printPoint(const P4Singularities::semi_elementary *p)
+{
+    // qDebug() << "print point semi elementary";
+    double pos[2];
+
+    getChartPos(p->chart, p->x0, p->y0, pos);
+
+    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+        return;
+
+    switch (p->type) {
+    case 1:
+        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 2:
+        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 3:
+        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 4:
+        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 5:
+        print_seunstablenode(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 6:
+        print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 7:
+        print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    case 8:
+        print_sestablenode(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    }
+
+    switch (p->position) {
+    case P4Singularities::position_virtual:
+        switch (p->type) {
+        case 1:
+            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 2:
+            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 3:
+            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 4:
+            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 5:
+            print_virtualseunstablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 6:
+            print_virtualsesaddle(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 7:
+            print_virtualsesaddle(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 8:
+            print_virtualsestablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+        break;
+    case P4Singularities::position_coinciding:
+        break;
+    case P4Singularities::position_coinciding_virtual:
+        break;
+    case P4Singularities::position_coinciding_main:
+        print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
+        break;
+    default:
+        switch (p->type) {
+        case 1:
+            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 2:
+            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 3:
+            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 4:
+            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 5:
+            print_seunstablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 6:
+            print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 7:
+            print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        case 8:
+            print_sestablenode(coWinX(pos[0]), coWinY(pos[1]));
+            break;
+        }
+        break;
+    }
+}
+
+void P4PlotCanvas::printPoints()
+{
+    // qDebug() << "print points";
+    print_comment("Printing symbols at all singular points:");
+
+    for (auto const &vf : gVFResults.vf_) {
+        for (auto s = vf->firstSaddlePoint_; s != nullptr; s = s->next_saddle)
+            printPoint(s);
+        for (auto np = vf->firstNodePoint_; np != nullptr; np = np->next_node)
+            printPoint(np);
+        for (auto wfp = vf->firstWfPoint_; wfp != nullptr; wfp = wfp->next_wf)
+            printPoint(wfp);
+        for (auto sfp = vf->firstSfPoint_; sfp != nullptr; sfp = sfp->next_sf)
+            printPoint(sfp);
+        for (auto sep = vf->firstSePoint_; sep != nullptr; sep = sep->next_se)
+            printPoint(sep);
+        for (auto dp = vf->firstDePoint_; dp != nullptr; dp = dp->next_de)
+            printPoint(dp);
+    }
+}
+
+void P4PlotCanvas::printPointSeparatrices(const P4Singularities::semi_elementary *p)
+{
+    // qDebug() << "print point separatrices (semi elementary)";
+    for (auto s = p->separatrices; s != nullptr; s = s->next_sep) {
+        print_comment("Next separatrix of degenerate point:");
+        draw_sep(this, s->first_sep_point);
+    }
+}
+
+void P4PlotCanvas::printPointSeparatrices(const P4Singularities::saddle *p)
+{
+    // qDebug() << "print point separatrices (saddle)";
+    for (auto s = p->separatrices; s != nullptr; s = s->next_sep) {
+        print_comment("Next separatrix of saddle point:");
+        draw_sep(this, s->first_sep_point);
+    }
+}
+
+void P4PlotCanvas::printPointSeparatrices(const P4Singularities::degenerate *p)
+{
+    // qDebug() << "print point separatrices (degenerate)";
+    for (auto b = p->blow_up; b != nullptr; b = b->next_blow_up_point) {
+        print_comment("Next separatrix of degenerate point:");
+        draw_sep(this, b->first_sep_point);
+    }
+}
+
+void P4PlotCanvas::printSeparatrices()
+{
+    // qDebug() << "print separatrices";
+    for (auto const &vf : gVFResults.vf_) {
+        for (auto s = vf->firstSaddlePoint_; s != nullptr; s = s->next_saddle) {
+            print_comment("Printing separatrice for saddle singularity:");
+            printPointSeparatrices(s);
+        }
+        for (auto sep = vf->firstSePoint_; sep != nullptr; sep = sep->next_se) {
+            print_comment(
+                "Printing separatrices for semi-hyperbolic singularity:");
+            printPointSeparatrices(sep);
+        }
+        for (auto dp = vf->firstDePoint_; dp != nullptr; dp = dp->next_de) {
+            print_comment("Printing separatrices for degenerate singularity:");
+            printPointSeparatrices(dp);
+        }
+    }
+}
+
+void P4PlotCanvas::printGcf()
+{
+    // qDebug() << "print gcf";
+    bool isagcf{false};
+    for (auto const &vf : gVFResults.vf_) {
+        if (vf->gcf_points_ != nullptr) {
+            isagcf = true;
+            break;
+        }
+    }
+    if (isagcf) {
+        for (auto const &vf : gVFResults.vf_) {
+            print_comment("Printing greatest common factor:");
+            draw_gcf(this, vf->gcf_points_,
+                     P4ColourSettings::colour_curve_singularities, 1);
+        }
+    }
+}
+
+void P4PlotCanvas::printSeparatingCurves()
+{
+    // qDebug() << "print separating curve";
+    QString comment;
+    bool dashes;
+    double pcoord[3];
+
+    if (gThisVF->numSeparatingCurves_ > 0 &&
+        !gVFResults.separatingCurves_.empty()) {
+        print_comment("Printing separating curves:");
+        for (unsigned int i = 0; i < gThisVF->numSeparatingCurves_; i++) {
+            comment.sprintf("Curve #%d:", i + 1);
+            print_comment(comment);
+            dashes = true;
+            auto &sep = gVFResults.separatingCurves_[i].points;
+            for (auto it = std::begin(sep); it != std::end(sep); ++it) {
+                if (it->color == P4ColourSettings::colour_separating_curve) {
+                    if (it->dashes && dashes)
+                        (*plot_l)(this, pcoord, it->pcoord, it->color);
+                    else {
+                        auto nextpt = it + 1;
+                        if (nextpt == std::end(sep))
+                            (*plot_p)(this, it->pcoord, it->color);
+                        else if (!nextpt->dashes ||
+                                 nextpt->color != P4ColourSettings::
+                                                      colour_separating_curve ||
+                                 !dashes)
+                            (*plot_p)(this, it->pcoord, it->color);
+                        // draw nothing when the next point is a dash
+                    }
+                    dashes = true;
+                } else {
+                    dashes = false;
+                }
+                copy_x_into_y(it->pcoord, pcoord);
+            }
+        }
+    }
+}
+
+void P4PlotCanvas::printArbitraryCurves()
+{
+    // qDebug() << "print arbitrary curves";
+    QString comment;
+    int i{1};
+    for (auto const &it : gVFResults.arbitraryCurves_) {
+        comment.sprintf("Printing curve %d:", i++);
+        print_comment(comment);
+        drawArbitraryCurve(this, it.points,
+                           P4ColourSettings::colour_arbitrary_curve, 1);
+    }
+}
+
+void P4PlotCanvas::printIsoclines()
+{
+    // qDebug() << "print isoclines";
+    QString comment;
+    int i{1};
+    for (auto const &vf : gVFResults.vf_) {
+        for (auto const &it : vf->isocline_vector_) {
+            comment.sprintf("Printing isocline %d:", i++);
+            print_comment(comment);
+            draw_isoclines(this, it.points, it.color, 1);
+        }
+    }
+}
+
+void P4PlotCanvas::printPoincareSphere()
+{
+    // qDebug() << "print poincare sphere";
+    print_comment("Printing Poincare Sphere:");
+    auto p =
+        produceEllipse(0.0, 0.0, 1.0, 1.0, false, coWinH(1.0), coWinV(1.0));
+    for (auto &q : p) {
+        q.x1 = coWinX(q.x1);
+        q.y1 = coWinY(q.y1);
+        q.x2 = coWinX(q.x2);
+        q.y2 = coWinY(q.y2);
+    }
+    print_elips(coWinX(0), coWinY(0), coWinH(1), coWinV(1),
+                P4ColourSettings::colour_line_at_infinity, false, p);
+}
+
+void P4PlotCanvas::printPoincareLyapunovSphere()
+{
+    // qDebug() << "print poincare-lyapunov sphere";
+    print_comment("Printing Poincare Lyapunov-Sphere (circle at infinity):");
+
+    auto p =
+        produceEllipse(0.0, 0.0, 1.0, 1.0, false, coWinH(1.0), coWinV(1.0));
+    for (auto &q : p) {
+        q.x1 = coWinX(q.x1);
+        q.y1 = coWinY(q.y1);
+        q.x2 = coWinX(q.x2);
+        q.y2 = coWinY(q.y2);
+    }
+    print_elips(coWinX(0.0), coWinY(0.0), coWinH(1.0), coWinV(1.0),
+                P4ColourSettings::colour_line_at_infinity, false, p);
+
+    p.clear();
+
+    print_comment(
+        "Printing Poincare Lyapunov-Sphere (circle of finite radius):");
+
+    p = produceEllipse(0.0, 0.0, RADIUS, RADIUS, true, coWinH(RADIUS),
+                       coWinV(RADIUS));
+    for (auto &q : p) {
+        q.x1 = coWinX(q.x1);
+        q.y1 = coWinY(q.y1);
+        q.x2 = coWinX(q.x2);
+        q.y2 = coWinY(q.y2);
+    }
+    print_elips(coWinX(0.0), coWinY(0.0), coWinH(RADIUS), coWinV(RADIUS),
+                P4ColourSettings::colour_line_at_infinity, true, p);
+}
+
+void P4PlotCanvas::printLineAtInfinity()
+{
+    // qDebug() << "print line at infinity";
+    switch (gVFResults.typeofview_) {
+    case P4TypeOfView::typeofview_U1:
+    case P4TypeOfView::typeofview_V1:
+        if (x0_ < 0.0 && x1_ > 0.0)
+            print_line(coWinX(0.0), coWinY(y0_), coWinX(0.0), coWinY(y1_),
+                       P4ColourSettings::colour_line_at_infinity);
+        break;
+    case P4TypeOfView::typeofview_U2:
+    case P4TypeOfView::typeofview_V2:
+        if (y0_ < 0.0 && y1_ > 0.0)
+            print_line(coWinX(x0_), coWinY(0.0), coWinX(x1_), coWinY(0.0),
+                       P4ColourSettings::colour_line_at_infinity);
+        break;
+    }
+}
+
+// The grid of the printout has as many arrows as the one on the screen.
+void P4PlotCanvas::printFlowField()
+{
+    // qDebug() << "print flow field";
+    P4FlowGrid grid;
+    double spacing{std::max(FLOWFIELDSPACING * horPixelsPerMM_, 8.0)};
+
+    if (gVFResults.flowField_ == P4TypeOfFlowField::flowfield_none ||
+        gVFResults.singularitiesOnly_)
+        return;
+
+    print_comment("Direction field");
+    spacing *= static_cast<double>(w_) / oldw_;
+    grid.update(x0_, y0_, x1_, y1_, w_, h_,
+                std::max(1, static_cast<int>(std::round(spacing))));
+    drawFlowField(grid, 0.6 * spacing, &P4Canvas::printLine);
+}
+
+void P4PlotCanvas::printOrbits()
+{
+    // qDebug() << "print orbits";
+    // inspired by DrawOrbits, except that we put comments between
+    QString s;
+    int i{1};
+    for (auto o = gVFResults.firstOrbit_; o != nullptr; o = o->next) {
+        s.sprintf("Starting orbit %d", i++);
+        print_comment(s);
+        drawOrbit(this, o->pcoord, o->firstpt, o->color);
+    }
+}
+
+void P4PlotCanvas::printLimitCycles()
+{
+    // qDebug() << "print limit cycles";
+    // inspired by DrawOrbits, except that we put comments between
+    QString s;
+    int i{1};
+    for (auto o = gVFResults.firstLimCycle_; o != nullptr; o = o->next) {
+        s.sprintf("Starting limit cycle %d", i++);
+        print_comment(s);
+        drawOrbit(this, o->pcoord, o->firstpt, o->color);
+    }
+}
+
+void P4PlotCanvas::printLine(double x1, double y1, double x2, double y2, int color)
+{
+    // qDebug() << "print line";
+    int wx1, wy1, wx2, wy2;
+
+    if (x1 >= x0_ && x1 <= x1_ && y1 >= y0_ && y1 <= y1_) {
+        wx1 = coWinX(x1);
+        wy1 = coWinY(y1);
+
+        if (x2 >= x0_ && x2 <= x1_ && y2 >= y0_ && y2 <= y1_) {
+            // both points are visible in the window
+            wx2 = coWinX(x2);
+            wy2 = coWinY(y2);
+
+            print_line(wx1, wy1, wx2, wy2, color);
+        } else {
+            // only (x2,y2) is not visible
+            if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_)) {
+                wx1 = coWinX(x1);
+                wy1 = coWinY(y1);
+                wx2 = coWinX(x2);
+                wy2 = coWinY(y2);
+                print_line(wx1, wy1, wx2, wy2, color);
+            }
+        }
+    } else {
+        if (x2 >= x0_ && x2 <= x1_ && y2 >= y0_ && y2 <= y1_) {
+            // only (x2,y2) is visible
+            if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_)) {
+                wx1 = coWinX(x1);
+                wy1 = coWinY(y1);
+                wx2 = coWinX(x2);
+                wy2 = coWinY(y2);
+                print_line(wx1, wy1, wx2, wy2, color);
+            }
+        } else {
+            // both end points are invisible
+            if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_)) {
+                wx1 = coWinX(x1);
+                wy1 = coWinY(y1);
+                wx2 = coWinX(x2);
+                wy2 = coWinY(y2);
+                print_line(wx1, wy1, wx2, wy2, color);
+            }
+        }
+    }
+}
+
+void P4PlotCanvas::printPoint(double x, double y, int color)
+{
+    // qDebug() << "print point";
+    if (x < x0_ || x > x1_ || y < y0_ || y > y1_)
+        return;
+
+    print_point(coWinX(x), coWinY(y), color);
+}
+
+void P4PlotCanvas::calculateHeightFromWidth(int &width, int &height,
+                                            int maxheight, double aspectratio)
+{
+    // given an optimal width in width, this procedure calculates the
+    // corresponding height in order to maintain the given aspectratio. If
+    // however the maximum height is violated, then we choose to have the
+    // maximum height and calculate the corresponding width.
+
+    double w{static_cast<double>(width)};
+    double h{w * dy_ / dx_ * aspectratio};
+
+    if (std::round(h) <= maxheight || maxheight == -1) {
+        height = static_cast<int>(std::round(h));
+    } else {
+        height = maxheight;
+        h = static_cast<double>(maxheight);
+        w = h * dx_ / dy_;
+        w /= aspectratio;
+        width = static_cast<int>(std::round(w));
+    }
+}
+
+bool P4PlotCanvas::preparePrinting(int printmethod, bool isblackwhite,
+                                   int myresolution, double mylinewidth,
+                                   double mysymbolsize)
+{
+    // qDebug() << "prepare printing";
+    double pagewidth, pageheight;
+    double aspectratio{1}; // assume aspect ratio 1
+
+    printMethod_ = printmethod;
+    printError_ = "";
+
+    if (printmethod == P4PRINT_DEFAULT) {
+        if (printDevice_ == nullptr) {
+            printMethod_ = P4PRINT_NONE;
+            return false;
+        }
+        pagewidth = printDevice_->width();
+        pageheight = printDevice_->height();
+    } else
+        pagewidth = pageheight = -1; // will be redefined in a minute
+
+    sP4pixmapDPM = myresolution / 2.54;
+
+    double hpixels{myresolution * 15 / 2.54};
+    double maxvpixels{(myresolution * aspectratio * 20) / 2.54 + 0.5};
+
+    oldw_ = w_;
+    oldh_ = h_;
+    w_ = static_cast<int>(std::round(hpixels));
+
+    switch (printmethod) {
+    case P4PRINT_DEFAULT: /* pagewidth and height already set */
+        break;
+    case P4PRINT_JPEGIMAGE:
+    case P4PRINT_PNGIMAGE:
+    case P4PRINT_TIFFIMAGE:
+        pagewidth = -1;
+        pageheight = -1;
+        break;
+    case P4PRINT_XFIGIMAGE:
+    case P4PRINT_SVGIMAGE:
+    case P4PRINT_PDFIMAGE:
+        pagewidth = -1;
+        pageheight = -1;
+        break;
+    case P4PRINT_EPSIMAGE:
+        pagewidth = myresolution * POSTSCRIPTPAGEWIDTH; // see custom.cpp
+        pageheight = myresolution * POSTSCRIPTPAGEHEIGHT;
+        break;
+    }
+
+    if (w_ > pagewidth && pagewidth != -1)
+        w_ = static_cast<int>(std::round(pagewidth));
+    if (maxvpixels > pageheight && pageheight != -1)
+        maxvpixels = pageheight;
+
+    calculateHeightFromWidth(w_, h_, std::round(maxvpixels), aspectratio);
+
+    // 25.4 dots per mm
+    double lw{myresolution * mylinewidth / 25.4};
+    if (lw < 1.0)
+        lw = 1.0;
+
+    // 25.4 dots per mm
+    double ss{(myresolution * mysymbolsize / 25.4 + 0.5) / 2.0};
+    if (ss < 1.0)
+        ss = 1.0;
+
+    double tx, ty;
+    if (pagewidth == -1 || pageheight == -1) {
+        tx = 0;
+        ty = 0;
+    } else {
+        tx = (pagewidth - w_) / 2.0;
+        ty = (pageheight - h_) / 2.0;
+    }
+
+    switch (printmethod) {
+    case P4PRINT_EPSIMAGE:
+        reverseYAxis_ = true;
+        preparePostscriptPrinting(std::round(tx), std::round(ty), w_, h_,
+                                  iszoom_, isblackwhite, myresolution,
+                                  std::round(lw), 2 * std::round(ss));
+        break;
+    case P4PRINT_XFIGIMAGE:
+        reverseYAxis_ = false;
+        prepareXFigPrinting(w_, h_, iszoom_, isblackwhite, myresolution,
+                            std::round(lw), 2 * std::round(ss));
+        break;
+    case P4PRINT_SVGIMAGE:
+        reverseYAxis_ = false;
+        prepareSVGPrinting(w_, h_, iszoom_, isblackwhite, myresolution,
+                           std::round(lw), 2 * std::round(ss));
+        break;
+    case P4PRINT_PDFIMAGE:
+        reverseYAxis_ = false;
+        if (!preparePDFPrinting(w_, h_, iszoom_, isblackwhite, myresolution,
+                                std::round(lw), 2 * std::round(ss))) {
+            printError_ = "Print failure (unable to create the PDF document).";
+            printMethod_ = P4PRINT_NONE;
+            w_ = oldw_;
+            h_ = oldh_;
+            return false;
+        }
+        break;
+    case P4PRINT_DEFAULT:
+        printPainter_ = new QPainter{};
+
+        if (!printPainter_->begin(printDevice_)) {
+            delete printPainter_;
+            printPainter_ = nullptr;
+            printMethod_ = P4PRINT_NONE;
+            w_ = oldw_;
+            h_ = oldh_;
+            return false;
+        }
+
+        printPainter_->translate(tx, ty);
+        if (iszoom_ ||
+            gVFResults.typeofview_ == P4TypeOfView::typeofview_plane) {
+            QPen p{P4Colours::p4XfigColour(
+                       printColorTable(P4ColourSettings::colour_foreground)),
+                   std::round(lw)};
+            printPainter_->setPen(p);
+            printPainter_->drawRect(0, 0, w_, h_);
+        }
+        reverseYAxis_ = false; // no need for reversing axes in this case
+        prepareP4Printing(w_, h_, isblackwhite, printPainter_, std::round(lw),
+                          2 * std::round(ss));
+        break;
+
+    case P4PRINT_JPEGIMAGE:
+        printPainter_ = new QPainter{};
+        sP4pixmap = new QPixmap{w_, h_};
+        reverseYAxis_ = false; // no need for reversing axes in this case
+        if (sP4pixmap->isNull()) {
+            printError_ = "Print failure (try to choose a lower resolution).";
+            delete sP4pixmap;
+            sP4pixmap = nullptr;
+            delete printPainter_;
+            printPainter_ = nullptr;
+            printMethod_ = P4PRINT_NONE;
+            w_ = oldw_;
+            h_ = oldh_;
+            return false;
+        }
+        if (!printPainter_->begin(sP4pixmap)) {
+            delete sP4pixmap;
+            sP4pixmap = nullptr;
+            delete printPainter_;
+            printPainter_ = nullptr;
+            printMethod_ = P4PRINT_NONE;
+            w_ = oldw_;
+            h_ = oldh_;
+            return false;
+        }
+
+        prepareP4Printing(w_, h_, isblackwhite, printPainter_, std::round(lw),
+                          2 * std::round(ss));
+        break;
+
+    case P4PRINT_PNGIMAGE:
+    case P4PRINT_TIFFIMAGE:
+        // the image is painted by finishPrinting, one band at a time
+        reverseYAxis_ = false;
+        prepareP4TiledPrinting(w_, h_, isblackwhite, std::round(lw),
+                               2 * std::round(ss));
+        break;
+    }
+    return true;
+}
+
+bool P4PlotCanvas::finishPrinting()
+{
+    // qDebug() << "finish printing";
+    if (printMethod_ == P4PRINT_NONE)
+        return true; // preparePrinting failed, and has said why
+
+    if (printMethod_ == P4PRINT_EPSIMAGE) {
+        finishPostscriptPrinting();
+        reverseYAxis_ = false;
+        w_ = oldw_;
+        h_ = oldh_;
+    } else if (printMethod_ == P4PRINT_XFIGIMAGE) {
+        finishXFigPrinting();
+        reverseYAxis_ = false;
+        w_ = oldw_;
+        h_ = oldh_;
+    } else if (printMethod_ == P4PRINT_SVGIMAGE) {
+        finishSVGPrinting();
+        reverseYAxis_ = false;
+        w_ = oldw_;
+        h_ = oldh_;
+    } else if (printMethod_ == P4PRINT_PDFIMAGE) {
+        finishPDFPrinting();
+        reverseYAxis_ = false;
+        w_ = oldw_;
+        h_ = oldh_;
+    } else if (printMethod_ == P4PRINT_DEFAULT) {
+        finishP4Printing();
+        printPainter_->end();
+        delete printPainter_;
+        printPainter_ = nullptr;
+        w_ = oldw_;
+        h_ = oldh_;
+        reverseYAxis_ = false;
+    } else if (printMethod_ == P4PRINT_JPEGIMAGE) {
+        finishP4Printing();
+        printPainter_->end();
+        delete printPainter_;
+        printPainter_ = nullptr;
+
+        if (sP4pixmap->save(gThisVF->getbarefilename() + ".jpg", "JPEG", 100) ==
+            false) {
+            printError_ = "For some reason, P4 is unable to save the "
+                          "resulting JPEG image to disc.";
+        }
+
+        delete sP4pixmap;
+        sP4pixmap = nullptr;
+        reverseYAxis_ = false;
+        w_ = oldw_;
+        h_ = oldh_;
+    } else if (printMethod_ == P4PRINT_PNGIMAGE ||
+               printMethod_ == P4PRINT_TIFFIMAGE) {
+        bool result;
+        if (printMethod_ == P4PRINT_PNGIMAGE)
+            result = finishP4TiledPrinting(gThisVF->getbarefilename() + ".png",
+                                           P4ImageFormat::png,
+                                           sP4pixmapDPM * 2.54,
+                                           printParallel_);
+        else
+            result = finishP4TiledPrinting(gThisVF->getbarefilename() + ".tif",
+                                           P4ImageFormat::tiff,
+                                           sP4pixmapDPM * 2.54,
+                                           printParallel_);
+        if (!result) {
+            printError_ = "For some reason, P4 is unable to save the "
+                          "resulting image to disc.";
+        }
+
+        reverseYAxis_ = false;
+        w_ = oldw_;
+        h_ = oldh_;
+    }
+    printMethod_ = P4PRINT_NONE;
+    return printError_.isEmpty();
+}
+
+// TODO call from paintEvent with a printFlag or something
+void P4PlotCanvas::print()
+{
+    // qDebug() << "print";
+    if (printMethod_ == P4PRINT_NONE)
+        return;
+
+    printFlowField();
+    if (gVFResults.typeofview_ != P4TypeOfView::typeofview_plane) {
+        if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere) {
+            if (gVFResults.plweights_)
+                printPoincareLyapunovSphere();
+            else
+                printPoincareSphere();
+        } else
+            printLineAtInfinity();
+    }
+    printSeparatingCurves();
+    printOrbits();
+    printSeparatrices();
+    printGcf();
+    printArbitraryCurves(); // TODO
+    printIsoclines();
+    printLimitCycles();
+    printPoints();
+}
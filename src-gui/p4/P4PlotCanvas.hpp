@@ -0,0 +1,164 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <vector>
+
+#include "P4Canvas.hpp"
+
+#define FLOWFIELDSPACING 6 // mm in between arrows of the direction field
+
+#define P4PRINT_NONE 0
+#define P4PRINT_DEFAULT 1
+#define P4PRINT_EPSIMAGE 2
+#define P4PRINT_XFIGIMAGE 3
+#define P4PRINT_JPEGIMAGE 4
+#define P4PRINT_PNGIMAGE 5  // printed in bands, see prepareP4TiledPrinting
+#define P4PRINT_TIFFIMAGE 6
+#define P4PRINT_SVGIMAGE 7
+#define P4PRINT_PDFIMAGE 8
+
+class QPainter;
+class QPaintDevice;
+
+class P4FlowGrid;
+
+namespace P4Singularities
+{
+struct saddle;
+struct node;
+struct semi_elementary;
+struct weak_focus;
+struct strong_focus;
+struct degenerate;
+} // namespace P4Singularities
+
+struct P4POLYLINES;
+
+// The plot of gVFResults without a window: the view, its coordinates, and
+// printing it.  p4-render prints on one directly; P4Sphere puts it in a
+// window and draws on the screen as well.
+class P4PlotCanvas : public P4Canvas
+{
+  public:
+    // parameters x1,... are irrelevant if isZoom is false
+    P4PlotCanvas(bool isZoom, double x1, double y1, double x2, double y2);
+
+    double horPixelsPerMM_{1};
+    double verPixelsPerMM_{1};
+
+    QString chartstring_;
+
+    int spherebgcolor_{0};
+
+    int oldw_{0}; // used while printing
+    int oldh_{0};
+
+    // the size of the plot on screen, which the printouts scale from
+    void setCanvasSize(int width, int height, double pixelsPerMM);
+    // takes the view of gVFResults, once it has been read
+    void setupView();
+
+    bool getChartPos(int, double, double, double *);
+    void calculateHeightFromWidth(int &width, int &height, int maxheight = -1,
+                                  double aspectratio = 1);
+
+    std::vector<P4POLYLINES> produceEllipse(double cx, double cy, double a,
+                                            double b, bool dotted, double resa,
+                                            double resb);
+
+    // coordinate changes: from world to windows coordinates
+    int coWinX(double x);
+    int coWinY(double y);
+    // from windows to world coordinates
+    double coWorldX(int x);
+    double coWorldY(int y);
+    int coWinV(double);
+    int coWinH(double);
+
+    void printPoint(const P4Singularities::saddle *);
+    void printPoint(const P4Singularities::node *);
+    void printPoint(const P4Singularities::semi_elementary *);
+    void printPoint(const P4Singularities::weak_focus *);
+    void printPoint(const P4Singularities::strong_focus *);
+    void printPoint(const P4Singularities::degenerate *);
+    void printPointSeparatrices(const P4Singularities::semi_elementary *p);
+    void printPointSeparatrices(const P4Singularities::saddle *p);
+    void printPointSeparatrices(const P4Singularities::degenerate *p);
+    void printPoints();
+    void printSeparatrices();
+    void printGcf();
+    void printSeparatingCurves();
+    void printArbitraryCurves(); // FIXME:
+    void printIsoclines();       // FIXME:
+    void printPoincareSphere();
+    void printPoincareLyapunovSphere();
+    void printLineAtInfinity();
+    void printFlowField();
+    void printOrbits();
+    void printLimitCycles();
+
+    // Returns false if nothing can be printed, with the reason in
+    // printError() when there is one; print and finishPrinting then do
+    // nothing.  finishPrinting returns false if the file was not written.
+    bool preparePrinting(int, bool, int, double, double);
+    void print();
+    bool finishPrinting();
+    const QString &printError() const { return printError_; }
+
+    void printPoint(double x, double y, int color) override;
+    void printLine(double x1, double y1, double x2, double y2,
+                   int color) override;
+
+    // nothing is drawn on screen
+    bool isZoom() const override;
+    P4RefineJob *refineJob() override;
+    bool isDrawing() const override;
+    void drawPoint(double x, double y, int color) override;
+    void drawLine(double x1, double y1, double x2, double y2,
+                  int color) override;
+    void prepareDrawing(int layer) override;
+    void finishDrawing() override;
+    void refresh() override;
+    void refreshLayer(int layer) override;
+
+  protected:
+    bool iszoom_;
+
+    // when calculating coordinates: this determines orientation of horizontal
+    // axis.  Normally false, only true when printing.
+    bool reverseYAxis_{false};
+
+    // the printer of P4PRINT_DEFAULT, and whether the bitmaps are printed in
+    // bands on all threads
+    QPaintDevice *printDevice_{nullptr};
+    bool printParallel_{true};
+
+    void drawFlowField(const P4FlowGrid &grid, double len,
+                       void (P4Canvas::*line)(double, double, double, double,
+                                              int));
+
+  private:
+    int printMethod_{P4PRINT_NONE};
+    QPainter *printPainter_{nullptr};
+    QString printError_;
+};
@@ -223,13 +223,10 @@ P4PlotWnd::P4PlotWnd(P4StartDlg *main) : QMainWindow{}, parent_{main}
     lcWindow_ = nullptr;
     delete gcfWindow_;
     gcfWindow_ = nullptr;
-    gThisVF->setGcfDlg(nullptr);
     delete curveWindow_;
     curveWindow_ = nullptr;
-    gThisVF->setArbitraryCurveDlg(nullptr);
     delete isoclinesWindow_;
     isoclinesWindow_ = nullptr;
-    gThisVF->setIsoclinesDlg(nullptr);
 }*/
 
 void P4PlotWnd::onSaveSignal()
@@ -306,6 +303,15 @@ void P4PlotWnd::signalEvaluated()
         it->signalEvaluated();
 }
 
+// one more finite singularity has been read, see
+// P4StartDlg::signalSingularityEvaluated
+void P4PlotWnd::signalSingularityEvaluated()
+{
+    sphere_->refresh();
+    for (auto &it : zoomWindows_)
+        it->signalEvaluated();
+}
+
 void P4PlotWnd::onBtnClose()
 {
     // qDebug() << "button close";
@@ -397,7 +403,7 @@ void P4PlotWnd::onBtnPlotAllSeps()
 {
     // qDebug() << "button plot all separatrices";
     getDlgData();
-    sphere_->prepareDrawing();
+    sphere_->prepareDrawing(P4SphereLayers::layer_separatrices);
     plot_all_sep(sphere_);
     sphere_->finishDrawing();
     flagAllSepsPlotted_ = true;
@@ -474,6 +480,17 @@ void P4PlotWnd::configure()
             }
         }
     }
+
+    // while the singularities come in one by one, the vector fields in the
+    // charts are not known and nothing can be integrated (the gcf is not
+    // read either)
+    const bool known{!gVFResults.singularitiesOnly_};
+    actOrbits_->setEnabled(known);
+    actPlotSep_->setEnabled(known);
+    actPlotAllSeps_->setEnabled(known);
+    actLimitCycles_->setEnabled(known);
+    actCurve_->setEnabled(known);
+    actIsoclines_->setEnabled(known);
 }
 
 void P4PlotWnd::openZoomWindow(double x1, double y1, double x2, double y2)
@@ -520,6 +537,16 @@ void P4PlotWnd::customEvent(QEvent *_e)
     double ucoord1[2];
     double x, y, x0, y0, x1, y1;
 
+    if (gVFResults.singularitiesOnly_) {
+        switch (static_cast<int>(e->type())) {
+        case TYPE_ORBIT_EVENT:
+        case TYPE_SELECT_ORBIT:
+        case TYPE_SELECT_LCSECTION:
+        case TYPE_SEP_EVENT:
+            return;
+        }
+    }
+
     switch (static_cast<int>(e->type())) {
     case TYPE_OPENZOOMWINDOW: {
         double *data1{static_cast<double *>(e->data())};
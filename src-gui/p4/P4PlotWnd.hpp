@@ -89,6 +89,7 @@ class P4PlotWnd : public QMainWindow
   public slots:
     // void signalEvaluating();
     void signalEvaluated();
+    void signalSingularityEvaluated();
     void signalChanged();
 
     void onBtnClose();
@@ -44,6 +44,7 @@ bool P4PrintDlg::sM_lastBlackWhite{false};
 double P4PrintDlg::sM_lastLineWidth{DEFAULT_LINEWIDTH};
 double P4PrintDlg::sM_lastSymbolSize{DEFAULT_SYMBOLSIZE};
 int P4PrintDlg::sM_lastResolution{DEFAULT_RESOLUTION};
+bool P4PrintDlg::sM_lastParallel{true};
 
 P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
 {
@@ -58,6 +59,10 @@ P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
     btn_epsimage_ = new QPushButton{"&EPS Image", this};
     btn_xfigimage_ = new QPushButton{"&XFIG Image", this};
     btn_jpeg_ = new QPushButton{"&JPEG Image", this};
+    btn_png_ = new QPushButton{"&PNG Image", this};
+    btn_tiff_ = new QPushButton{"&TIFF Image", this};
+    btn_svg_ = new QPushButton{"S&VG Image", this};
+    btn_pdf_ = new QPushButton{"P&DF Document", this};
     btn_cancel_ = new QPushButton{"&Cancel", this};
 
     auto label_1 = new QLabel{"Output resolution (in DPI): ", this};
@@ -71,6 +76,9 @@ P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
     btn_blackwhite_ = new QCheckBox{"&Black&&White printing", this};
     btn_blackwhite_->setChecked(sM_lastBlackWhite);
 
+    btn_parallel_ = new QCheckBox{"Render PNG/TIFF in para&llel", this};
+    btn_parallel_->setChecked(sM_lastParallel);
+
     auto lbl_bgcolor = new QLabel{"Print background colour:", this};
     btn_whitebg_ = new QRadioButton{"&White", this};
     btn_blackbg_ = new QRadioButton{"B&lack", this};
@@ -94,6 +102,16 @@ P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
     btn_xfigimage_->setToolTip(
         "Produce a .FIG image file that can be read using XFIG");
     btn_jpeg_->setToolTip("Produce a .JPG image file");
+    btn_png_->setToolTip("Produce a .PNG image file.\nThe image is produced "
+                         "in bands, so that high resolutions can be used.");
+    btn_tiff_->setToolTip("Produce a .TIF image file.\nThe image is produced "
+                          "in bands, so that high resolutions can be used.");
+    btn_svg_->setToolTip("Produce a .SVG (Scalable Vector Graphics) image "
+                         "file");
+    btn_pdf_->setToolTip("Produce a .PDF document of one page");
+    btn_parallel_->setToolTip(
+        "If checked, bands of PNG and TIFF images are produced on all "
+        "processor cores at the same time, using more memory");
     btn_cancel_->setToolTip("Cancel printing");
     btn_blackwhite_->setToolTip(
         "If checked, produce a black&white image, rather than a colour image");
@@ -124,6 +142,10 @@ P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
     buttons->addWidget(btn_epsimage_);
     buttons->addWidget(btn_xfigimage_);
     buttons->addWidget(btn_jpeg_);
+    buttons->addWidget(btn_png_);
+    buttons->addWidget(btn_tiff_);
+    buttons->addWidget(btn_svg_);
+    buttons->addWidget(btn_pdf_);
     buttons->addWidget(btn_cancel_);
     mainLayout_->addLayout(buttons);
 
@@ -137,6 +159,14 @@ P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
                      &P4PrintDlg::onXfigImagePrinter);
     QObject::connect(btn_jpeg_, &QPushButton::clicked, this,
                      &P4PrintDlg::onJpegImagePrinter);
+    QObject::connect(btn_png_, &QPushButton::clicked, this,
+                     &P4PrintDlg::onPngImagePrinter);
+    QObject::connect(btn_tiff_, &QPushButton::clicked, this,
+                     &P4PrintDlg::onTiffImagePrinter);
+    QObject::connect(btn_svg_, &QPushButton::clicked, this,
+                     &P4PrintDlg::onSvgImagePrinter);
+    QObject::connect(btn_pdf_, &QPushButton::clicked, this,
+                     &P4PrintDlg::onPdfImagePrinter);
     QObject::connect(btn_cancel_, &QPushButton::clicked, this,
                      &P4PrintDlg::onCancel);
     QObject::connect(btn_whitebg_, &QRadioButton::toggled, this,
@@ -146,6 +176,7 @@ P4PrintDlg::P4PrintDlg(Qt::WindowFlags f, QWidget *parent) : QDialog{parent, f}
 
     mainLayout_->addSpacing(2);
     mainLayout_->addWidget(btn_blackwhite_);
+    mainLayout_->addWidget(btn_parallel_);
     mainLayout_->addSpacing(2);
 
     auto printColourLayout = new QHBoxLayout{};
@@ -196,6 +227,7 @@ bool P4PrintDlg::readDialog()
     bool result;
 
     sM_lastBlackWhite = btn_blackwhite_->isChecked();
+    sM_lastParallel = btn_parallel_->isChecked();
 
     result = readFloatField(edt_resolution_, res, DEFAULT_RESOLUTION, 72, 4800);
     sM_lastResolution = std::floor(res);
@@ -267,6 +299,46 @@ void P4PrintDlg::onJpegImagePrinter()
         done(P4PRINT_JPEGIMAGE);
 }
 
+void P4PrintDlg::onPngImagePrinter()
+{
+    if (!readDialog())
+        return;
+    if (sM_lastBlackWhite)
+        done(-P4PRINT_PNGIMAGE);
+    else
+        done(P4PRINT_PNGIMAGE);
+}
+
+void P4PrintDlg::onTiffImagePrinter()
+{
+    if (!readDialog())
+        return;
+    if (sM_lastBlackWhite)
+        done(-P4PRINT_TIFFIMAGE);
+    else
+        done(P4PRINT_TIFFIMAGE);
+}
+
+void P4PrintDlg::onSvgImagePrinter()
+{
+    if (!readDialog())
+        return;
+    if (sM_lastBlackWhite)
+        done(-P4PRINT_SVGIMAGE);
+    else
+        done(P4PRINT_SVGIMAGE);
+}
+
+void P4PrintDlg::onPdfImagePrinter()
+{
+    if (!readDialog())
+        return;
+    if (sM_lastBlackWhite)
+        done(-P4PRINT_PDFIMAGE);
+    else
+        done(P4PRINT_PDFIMAGE);
+}
+
 void P4PrintDlg::onCancel() { done(P4PRINT_NONE); }
 
 bool P4PrintDlg::readFloatField(QLineEdit *edt, double &presult,
@@ -21,6 +21,8 @@
 
 #include <QDialog>
 
+#include "P4PlotCanvas.hpp" // P4PRINT_...
+
 class QBoxLayout;
 class QCheckBox;
 class QLineEdit;
@@ -39,6 +41,7 @@ class P4PrintDlg : public QDialog
     static double sM_lastLineWidth;
     static double sM_lastSymbolSize;
     static int sM_lastResolution;
+    static bool sM_lastParallel;
 
   private:
     QPushButton *btn_default_{nullptr};
@@ -46,8 +49,13 @@ class P4PrintDlg : public QDialog
     QPushButton *btn_xfigimage_;
     QPushButton *btn_cancel_;
     QPushButton *btn_jpeg_;
+    QPushButton *btn_png_;
+    QPushButton *btn_tiff_;
+    QPushButton *btn_svg_;
+    QPushButton *btn_pdf_;
     QBoxLayout *mainLayout_;
     QCheckBox *btn_blackwhite_;
+    QCheckBox *btn_parallel_;
 
     QRadioButton *btn_whitebg_;
     QRadioButton *btn_blackbg_;
@@ -61,6 +69,10 @@ class P4PrintDlg : public QDialog
     void onEpsImagePrinter();
     void onXfigImagePrinter();
     void onJpegImagePrinter();
+    void onPngImagePrinter();
+    void onTiffImagePrinter();
+    void onSvgImagePrinter();
+    void onPdfImagePrinter();
     void onCancel();
 
     bool readDialog();
@@ -72,9 +84,3 @@ class P4PrintDlg : public QDialog
     double getChosenLineWidth();
     double getChosenSymbolSize();
 };
-
-#define P4PRINT_NONE 0
-#define P4PRINT_DEFAULT 1
-#define P4PRINT_EPSIMAGE 2
-#define P4PRINT_XFIGIMAGE 3
-#define P4PRINT_JPEGIMAGE 4
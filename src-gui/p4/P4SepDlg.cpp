@@ -151,7 +151,7 @@ void P4SepDlg::onbtn_selectnext()
     btn_selectnext_->setEnabled(true);
     btn_intnext_->setEnabled(true);
 
-    mainSphere_->prepareDrawing();
+    mainSphere_->prepareDrawing(P4SphereLayers::layer_separatrices);
     (*select_next_sep)(mainSphere_);
     mainSphere_->finishDrawing();
 }
@@ -170,7 +170,7 @@ void P4SepDlg::onbtn_intnext()
     btn_selectnext_->setEnabled(true);
     btn_intnext_->setEnabled(true);
 
-    mainSphere_->prepareDrawing();
+    mainSphere_->prepareDrawing(P4SphereLayers::layer_separatrices);
     (*plot_next_sep)(mainSphere_, gVFResults.selected_sep_vfindex_);
     mainSphere_->finishDrawing();
 }
@@ -188,7 +188,7 @@ void P4SepDlg::onbtn_start()
     btn_selectnext_->setEnabled(true);
     btn_intnext_->setEnabled(true);
 
-    mainSphere_->prepareDrawing();
+    mainSphere_->prepareDrawing(P4SphereLayers::layer_separatrices);
     (*start_plot_sep)(mainSphere_, gVFResults.selected_sep_vfindex_);
     mainSphere_->finishDrawing();
 }
@@ -200,7 +200,7 @@ void P4SepDlg::onbtn_cont()
 
     plotWnd_->getDlgData();
 
-    mainSphere_->prepareDrawing();
+    mainSphere_->prepareDrawing(P4SphereLayers::layer_separatrices);
     (*cont_plot_sep)(mainSphere_);
     mainSphere_->finishDrawing();
 }
@@ -288,7 +288,7 @@ void P4SepDlg::onepsilon_enter()
     btn_selectnext_->setEnabled(true);
     btn_intnext_->setEnabled(true);
 
-    mainSphere_->prepareDrawing();
+    mainSphere_->prepareDrawing(P4SphereLayers::layer_separatrices);
     (*change_epsilon)(mainSphere_, eps);
     mainSphere_->finishDrawing();
 }
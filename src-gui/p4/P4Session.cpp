@@ -0,0 +1,701 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4Session.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "P4InputVF.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4PickIndex.hpp"
+#include "P4Trace.hpp"
+#include "P4TrajectoryStore.hpp"
+#include "P4VFStudy.hpp"
+#include "structures.hpp"
+
+#define SESSION_MAGIC "P4SESSN" // 8 bytes with the terminating zero
+#define SESSION_VERSION 1
+#define SESSION_BYTEORDER 0x01020304
+
+// flags of a section
+#define SESSION_COMPRESSED 1
+
+// the tables of the study, after its base name
+static const char *sTables[]{"_vec.tab", "_fin.tab", "_inf.tab",
+                             "_sepcurves.tab"};
+
+// what a curve of the session belongs to
+namespace P4SessionCurve
+{
+enum {
+    curve_orbit,
+    curve_limitcycle,
+    curve_saddlesep,      // separatrix of a saddle
+    curve_sesep,          // separatrix of a semi-elementary point
+    curve_desep,          // separatrix of a blow-up of a degenerate point
+    curve_gcf,            // zeros of the greatest common factor
+    curve_isocline,
+    curve_arbitrarycurve
+};
+}
+
+struct sessionheader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+};
+
+struct sessionsection {
+    char tag[4];
+    uint32_t flags;
+    uint64_t size;    // size in the file
+    uint64_t rawsize; // size when uncompressed
+};
+
+// Followed by the points: the first one as 3 doubles, the differences to
+// the next n-1 as 3 floats each, and then 4 bytes per point with its colour,
+// dashes, dir and type.  The record is padded to a multiple of 8 bytes.
+struct sessioncurve {
+    int32_t kind;
+    int32_t vfindex;
+    int32_t owner;    // the singularity in its list
+    int32_t index;    // the separatrix of the singularity, or the curve
+    int32_t color;    // of an orbit, limit cycle or isocline
+    uint32_t n;       // number of points
+    double start[3];  // of an orbit or limit cycle
+};
+
+// the parameters of the view and of the integration, in this order
+#define SESSION_NUMCONFIG 19
+
+// -----------------------------------------------------------------------
+//                          WRITING
+// -----------------------------------------------------------------------
+
+template <typename T> static void put(QByteArray &buf, const T &v)
+{
+    buf.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+static void pad(QByteArray &buf)
+{
+    while (buf.size() % 8 != 0)
+        buf.append('\0');
+}
+
+static void putSection(QFile &file, const char *tag, const QByteArray &data,
+                       bool compress)
+{
+    sessionsection s;
+    QByteArray packed;
+
+    memcpy(s.tag, tag, 4);
+    s.flags = 0;
+    s.rawsize = data.size();
+    if (compress) {
+        packed = qCompress(data);
+        s.flags |= SESSION_COMPRESSED;
+    } else {
+        packed = data;
+    }
+    s.size = packed.size();
+    pad(packed);
+
+    file.write(reinterpret_cast<const char *>(&s), sizeof(s));
+    file.write(packed);
+}
+
+static void putCurve(QByteArray &buf, sessioncurve c,
+                     const std::vector<const P4Orbits::orbits_points *> &pts)
+{
+    double prev[3];
+    float d;
+    int k;
+
+    c.n = static_cast<uint32_t>(pts.size());
+    put(buf, c);
+    if (pts.empty())
+        return;
+
+    for (k = 0; k < 3; k++) {
+        prev[k] = pts[0]->pcoord[k];
+        put(buf, prev[k]);
+    }
+    for (size_t i = 1; i < pts.size(); i++) {
+        for (k = 0; k < 3; k++) {
+            d = static_cast<float>(pts[i]->pcoord[k] - prev[k]);
+            put(buf, d);
+            prev[k] += d;
+        }
+    }
+    for (auto p : pts) {
+        put(buf, static_cast<uint8_t>(p->color));
+        put(buf, static_cast<int8_t>(p->dashes));
+        put(buf, static_cast<int8_t>(p->dir));
+        put(buf, static_cast<int8_t>(p->type));
+    }
+    pad(buf);
+}
+
+static void putCurve(QByteArray &buf, const sessioncurve &c,
+                     const std::vector<P4Orbits::orbits_points> &points)
+{
+    std::vector<const P4Orbits::orbits_points *> pts;
+
+    for (auto const &p : points)
+        pts.push_back(&p);
+    putCurve(buf, c, pts);
+}
+
+static void putCurve(QByteArray &buf, const sessioncurve &c,
+                     P4Orbits::orbits_points *first)
+{
+    std::vector<P4Orbits::orbits_points> points;
+
+    // all the points, not the summary of the chunks moved out of memory
+    P4CurveReader r{first, true};
+    for (auto p = r.next(); p != nullptr; p = r.next()) {
+        double pc[3]{p->pcoord[0], p->pcoord[1], p->pcoord[2]};
+        points.emplace_back(pc, p->color, p->dashes, p->dir, p->type);
+    }
+    putCurve(buf, c, points);
+}
+
+static sessioncurve curveOf(int kind, int vfindex, int owner, int index)
+{
+    return {kind, vfindex, owner, index, 0, 0, {0, 0, 0}};
+}
+
+static void putOrbits(QByteArray &buf, int kind, const P4Orbits::orbits *o)
+{
+    int index{0};
+
+    for (; o != nullptr; o = o->next, index++) {
+        sessioncurve c{curveOf(kind, -1, -1, index)};
+        c.color = o->color;
+        c.start[0] = o->pcoord[0];
+        c.start[1] = o->pcoord[1];
+        c.start[2] = o->pcoord[2];
+        putCurve(buf, c, o->firstpt);
+    }
+}
+
+static void putSeparatrices(QByteArray &buf, int kind, int vfindex,
+                            int owner, const P4Blowup::sep *s)
+{
+    for (int index = 0; s != nullptr; s = s->next_sep, index++) {
+        if (s->first_sep_point != nullptr)
+            putCurve(buf, curveOf(kind, vfindex, owner, index),
+                     s->first_sep_point);
+    }
+}
+
+static QByteArray curvesOfStudy()
+{
+    QByteArray buf;
+    int i, j, k;
+
+    putOrbits(buf, P4SessionCurve::curve_orbit, gVFResults.firstOrbit_);
+    putOrbits(buf, P4SessionCurve::curve_limitcycle,
+              gVFResults.firstLimCycle_);
+
+    for (i = 0; i < static_cast<int>(gVFResults.vf_.size()); i++) {
+        const auto &vf = gVFResults.vf_[i];
+
+        j = 0;
+        for (auto p = vf->firstSaddlePoint_; p != nullptr;
+             p = p->next_saddle, j++)
+            putSeparatrices(buf, P4SessionCurve::curve_saddlesep, i, j,
+                            p->separatrices);
+        j = 0;
+        for (auto p = vf->firstSePoint_; p != nullptr; p = p->next_se, j++)
+            putSeparatrices(buf, P4SessionCurve::curve_sesep, i, j,
+                            p->separatrices);
+        j = 0;
+        for (auto p = vf->firstDePoint_; p != nullptr; p = p->next_de, j++) {
+            k = 0;
+            for (auto b = p->blow_up; b != nullptr;
+                 b = b->next_blow_up_point, k++) {
+                if (b->first_sep_point != nullptr)
+                    putCurve(buf,
+                             curveOf(P4SessionCurve::curve_desep, i, j, k),
+                             b->first_sep_point);
+            }
+        }
+
+        if (vf->gcf_points_ != nullptr)
+            putCurve(buf, curveOf(P4SessionCurve::curve_gcf, i, -1, 0),
+                     vf->gcf_points_);
+
+        k = 0;
+        for (auto const &iso : vf->isocline_vector_) {
+            sessioncurve c{curveOf(P4SessionCurve::curve_isocline, i, -1, k++)};
+            c.color = iso.color;
+            putCurve(buf, c, iso.points);
+        }
+    }
+
+    k = 0;
+    for (auto const &curve : gVFResults.arbitraryCurves_)
+        putCurve(buf, curveOf(P4SessionCurve::curve_arbitrarycurve, -1, -1,
+                              k++),
+                 curve.points);
+
+    return buf;
+}
+
+static QByteArray configOfStudy()
+{
+    QByteArray buf;
+    const double config[SESSION_NUMCONFIG]{
+        static_cast<double>(gVFResults.typeofview_),
+        gVFResults.config_projection_,
+        gVFResults.xmin_,
+        gVFResults.xmax_,
+        gVFResults.ymin_,
+        gVFResults.ymax_,
+        static_cast<double>(gVFResults.flowField_),
+        static_cast<double>(gVFResults.plotVirtualSingularities_),
+        gVFResults.config_hma_,
+        gVFResults.config_hmi_,
+        gVFResults.config_branchhmi_,
+        gVFResults.config_step_,
+        gVFResults.config_currentstep_,
+        gVFResults.config_tolerance_,
+        static_cast<double>(gVFResults.config_intpoints_),
+        static_cast<double>(gVFResults.config_dashes_),
+        static_cast<double>(gVFResults.config_kindvf_),
+        static_cast<double>(gVFResults.config_lc_numpoints_),
+        static_cast<double>(gVFResults.config_lc_value_)};
+
+    for (auto v : config)
+        put(buf, v);
+    return buf;
+}
+
+static QByteArray hashOfFile(const QString &fname)
+{
+    QFile file{fname};
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+
+    if (file.open(QFile::ReadOnly))
+        hash.addData(&file);
+    return hash.result();
+}
+
+bool P4Session::save(const QString &fname, bool compress)
+{
+    P4TraceSpan span{"saveSession", "study"};
+    QString basename{gThisVF->getbarefilename()};
+    QByteArray tables;
+    sessionheader h;
+
+    for (auto suffix : sTables) {
+        QFile table{basename + suffix};
+        if (!table.open(QFile::ReadOnly))
+            continue;
+        QByteArray contents{table.readAll()};
+        put(tables, static_cast<uint32_t>(strlen(suffix)));
+        tables.append(suffix);
+        put(tables, static_cast<uint64_t>(contents.size()));
+        tables.append(contents);
+    }
+
+    QFile file{fname};
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    memcpy(h.magic, SESSION_MAGIC, sizeof(h.magic));
+    h.version = SESSION_VERSION;
+    h.byteorder = SESSION_BYTEORDER;
+    file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+    putSection(file, "INP ", hashOfFile(gThisVF->getfilename()), false);
+    putSection(file, "TABS", tables, compress);
+    putSection(file, "CONF", configOfStudy(), false);
+    putSection(file, "CURV", curvesOfStudy(), compress);
+
+    file.close();
+    if (file.error() != QFile::NoError) {
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                          READING
+// -----------------------------------------------------------------------
+
+// reads from a section, in place
+struct sessionreader {
+    const char *p;
+    const char *end;
+
+    template <typename T> bool get(T &v)
+    {
+        if (end - p < static_cast<ptrdiff_t>(sizeof(T)))
+            return false;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+    bool skip(size_t n)
+    {
+        if (static_cast<size_t>(end - p) < n)
+            return false;
+        p += n;
+        return true;
+    }
+};
+
+// Decodes the points of a curve and passes them to add, one by one.
+template <typename ADD>
+static bool getPoints(sessionreader &r, uint32_t n, ADD add)
+{
+    double pc[3];
+    float d[3];
+    int8_t attr[4];
+
+    if (n == 0)
+        return true;
+
+    size_t size{3 * sizeof(double) + (n - 1) * 3 * sizeof(float) + n * 4};
+    if (static_cast<size_t>(r.end - r.p) < size)
+        return false;
+
+    const char *dp{r.p + 3 * sizeof(double)};
+    const char *ap{dp + (n - 1) * 3 * sizeof(float)};
+    memcpy(pc, r.p, sizeof(pc));
+    for (uint32_t i = 0; i < n; i++) {
+        if (i > 0) {
+            memcpy(d, dp, sizeof(d));
+            dp += sizeof(d);
+            pc[0] += d[0];
+            pc[1] += d[1];
+            pc[2] += d[2];
+        }
+        memcpy(attr, ap, sizeof(attr));
+        ap += sizeof(attr);
+        add(pc, static_cast<uint8_t>(attr[0]), attr[1], attr[2], attr[3]);
+    }
+
+    r.p += size;
+    return r.skip((8 - size % 8) % 8);
+}
+
+static bool getList(sessionreader &r, uint32_t n,
+                    P4Orbits::orbits_points *&first,
+                    P4Orbits::orbits_points *&last)
+{
+    first = last = nullptr;
+    return getPoints(r, n, [&first, &last](double *pc, int color, int dashes,
+                                          int dir, int type) {
+        auto p = new P4Orbits::orbits_points{pc, color, dashes, dir, type};
+        if (last == nullptr)
+            first = p;
+        else
+            last->nextpt = p;
+        last = p;
+    });
+}
+
+static bool getVector(sessionreader &r, uint32_t n,
+                      std::vector<P4Orbits::orbits_points> &points)
+{
+    points.reserve(n);
+    return getPoints(r, n, [&points](double *pc, int color, int dashes,
+                                     int dir, int type) {
+        points.emplace_back(pc, color, dashes, dir, type);
+    });
+}
+
+template <typename T> static T *nth(T *p, T *T::*next, int n)
+{
+    for (; p != nullptr && n > 0; n--)
+        p = p->*next;
+    return p;
+}
+
+// Attaches a separatrix to what readTables has built for the study.
+static bool getSeparatrix(sessionreader &r, const sessioncurve &c)
+{
+    P4Orbits::orbits_points **first, **last;
+
+    if (c.vfindex < 0 || c.vfindex >= static_cast<int>(gVFResults.vf_.size()))
+        return false;
+    const auto &vf = gVFResults.vf_[c.vfindex];
+
+    if (c.kind == P4SessionCurve::curve_desep) {
+        auto de = nth(vf->firstDePoint_, &P4Singularities::degenerate::next_de,
+                      c.owner);
+        if (de == nullptr)
+            return false;
+        auto b = nth(de->blow_up, &P4Blowup::blow_up_points::next_blow_up_point,
+                     c.index);
+        if (b == nullptr)
+            return false;
+        first = &b->first_sep_point;
+        last = &b->last_sep_point;
+    } else {
+        P4Blowup::sep *s{nullptr};
+        if (c.kind == P4SessionCurve::curve_saddlesep) {
+            auto sa = nth(vf->firstSaddlePoint_,
+                          &P4Singularities::saddle::next_saddle, c.owner);
+            if (sa != nullptr)
+                s = sa->separatrices;
+        } else {
+            auto se = nth(vf->firstSePoint_,
+                          &P4Singularities::semi_elementary::next_se, c.owner);
+            if (se != nullptr)
+                s = se->separatrices;
+        }
+        s = nth(s, &P4Blowup::sep::next_sep, c.index);
+        if (s == nullptr)
+            return false;
+        first = &s->first_sep_point;
+        last = &s->last_sep_point;
+    }
+
+    P4TrajectoryStore::forget(first);
+    delete *first;
+    if (!getList(r, c.n, *first, *last))
+        return false;
+    P4TrajectoryStore::grown(first);
+    return true;
+}
+
+static bool getOrbit(sessionreader &r, const sessioncurve &c,
+                     P4Orbits::orbits *&first, P4Orbits::orbits *&current)
+{
+    double start[3]{c.start[0], c.start[1], c.start[2]};
+    auto o = new P4Orbits::orbits{start, c.color};
+
+    if (current == nullptr)
+        first = o;
+    else
+        current->next = o;
+    current = o;
+    if (!getList(r, c.n, o->firstpt, o->currentpt))
+        return false;
+    P4TrajectoryStore::grown(&o->firstpt);
+    return true;
+}
+
+static bool getCurves(sessionreader r)
+{
+    sessioncurve c;
+    P4Orbits::orbits_points *last;
+
+    while (r.p < r.end) {
+        if (!r.get(c))
+            return false;
+
+        switch (c.kind) {
+        case P4SessionCurve::curve_orbit:
+            if (!getOrbit(r, c, gVFResults.firstOrbit_,
+                          gVFResults.currentOrbit_))
+                return false;
+            break;
+        case P4SessionCurve::curve_limitcycle:
+            if (!getOrbit(r, c, gVFResults.firstLimCycle_,
+                          gVFResults.currentLimCycle_))
+                return false;
+            break;
+        case P4SessionCurve::curve_saddlesep:
+        case P4SessionCurve::curve_sesep:
+        case P4SessionCurve::curve_desep:
+            if (!getSeparatrix(r, c))
+                return false;
+            break;
+        case P4SessionCurve::curve_gcf:
+            if (c.vfindex < 0 ||
+                c.vfindex >= static_cast<int>(gVFResults.vf_.size()))
+                return false;
+            delete gVFResults.vf_[c.vfindex]->gcf_points_;
+            if (!getList(r, c.n, gVFResults.vf_[c.vfindex]->gcf_points_,
+                         last))
+                return false;
+            break;
+        case P4SessionCurve::curve_isocline:
+            if (c.vfindex < 0 ||
+                c.vfindex >= static_cast<int>(gVFResults.vf_.size()))
+                return false;
+            gVFResults.vf_[c.vfindex]->isocline_vector_.emplace_back(c.color);
+            if (!getVector(r, c.n,
+                           gVFResults.vf_[c.vfindex]->isocline_vector_.back()
+                               .points))
+                return false;
+            break;
+        case P4SessionCurve::curve_arbitrarycurve:
+            gVFResults.arbitraryCurves_.emplace_back();
+            if (!getVector(r, c.n, gVFResults.arbitraryCurves_.back().points))
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool getConfig(sessionreader r)
+{
+    double config[SESSION_NUMCONFIG];
+
+    for (auto &v : config)
+        if (!r.get(v))
+            return false;
+
+    gVFResults.typeofview_ = static_cast<int>(config[0]);
+    gVFResults.config_projection_ = config[1];
+    gVFResults.xmin_ = config[2];
+    gVFResults.xmax_ = config[3];
+    gVFResults.ymin_ = config[4];
+    gVFResults.ymax_ = config[5];
+    gVFResults.flowField_ = static_cast<int>(config[6]);
+    gVFResults.plotVirtualSingularities_ = config[7] != 0;
+    gVFResults.config_hma_ = config[8];
+    gVFResults.config_hmi_ = config[9];
+    gVFResults.config_branchhmi_ = config[10];
+    gVFResults.config_step_ = config[11];
+    gVFResults.config_currentstep_ = config[12];
+    gVFResults.config_tolerance_ = config[13];
+    gVFResults.config_intpoints_ = static_cast<int>(config[14]);
+    gVFResults.config_dashes_ = config[15] != 0;
+    gVFResults.config_kindvf_ = config[16] != 0;
+    gVFResults.config_lc_numpoints_ = static_cast<int>(config[17]);
+    gVFResults.config_lc_value_ = static_cast<int>(config[18]);
+    return true;
+}
+
+// Writes the tables to a temporary directory, and reads them from there as
+// if Maple had just written them.
+static bool getTables(sessionreader r)
+{
+    QTemporaryDir dir;
+    uint32_t namelen;
+    uint64_t size;
+
+    if (!dir.isValid())
+        return false;
+    QString basename{dir.path() + QDir::separator() + "session"};
+
+    while (r.p < r.end) {
+        if (!r.get(namelen) || namelen > 64 ||
+            static_cast<size_t>(r.end - r.p) < namelen)
+            return false;
+        QString suffix{QString::fromLatin1(r.p, namelen)};
+        r.p += namelen;
+        if (!r.get(size) || static_cast<uint64_t>(r.end - r.p) < size ||
+            suffix.contains('/') || suffix.contains('\\'))
+            return false;
+        QFile table{basename + suffix};
+        if (!table.open(QFile::WriteOnly) ||
+            table.write(r.p, static_cast<qint64>(size)) !=
+                static_cast<qint64>(size))
+            return false;
+        r.p += size;
+    }
+    return gVFResults.readTables(basename, false, false);
+}
+
+bool P4Session::load(const QString &fname)
+{
+    P4TraceSpan span{"loadSession", "study"};
+    QFile file{fname};
+    sessionheader h;
+    sessionsection s;
+    sessionreader sections[4];
+    QByteArray unpacked[4];
+    QByteArray contents;
+    static const char *tags[]{"INP ", "TABS", "CONF", "CURV"};
+    int k;
+
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    sessionreader r;
+    const uchar *map{file.map(0, file.size())};
+    if (map != nullptr) {
+        r.p = reinterpret_cast<const char *>(map);
+    } else {
+        contents = file.readAll();
+        r.p = contents.constData();
+    }
+    r.end = r.p + file.size();
+
+    if (!r.get(h) || memcmp(h.magic, SESSION_MAGIC, sizeof(h.magic)) ||
+        h.version != SESSION_VERSION || h.byteorder != SESSION_BYTEORDER)
+        return false;
+
+    for (k = 0; k < 4; k++) {
+        if (!r.get(s) || memcmp(s.tag, tags[k], 4) ||
+            static_cast<uint64_t>(r.end - r.p) < s.size)
+            return false;
+        sections[k].p = r.p;
+        sections[k].end = r.p + s.size;
+        if (s.flags & SESSION_COMPRESSED) {
+            unpacked[k] = qUncompress(reinterpret_cast<const uchar *>(r.p),
+                                      static_cast<int>(s.size));
+            if (static_cast<uint64_t>(unpacked[k].size()) != s.rawsize)
+                return false;
+            sections[k].p = unpacked[k].constData();
+            sections[k].end = sections[k].p + s.rawsize;
+        }
+        r.p += s.size;
+        r.skip((8 - s.size % 8) % 8);
+    }
+
+    QByteArray hash{sections[0].p,
+                    static_cast<int>(sections[0].end - sections[0].p)};
+    if (hash != hashOfFile(gThisVF->getfilename()))
+        return false;
+
+    // readTables resets the study; the view and the curves come after it
+    if (!getTables(sections[1]))
+        return false;
+    if (!getConfig(sections[2]) || !getCurves(sections[3])) {
+        gVFResults.reset();
+        return false;
+    }
+    gVFResults.setupCoordinateTransformations();
+    gPickIndex.invalidate();
+    return true;
+}
+
+QByteArray P4Session::keepCurves() { return curvesOfStudy(); }
+
+bool P4Session::restoreCurves(const QByteArray &curves)
+{
+    sessionreader r{curves.constData(), curves.constData() + curves.size()};
+
+    if (!getCurves(r))
+        return false;
+    gPickIndex.invalidate();
+    return true;
+}
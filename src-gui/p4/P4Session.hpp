@@ -0,0 +1,54 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+// Session files (.p4s) keep a phase portrait as it is plotted: the tables
+// of the study, the view and integration parameters, and every orbit,
+// separatrix, limit cycle and curve that has been computed.  Opening one
+// shows the portrait again without Maple and without integrating anything.
+//
+// The file is a header followed by sections, each with a tag and a size.
+// A curve is stored as its first point, in doubles, and the differences to
+// the next points as floats.  Each difference is taken from the point as it
+// will be decoded, so that the rounding errors do not add up along the
+// curve.  Sections can be compressed with zlib.  On open, the file is
+// memory-mapped, and uncompressed sections are decoded straight from the
+// map.  Numbers are in the byte order of the machine that wrote the file;
+// files from a machine with another byte order are refused.
+
+class P4Session
+{
+  public:
+    // stores gVFResults, with the tables and the .inp file of gThisVF
+    static bool save(const QString &fname, bool compress);
+    // replaces gVFResults by the session, if it was saved from the same
+    // .inp file as the one of gThisVF
+    static bool load(const QString &fname);
+
+    // the curves of gVFResults, in the format of a session file, to be put
+    // back by restoreCurves after readTables has read the study again
+    static QByteArray keepCurves();
+    // attaches the curves to the study that readTables has built; the
+    // singularities must have kept their places in the lists of each vf
+    static bool restoreCurves(const QByteArray &curves);
+};
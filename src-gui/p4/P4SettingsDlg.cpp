@@ -21,12 +21,14 @@
 
 #include <QBoxLayout>
 #include <QButtonGroup>
+#include <QCheckBox>
 #include <QFileDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QSpinBox>
 #include <QString>
 #include <QWidget>
 
@@ -107,6 +109,25 @@ P4SettingsDlg::P4SettingsDlg(QWidget *parent, Qt::WindowFlags f)
     btn_maple_ = new QPushButton{"Browse...", this};
     lbl_maple->setBuddy(edt_maple_);
 
+    edt_trace_ = new QLineEdit{getP4TraceFile(), this};
+    auto lbl_trace = new QLabel{"T&race File", this};
+    lbl_trace->setBuddy(edt_trace_);
+
+    chk_compress_ = new QCheckBox{"Com&press saved plots", this};
+    chk_compress_->setChecked(getCompressSessions());
+
+    chk_certify_ = new QCheckBox{"Certify &Lyapunov constants", this};
+    chk_certify_->setChecked(getCertifyLyapunov());
+
+    spin_budget_ = new QSpinBox{this};
+    spin_budget_->setRange(0, 1024 * 1024);
+    spin_budget_->setSingleStep(256);
+    spin_budget_->setSuffix(" MB");
+    spin_budget_->setSpecialValueText("No limit");
+    spin_budget_->setValue(getMemoryBudget());
+    auto lbl_budget = new QLabel{"Memor&y for Curves", this};
+    lbl_budget->setBuddy(spin_budget_);
+
     auto lbl_bgcolor = new QLabel{"Plot background color", this};
     btn_bgblack_ = new QRadioButton{"Black", this};
     btn_bgwhite_ = new QRadioButton{"White", this};
@@ -139,6 +160,24 @@ P4SettingsDlg::P4SettingsDlg(QWidget *parent, Qt::WindowFlags f)
                           "directory.");
     edt_maple_->setToolTip(
         "The name of the Maple executable (command-line version)");
+    edt_trace_->setToolTip(
+        "Records a timeline of the evaluation and the plotting in this file, "
+        "in the\nChrome trace-event format, from the next start of P4 on.  "
+        "Leave blank\nwhen no timeline is needed.  The environment "
+        "variable P4_TRACE\ntakes precedence.");
+    chk_compress_->setToolTip(
+        "When a vector field is saved with its plot open, the orbits and\n"
+        "separatrices are saved too, in a .p4s file.  Compressing makes\n"
+        "the file smaller, and opening it a little slower.");
+    chk_certify_->setToolTip(
+        "Computes the Lyapunov constants of every weak focus with interval\n"
+        "arithmetic, so that their signs are certain.  This is much slower.\n"
+        "Otherwise, only the constants whose sign may be wrong in double\n"
+        "precision are certified.");
+    spin_budget_->setToolTip(
+        "Orbits and separatrices that do not fit in this memory are moved\n"
+        "to a temporary file.  The plot window then draws a summary of\n"
+        "them, and reads them back for zoom windows and for printing.");
     // edt_red->setToolTip("The name of the reduce executable");
 
     btn_ok_->setToolTip("Store changes, and go back to program");
@@ -182,6 +221,12 @@ P4SettingsDlg::P4SettingsDlg(QWidget *parent, Qt::WindowFlags f)
     lay00->addWidget(lbl_maple, 3, 0);
     lay00->addWidget(edt_maple_, 3, 1);
     lay00->addWidget(btn_maple_, 3, 2);
+    lay00->addWidget(lbl_trace, 4, 0);
+    lay00->addWidget(edt_trace_, 4, 1);
+    lay00->addWidget(chk_compress_, 5, 1);
+    lay00->addWidget(chk_certify_, 6, 1);
+    lay00->addWidget(lbl_budget, 7, 0);
+    lay00->addWidget(spin_budget_, 7, 1);
 
     auto bgbuttons = new QHBoxLayout{};
     bgbuttons->addWidget(lbl_bgcolor);
@@ -290,6 +335,11 @@ void P4SettingsDlg::onOk()
 
     setMapleExe(addQuotes(s));
 
+    setP4TraceFile(stripQuotes(stripQuotes(edt_trace_->text()).trimmed()));
+    setCompressSessions(chk_compress_->isChecked());
+    setCertifyLyapunov(chk_certify_->isChecked());
+    setMemoryBudget(spin_budget_->value());
+
     done(1);
 }
 
@@ -299,6 +349,10 @@ void P4SettingsDlg::onReset()
     edt_sum_->setText(stripQuotes(getDefaultP4SumTablePath()));
     edt_temp_->setText(stripQuotes(getDefaultP4TempPath()));
     edt_maple_->setText(stripQuotes(getDefaultMapleInstallation()));
+    edt_trace_->setText("");
+    chk_compress_->setChecked(true);
+    chk_certify_->setChecked(false);
+    spin_budget_->setValue(0);
 }
 
 void P4SettingsDlg::onBrowseMaple()
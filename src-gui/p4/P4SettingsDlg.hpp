@@ -23,9 +23,11 @@
 
 class QBoxLayout;
 class QButtonGroup;
+class QCheckBox;
 class QLineEdit;
 class QPushButton;
 class QRadioButton;
+class QSpinBox;
 class QString;
 class QWidget;
 
@@ -50,6 +52,12 @@ class P4SettingsDlg : public QDialog
     QLineEdit *edt_maple_;
     QPushButton *btn_maple_;
 
+    QLineEdit *edt_trace_;
+
+    QCheckBox *chk_compress_;
+    QCheckBox *chk_certify_;
+    QSpinBox *spin_budget_;
+
     QRadioButton *btn_bgblack_;
     QRadioButton *btn_bgwhite_;
 
@@ -30,15 +30,19 @@
 #include <QResizeEvent>
 #include <QStatusBar>
 #include <QTimer>
+#include <QtConcurrentRun>
 
+#include <algorithm>
 #include <cmath>
 #include <utility>
 
 #include "P4Application.hpp"
 #include "P4Event.hpp"
 #include "P4ParentStudy.hpp"
+#include "P4PickIndex.hpp"
 #include "P4PrintDlg.hpp"
 #include "P4StartDlg.hpp"
+#include "P4Trace.hpp"
 #include "custom.hpp"
 #include "main.hpp"
 #include "math_arbitrarycurve.hpp"
@@ -49,16 +53,10 @@
 #include "math_limitcycles.hpp"
 #include "math_orbits.hpp"
 #include "math_p4.hpp"
+#include "math_refine.hpp"
 #include "math_separatrice.hpp"
 #include "plot_points.hpp"
 #include "plot_tools.hpp"
-#include "print_bitmap.hpp"
-#include "print_points.hpp"
-#include "print_postscript.hpp"
-#include "print_xfig.hpp"
-
-QPixmap *sP4pixmap;
-static double sP4pixmapDPM{0};
 
 int P4Sphere::sM_numSpheres{0};
 QVector<P4Sphere *> P4Sphere::sM_sphereList;
@@ -80,7 +78,8 @@ QVector<P4Sphere *> P4Sphere::sM_sphereList;
 
 P4Sphere::P4Sphere(QStatusBar *bar, bool isZoom, double x1, double y1,
                    double x2, double y2, QWidget *parent)
-    : QWidget{parent}, parentWnd_{parent}, msgBar_{bar}, iszoom_{isZoom}
+    : QWidget{parent}, P4PlotCanvas{isZoom, x1, y1, x2, y2},
+      parentWnd_{parent}, msgBar_{bar}
 {
     // qDebug() << "called constructor";
     // setAttribute(Qt::WA_PaintOnScreen);
@@ -104,21 +103,30 @@ P4Sphere::P4Sphere(QStatusBar *bar, bool isZoom, double x1, double y1,
     setFocusPolicy(Qt::ClickFocus);
     setWindowFlags(windowFlags());
 
-    if (iszoom_) {
-        x0_ = x1;
-        y0_ = y1;
-        x1_ = x2;
-        y1_ = y2;
-    }
-
     paintedXMax_ = w_;
     paintedYMax_ = h_;
+
+    for (auto &dirty : isLayerDirty_)
+        dirty = true;
+
+    renderWatcher_ = new QFutureWatcher<QImage>{this};
+    QObject::connect(renderWatcher_, &QFutureWatcher<QImage>::finished, this,
+                     &P4Sphere::onRenderFinished);
+
+    recordTimer_ = new QTimer{this};
+    recordTimer_->setSingleShot(true);
+    recordTimer_->setInterval(0);
+    QObject::connect(recordTimer_, &QTimer::timeout, this,
+                     &P4Sphere::recordNextLayer);
 }
 
 P4Sphere::~P4Sphere()
 {
     int i;
 
+    cancelRender();
+    renderWatcher_->waitForFinished();
+
     for (i = 0; i < sM_numSpheres; i++) {
         if (sM_sphereList[i] == this)
             break;
@@ -140,6 +148,7 @@ P4Sphere::~P4Sphere()
     B       backward integration of orbit
     D       delete orbit
     A       delete all orbits
+    Delete  delete the orbit selected with the right mouse button
 
     Shift+C continue integrate separatrice
     Shift+N next separatrice
@@ -209,6 +218,15 @@ void P4Sphere::keyPressEvent(QKeyEvent *e)
             gP4app->postEvent(parentWnd_, e1);
         }
         break;
+    case Qt::Key_Delete:
+        if (bs == Qt::NoModifier && gVFResults.selectedOrbit_ != nullptr) {
+            // DEL: delete selected orbit
+            data1 = new int{4};
+            auto e1 =
+                new P4Event{static_cast<QEvent::Type>(TYPE_ORBIT_EVENT), data1};
+            gP4app->postEvent(parentWnd_, e1);
+        }
+        break;
     case Qt::Key_N:
         if (bs == Qt::ShiftModifier ||
             bs == Qt::AltModifier + Qt::ShiftModifier) {
@@ -244,98 +262,21 @@ void P4Sphere::keyPressEvent(QKeyEvent *e)
     e->ignore();
 }
 
-static QString makechartstring(int p, int q, bool isu1v1chart, bool negchart)
-{
-    QString buf;
-
-    if (isu1v1chart) {
-        // make { x = +/- 1/z2^p, y = z1/z2^q }
-
-        if (p != 1 && q != 1)
-            buf.sprintf("{x=%d/z2^%d,y=z1/z2^%d}", (negchart ? -1 : 1), p, q);
-        else if (p == 1 && q != 1)
-            buf.sprintf("{x=%d/z2,y=z1/z2^%d}", (negchart ? -1 : 1), q);
-        else if (p != 1 && q == 1)
-            buf.sprintf("{x=%d/z2^%d,y=z1/z2}", (negchart ? -1 : 1), p);
-        else
-            buf.sprintf("{x=%d/z2,y=z1/z2}", (negchart ? -1 : 1));
-    } else {
-        // make { x = 1/z2^p, y = +/- z1/z2^q }
-
-        if (p != 1 && q != 1)
-            buf.sprintf("{x=z1/z2^%d,y=%d/z2^%d}", p, (negchart ? -1 : 1), q);
-        else if (p == 1 && q != 1)
-            buf.sprintf("{x=z1/z2,y=%d/z2^%d}", (negchart ? -1 : 1), q);
-        else if (p != 1 && q == 1)
-            buf.sprintf("{x=z1/z2^%d,y=%d/z2}", p, (negchart ? -1 : 1));
-        else
-            buf.sprintf("{x=z1/z2,y=%d/z2}", (negchart ? -1 : 1));
-    }
-
-    return buf;
-}
-
 void P4Sphere::setupPlot()
 {
     QPalette palette;
 
-    spherebgcolor_ = P4ColourSettings::colour_background;
-    palette.setColor(backgroundRole(), P4Colours::p4XfigColour(spherebgcolor_));
-    setPalette(palette);
+    // the refine jobs of this window were made for the old view
+    stopRefinedCurves();
 
     circleAtInfinity_.clear();
     plCircle_.clear();
+    gPickIndex.invalidate();
 
-    if (!iszoom_) {
-        switch (gVFResults.typeofview_) {
-        case P4TypeOfView::typeofview_plane:
-        case P4TypeOfView::typeofview_U1:
-        case P4TypeOfView::typeofview_U2:
-        case P4TypeOfView::typeofview_V1:
-        case P4TypeOfView::typeofview_V2:
-            x0_ = gVFResults.xmin_;
-            y0_ = gVFResults.ymin_;
-            x1_ = gVFResults.xmax_;
-            y1_ = gVFResults.ymax_;
-            break;
-        case P4TypeOfView::typeofview_sphere:
-            x0_ = -1.1;
-            y0_ = -1.1;
-            x1_ = 1.1;
-            y1_ = 1.1;
-            break;
-        }
-    }
-
-    dx_ = x1_ - x0_;
-    dy_ = y1_ - y0_;
-
-    // double idealhd{std::round(w_ / dx_ * dy_)};
+    setupView();
 
-    switch (gVFResults.typeofview_) {
-    case P4TypeOfView::typeofview_plane:
-        chartstring_ = "";
-        break;
-    case P4TypeOfView::typeofview_sphere:
-        chartstring_ = "";
-        break;
-    case P4TypeOfView::typeofview_U1:
-        chartstring_ =
-            makechartstring(gVFResults.p_, gVFResults.q_, true, false);
-        break;
-    case P4TypeOfView::typeofview_U2:
-        chartstring_ =
-            makechartstring(gVFResults.p_, gVFResults.q_, false, false);
-        break;
-    case P4TypeOfView::typeofview_V1:
-        chartstring_ =
-            makechartstring(gVFResults.p_, gVFResults.q_, true, true);
-        break;
-    case P4TypeOfView::typeofview_V2:
-        chartstring_ =
-            makechartstring(gVFResults.p_, gVFResults.q_, false, true);
-        break;
-    }
+    palette.setColor(backgroundRole(), P4Colours::p4XfigColour(spherebgcolor_));
+    setPalette(palette);
 
     if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere) {
         circleAtInfinity_ =
@@ -345,6 +286,11 @@ void P4Sphere::setupPlot()
                                        coWinH(RADIUS), coWinV(RADIUS));
     }
 
+    // the visible part of the view has changed
+    for (auto &dirty : isLayerDirty_)
+        dirty = true;
+    flowGrid_.invalidate();
+    clearRefinedCurves();
     isPainterCacheDirty_ = true;
 }
 
@@ -405,9 +351,9 @@ void P4Sphere::loadAnchorMap()
         paint.drawPixmap(0, ah - 1, aw, 1, *painterCache_, x1, y2, aw, 1);
         paint.drawPixmap(0, 0, 1, ah, *painterCache_, x1, y1, 1, ah);
         paint.drawPixmap(aw - 1, 0, 1, ah, *painterCache_, x2, y1, 1, ah);*/
-        paint.drawPixmap(0, 0, aw, ah, *painterCache_, x1, y1, aw, ah);
+        paint.drawImage(0, 0, *painterCache_, x1, y1, aw, ah);
     } else {
-        paint.drawPixmap(0, 0, aw, ah, *painterCache_, x1, y1, aw, ah);
+        paint.drawImage(0, 0, *painterCache_, x1, y1, aw, ah);
     }
 }
 
@@ -495,66 +441,12 @@ void P4Sphere::adjustToNewSize()
                                        coWinH(RADIUS), coWinV(RADIUS));
     }
 
-    if (painterCache_ != nullptr) {
-        delete painterCache_;
-        painterCache_ = new QPixmap{size()};
-        isPainterCacheDirty_ = false;
-
-        QPainter paint{painterCache_};
-        paint.fillRect(0, 0, width(), height(),
-                       QColor(P4Colours::p4XfigColour(
-                           P4ColourSettings::colour_background)));
-
-        paint.setPen(
-            P4Colours::p4XfigColour(P4ColourSettings::colour_line_at_infinity));
-        staticPainter_ = &paint;
-
-        // Mental note: do not use prepareDrawing/FinishDrawing here,
-        // since it is not good to do drawing for all spheres every time we
-        // get a paint event from windows
-
-        if (gVFResults.typeofview_ != P4TypeOfView::typeofview_plane) {
-            if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere) {
-                if (gVFResults.plweights_)
-                    plotPoincareLyapunovSphere();
-                else
-                    plotPoincareSphere();
-            } else
-                plotLineAtInfinity();
-        }
-        // during resizing : only plot essential information
-        //      plotSeparatrices();
-        //      plotGcf();
-        //      DrawOrbits(this);
-        //      DrawLimitCycles(this);
-        plotPoints();
-
-        QColor c{P4Colours::p4XfigColour(P4Colours::white)};
-        c.setAlpha(128);
-        paint.setPen(c);
-        paint.drawText(0, 0, width(), height(),
-                       Qt::AlignHCenter | Qt::AlignVCenter, "Resizing ...  ");
-
-        staticPainter_ = nullptr;
-
-        if (refreshTimeout_ != nullptr)
-            refreshTimeout_->stop();
-        else {
-            refreshTimeout_ = new QTimer{};
-            QObject::connect(refreshTimeout_, &QTimer::timeout, this,
-                             &P4Sphere::refreshAfterResize);
-        }
-        refreshTimeout_->start(500);
-    }
-}
-
-void P4Sphere::refreshAfterResize()
-{
-    if (refreshTimeout_ != nullptr) {
-        delete refreshTimeout_;
-        refreshTimeout_ = nullptr;
-    }
-    refresh();
+    // The display lists are in view coordinates, so they are only replayed
+    // at the new size.  Until then, the last frame remains on screen.  Only
+    // the direction field is recorded again, as its grid is in pixels.
+    isLayerDirty_[P4SphereLayers::layer_flow_field] = true;
+    cancelRender();
+    isPainterCacheDirty_ = true;
 }
 
 void P4Sphere::resizeEvent(QResizeEvent *e)
@@ -568,63 +460,248 @@ void P4Sphere::resizeEvent(QResizeEvent *e)
 void P4Sphere::paintEvent(QPaintEvent *p)
 {
     // qDebug() << "paint event";
-    if (gThisVF->evaluating_)
+    // while Maple runs, only what has been read of it can be shown
+    if (gThisVF->evaluating_ && !gVFResults.partial_)
         return;
 
-    if (painterCache_ == nullptr || isPainterCacheDirty_) {
-        if (painterCache_ == nullptr) {
-            // qDebug() << "  creating new QPixmap painterCache_...";
-            painterCache_ = new QPixmap{size()};
-        }
+    P4TraceSpan span{"paint", "plot"};
+
+    if (isPainterCacheDirty_) {
+        // The paint event only shows the last frame.  The layers that have
+        // changed are walked again later on, the others are taken as they
+        // are, and rasterizing happens off the GUI thread.
         isPainterCacheDirty_ = false;
+        recordTimer_->start();
+    }
+
+    QPainter widgetpaint{this};
+    if (painterCache_ == nullptr || painterCache_->size() != size()) {
+        // the last frame was rendered at another size (or not at all yet)
+        widgetpaint.fillRect(rect(), P4Colours::p4XfigColour(
+                                         P4ColourSettings::colour_background));
+    }
+    if (painterCache_ != nullptr)
+        widgetpaint.drawImage(0, 0, *painterCache_);
+
+    if (selectingPointStep_ != 0) {
+        widgetpaint.setPen(P4Colours::p4XfigColour(P4Colours::white));
+        widgetpaint.setBrush(Qt::NoBrush);
+        widgetpaint.drawEllipse(selectingX_ - selectingPointRadius_,
+                                selectingY_ - selectingPointRadius_,
+                                selectingPointRadius_ + selectingPointRadius_,
+                                selectingPointRadius_ + selectingPointRadius_);
+    }
+}
+
+// Records the first dirty layer, and comes back for the next one after the
+// events that have arrived in the mean time.  When all layers are recorded,
+// the frame is rendered.
+void P4Sphere::recordNextLayer()
+{
+    if (gThisVF->evaluating_ && !gVFResults.partial_) {
+        // the next paint event comes back here
+        isPainterCacheDirty_ = true;
+        return;
+    }
+
+    markStoppedRefineJobs();
+    for (int layer = 0; layer < P4SphereLayers::numLayers; layer++) {
+        if (isLayerDirty_[layer]) {
+            recordLayer(layer);
+            recordTimer_->start();
+            return;
+        }
+    }
+    startRender();
+}
+
+// Walks the data of one layer, recording its primitives in a new display
+// list of the layer instead of painting them.
+//
+// The curves are transformed to view coordinates only once by plot_l and
+// plot_p, which hand them to every sphere.  So every other sphere on which
+// the layer is dirty records it in the same walk, each clipping to its own
+// window.  The direction field, the line at infinity and the singular points
+// are plotted for this sphere only, and so are the orbits and separatrices on
+// a sphere that refines curves.
+void P4Sphere::recordLayer(int layer)
+{
+    P4TraceSpan span{"recordLayer", "plot", "layer", layer};
+    bool refined{layer == P4SphereLayers::layer_orbits ||
+                 layer == P4SphereLayers::layer_separatrices};
+    bool shared{layer != P4SphereLayers::layer_flow_field &&
+                layer != P4SphereLayers::layer_line_at_infinity &&
+                layer != P4SphereLayers::layer_points &&
+                !(refined && refineCurves_)};
 
-        // qDebug() << "creating new QPainter from QPixmap painterCache_...";
-        QPainter paint{painterCache_};
-        paint.fillRect(0, 0, width(), height(),
-                       QColor(P4Colours::p4XfigColour(
-                           P4ColourSettings::colour_background)));
-
-        paint.setPen(
-            P4Colours::p4XfigColour(P4ColourSettings::colour_line_at_infinity));
-
-        staticPainter_ = &paint;
-
-        // Mental note: do not use prepareDrawing/FinishDrawing here,
-        // since it is not good to do drawing for all spheres every time we
-        // get a paint event from windows
-
-        if (gVFResults.typeofview_ != P4TypeOfView::typeofview_plane) {
-            if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere) {
-                if (gVFResults.plweights_)
-                    plotPoincareLyapunovSphere();
-                else
-                    plotPoincareSphere();
-            } else
-                plotLineAtInfinity();
+    for (auto const &it : sM_sphereList) {
+        if (it == this || (shared && it->isLayerDirty_[layer] &&
+                           it->staticPainter_ == nullptr &&
+                           !(refined && it->refineCurves_))) {
+            it->recorded_.reset(new P4DisplayList);
+            it->recording_ = it->recorded_.get();
         }
+    }
+    if (refined && refineCurves_)
+        refining_.reset(new P4RefineJob{this});
+
+    switch (layer) {
+    case P4SphereLayers::layer_flow_field:
+        plotFlowField();
+        break;
+    case P4SphereLayers::layer_line_at_infinity:
+        if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere) {
+            if (gVFResults.plweights_)
+                plotPoincareLyapunovSphere();
+            else
+                plotPoincareSphere();
+        } else if (gVFResults.typeofview_ != P4TypeOfView::typeofview_plane)
+            plotLineAtInfinity();
+        break;
+    case P4SphereLayers::layer_separating_curves:
         plotSeparatingCurves();
+        break;
+    case P4SphereLayers::layer_separatrices:
         plotSeparatrices();
+        break;
+    case P4SphereLayers::layer_gcf:
         plotGcf();
+        break;
+    case P4SphereLayers::layer_arbitrary_curves:
         plotArbitraryCurves();
+        break;
+    case P4SphereLayers::layer_isoclines:
         plotIsoclines();
+        break;
+    case P4SphereLayers::layer_orbits:
         drawOrbits(this);
+        break;
+    case P4SphereLayers::layer_limit_cycles:
         drawLimitCycles(this);
+        break;
+    case P4SphereLayers::layer_points:
         plotPoints();
+        break;
+    }
 
-        staticPainter_ = nullptr;
+    for (auto const &it : sM_sphereList) {
+        if (it->recording_ != nullptr) {
+            it->layers_[layer].assign(1, std::move(it->recorded_));
+            it->refineJobs_[layer].reset();
+            if (it->refining_ != nullptr && !it->refining_->empty())
+                it->refineJobs_[layer] = std::move(it->refining_);
+            it->refining_.reset();
+            it->recording_ = nullptr;
+            it->isLayerDirty_[layer] = false;
+        }
     }
+}
 
-    QPainter widgetpaint{this};
-    widgetpaint.drawPixmap(0, 0, *painterCache_);
+P4WinTransform P4Sphere::winTransform() const
+{
+    return P4WinTransform{x0_, y0_, (w_ - 1) / dx_, (h_ - 1) / dy_, w_, h_,
+                          reverseYAxis_};
+}
 
-    if (selectingPointStep_ != 0) {
-        widgetpaint.setPen(P4Colours::p4XfigColour(P4Colours::white));
-        widgetpaint.setBrush(Qt::NoBrush);
-        widgetpaint.drawEllipse(selectingX_ - selectingPointRadius_,
-                                selectingY_ - selectingPointRadius_,
-                                selectingPointRadius_ + selectingPointRadius_,
-                                selectingPointRadius_ + selectingPointRadius_);
+// what the render takes of a layer
+struct p4renderlayer {
+    std::vector<std::shared_ptr<const P4DisplayList>> lists;
+    std::shared_ptr<const P4RefineJob> refine;
+};
+
+// Runs on a worker thread: the display lists and refine jobs it is given are
+// not changed anymore, and it gives up as soon as the render is superseded.
+// The curves of a zoom window that refines are integrated again here, on
+// top of the rest of their layer.
+static QImage rasterizeLayers(QSize size, P4WinTransform t, int bgcolor,
+                              std::vector<p4renderlayer> layers,
+                              std::shared_ptr<std::atomic<bool>> cancel)
+{
+    P4TraceSpan span{"rasterize", "plot"};
+    QImage image{size, QImage::Format_RGB32};
+    image.fill(P4Colours::p4XfigColour(bgcolor));
+
+    QPainter paint{&image};
+    for (auto const &it : layers) {
+        for (auto const &l : it.lists) {
+            if (*cancel)
+                return image;
+            l->replay(&paint, t, cancel.get());
+        }
+        if (it.refine != nullptr) {
+            P4TraceSpan refine{"refine", "plot"};
+            P4DisplayList refined;
+            if (!it.refine->run(refined, cancel.get()))
+                return image;
+            refined.replay(&paint, t, cancel.get());
+        }
+    }
+    return image;
+}
+
+void P4Sphere::startRender()
+{
+    std::vector<p4renderlayer> layers;
+
+    cancelRender();
+    renderCancel_ = std::make_shared<std::atomic<bool>>(false);
+
+    // only the pointers are copied
+    for (int layer = 0; layer < P4SphereLayers::numLayers; layer++)
+        layers.push_back({layers_[layer], refineJobs_[layer]});
+    renderWatcher_->setFuture(QtConcurrent::run(
+        rasterizeLayers, size(), winTransform(),
+        P4ColourSettings::colour_background, std::move(layers),
+        renderCancel_));
+}
+
+// The layers whose refine jobs were stopped (see stopRefinedCurves) are
+// marked dirty.  Returns whether there were any.
+bool P4Sphere::markStoppedRefineJobs()
+{
+    bool stopped{false};
+
+    for (int layer = 0; layer < P4SphereLayers::numLayers; layer++) {
+        if (refineJobs_[layer] != nullptr && refineJobs_[layer]->isStopped()) {
+            refineJobs_[layer].reset();
+            isLayerDirty_[layer] = true;
+            stopped = true;
+        }
+    }
+    return stopped;
+}
+
+void P4Sphere::cancelRender()
+{
+    if (renderCancel_ != nullptr)
+        *renderCancel_ = true;
+}
+
+// Swaps in the finished frame.  This happens on the GUI thread, so it is
+// never seen half-way by a paint event.
+void P4Sphere::onRenderFinished()
+{
+    if (!renderWatcher_->isFinished() || *renderCancel_)
+        return; // superseded
+
+    // a refine job was stopped while the frame was rendered, so the frame
+    // lacks its curves: they are recorded and rendered again
+    if (markStoppedRefineJobs()) {
+        isPainterCacheDirty_ = true;
+        update();
+        return;
     }
+
+    if (painterCache_ == nullptr)
+        painterCache_ = new QImage{renderWatcher_->result()};
+    else
+        *painterCache_ = renderWatcher_->result();
+
+    // a selection rectangle drawn on the old frame is gone now
+    delete anchorMap_;
+    anchorMap_ = nullptr;
+
+    update();
 }
 
 void P4Sphere::markSelection(int x1, int y1, int x2, int y2, int selectiontype)
@@ -811,56 +888,6 @@ void P4Sphere::mouseMoveEvent(QMouseEvent *e)
     }
 }
 
-double P4Sphere::coWorldX(int x)
-{
-    double wx{static_cast<double>(x) / (w_ - 1)};
-    return (wx * dx_ + x0_);
-}
-
-double P4Sphere::coWorldY(int y)
-{
-    double wy{static_cast<double>(h_ - 1 - y) / (h_ - 1)};
-
-    return (wy * dy_ + y0_);
-}
-
-int P4Sphere::coWinH(double deltax)
-{
-    double wx{deltax / dx_ * (w_ - 1)};
-
-    return static_cast<int>(std::round(wx));
-}
-
-int P4Sphere::coWinV(double deltay)
-{
-    double wy{deltay / dy_ * (h_ - 1)};
-
-    return static_cast<int>(std::round(wy));
-}
-
-int P4Sphere::coWinX(double x)
-{
-    double wx{(x - x0_) / dx_ * (w_ - 1)};
-    int iwx{static_cast<int>(std::round(wx))};
-
-    if (iwx >= w_)
-        iwx = w_ - 1;
-
-    return iwx;
-}
-
-int P4Sphere::coWinY(double y)
-{
-    double wy{(y - y0_) / dy_ * (h_ - 1)};
-    int iwy{static_cast<int>(std::round(wy))};
-
-    if (iwy >= h_)
-        iwy = h_ - 1;
-
-    // on screen: vertical axis orientation is reversed
-    return (reverseYAxis_) ? iwy : h_ - 1 - iwy;
-}
-
 void P4Sphere::mousePressEvent(QMouseEvent *e)
 {
     if (e->button() == Qt::LeftButton) {
@@ -905,10 +932,12 @@ void P4Sphere::mousePressEvent(QMouseEvent *e)
         if (selectingZoom_) {
             saveAnchorMap();
             selectingZoom_ = false;
-        }
-        if (selectingLCSection_) {
+        } else if (selectingLCSection_) {
             saveAnchorMap();
             selectingLCSection_ = false;
+        } else {
+            // otherwise select the nearest orbit, to delete it
+            selectNearestOrbit(e->pos());
         }
     }
     QWidget::mousePressEvent(e);
@@ -947,34 +976,6 @@ void P4Sphere::mouseReleaseEvent(QMouseEvent *e)
     QWidget::mouseReleaseEvent(e);
 }
 
-bool P4Sphere::getChartPos(int chart, double x0_, double y0_, double *pos)
-{
-    double pcoord[3];
-
-    switch (chart) {
-    case P4Charts::chart_R2:
-        MATHFUNC(finite_to_viewcoord)(x0_, y0_, pos);
-        break;
-    case P4Charts::chart_U1:
-        MATHFUNC(U1_to_sphere)(x0_, 0, pcoord);
-        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
-        break;
-    case P4Charts::chart_U2:
-        MATHFUNC(U2_to_sphere)(x0_, 0, pcoord);
-        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
-        break;
-    case P4Charts::chart_V1:
-        MATHFUNC(V1_to_sphere)(x0_, 0, pcoord);
-        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
-        break;
-    case P4Charts::chart_V2:
-        MATHFUNC(V2_to_sphere)(x0_, 0, pcoord);
-        MATHFUNC(sphere_to_viewcoord)(pcoord[0], pcoord[1], pcoord[2], pos);
-        break;
-    }
-    return true;
-}
-
 void P4Sphere::updatePointSelection()
 {
     if (selectingPointStep_ == 0) {
@@ -994,11 +995,31 @@ void P4Sphere::updatePointSelection()
            selectingPointRadius_ + selectingPointRadius_ + 1);
 }
 
+// animate a growing circle around the selected point
+void P4Sphere::flashPointSelection(int px, int py)
+{
+    if (selectingTimer_ != nullptr) {
+        delete selectingTimer_;
+        selectingTimer_ = nullptr;
+        selectingPointStep_ = 0;
+        updatePointSelection();
+    }
+
+    selectingPointStep_ = SELECTINGPOINTSTEPS - 1;
+    selectingX_ = px;
+    selectingY_ = py;
+
+    selectingTimer_ = new QTimer{};
+    QObject::connect(selectingTimer_, &QTimer::timeout, this,
+                     &P4Sphere::updatePointSelection);
+    selectingTimer_->start(SELECTINGPOINTSPEED);
+}
+
 void P4Sphere::selectNearestSingularity(const QPoint &winpos)
 {
     int x{winpos.x()}, y{winpos.y()};
 
-    sM_sphereList.back()->prepareDrawing();
+    sM_sphereList.back()->prepareDrawing(P4SphereLayers::layer_separatrices);
     auto result =
         find_critical_point(sM_sphereList.back(), coWorldX(x), coWorldY(y));
     sM_sphereList.back()->finishDrawing();
@@ -1007,24 +1028,8 @@ void P4Sphere::selectNearestSingularity(const QPoint &winpos)
         msgBar_->showMessage(
             "Search nearest critical point: None with separatrices found.");
     } else {
-        auto px = coWinX(gVFResults.selected_ucoord_[0]);
-        auto py = coWinY(gVFResults.selected_ucoord_[1]);
-
-        if (selectingTimer_ != nullptr) {
-            delete selectingTimer_;
-            selectingTimer_ = nullptr;
-            selectingPointStep_ = 0;
-            updatePointSelection();
-        }
-
-        selectingPointStep_ = SELECTINGPOINTSTEPS - 1;
-        selectingX_ = px;
-        selectingY_ = py;
-
-        selectingTimer_ = new QTimer{};
-        QObject::connect(selectingTimer_, &QTimer::timeout, this,
-                         &P4Sphere::updatePointSelection);
-        selectingTimer_->start(SELECTINGPOINTSPEED);
+        flashPointSelection(coWinX(gVFResults.selected_ucoord_[0]),
+                            coWinY(gVFResults.selected_ucoord_[1]));
         msgBar_->showMessage("Search nearest critical point: Found");
 
         auto data1 = new int{-1};
@@ -1034,6 +1039,23 @@ void P4Sphere::selectNearestSingularity(const QPoint &winpos)
     }
 }
 
+void P4Sphere::selectNearestOrbit(const QPoint &winpos)
+{
+    double ucoord[2];
+    double maxdist{SELECTINGORBITPIXELS * dx_ / (w_ - 1)};
+
+    auto orbit = gPickIndex.nearestOrbit(coWorldX(winpos.x()),
+                                         coWorldY(winpos.y()), maxdist, ucoord);
+    gVFResults.selectedOrbit_ = orbit;
+
+    if (orbit == nullptr) {
+        msgBar_->showMessage("Select orbit: None found.");
+    } else {
+        flashPointSelection(coWinX(ucoord[0]), coWinY(ucoord[1]));
+        msgBar_->showMessage("Select orbit: Found (press DEL to delete it)");
+    }
+}
+
 // -----------------------------------------------------------------------
 //                          PLOT SINGULAR POINTS
 // -----------------------------------------------------------------------
@@ -1061,17 +1083,17 @@ void P4Sphere::plotPoint(const P4Singularities::saddle *p)
 
     switch (p->position) {
     case P4Singularities::position_virtual:
-        win_plot_virtualsaddle(staticPainter_, x, y);
+        plotSymbol(win_plot_virtualsaddle, pos);
         break;
     case P4Singularities::position_coinciding:
         break;
     case P4Singularities::position_coinciding_virtual:
         break;
     case P4Singularities::position_coinciding_main:
-        win_plot_coinciding(staticPainter_, x, y);
+        plotSymbol(win_plot_coinciding, pos);
         break;
     default:
-        win_plot_saddle(staticPainter_, x, y);
+        plotSymbol(win_plot_saddle, pos);
         break;
     }
 }
@@ -1101,33 +1123,33 @@ void P4Sphere::plotPoint(const P4Singularities::node *p)
     if (p->stable == -1) {
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualstablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualstablenode, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_stablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_stablenode, pos);
             break;
         }
     } else {
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualunstablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualunstablenode, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_unstablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_unstablenode, pos);
             break;
         }
     }
@@ -1159,68 +1181,68 @@ void P4Sphere::plotPoint(const P4Singularities::weak_focus *p)
     case P4SingularityStability::stable:
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualstableweakfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualstableweakfocus, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_stableweakfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_stableweakfocus, pos);
             break;
         }
         break;
     case P4SingularityStability::unstable:
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualunstableweakfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualunstableweakfocus, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_unstableweakfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_unstableweakfocus, pos);
             break;
         }
         break;
     case P4SingularityStability::center:
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualcenter(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualcenter, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_center(staticPainter_, x, y);
+            plotSymbol(win_plot_center, pos);
             break;
         }
         break;
     default:
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualweakfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualweakfocus, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_weakfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_weakfocus, pos);
             break;
         }
         break;
@@ -1252,33 +1274,33 @@ void P4Sphere::plotPoint(const P4Singularities::strong_focus *p)
     if (p->stable == -1) {
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualstablestrongfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualstablestrongfocus, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_stablestrongfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_stablestrongfocus, pos);
             break;
         }
     } else {
         switch (p->position) {
         case P4Singularities::position_virtual:
-            win_plot_virtualunstablestrongfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualunstablestrongfocus, pos);
             break;
         case P4Singularities::position_coinciding:
             break;
         case P4Singularities::position_coinciding_virtual:
             break;
         case P4Singularities::position_coinciding_main:
-            win_plot_coinciding(staticPainter_, x, y);
+            plotSymbol(win_plot_coinciding, pos);
             break;
         default:
-            win_plot_unstablestrongfocus(staticPainter_, x, y);
+            plotSymbol(win_plot_unstablestrongfocus, pos);
             break;
         }
     }
@@ -1308,17 +1330,17 @@ void P4Sphere::plotPoint(const P4Singularities::degenerate *p)
 
     switch (p->position) {
     case P4Singularities::position_virtual:
-        win_plot_virtualdegen(staticPainter_, x, y);
+        plotSymbol(win_plot_virtualdegen, pos);
         break;
     case P4Singularities::position_coinciding:
         break;
     case P4Singularities::position_coinciding_virtual:
         break;
     case P4Singularities::position_coinciding_main:
-        win_plot_coinciding(staticPainter_, x, y);
+        plotSymbol(win_plot_coinciding, pos);
         break;
     default:
-        win_plot_degen(staticPainter_, x, y);
+        plotSymbol(win_plot_degen, pos);
         break;
     }
 }
@@ -1349,28 +1371,28 @@ void P4Sphere::plotPoint(const P4Singularities::semi_elementary *p)
     case P4Singularities::position_virtual:
         switch (p->type) {
         case 1:
-            win_plot_virtualsesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsesaddlenode, pos);
             break;
         case 2:
-            win_plot_virtualsesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsesaddlenode, pos);
             break;
         case 3:
-            win_plot_virtualsesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsesaddlenode, pos);
             break;
         case 4:
-            win_plot_virtualsesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsesaddlenode, pos);
             break;
         case 5:
-            win_plot_virtualseunstablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualseunstablenode, pos);
             break;
         case 6:
-            win_plot_virtualsesaddle(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsesaddle, pos);
             break;
         case 7:
-            win_plot_virtualsesaddle(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsesaddle, pos);
             break;
         case 8:
-            win_plot_virtualsestablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_virtualsestablenode, pos);
             break;
         }
         break;
@@ -1379,33 +1401,33 @@ void P4Sphere::plotPoint(const P4Singularities::semi_elementary *p)
     case P4Singularities::position_coinciding_virtual:
         break;
     case P4Singularities::position_coinciding_main:
-        win_plot_coinciding(staticPainter_, x, y);
+        plotSymbol(win_plot_coinciding, pos);
         break;
     default:
         switch (p->type) {
         case 1:
-            win_plot_sesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_sesaddlenode, pos);
             break;
         case 2:
-            win_plot_sesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_sesaddlenode, pos);
             break;
         case 3:
-            win_plot_sesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_sesaddlenode, pos);
             break;
         case 4:
-            win_plot_sesaddlenode(staticPainter_, x, y);
+            plotSymbol(win_plot_sesaddlenode, pos);
             break;
         case 5:
-            win_plot_seunstablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_seunstablenode, pos);
             break;
         case 6:
-            win_plot_sesaddle(staticPainter_, x, y);
+            plotSymbol(win_plot_sesaddle, pos);
             break;
         case 7:
-            win_plot_sesaddle(staticPainter_, x, y);
+            plotSymbol(win_plot_sesaddle, pos);
             break;
         case 8:
-            win_plot_sestablenode(staticPainter_, x, y);
+            plotSymbol(win_plot_sestablenode, pos);
             break;
         }
         break;
@@ -1432,6 +1454,15 @@ void P4Sphere::plotPoints()
     }
 }
 
+void P4Sphere::plotSymbol(void (*plot)(QPainter *, int, int),
+                          const double *pos)
+{
+    if (recording_ != nullptr)
+        recording_->addSymbol(pos[0], pos[1], plot);
+    else if (staticPainter_ != nullptr)
+        (*plot)(staticPainter_, coWinX(pos[0]), coWinY(pos[1]));
+}
+
 void P4Sphere::plotPointSeparatrices(const P4Singularities::semi_elementary *p)
 {
     // qDebug() << "plot point separatrices (semi elementary)";
@@ -1531,154 +1562,13 @@ void P4Sphere::plotIsoclines()
     }
 }
 
-// -----------------------------------------------------------------------
-//                          PLOT TOOLS
-// -----------------------------------------------------------------------
-
-std::vector<P4POLYLINES> P4Sphere::produceEllipse(double cx, double cy,
-                                                  double a, double b,
-                                                  bool dotted, double resa,
-                                                  double resb)
-{
-    // this is an exact copy of the plotEllipse routine, except that output
-    // is stored in a list of points that is dynamically allocated.
-
-    double theta{0}, t1, t2, e, R, x, y, c, prevx{0}, prevy{0};
-    bool d{false};
-    bool doton{true};
-    int dotcount{0};
-    std::vector<P4POLYLINES> result;
-
-    R = (resa < resb) ? resa : resb;
-    if (R < 1.0)
-        R = 1.0; // protection
-    e = 2 * acos(1.0 - 0.5 / R);
-    if (R * sin(e) > 1.0)
-        e = asin(1.0 / R);
-
-    while (theta < TWOPI) {
-        c = (x0_ - cx) / a;
-        if (c > -1.0 && c < 1.0) {
-            t1 = acos(c);
-            t2 = TWOPI - t1;
-            if (theta >= t1 && theta < t2) {
-                theta = t2 + e / 4;
-                d = false;
-                continue;
-            }
-        }
-        c = (x1_ - cx) / a;
-        if (c > -1.0 && c < 1.0) {
-            t1 = acos(c);
-            t2 = TWOPI - t1;
-            if (theta < t1) {
-                theta = t1 + e / 4;
-                d = false;
-                continue;
-            }
-            if (theta >= t2) {
-                theta = TWOPI + e / 4;
-                d = false;
-                break;
-            }
-        }
-        c = (y0_ - cy) / b;
-        if (c > -1.0 && c < 1.0) {
-            t1 = asin(c);
-            t2 = PI - t1;
-            if (t1 < 0) {
-                t2 = t1 + TWOPI;
-                t1 = PI - t1;
-                if (theta >= t1 && theta < t2) {
-                    theta = t2 + e / 4;
-                    d = false;
-                    continue;
-                }
-            } else {
-                if (theta < t1) {
-                    theta = t1 + e / 4;
-                    d = false;
-                    continue;
-                }
-                if (theta >= t2) {
-                    theta = TWOPI + e / 4;
-                    d = false;
-                    break;
-                }
-            }
-        }
-        c = (y1_ - cy) / b;
-        if (c > -1.0 && c < 1.0) {
-            t1 = asin(c);
-            t2 = PI - t1;
-            if (t1 < 0) {
-                t2 = t1 + TWOPI;
-                t1 = PI - t1;
-                if (theta < t1) {
-                    theta = t1 + e / 4;
-                    d = false;
-                    continue;
-                }
-                if (theta >= t2) {
-                    theta = TWOPI;
-                    d = false;
-                    break;
-                }
-            } else {
-                if (theta >= t1 && theta < t2) {
-                    theta = t2 + e / 4;
-                    d = false;
-                    continue;
-                }
-            }
-        }
-
-        x = cx + a * cos(theta);
-        y = cy + b * sin(theta);
-        theta += e;
-
-        // (x,y) is inside view
-
-        if (!d) {
-            if (doton) {
-                d = true;
-                prevx = x;
-                prevy = y;
-                dotcount = 0;
-                doton = true;
-            } else {
-                if (++dotcount > 7 && dotted) {
-                    d = false;
-                    doton = !doton;
-                    dotcount = 0;
-                }
-            }
-        } else {
-            if (doton) {
-                result.emplace_back(prevx, prevy, x, y);
-                prevx = x;
-                prevy = y;
-            }
-            if (++dotcount > 7 && dotted) {
-                d = false;
-                doton = (doton) ? false : true;
-                dotcount = 0;
-            }
-        }
-    }
-    return result;
-}
-
 void P4Sphere::plotPoincareSphere()
 {
     // qDebug() << "plot poincare sphere";
     int color{P4ColourSettings::colour_line_at_infinity};
 
-    staticPainter_->setPen(P4Colours::p4XfigColour(color));
-    for (auto const &it : circleAtInfinity_) {
-        staticPainter_->drawLine(coWinX(it.x1), coWinY(it.y1), coWinX(it.x2),
-                                 coWinY(it.y2));
-    }
+    for (auto const &it : circleAtInfinity_)
+        drawLine(it.x1, it.y1, it.x2, it.y2, color);
 }
 
 void P4Sphere::plotPoincareLyapunovSphere()
@@ -1686,17 +1576,11 @@ void P4Sphere::plotPoincareLyapunovSphere()
     // qDebug() << "plot poincare-lyapunov sphere";
     int color{P4ColourSettings::colour_line_at_infinity};
 
-    staticPainter_->setPen(P4Colours::p4XfigColour(color));
-    for (auto const &it : circleAtInfinity_) {
-        staticPainter_->drawLine(coWinX(it.x1), coWinY(it.y1), coWinX(it.x2),
-                                 coWinY(it.y2));
-    }
+    for (auto const &it : circleAtInfinity_)
+        drawLine(it.x1, it.y1, it.x2, it.y2, color);
 
-    for (auto const &it : plCircle_) {
-        staticPainter_->drawLine(coWinX(it.x1), coWinY(it.y1), coWinX(it.x2),
-                                 coWinY(it.y2));
-    }
-    return;
+    for (auto const &it : plCircle_)
+        drawLine(it.x1, it.y1, it.x2, it.y2, color);
 }
 
 void P4Sphere::plotLineAtInfinity()
@@ -1705,20 +1589,15 @@ void P4Sphere::plotLineAtInfinity()
     switch (gVFResults.typeofview_) {
     case P4TypeOfView::typeofview_U1:
     case P4TypeOfView::typeofview_V1:
-        if (x0_ < 0.0 && x1_ > 0.0) {
-            staticPainter_->setPen(P4Colours::p4XfigColour(
-                P4ColourSettings::colour_line_at_infinity));
-            staticPainter_->drawLine(coWinX(0.0), 0, coWinX(0.0), h_ - 1);
-        }
+        if (x0_ < 0.0 && x1_ > 0.0)
+            drawLine(0.0, y0_, 0.0, y1_,
+                     P4ColourSettings::colour_line_at_infinity);
         break;
     case P4TypeOfView::typeofview_U2:
     case P4TypeOfView::typeofview_V2:
-        if (y0_ < 0.0 && y1_ > 0.0) {
-            staticPainter_->setPen(P4Colours::p4XfigColour(
-                P4ColourSettings::colour_line_at_infinity));
-            staticPainter_->drawLine(0, coWinY(0.0), w_ - 1, coWinY(0.0));
-        }
-
+        if (y0_ < 0.0 && y1_ > 0.0)
+            drawLine(x0_, 0.0, x1_, 0.0,
+                     P4ColourSettings::colour_line_at_infinity);
         break;
     case P4TypeOfView::typeofview_plane:
     case P4TypeOfView::typeofview_sphere:
@@ -1727,1043 +1606,189 @@ void P4Sphere::plotLineAtInfinity()
     }
 }
 
-void P4Sphere::drawLine(double x1, double y1, double x2, double y2, int color)
-{
-    // qDebug() << "draw line";
-    int wx1, wy1, wx2, wy2;
-
-    if (staticPainter_ != nullptr) {
-        if (x1 >= x0_ && x1 <= x1_ && y1 >= y0_ && y1 <= y1_) {
-            wx1 = coWinX(x1);
-            wy1 = coWinY(y1);
-
-            if (x2 >= x0_ && x2 <= x1_ && y2 >= y0_ && y2 <= y1_) {
-                // both points are visible in the window
-
-                wx2 = coWinX(x2);
-                wy2 = coWinY(y2);
-
-                if (paintedXMin_ > wx1)
-                    paintedXMin_ = wx1;
-                if (paintedXMax_ < wx1)
-                    paintedXMax_ = wx1;
-                if (paintedYMin_ > wy1)
-                    paintedYMin_ = wy1;
-                if (paintedYMax_ < wy1)
-                    paintedYMax_ = wy1;
-                if (paintedXMin_ > wx2)
-                    paintedXMin_ = wx2;
-                if (paintedXMax_ < wx2)
-                    paintedXMax_ = wx2;
-                if (paintedYMin_ > wy2)
-                    paintedYMin_ = wy2;
-                if (paintedYMax_ < wy2)
-                    paintedYMax_ = wy2;
-
-                staticPainter_->setPen(P4Colours::p4XfigColour(color));
-                staticPainter_->drawLine(wx1, wy1, wx2, wy2);
-            } else {
-                // only (x2,y2) is not visible
-
-                if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_,
-                                           y1_)) {
-                    wx1 = coWinX(x1);
-                    wy1 = coWinY(y1);
-                    wx2 = coWinX(x2);
-                    wy2 = coWinY(y2);
-                    staticPainter_->setPen(P4Colours::p4XfigColour(color));
-
-                    if (paintedXMin_ > wx1)
-                        paintedXMin_ = wx1;
-                    if (paintedXMax_ < wx1)
-                        paintedXMax_ = wx1;
-                    if (paintedYMin_ > wy1)
-                        paintedYMin_ = wy1;
-                    if (paintedYMax_ < wy1)
-                        paintedYMax_ = wy1;
-                    if (paintedXMin_ > wx2)
-                        paintedXMin_ = wx2;
-                    if (paintedXMax_ < wx2)
-                        paintedXMax_ = wx2;
-                    if (paintedYMin_ > wy2)
-                        paintedYMin_ = wy2;
-                    if (paintedYMax_ < wy2)
-                        paintedYMax_ = wy2;
-
-                    staticPainter_->drawLine(wx1, wy1, wx2, wy2);
-                }
-            }
-        } else {
-            if (x2 >= x0_ && x2 <= x1_ && y2 >= y0_ && y2 <= y1_) {
-                // only (x2,y2) is visible
-
-                if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_,
-                                           y1_)) {
-                    wx1 = coWinX(x1);
-                    wy1 = coWinY(y1);
-                    wx2 = coWinX(x2);
-                    wy2 = coWinY(y2);
-                    staticPainter_->setPen(P4Colours::p4XfigColour(color));
-
-                    if (paintedXMin_ > wx1)
-                        paintedXMin_ = wx1;
-                    if (paintedXMax_ < wx1)
-                        paintedXMax_ = wx1;
-                    if (paintedYMin_ > wy1)
-                        paintedYMin_ = wy1;
-                    if (paintedYMax_ < wy1)
-                        paintedYMax_ = wy1;
-                    if (paintedXMin_ > wx2)
-                        paintedXMin_ = wx2;
-                    if (paintedXMax_ < wx2)
-                        paintedXMax_ = wx2;
-                    if (paintedYMin_ > wy2)
-                        paintedYMin_ = wy2;
-                    if (paintedYMax_ < wy2)
-                        paintedYMax_ = wy2;
-
-                    staticPainter_->drawLine(wx1, wy1, wx2, wy2);
-                }
-            } else {
-                // both end points are invisible
-
-                if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_,
-                                           y1_)) {
-                    wx1 = coWinX(x1);
-                    wy1 = coWinY(y1);
-                    wx2 = coWinX(x2);
-                    wy2 = coWinY(y2);
-                    staticPainter_->setPen(P4Colours::p4XfigColour(color));
-
-                    if (paintedXMin_ > wx1)
-                        paintedXMin_ = wx1;
-                    if (paintedXMax_ < wx1)
-                        paintedXMax_ = wx1;
-                    if (paintedYMin_ > wy1)
-                        paintedYMin_ = wy1;
-                    if (paintedYMax_ < wy1)
-                        paintedYMax_ = wy1;
-                    if (paintedXMin_ > wx2)
-                        paintedXMin_ = wx2;
-                    if (paintedXMax_ < wx2)
-                        paintedXMax_ = wx2;
-                    if (paintedYMin_ > wy2)
-                        paintedYMin_ = wy2;
-                    if (paintedYMax_ < wy2)
-                        paintedYMax_ = wy2;
-
-                    staticPainter_->drawLine(wx1, wy1, wx2, wy2);
-                }
-            }
-        }
-    }
-}
-
-void P4Sphere::drawPoint(double x, double y, int color)
-{
-    // qDebug() << "draw point";
-    if (staticPainter_ != nullptr) {
-        if (x < x0_ || x > x1_ || y < y0_ || y > y1_)
-            return;
-        staticPainter_->setPen(P4Colours::p4XfigColour(color));
-        auto _x = coWinX(x);
-        auto _y = coWinY(y);
-
-        if (paintedXMin_ > _x)
-            paintedXMin_ = _x;
-        if (paintedXMax_ < _x)
-            paintedXMax_ = _x;
-        if (paintedYMin_ > _y)
-            paintedYMin_ = _y;
-        if (paintedYMax_ < _y)
-            paintedYMax_ = _y;
-
-        staticPainter_->drawPoint(_x, _y);
-    }
-}
-
-//---------------------------------------------------------------------
-//                  PRINTING METHODS
-//---------------------------------------------------------------------
-void P4Sphere::printPoint(const P4Singularities::saddle *p)
+void P4Sphere::plotFlowField()
 {
-    // qDebug() << "print point saddle";
-    double pos[2];
+    // qDebug() << "plot flow field";
+    int spacing{static_cast<int>(
+        std::round(std::max(FLOWFIELDSPACING * horPixelsPerMM_, 8.0)))};
 
-    getChartPos(p->chart, p->x0, p->y0, pos);
-    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+    if (gVFResults.flowField_ == P4TypeOfFlowField::flowfield_none ||
+        gVFResults.singularitiesOnly_)
         return;
 
-    switch (p->position) {
-    case P4Singularities::position_virtual:
-        print_virtualsaddle(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case P4Singularities::position_coinciding:
-        break;
-    case P4Singularities::position_coinciding_virtual:
-        break;
-    case P4Singularities::position_coinciding_main:
-        print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    default:
-        print_saddle(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    }
+    flowGrid_.update(x0_, y0_, x1_, y1_, w_, h_, spacing);
+    drawFlowField(flowGrid_, 0.6 * spacing, &P4Canvas::drawLine);
 }
 
-void P4Sphere::printPoint(const P4Singularities::node *p)
+void P4Sphere::drawLine(double x1, double y1, double x2, double y2, int color)
 {
-    // qDebug() << "print point node";
-    double pos[2];
-
-    getChartPos(p->chart, p->x0, p->y0, pos);
+    // qDebug() << "draw line";
+    int wx1, wy1, wx2, wy2;
 
-    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+    if (staticPainter_ == nullptr && recording_ == nullptr)
         return;
 
-    if (p->stable == -1) {
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualstablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_stablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-    } else {
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualunstablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_unstablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
+    if (x1 < x0_ || x1 > x1_ || y1 < y0_ || y1 > y1_ || x2 < x0_ ||
+        x2 > x1_ || y2 < y0_ || y2 > y1_) {
+        // at least one end point is not visible: clip the segment
+        if (!lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_))
+            return;
     }
-}
 
-void P4Sphere::printPoint(const P4Singularities::weak_focus *p)
-{
-    // qDebug() << "print point weak focus";
-    double pos[2];
-
-    getChartPos(p->chart, p->x0, p->y0, pos);
-
-    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+    if (recording_ != nullptr) {
+        recording_->addLine(x1, y1, x2, y2, color);
         return;
-
-    switch (p->type) {
-    case P4SingularityStability::stable:
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualstableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_stableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-        break;
-    case P4SingularityStability::unstable:
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualunstableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_unstableweakfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-        break;
-    case P4SingularityStability::center:
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualcenter(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_center(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-        break;
-    default:
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualweakfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_weakfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-        break;
     }
-}
-
-void P4Sphere::printPoint(const P4Singularities::strong_focus *p)
-{
-    // qDebug() << "print point strong focus";
-    double pos[2];
-
-    getChartPos(p->chart, p->x0, p->y0, pos);
-
-    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
-        return;
 
-    if (p->stable == -1) {
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualstablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_stablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-    } else {
-        switch (p->position) {
-        case P4Singularities::position_virtual:
-            print_virtualunstablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case P4Singularities::position_coinciding:
-            break;
-        case P4Singularities::position_coinciding_virtual:
-            break;
-        case P4Singularities::position_coinciding_main:
-            print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        default:
-            print_unstablestrongfocus(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
+    wx1 = winView_.coWinX(x1);
+    wy1 = winView_.coWinY(y1);
+    wx2 = winView_.coWinX(x2);
+    wy2 = winView_.coWinY(y2);
+
+    // Segments are not painted one by one, but gathered in a polyline that
+    // is painted by flushPendingLine.  An end point in the same pixel as the
+    // previous one is merged with it.
+    if (pendingLine_.isEmpty() || pendingColor_ != color ||
+        pendingLine_.last() != QPoint{wx1, wy1}) {
+        flushPendingLine();
+        pendingColor_ = color;
+        pendingLine_.append(QPoint{wx1, wy1});
+    }
+    if (pendingLine_.last() != QPoint{wx2, wy2})
+        pendingLine_.append(QPoint{wx2, wy2});
+
+    // keep the display list of the layer in step with the painter cache.
+    // Erasing (drawing in the background colour) cannot be kept in a list,
+    // so then the layer is walked again at the next repaint.
+    if (drawingLayer_ >= 0 && !isLayerDirty_[drawingLayer_]) {
+        if (color == spherebgcolor_)
+            isLayerDirty_[drawingLayer_] = true;
+        else
+            drawn_->addLine(x1, y1, x2, y2, color);
     }
 }
 
-void P4Sphere::printPoint(const P4Singularities::degenerate *p)
+// Paints the polyline gathered by drawLine, with a single pen change and a
+// single update of the painted rectangle.
+void P4Sphere::flushPendingLine()
 {
-    // qDebug() << "print point degenerate";
-    double pos[2];
-
-    getChartPos(p->chart, p->x0, p->y0, pos);
-
-    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
+    if (pendingLine_.isEmpty())
         return;
 
-    switch (p->position) {
-    case P4Singularities::position_virtual:
-        print_virtualdegen(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case P4Singularities::position_coinciding:
-        break;
-    case P4Singularities::position_coinciding_virtual:
-        break;
-    case P4Singularities::position_coinciding_main:
-        print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    default:
-        print_degen(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    }
-}
-
-void P4Sphere::printPoint(const P4Singularities::semi_elementary *p)
-{
-    // qDebug() << "print point semi elementary";
-    double pos[2];
+    QRect r{pendingLine_.boundingRect()};
+    if (paintedXMin_ > r.left())
+        paintedXMin_ = r.left();
+    if (paintedXMax_ < r.right())
+        paintedXMax_ = r.right();
+    if (paintedYMin_ > r.top())
+        paintedYMin_ = r.top();
+    if (paintedYMax_ < r.bottom())
+        paintedYMax_ = r.bottom();
 
-    getChartPos(p->chart, p->x0, p->y0, pos);
+    staticPainter_->setPen(P4Colours::p4XfigColour(pendingColor_));
+    if (pendingLine_.size() == 1)
+        staticPainter_->drawPoint(pendingLine_.first());
+    else
+        staticPainter_->drawPolyline(pendingLine_);
 
-    if (pos[0] < x0_ || pos[0] > x1_ || pos[1] < y0_ || pos[1] > y1_)
-        return;
-
-    switch (p->type) {
-    case 1:
-        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 2:
-        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 3:
-        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 4:
-        print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 5:
-        print_seunstablenode(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 6:
-        print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 7:
-        print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    case 8:
-        print_sestablenode(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    }
-
-    switch (p->position) {
-    case P4Singularities::position_virtual:
-        switch (p->type) {
-        case 1:
-            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 2:
-            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 3:
-            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 4:
-            print_virtualsesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 5:
-            print_virtualseunstablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 6:
-            print_virtualsesaddle(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 7:
-            print_virtualsesaddle(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 8:
-            print_virtualsestablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-        break;
-    case P4Singularities::position_coinciding:
-        break;
-    case P4Singularities::position_coinciding_virtual:
-        break;
-    case P4Singularities::position_coinciding_main:
-        print_coinciding(coWinX(pos[0]), coWinY(pos[1]));
-        break;
-    default:
-        switch (p->type) {
-        case 1:
-            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 2:
-            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 3:
-            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 4:
-            print_sesaddlenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 5:
-            print_seunstablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 6:
-            print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 7:
-            print_sesaddle(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        case 8:
-            print_sestablenode(coWinX(pos[0]), coWinY(pos[1]));
-            break;
-        }
-        break;
-    }
-}
-
-void P4Sphere::printPoints()
-{
-    // qDebug() << "print points";
-    print_comment("Printing symbols at all singular points:");
-
-    for (auto const &vf : gVFResults.vf_) {
-        for (auto s = vf->firstSaddlePoint_; s != nullptr; s = s->next_saddle)
-            printPoint(s);
-        for (auto np = vf->firstNodePoint_; np != nullptr; np = np->next_node)
-            printPoint(np);
-        for (auto wfp = vf->firstWfPoint_; wfp != nullptr; wfp = wfp->next_wf)
-            printPoint(wfp);
-        for (auto sfp = vf->firstSfPoint_; sfp != nullptr; sfp = sfp->next_sf)
-            printPoint(sfp);
-        for (auto sep = vf->firstSePoint_; sep != nullptr; sep = sep->next_se)
-            printPoint(sep);
-        for (auto dp = vf->firstDePoint_; dp != nullptr; dp = dp->next_de)
-            printPoint(dp);
-    }
-}
-
-void P4Sphere::printPointSeparatrices(const P4Singularities::semi_elementary *p)
-{
-    // qDebug() << "print point separatrices (semi elementary)";
-    for (auto s = p->separatrices; s != nullptr; s = s->next_sep) {
-        print_comment("Next separatrix of degenerate point:");
-        draw_sep(this, s->first_sep_point);
-    }
-}
-
-void P4Sphere::printPointSeparatrices(const P4Singularities::saddle *p)
-{
-    // qDebug() << "print point separatrices (saddle)";
-    for (auto s = p->separatrices; s != nullptr; s = s->next_sep) {
-        print_comment("Next separatrix of saddle point:");
-        draw_sep(this, s->first_sep_point);
-    }
-}
-
-void P4Sphere::printPointSeparatrices(const P4Singularities::degenerate *p)
-{
-    // qDebug() << "print point separatrices (degenerate)";
-    for (auto b = p->blow_up; b != nullptr; b = b->next_blow_up_point) {
-        print_comment("Next separatrix of degenerate point:");
-        draw_sep(this, b->first_sep_point);
-    }
-}
-
-void P4Sphere::printSeparatrices()
-{
-    // qDebug() << "print separatrices";
-    for (auto const &vf : gVFResults.vf_) {
-        for (auto s = vf->firstSaddlePoint_; s != nullptr; s = s->next_saddle) {
-            print_comment("Printing separatrice for saddle singularity:");
-            printPointSeparatrices(s);
-        }
-        for (auto sep = vf->firstSePoint_; sep != nullptr; sep = sep->next_se) {
-            print_comment(
-                "Printing separatrices for semi-hyperbolic singularity:");
-            printPointSeparatrices(sep);
-        }
-        for (auto dp = vf->firstDePoint_; dp != nullptr; dp = dp->next_de) {
-            print_comment("Printing separatrices for degenerate singularity:");
-            printPointSeparatrices(dp);
-        }
-    }
-}
-
-void P4Sphere::printGcf()
-{
-    // qDebug() << "print gcf";
-    bool isagcf{false};
-    for (auto const &vf : gVFResults.vf_) {
-        if (vf->gcf_points_ != nullptr) {
-            isagcf = true;
-            break;
-        }
-    }
-    if (isagcf) {
-        for (auto const &vf : gVFResults.vf_) {
-            print_comment("Printing greatest common factor:");
-            draw_gcf(this, vf->gcf_points_,
-                     P4ColourSettings::colour_curve_singularities, 1);
-        }
-    }
-}
-
-void P4Sphere::printSeparatingCurves()
-{
-    // qDebug() << "print separating curve";
-    QString comment;
-    bool dashes;
-    double pcoord[3];
-
-    if (gThisVF->numSeparatingCurves_ > 0 &&
-        !gVFResults.separatingCurves_.empty()) {
-        print_comment("Printing separating curves:");
-        for (unsigned int i = 0; i < gThisVF->numSeparatingCurves_; i++) {
-            comment.sprintf("Curve #%d:", i + 1);
-            print_comment(comment);
-            dashes = true;
-            auto &sep = gVFResults.separatingCurves_[i].points;
-            for (auto it = std::begin(sep); it != std::end(sep); ++it) {
-                if (it->color == P4ColourSettings::colour_separating_curve) {
-                    if (it->dashes && dashes)
-                        (*plot_l)(this, pcoord, it->pcoord, it->color);
-                    else {
-                        auto nextpt = it + 1;
-                        if (nextpt == std::end(sep))
-                            (*plot_p)(this, it->pcoord, it->color);
-                        else if (!nextpt->dashes ||
-                                 nextpt->color != P4ColourSettings::
-                                                      colour_separating_curve ||
-                                 !dashes)
-                            (*plot_p)(this, it->pcoord, it->color);
-                        // draw nothing when the next point is a dash
-                    }
-                    dashes = true;
-                } else {
-                    dashes = false;
-                }
-                copy_x_into_y(it->pcoord, pcoord);
-            }
-        }
-    }
-}
-
-void P4Sphere::printArbitraryCurves()
-{
-    // qDebug() << "print arbitrary curves";
-    QString comment;
-    int i{1};
-    for (auto const &it : gVFResults.arbitraryCurves_) {
-        comment.sprintf("Printing curve %d:", i++);
-        print_comment(comment);
-        drawArbitraryCurve(this, it.points,
-                           P4ColourSettings::colour_arbitrary_curve, 1);
-    }
-}
-
-void P4Sphere::printIsoclines()
-{
-    // qDebug() << "print isoclines";
-    QString comment;
-    int i{1};
-    for (auto const &vf : gVFResults.vf_) {
-        for (auto const &it : vf->isocline_vector_) {
-            comment.sprintf("Printing isocline %d:", i++);
-            print_comment(comment);
-            draw_isoclines(this, it.points, it.color, 1);
-        }
-    }
-}
-
-void P4Sphere::printPoincareSphere()
-{
-    // qDebug() << "print poincare sphere";
-    print_comment("Printing Poincare Sphere:");
-    auto p =
-        produceEllipse(0.0, 0.0, 1.0, 1.0, false, coWinH(1.0), coWinV(1.0));
-    for (auto &q : p) {
-        q.x1 = coWinX(q.x1);
-        q.y1 = coWinY(q.y1);
-        q.x2 = coWinX(q.x2);
-        q.y2 = coWinY(q.y2);
-    }
-    print_elips(coWinX(0), coWinY(0), coWinH(1), coWinV(1),
-                P4ColourSettings::colour_line_at_infinity, false, p);
-}
-
-void P4Sphere::printPoincareLyapunovSphere()
-{
-    // qDebug() << "print poincare-lyapunov sphere";
-    print_comment("Printing Poincare Lyapunov-Sphere (circle at infinity):");
-
-    auto p =
-        produceEllipse(0.0, 0.0, 1.0, 1.0, false, coWinH(1.0), coWinV(1.0));
-    for (auto &q : p) {
-        q.x1 = coWinX(q.x1);
-        q.y1 = coWinY(q.y1);
-        q.x2 = coWinX(q.x2);
-        q.y2 = coWinY(q.y2);
-    }
-    print_elips(coWinX(0.0), coWinY(0.0), coWinH(1.0), coWinV(1.0),
-                P4ColourSettings::colour_line_at_infinity, false, p);
-
-    p.clear();
-
-    print_comment(
-        "Printing Poincare Lyapunov-Sphere (circle of finite radius):");
-
-    p = produceEllipse(0.0, 0.0, RADIUS, RADIUS, true, coWinH(RADIUS),
-                       coWinV(RADIUS));
-    for (auto &q : p) {
-        q.x1 = coWinX(q.x1);
-        q.y1 = coWinY(q.y1);
-        q.x2 = coWinX(q.x2);
-        q.y2 = coWinY(q.y2);
-    }
-    print_elips(coWinX(0.0), coWinY(0.0), coWinH(RADIUS), coWinV(RADIUS),
-                P4ColourSettings::colour_line_at_infinity, true, p);
-}
-
-void P4Sphere::printLineAtInfinity()
-{
-    // qDebug() << "print line at infinity";
-    switch (gVFResults.typeofview_) {
-    case P4TypeOfView::typeofview_U1:
-    case P4TypeOfView::typeofview_V1:
-        if (x0_ < 0.0 && x1_ > 0.0)
-            print_line(coWinX(0.0), coWinY(y0_), coWinX(0.0), coWinY(y1_),
-                       P4ColourSettings::colour_line_at_infinity);
-        break;
-    case P4TypeOfView::typeofview_U2:
-    case P4TypeOfView::typeofview_V2:
-        if (y0_ < 0.0 && y1_ > 0.0)
-            print_line(coWinX(x0_), coWinY(0.0), coWinX(x1_), coWinY(0.0),
-                       P4ColourSettings::colour_line_at_infinity);
-        break;
-    }
+    pendingLine_.resize(0); // keeps the allocated memory
 }
 
-void P4Sphere::printOrbits()
+void P4Sphere::drawPoint(double x, double y, int color)
 {
-    // qDebug() << "print orbits";
-    // inspired by DrawOrbits, except that we put comments between
-    QString s;
-    int i{1};
-    for (auto o = gVFResults.firstOrbit_; o != nullptr; o = o->next) {
-        s.sprintf("Starting orbit %d", i++);
-        print_comment(s);
-        drawOrbit(this, o->pcoord, o->firstpt, o->color);
-    }
-}
+    // qDebug() << "draw point";
+    if (staticPainter_ == nullptr && recording_ == nullptr)
+        return;
+    if (x < x0_ || x > x1_ || y < y0_ || y > y1_)
+        return;
 
-void P4Sphere::printLimitCycles()
-{
-    // qDebug() << "print limit cycles";
-    // inspired by DrawOrbits, except that we put comments between
-    QString s;
-    int i{1};
-    for (auto o = gVFResults.firstLimCycle_; o != nullptr; o = o->next) {
-        s.sprintf("Starting limit cycle %d", i++);
-        print_comment(s);
-        drawOrbit(this, o->pcoord, o->firstpt, o->color);
+    if (recording_ != nullptr) {
+        recording_->addPoint(x, y, color);
+        return;
     }
-}
-
-void P4Sphere::printLine(double x1, double y1, double x2, double y2, int color)
-{
-    // qDebug() << "print line";
-    int wx1, wy1, wx2, wy2;
-
-    if (x1 >= x0_ && x1 <= x1_ && y1 >= y0_ && y1 <= y1_) {
-        wx1 = coWinX(x1);
-        wy1 = coWinY(y1);
 
-        if (x2 >= x0_ && x2 <= x1_ && y2 >= y0_ && y2 <= y1_) {
-            // both points are visible in the window
-            wx2 = coWinX(x2);
-            wy2 = coWinY(y2);
-
-            print_line(wx1, wy1, wx2, wy2, color);
-        } else {
-            // only (x2,y2) is not visible
-            if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_)) {
-                wx1 = coWinX(x1);
-                wy1 = coWinY(y1);
-                wx2 = coWinX(x2);
-                wy2 = coWinY(y2);
-                print_line(wx1, wy1, wx2, wy2, color);
-            }
-        }
-    } else {
-        if (x2 >= x0_ && x2 <= x1_ && y2 >= y0_ && y2 <= y1_) {
-            // only (x2,y2) is visible
-            if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_)) {
-                wx1 = coWinX(x1);
-                wy1 = coWinY(y1);
-                wx2 = coWinX(x2);
-                wy2 = coWinY(y2);
-                print_line(wx1, wy1, wx2, wy2, color);
-            }
-        } else {
-            // both end points are invisible
-            if (lineRectangleIntersect(x1, y1, x2, y2, x0_, x1_, y0_, y1_)) {
-                wx1 = coWinX(x1);
-                wy1 = coWinY(y1);
-                wx2 = coWinX(x2);
-                wy2 = coWinY(y2);
-                print_line(wx1, wy1, wx2, wy2, color);
-            }
-        }
+    flushPendingLine();
+    staticPainter_->setPen(P4Colours::p4XfigColour(color));
+    auto _x = winView_.coWinX(x);
+    auto _y = winView_.coWinY(y);
+
+    if (paintedXMin_ > _x)
+        paintedXMin_ = _x;
+    if (paintedXMax_ < _x)
+        paintedXMax_ = _x;
+    if (paintedYMin_ > _y)
+        paintedYMin_ = _y;
+    if (paintedYMax_ < _y)
+        paintedYMax_ = _y;
+
+    staticPainter_->drawPoint(_x, _y);
+
+    if (drawingLayer_ >= 0 && !isLayerDirty_[drawingLayer_]) {
+        if (color == spherebgcolor_)
+            isLayerDirty_[drawingLayer_] = true;
+        else
+            drawn_->addPoint(x, y, color);
     }
 }
 
-void P4Sphere::printPoint(double x, double y, int color)
-{
-    // qDebug() << "print point";
-    if (x < x0_ || x > x1_ || y < y0_ || y > y1_)
-        return;
-
-    print_point(coWinX(x), coWinY(y), color);
-}
-
 void P4Sphere::refresh()
 {
+    gPickIndex.invalidate();
+    for (auto &dirty : isLayerDirty_)
+        dirty = true;
     isPainterCacheDirty_ = true;
     update();
 }
 
-void P4Sphere::calculateHeightFromWidth(int &width, int &height,
-                                        int maxheight = -1,
-                                        double aspectratio = 1)
+void P4Sphere::setRefineCurves(bool refine)
 {
-    // given an optimal width in width, this procedure calculates the
-    // corresponding height in order to maintain the given aspectratio. If
-    // however the maximum height is violated, then we choose to have the
-    // maximum height and calculate the corresponding width.
-
-    double w{static_cast<double>(width)};
-    double h{w * dy_ / dx_ * aspectratio};
-
-    if (std::round(h) <= maxheight || maxheight == -1) {
-        height = static_cast<int>(std::round(h));
-    } else {
-        height = maxheight;
-        h = static_cast<double>(maxheight);
-        w = h * dx_ / dy_;
-        w /= aspectratio;
-        width = static_cast<int>(std::round(w));
-    }
+    refineCurves_ = refine;
+    isLayerDirty_[P4SphereLayers::layer_orbits] = true;
+    isLayerDirty_[P4SphereLayers::layer_separatrices] = true;
+    isPainterCacheDirty_ = true;
+    update();
 }
 
-void P4Sphere::preparePrinting(int printmethod, bool isblackwhite,
-                               int myresolution, double mylinewidth,
-                               double mysymbolsize)
+// Curves are only refined while the display lists are recorded, not while
+// they are drawn incrementally or printed.
+P4RefineJob *P4Sphere::refineJob()
 {
-    // qDebug() << "prepare printing";
-    double pagewidth, pageheight;
-    double aspectratio{1}; // assume aspect ratio 1
-
-    printMethod_ = printmethod;
-
-    if (printmethod == P4PRINT_DEFAULT) {
-        pagewidth = gP4printer->width();
-        pageheight = gP4printer->height();
-    } else
-        pagewidth = pageheight = -1; // will be redefined in a minute
-
-    sP4pixmapDPM = myresolution / 2.54;
-
-    double hpixels{myresolution * 15 / 2.54};
-    double maxvpixels{(myresolution * aspectratio * 20) / 2.54 + 0.5};
-
-    oldw_ = w_;
-    oldh_ = h_;
-    w_ = static_cast<int>(std::round(hpixels));
-
-    switch (printmethod) {
-    case P4PRINT_DEFAULT: /* pagewidth and height already set */
-        break;
-    case P4PRINT_JPEGIMAGE:
-        pagewidth = -1;
-        pageheight = -1;
-        break;
-    case P4PRINT_XFIGIMAGE:
-        pagewidth = -1;
-        pageheight = -1;
-        break;
-    case P4PRINT_EPSIMAGE:
-        pagewidth = myresolution * POSTSCRIPTPAGEWIDTH; // see custom.cpp
-        pageheight = myresolution * POSTSCRIPTPAGEHEIGHT;
-        break;
-    }
-
-    if (w_ > pagewidth && pagewidth != -1)
-        w_ = static_cast<int>(std::round(pagewidth));
-    if (maxvpixels > pageheight && pageheight != -1)
-        maxvpixels = pageheight;
-
-    calculateHeightFromWidth(w_, h_, std::round(maxvpixels), aspectratio);
-
-    // 25.4 dots per mm
-    double lw{myresolution * mylinewidth / 25.4};
-    if (lw < 1.0)
-        lw = 1.0;
-
-    // 25.4 dots per mm
-    double ss{(myresolution * mysymbolsize / 25.4 + 0.5) / 2.0};
-    if (ss < 1.0)
-        ss = 1.0;
-
-    double tx, ty;
-    if (pagewidth == -1 || pageheight == -1) {
-        tx = 0;
-        ty = 0;
-    } else {
-        tx = (pagewidth - w_) / 2.0;
-        ty = (pageheight - h_) / 2.0;
-    }
-
-    switch (printmethod) {
-    case P4PRINT_EPSIMAGE:
-        reverseYAxis_ = true;
-        preparePostscriptPrinting(std::round(tx), std::round(ty), w_, h_,
-                                  iszoom_, isblackwhite, myresolution,
-                                  std::round(lw), 2 * std::round(ss));
-        break;
-    case P4PRINT_XFIGIMAGE:
-        reverseYAxis_ = false;
-        prepareXFigPrinting(w_, h_, iszoom_, isblackwhite, myresolution,
-                            std::round(lw), 2 * std::round(ss));
-        break;
-    case P4PRINT_DEFAULT:
-        staticPainter_ = new QPainter{};
-
-        if (!staticPainter_->begin(gP4printer)) {
-            delete staticPainter_;
-            staticPainter_ = nullptr;
-            return;
-        }
-
-        staticPainter_->translate(tx, ty);
-        if (iszoom_ ||
-            gVFResults.typeofview_ == P4TypeOfView::typeofview_plane) {
-            QPen p{P4Colours::p4XfigColour(
-                       printColorTable(P4ColourSettings::colour_foreground)),
-                   std::round(lw)};
-            staticPainter_->setPen(p);
-            staticPainter_->drawRect(0, 0, w_, h_);
-        }
-        reverseYAxis_ = false; // no need for reversing axes in this case
-        prepareP4Printing(w_, h_, isblackwhite, staticPainter_, std::round(lw),
-                          2 * std::round(ss));
-        break;
-
-    case P4PRINT_JPEGIMAGE:
-        staticPainter_ = new QPainter{};
-        sP4pixmap = new QPixmap{w_, h_};
-        reverseYAxis_ = false; // no need for reversing axes in this case
-        if (sP4pixmap->isNull()) {
-            msgBar_->showMessage(
-                "Print failure (try to choose a lower resolution).");
-            delete sP4pixmap;
-            sP4pixmap = nullptr;
-            delete staticPainter_;
-            staticPainter_ = nullptr;
-            return;
-        }
-        if (!staticPainter_->begin(sP4pixmap)) {
-            delete sP4pixmap;
-            sP4pixmap = nullptr;
-            delete staticPainter_;
-            staticPainter_ = nullptr;
-            return;
-        }
-
-        prepareP4Printing(w_, h_, isblackwhite, staticPainter_, std::round(lw),
-                          2 * std::round(ss));
-        break;
-    }
-    msgBar_->showMessage("Printing ...");
+    return (recording_ != nullptr) ? refining_.get() : nullptr;
 }
 
-void P4Sphere::finishPrinting()
+bool P4Sphere::isDrawing() const
 {
-    // qDebug() << "finish printing";
-    if (printMethod_ == P4PRINT_EPSIMAGE) {
-        finishPostscriptPrinting();
-        reverseYAxis_ = false;
-        w_ = oldw_;
-        h_ = oldh_;
-    } else if (printMethod_ == P4PRINT_XFIGIMAGE) {
-        finishXFigPrinting();
-        reverseYAxis_ = false;
-        w_ = oldw_;
-        h_ = oldh_;
-    } else if (printMethod_ == P4PRINT_DEFAULT) {
-        finishP4Printing();
-        staticPainter_->end();
-        delete staticPainter_;
-        staticPainter_ = nullptr;
-        w_ = oldw_;
-        h_ = oldh_;
-        reverseYAxis_ = false;
-    } else if (printMethod_ == P4PRINT_JPEGIMAGE) {
-        if (sP4pixmap == nullptr) {
-            finishP4Printing();
-            w_ = oldw_;
-            h_ = oldh_;
-            reverseYAxis_ = false;
-            return;
-        }
-
-        finishP4Printing();
-        staticPainter_->end();
-        delete staticPainter_;
-        staticPainter_ = nullptr;
-
-        if (sP4pixmap->save(gThisVF->getbarefilename() + ".jpg", "JPEG", 100) ==
-            false) {
-            QMessageBox::critical(this, "P4",
-                                  "For some reason, P4 is unable to save the "
-                                  "resulting JPEG image to disc.");
-        }
-
-        delete sP4pixmap;
-        sP4pixmap = nullptr;
-        reverseYAxis_ = false;
-        w_ = oldw_;
-        h_ = oldh_;
-    }
-    msgBar_->showMessage("Printing has finished.");
+    return recording_ != nullptr || staticPainter_ != nullptr;
 }
 
-// TODO call from paintEvent with a printFlag or something
-void P4Sphere::print()
+// Like refresh, but only the given layer is walked again.  Since the plot
+// functions draw on every sphere, the layer is refreshed on all of them.
+void P4Sphere::refreshLayer(int layer)
 {
-    // qDebug() << "print";
-    if (printMethod_ == P4PRINT_JPEGIMAGE && sP4pixmap == nullptr)
-        return;
-
-    if (gVFResults.typeofview_ != P4TypeOfView::typeofview_plane) {
-        if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere) {
-            if (gVFResults.plweights_)
-                printPoincareLyapunovSphere();
-            else
-                printPoincareSphere();
-        } else
-            printLineAtInfinity();
+    gPickIndex.invalidate();
+    for (auto const &it : sM_sphereList) {
+        it->isLayerDirty_[layer] = true;
+        it->isPainterCacheDirty_ = true;
+        it->update();
     }
-    printSeparatingCurves();
-    printOrbits();
-    printSeparatrices();
-    printGcf();
-    printArbitraryCurves(); // TODO
-    printIsoclines();
-    printLimitCycles();
-    printPoints();
 }
 
-void P4Sphere::prepareDrawing()
+// Prepares drawing on top of the painter cache of all spheres.  What is
+// drawn is also added to the display list of layer.
+void P4Sphere::prepareDrawing(int layer)
 {
     // qDebug() << "prepare drawing";
     if (painterCache_ == nullptr) {
         isPainterCacheDirty_ = true;
-        painterCache_ = new QPixmap{size()};
+        painterCache_ = new QImage{size(), QImage::Format_RGB32};
+        painterCache_->fill(
+            P4Colours::p4XfigColour(P4ColourSettings::colour_background));
     }
     staticPainter_ = new QPainter{painterCache_};
+    drawingLayer_ = layer;
+    if (layer >= 0)
+        drawn_.reset(new P4DisplayList);
+    winView_ = winTransform();
 
     paintedXMin_ = width() - 1;
     paintedYMin_ = height() - 1;
@@ -2771,7 +1796,7 @@ void P4Sphere::prepareDrawing()
     paintedYMax_ = 0;
 
     if (next_ != nullptr)
-        next_->prepareDrawing();
+        next_->prepareDrawing(layer);
 }
 
 void P4Sphere::finishDrawing()
@@ -2780,11 +1805,26 @@ void P4Sphere::finishDrawing()
     if (next_ != nullptr)
         next_->finishDrawing();
 
+    // orbits or separatrices may have been added
+    gPickIndex.invalidate();
+
+    // what has been drawn is published as a list of its own
+    if (drawingLayer_ >= 0 && !isLayerDirty_[drawingLayer_] &&
+        !drawn_->empty())
+        layers_[drawingLayer_].push_back(std::move(drawn_));
+    drawn_.reset();
+    drawingLayer_ = -1;
+
     if (staticPainter_ != nullptr) {
+        flushPendingLine();
         staticPainter_->end();
         delete staticPainter_;
         staticPainter_ = nullptr;
 
+        // a render in progress has not seen what was drawn now
+        if (renderWatcher_->isRunning())
+            startRender();
+
         if (paintedXMin_ < 0)
             paintedXMin_ = 0;
         if (paintedXMax_ >= width())
@@ -2820,3 +1860,30 @@ void P4Sphere::signalChanged()
         setPalette(palette);
     */
 }
+
+//---------------------------------------------------------------------
+//                  PRINTING METHODS
+//---------------------------------------------------------------------
+
+void P4Sphere::preparePrinting(int printmethod, bool isblackwhite,
+                               int myresolution, double mylinewidth,
+                               double mysymbolsize)
+{
+    printDevice_ = gP4printer;
+    if (!P4PlotCanvas::preparePrinting(printmethod, isblackwhite,
+                                       myresolution, mylinewidth,
+                                       mysymbolsize)) {
+        if (!printError().isEmpty())
+            msgBar_->showMessage(printError());
+        return;
+    }
+    msgBar_->showMessage("Printing ...");
+}
+
+void P4Sphere::finishPrinting()
+{
+    printParallel_ = P4PrintDlg::sM_lastParallel;
+    if (!P4PlotCanvas::finishPrinting())
+        QMessageBox::critical(this, "P4", printError());
+    msgBar_->showMessage("Printing has finished.");
+}
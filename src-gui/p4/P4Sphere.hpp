@@ -21,14 +21,24 @@
 
 #include <QWidget>
 
+#include <QFutureWatcher>
+#include <QImage>
 #include <QPoint>
+#include <QPolygon>
 #include <QString>
 #include <QVector>
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include "P4DisplayList.hpp"
+#include "P4FlowGrid.hpp"
+#include "P4PlotCanvas.hpp"
+
 #define SELECTINGPOINTSTEPS 5
 #define SELECTINGPOINTSPEED 150
+#define SELECTINGORBITPIXELS 6 // maximum distance when picking an orbit
 
 class QKeyEvent;
 class QMouseEvent;
@@ -39,19 +49,7 @@ class QResizeEvent;
 class QStatusBar;
 class QTimer;
 
-namespace P4Singularities
-{
-struct saddle;
-struct node;
-struct semi_elementary;
-struct weak_focus;
-struct strong_focus;
-struct degenerate;
-} // namespace P4Singularities
-
-struct P4POLYLINES;
-
-class P4Sphere : public QWidget
+class P4Sphere : public QWidget, public P4PlotCanvas
 {
     Q_OBJECT
 
@@ -66,42 +64,25 @@ class P4Sphere : public QWidget
     static QVector<P4Sphere *> sM_sphereList;
 
     /* Member variables */
-    double horPixelsPerMM_;
-    double verPixelsPerMM_;
-
-    double x0_, y0_; // world-coordinates of upper-left corner
-    double x1_, y1_; // world-coordinates of upper-right corner
-    double dx_;      // x1-x0
-    double dy_;      // y1-y0
-
-    QPixmap *painterCache_{nullptr};
+    QImage *painterCache_{nullptr}; // last completed frame
     bool isPainterCacheDirty_{true};
     int paintedXMin_{0}; // to know the update rectangle after painting
     int paintedXMax_;    // we keep to smallest rectangle enclosing
     int paintedYMin_{0}; // all painted objects.
     int paintedYMax_;
 
-    QString chartstring_;
-
-    int spherebgcolor_;
-
     P4Sphere *next_{nullptr}; // visible to PlotWnd
 
     int selectingX_{0}, selectingY_{0};
     int selectingPointStep_{0}, selectingPointRadius_{0};
     QTimer *selectingTimer_{nullptr};
 
-    int oldw_; // used while printing
-    int oldh_;
-    int w_;      // width of window
-    int h_;      // height of window
     int idealh_; // ideal height of window to get good aspect ratio
 
     /* Member functions */
 
     void paintEvent(QPaintEvent *);
 
-    bool getChartPos(int, double, double, double *);
     void adjustToNewSize();
 
     //    void signalEvaluating();
@@ -116,6 +97,7 @@ class P4Sphere : public QWidget
     void plotPointSeparatrices(const P4Singularities::saddle *);
     void plotPointSeparatrices(const P4Singularities::degenerate *);
     void plotPoints();
+    void plotSymbol(void (*plot)(QPainter *, int, int), const double *pos);
 
     void plotSeparatingCurves(); // FIXME:
     void plotSeparatrices();
@@ -125,87 +107,95 @@ class P4Sphere : public QWidget
     void plotPoincareSphere();
     void plotPoincareLyapunovSphere();
     void plotLineAtInfinity();
+    void plotFlowField();
 
     void markSelection(int x1, int y1, int x2, int y2, int selectiontype);
 
-    void printPoint(const P4Singularities::saddle *);
-    void printPoint(const P4Singularities::node *);
-    void printPoint(const P4Singularities::semi_elementary *);
-    void printPoint(const P4Singularities::weak_focus *);
-    void printPoint(const P4Singularities::strong_focus *);
-    void printPoint(const P4Singularities::degenerate *);
-    void printPointSeparatrices(const P4Singularities::semi_elementary *p);
-    void printPointSeparatrices(const P4Singularities::saddle *p);
-    void printPointSeparatrices(const P4Singularities::degenerate *p);
-    void printPoints();
-    void printSeparatrices();
-    void printGcf();
-    void printSeparatingCurves();
-    void printArbitraryCurves(); // FIXME:
-    void printIsoclines();       // FIXME:
-    void printPoincareSphere();
-    void printPoincareLyapunovSphere();
-    void printLineAtInfinity();
-
-    std::vector<P4POLYLINES> produceEllipse(double cx, double cy, double a,
-                                            double b, bool dotted, double resa,
-                                            double resb);
-
     void selectNearestSingularity(const QPoint &winpos);
+    void selectNearestOrbit(const QPoint &winpos);
+    void flashPointSelection(int px, int py);
+
+    // zoom windows can re-integrate orbits and separatrices for more detail
+    void setRefineCurves(bool refine);
+    P4RefineJob *refineJob() override;
+    bool isDrawing() const override;
 
-    void prepareDrawing();
-    void drawPoint(double x, double y, int color);
-    void drawLine(double x1, double y1, double x2, double y2, int color);
-    void finishDrawing();
-    void printOrbits();
-    void printLimitCycles();
+    void prepareDrawing(int layer) override;
+    void drawPoint(double x, double y, int color) override;
+    void drawLine(double x1, double y1, double x2, double y2,
+                  int color) override;
+    void finishDrawing() override;
 
+    // print with gP4printer, reporting on the status bar
     void preparePrinting(int, bool, int, double, double);
-    void printPoint(double x, double y, int color);
-    void print();
-    void printLine(double x1, double y1, double x2, double y2, int color);
     void finishPrinting();
 
     void saveAnchorMap();
     void loadAnchorMap();
 
-    // coordinate changes: from world to windows coordinates
-    int coWinX(double x);
-    int coWinY(double y);
-    // from windows to world coordinates
-    double coWorldX(int x);
-    double coWorldY(int y);
-    int coWinV(double);
-    int coWinH(double);
-
   public slots:
     void resizeEvent(QResizeEvent *e);
     void mouseMoveEvent(QMouseEvent *e);
     void mousePressEvent(QMouseEvent *e);
     void mouseReleaseEvent(QMouseEvent *e);
     void setupPlot();
-    void refresh();
+    void refresh() override;
+    void refreshLayer(int layer) override;
     void keyPressEvent(QKeyEvent *e);
-    void calculateHeightFromWidth(int &width, int &height, int maxheight,
-                                  double aspectratio);
-    void refreshAfterResize();
     void updatePointSelection();
+    void onRenderFinished();
+    void recordNextLayer();
 
   private:
     QWidget *parentWnd_;
     QStatusBar *msgBar_;
 
-    bool iszoom_;
-
-    // when calculating coordinates: this determines orientation of horizontal
-    // axis.  Normally false, only true when printing.
-    bool reverseYAxis_{false};
-
     std::vector<P4POLYLINES> circleAtInfinity_;
     std::vector<P4POLYLINES> plCircle_;
 
     QPainter *staticPainter_{nullptr};
-    QTimer *refreshTimeout_{nullptr};
+
+    // Display lists of the layers, see recordLayer.  A layer is the list in
+    // which it was recorded, followed by those of what has been drawn on it
+    // since.  Published lists never change, so that a render in progress
+    // shares them instead of taking a copy.
+    std::vector<std::shared_ptr<const P4DisplayList>>
+        layers_[P4SphereLayers::numLayers];
+    bool isLayerDirty_[P4SphereLayers::numLayers];
+    std::unique_ptr<P4DisplayList> recorded_;
+    P4DisplayList *recording_{nullptr}; // drawLine/drawPoint record here
+    int drawingLayer_{-1}; // layer drawn in between prepare/finishDrawing
+    std::unique_ptr<P4DisplayList> drawn_; // what is drawn on that layer
+
+    // the steps of the curves to refine, gathered while a layer is recorded,
+    // and those of each layer, integrated again by the render
+    std::unique_ptr<P4RefineJob> refining_;
+    std::shared_ptr<const P4RefineJob> refineJobs_[P4SphereLayers::numLayers];
+
+    // the dirty layers are recorded one per turn of the event loop, after
+    // the paint event that found them
+    QTimer *recordTimer_;
+    void recordLayer(int layer);
+    bool refineCurves_{false};
+
+    // direction field of the window, kept until the view changes
+    P4FlowGrid flowGrid_;
+
+    // polyline gathered by drawLine in between prepare/finishDrawing, and
+    // the window geometry taken by prepareDrawing to map it
+    QPolygon pendingLine_;
+    int pendingColor_{-1};
+    P4WinTransform winView_;
+    void flushPendingLine();
+
+    // the display lists are rasterized into a QImage on a worker thread
+    QFutureWatcher<QImage> *renderWatcher_;
+    std::shared_ptr<std::atomic<bool>> renderCancel_;
+
+    P4WinTransform winTransform() const;
+    void startRender();
+    void cancelRender();
+    bool markStoppedRefineJobs();
 
     bool selectingZoom_{false};
     bool selectingLCSection_{false};
@@ -214,6 +204,4 @@ class P4Sphere : public QWidget
     QPoint lcAnchor1_;
     QPoint lcAnchor2_;
     QPixmap *anchorMap_{nullptr};
-
-    int printMethod_;
 };
@@ -22,6 +22,7 @@
 #include <QBoxLayout>
 #include <QCloseEvent>
 #include <QDir>
+#include <QFile>
 #include <QFileDialog>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -30,6 +31,7 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QSettings>
+#include <QStatusBar>
 #include <QTextBrowser>
 #include <QTextEdit>
 #include <QTextStream>
@@ -42,6 +44,7 @@
 #include "P4PlotWnd.hpp"
 #include "P4ProcessWnd.hpp"
 #include "P4SeparatingCurvesDlg.hpp"
+#include "P4Session.hpp"
 #include "P4VFSelectDlg.hpp"
 #include "custom.hpp"
 #include "main.hpp"
@@ -146,6 +149,16 @@ P4StartDlg::P4StartDlg(const QString &autofilename) : QWidget{}
                      &P4StartDlg::onSaveSignal);
     QObject::connect(gThisVF, &P4InputVF::loadSignal, this,
                      &P4StartDlg::onLoadSignal);
+    QObject::connect(gThisVF, &P4InputVF::processStarted, this,
+                     &P4StartDlg::onProcessStarted);
+    QObject::connect(gThisVF, &P4InputVF::processOutput, this,
+                     &P4StartDlg::onProcessOutput);
+    QObject::connect(gThisVF, &P4InputVF::processStopped, this,
+                     &P4StartDlg::onProcessStopped);
+    // the tables are read once the process has gone
+    QObject::connect(gThisVF, &P4InputVF::separatingCurvesEvaluationFinished,
+                     this, &P4StartDlg::signalSeparatingCurvesEvaluated,
+                     Qt::QueuedConnection);
 
     // setting focus
 
@@ -176,6 +189,10 @@ P4StartDlg::~P4StartDlg()
         delete helpWindow_;
         helpWindow_ = nullptr;
     }
+    if (processWindow_ != nullptr) {
+        delete processWindow_;
+        processWindow_ = nullptr;
+    }
 }
 
 void P4StartDlg::onSaveSignal()
@@ -202,16 +219,11 @@ void P4StartDlg::onSaveSignal()
         settings.setValue("plotWindow", true);
     else
         settings.setValue("plotWindow", false);
-    if (gThisVF != nullptr) {
-        if (gThisVF->outputWindow_ != nullptr) {
-            settings.setValue("outputWindow", true);
-            settings.setValue("outputWindow-size",
-                              gThisVF->outputWindow_->size());
-            settings.setValue("outputWindow-pos",
-                              gThisVF->outputWindow_->pos());
-            settings.setValue("outputWindow-contents",
-                              gThisVF->outputWindow_->getText());
-        }
+    if (processWindow_ != nullptr) {
+        settings.setValue("outputWindow", true);
+        settings.setValue("outputWindow-size", processWindow_->size());
+        settings.setValue("outputWindow-pos", processWindow_->pos());
+        settings.setValue("outputWindow-contents", processWindow_->getText());
     }
     settings.endGroup();
 }
@@ -228,10 +240,8 @@ void P4StartDlg::onLoadSignal()
         if (settings.value("plotWindow").toBool()) {
             if (plotWindow_ != nullptr)
                 plotWindow_->show();
-            else {
-                onPlot();
-                plotWindow_->onLoadSignal();
-            }
+            else
+                reopenPlot_ = true;
         }
         if (settings.value("viewInfiniteWindow").toBool()) {
             if (viewInfiniteWindow_ != nullptr) {
@@ -256,16 +266,12 @@ void P4StartDlg::onLoadSignal()
                 settings.value("viewFiniteWindow-pos").toPoint());
         }
         if (settings.value("outputWindow").toBool()) {
-            if (gThisVF != nullptr) {
-                gThisVF->createProcessWindow();
-                gThisVF->outputWindow_->enableTerminateProcessButton(true);
-                gThisVF->outputWindow_->resize(
-                    settings.value("outputWindow-size").toSize());
-                gThisVF->outputWindow_->move(
-                    settings.value("outputWindow-pos").toPoint());
-                gThisVF->outputWindow_->setText(
-                    settings.value("outputWindow-contents").toString());
-            }
+            createProcessWindow();
+            processWindow_->enableTerminateProcessButton(true);
+            processWindow_->resize(settings.value("outputWindow-size").toSize());
+            processWindow_->move(settings.value("outputWindow-pos").toPoint());
+            processWindow_->setText(
+                settings.value("outputWindow-contents").toString());
         }
     }
     settings.endGroup();
@@ -317,6 +323,8 @@ void P4StartDlg::onPlot()
     if (findWindow_ != nullptr)
         findWindow_->getDataFromDlg();
 
+    plotIsPartial_ = false;
+
     // read maple results
     if (!gVFResults.readTables(gThisVF->getbarefilename(), false, false)) {
         QMessageBox::critical(this, "P4",
@@ -344,6 +352,79 @@ void P4StartDlg::onPlot()
     plotWindow_->adjustHeight();
 }
 
+// Maple has written one more finite singularity.  If a plot is wanted, it is
+// shown with those found before, while the next ones are studied; nothing can
+// be integrated until the finite region is complete (signalFiniteEvaluated)
+// or the study has finished (signalEvaluated).  If a record cannot be read,
+// the plot waits for those.
+void P4StartDlg::signalSingularityEvaluated()
+{
+    if (plotWindow_ == nullptr && !gCmdLineAutoPlot)
+        return;
+    if (!canOpenPlot())
+        return;
+
+    bool first{!gVFResults.singularitiesOnly_};
+    if (first) {
+        if (findWindow_ != nullptr)
+            findWindow_->getDataFromDlg();
+        if (!gVFResults.startReadingSingularities(
+                gThisVF->getbarefilename()))
+            return;
+    }
+    if (!gVFResults.readNextSingularity(gThisVF->getbarefilename()))
+        return;
+
+    if (first) {
+        gVFResults.setupCoordinateTransformations();
+        if (plotWindow_ == nullptr)
+            plotWindow_ = new P4PlotWnd{this};
+        plotWindow_->configure();
+        plotWindow_->show();
+        plotWindow_->raise();
+        plotWindow_->adjustHeight();
+    } else {
+        plotWindow_->signalSingularityEvaluated();
+    }
+    plotWindow_->statusBar()->showMessage(
+        "The finite singularities are still being studied...");
+    plotIsPartial_ = true;
+}
+
+// The tables of the finite region are complete while Maple studies infinity.
+// If a plot is wanted, the singularities are shown right away, and their
+// separatrices can be integrated; signalEvaluated plots the whole study and
+// keeps these curves.  Only the study of the whole sphere (typeofstudy_all)
+// is split in two, see P4InputVF::checkProcessLine.
+void P4StartDlg::signalFiniteEvaluated()
+{
+    if (plotWindow_ == nullptr && !gCmdLineAutoPlot)
+        return;
+    if (!canOpenPlot())
+        return;
+
+    if (findWindow_ != nullptr)
+        findWindow_->getDataFromDlg();
+
+    // nothing to show yet: wait for the whole study
+    if (!gVFResults.readTables(gThisVF->getbarefilename(), false, false,
+                               true))
+        return;
+    gVFResults.readArbitraryCurve(gThisVF->getbarefilename());
+    gVFResults.setupCoordinateTransformations();
+
+    if (plotWindow_ == nullptr)
+        plotWindow_ = new P4PlotWnd{this};
+
+    plotWindow_->configure();
+    plotWindow_->show();
+    plotWindow_->raise();
+    plotWindow_->adjustHeight();
+    plotWindow_->statusBar()->showMessage(
+        "Infinity is still being studied...");
+    plotIsPartial_ = true;
+}
+
 void P4StartDlg::onFilenameChange(const QString &fname)
 {
     gThisVF->filename_ = fname;
@@ -370,6 +451,22 @@ void P4StartDlg::signalEvaluated()
     btn_view_->setEnabled(true);
     btn_plot_->setEnabled(true);
 
+    // Replace the finite region by the whole study.  The tables of infinity
+    // only add singularities after those of the finite region, so the
+    // curves integrated in the meantime can be attached again.
+    if (plotIsPartial_ && plotWindow_ != nullptr) {
+        QByteArray curves{P4Session::keepCurves()};
+        onPlot();
+        if (!curves.isEmpty() && !gVFResults.vf_.empty() &&
+            P4Session::restoreCurves(curves))
+            plotWindow_->signalEvaluated();
+    } else if (gVFResults.partial_) {
+        // the plot was closed in the mean time: what was read while Maple
+        // ran is not kept, the next evaluation starts reading again
+        gVFResults.reset();
+    }
+    plotIsPartial_ = false;
+
     // freshen view finite/infinite windows if they are open:
     if (viewFiniteWindow_ != nullptr) {
         QString fname;
@@ -461,12 +558,27 @@ void P4StartDlg::signalEvaluated()
 
 void P4StartDlg::signalSaved()
 {
-    //
+    // keep what is plotted with the vector field, so that it reopens without
+    // being evaluated and integrated again
+    if (plotWindow_ != nullptr && !plotIsPartial_ && gThisVF->evaluated_ &&
+        !gVFResults.vf_.empty()) {
+        P4Session::save(gThisVF->getfilename_session(),
+                        getCompressSessions());
+    } else {
+        QFile::remove(gThisVF->getfilename_session());
+    }
 }
 
 void P4StartDlg::signalLoaded()
 {
-    //
+    // the vector field is only known when it has been read completely
+    if (reopenPlot_) {
+        reopenPlot_ = false;
+        if (!openSession())
+            onPlot();
+        if (plotWindow_ != nullptr)
+            plotWindow_->onLoadSignal();
+    }
 }
 
 void P4StartDlg::signalChanged()
@@ -670,6 +782,12 @@ void P4StartDlg::customEvent(QEvent *e)
     case TYPE_SIGNAL_EVALUATED:
         signalEvaluated();
         break;
+    case TYPE_SIGNAL_SINGULARITYEVALUATED:
+        signalSingularityEvaluated();
+        break;
+    case TYPE_SIGNAL_FINITEEVALUATED:
+        signalFiniteEvaluated();
+        break;
     case TYPE_SIGNAL_CHANGED:
         signalChanged();
         break;
@@ -682,9 +800,6 @@ void P4StartDlg::customEvent(QEvent *e)
     case TYPE_CLOSE_PLOTWINDOW:
         closePlotWindow();
         break;
-    case TYPE_SIGNAL_SEPARATINGCURVESEVALUATED:
-        signalSeparatingCurvesEvaluated();
-        break;
     default:
         QWidget::customEvent(e);
     }
@@ -718,12 +833,84 @@ bool P4StartDlg::canOpenPlot()
     return true;
 }
 
+bool P4StartDlg::openSession()
+{
+    if (findWindow_ != nullptr)
+        findWindow_->getDataFromDlg();
+
+    if (!canOpenPlot() || !QFile::exists(gThisVF->getfilename_session()))
+        return false;
+    if (!P4Session::load(gThisVF->getfilename_session()))
+        return false;
+
+    plotIsPartial_ = false;
+
+    if (plotWindow_ == nullptr) {
+        plotWindow_ = new P4PlotWnd{this};
+    }
+
+    plotWindow_->configure(); // configure plot window
+    plotWindow_->show();
+    plotWindow_->raise();
+    plotWindow_->adjustHeight();
+    return true;
+}
+
 void P4StartDlg::signalSeparatingCurvesEvaluated()
 {
     if (findWindow_ != nullptr)
         findWindow_->signalSeparatingCurvesEvaluated();
 }
 
+// -----------------------------------------------------------------------
+//          THE OUTPUT OF MAPLE
+// -----------------------------------------------------------------------
+
+void P4StartDlg::createProcessWindow()
+{
+    if (processWindow_ != nullptr) {
+        if (processWindow_->isVisible() == false)
+            processWindow_->show();
+        processWindow_->activateWindow();
+        processWindow_->raise();
+        return;
+    }
+
+    processWindow_ = new P4ProcessWnd{};
+
+    QObject::connect(processWindow_, &P4ProcessWnd::terminateSignal, gThisVF,
+                     &P4InputVF::onTerminateButton);
+}
+
+void P4StartDlg::onProcessStarted()
+{
+    if (processWindow_ == nullptr)
+        createProcessWindow();
+    else {
+        processWindow_->appendText(
+            "\n\n--------------------------------------------------------------"
+            "-----------------\n\n");
+        processWindow_->enableTerminateProcessButton(true);
+        processWindow_->show();
+        processWindow_->raise();
+    }
+}
+
+void P4StartDlg::onProcessOutput(const QString &text)
+{
+    if (processWindow_ != nullptr)
+        processWindow_->appendText(text);
+}
+
+void P4StartDlg::onProcessStopped()
+{
+    if (processWindow_ != nullptr) {
+        processWindow_->enableTerminateProcessButton(false);
+        processWindow_->show();
+        processWindow_->raise();
+    }
+}
+
 void P4StartDlg::closePlotWindow()
 {
     if (plotWindow_ != nullptr) {
@@ -33,8 +33,8 @@ class QString;
 
 class P4FindDlg;
 class P4PlotWnd;
+class P4ProcessWnd;
 
-#define TYPE_SIGNAL_SEPARATINGCURVESEVALUATED (QEvent::User + 1)
 #define TYPE_SIGNAL_EVALUATED (QEvent::User + 2)
 #define TYPE_SIGNAL_CHANGED (QEvent::User + 3)
 #define TYPE_SIGNAL_LOADED (QEvent::User + 4)
@@ -47,6 +47,8 @@ class P4PlotWnd;
 #define TYPE_CLOSE_ZOOMWINDOW (QEvent::User + 10)
 #define TYPE_OPENZOOMWINDOW (QEvent::User + 11)
 #define TYPE_SELECT_LCSECTION (QEvent::User + 12)
+#define TYPE_SIGNAL_FINITEEVALUATED (QEvent::User + 13)
+#define TYPE_SIGNAL_SINGULARITYEVALUATED (QEvent::User + 14)
 
 struct DOUBLEPOINT {
     double x;
@@ -73,6 +75,8 @@ class P4StartDlg : public QWidget
     // happened:
     void signalEvaluating();
     void signalEvaluated();
+    void signalSingularityEvaluated();
+    void signalFiniteEvaluated();
     void signalChanged();
     void signalLoaded();
     void signalSaved();
@@ -93,6 +97,10 @@ class P4StartDlg : public QWidget
     void showText(QTextEdit &win, const QString &caption, const QString &fname);
     void onSaveSignal();
     void onLoadSignal();
+    // the output of the Maple process of gThisVF
+    void onProcessStarted();
+    void onProcessOutput(const QString &text);
+    void onProcessStopped();
 
   private:
     QBoxLayout *mainLayout_;
@@ -111,8 +119,15 @@ class P4StartDlg : public QWidget
 
     P4FindDlg *findWindow_{nullptr};
     P4PlotWnd *plotWindow_{nullptr};
+    P4ProcessWnd *processWindow_{nullptr};
+    // the plot window shows the finite region while Maple is still busy
+    bool plotIsPartial_{false};
+    // the saved plot window is reopened once the vector field is loaded
+    bool reopenPlot_{false};
 
     bool canOpenPlot();
+    bool openSession();
+    void createProcessWindow();
 };
 
 extern P4StartDlg *gP4startDlg;
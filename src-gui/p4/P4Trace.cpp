@@ -0,0 +1,172 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4Trace.hpp"
+
+#include <cstdarg>
+
+std::mutex P4Trace::sM_mutex;
+FILE *P4Trace::sM_fp{nullptr};
+bool P4Trace::sM_first{true};
+std::atomic<bool> P4Trace::sM_on{false};
+std::atomic<long> P4Trace::sM_lastId{0};
+std::atomic<int> P4Trace::sM_lastThread{0};
+std::chrono::steady_clock::time_point P4Trace::sM_start;
+
+// The events all belong to one process.  The thread that starts the trace
+// is thread 1, the others are numbered in the order in which they first
+// record something.
+#define TRACE_PID 1
+
+static thread_local int sThreadId{0};
+
+// -----------------------------------------------------------------------
+//                      START/STOP
+// -----------------------------------------------------------------------
+
+bool P4Trace::start(const char *filename)
+{
+    std::lock_guard<std::mutex> lock{sM_mutex};
+
+    if (sM_fp != nullptr || filename == nullptr || *filename == 0)
+        return false;
+
+    sM_fp = fopen(filename, "w");
+    if (sM_fp == nullptr)
+        return false;
+
+    sThreadId = 1;
+    sM_lastThread = 1;
+    fprintf(sM_fp, "[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                   "\"tid\":1,\"args\":{\"name\":\"main\"}}",
+            TRACE_PID);
+    sM_first = false;
+    sM_start = std::chrono::steady_clock::now();
+    sM_on = true;
+    return true;
+}
+
+void P4Trace::stop()
+{
+    std::lock_guard<std::mutex> lock{sM_mutex};
+
+    if (sM_fp == nullptr)
+        return;
+
+    sM_on = false;
+    fprintf(sM_fp, "\n]\n");
+    fclose(sM_fp);
+    sM_fp = nullptr;
+}
+
+long long P4Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - sM_start)
+        .count();
+}
+
+// -----------------------------------------------------------------------
+//                      EVENTS
+// -----------------------------------------------------------------------
+
+void P4Trace::complete(const char *name, const char *cat, long long t0,
+                       const char *argname, long argvalue)
+{
+    long long t1;
+    int tid;
+
+    if (!isOn())
+        return;
+
+    t1 = now();
+    tid = threadId();
+    if (argname == nullptr)
+        writeEvent("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,"
+                   "\"dur\":%lld,\"pid\":%d,\"tid\":%d}",
+                   name, cat, t0, t1 - t0, TRACE_PID, tid);
+    else
+        writeEvent("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,"
+                   "\"dur\":%lld,\"pid\":%d,\"tid\":%d,"
+                   "\"args\":{\"%s\":%ld}}",
+                   name, cat, t0, t1 - t0, TRACE_PID, tid, argname,
+                   argvalue);
+}
+
+void P4Trace::completeAsync(const char *name, const char *cat, long id,
+                            long long t0)
+{
+    long long t1;
+    int tid;
+
+    if (!isOn())
+        return;
+
+    t1 = now();
+    tid = threadId();
+    writeEvent("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%ld,"
+               "\"ts\":%lld,\"pid\":%d,\"tid\":%d}",
+               name, cat, id, t0, TRACE_PID, tid);
+    writeEvent("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%ld,"
+               "\"ts\":%lld,\"pid\":%d,\"tid\":%d}",
+               name, cat, id, t1, TRACE_PID, tid);
+}
+
+void P4Trace::instant(const char *name, const char *cat)
+{
+    if (!isOn())
+        return;
+
+    writeEvent("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+               "\"ts\":%lld,\"pid\":%d,\"tid\":%d}",
+               name, cat, now(), TRACE_PID, threadId());
+}
+
+// The other threads are workers of the thread pool.  Each gets a name in
+// the viewer when it first records something.
+int P4Trace::threadId()
+{
+    if (sThreadId == 0) {
+        sThreadId = ++sM_lastThread;
+        writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                   "\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}",
+                   TRACE_PID, sThreadId, sThreadId - 1);
+    }
+    return sThreadId;
+}
+
+void P4Trace::writeEvent(const char *fmt, ...)
+{
+    va_list args;
+    std::lock_guard<std::mutex> lock{sM_mutex};
+
+    if (sM_fp == nullptr)
+        return;
+
+    if (!sM_first)
+        fprintf(sM_fp, ",\n");
+    sM_first = false;
+
+    va_start(args, fmt);
+    vfprintf(sM_fp, fmt, args);
+    va_end(args);
+
+    // a crash must not lose what is still in the buffer of the stream
+    fflush(sM_fp);
+}
@@ -0,0 +1,102 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+// Records where the time goes as Chrome trace events, which chrome://tracing,
+// Perfetto and most other trace viewers show as a timeline.
+//
+// Tracing is off until P4Trace::start is given a file: p4 and p4-render take
+// it from the environment variable P4_TRACE, or else from the "Trace File"
+// setting.  Each event is written out to the file when it completes, so that a
+// trace cut short by a crash can still be opened: viewers do not need the
+// closing bracket written by P4Trace::stop.  Names and categories are string
+// literals without quotes; they are not escaped.
+
+class P4Trace
+{
+  public:
+    static bool start(const char *filename);
+    static void stop();
+    static bool isOn() { return sM_on.load(std::memory_order_relaxed); }
+
+    // microseconds since start
+    static long long now();
+    // identifies one pair of asynchronous events
+    static long newId() { return ++sM_lastId; }
+
+    // a span from t0 till now on the calling thread ("X" event)
+    static void complete(const char *name, const char *cat, long long t0,
+                         const char *argname = nullptr, long argvalue = 0);
+    // a span from t0 till now that is not bound to a thread, like the
+    // lifetime of a Maple process ("b" and "e" events)
+    static void completeAsync(const char *name, const char *cat, long id,
+                              long long t0);
+    // a moment ("i" event)
+    static void instant(const char *name, const char *cat);
+
+  private:
+    static std::mutex sM_mutex;
+    static FILE *sM_fp;
+    static bool sM_first;
+    static std::atomic<bool> sM_on;
+    static std::atomic<long> sM_lastId;
+    static std::atomic<int> sM_lastThread;
+    static std::chrono::steady_clock::time_point sM_start;
+
+    static int threadId();
+    static void writeEvent(const char *fmt, ...);
+};
+
+// Records the time from its construction till the end of the scope:
+//
+//      P4TraceSpan span{"readTables", "study"};
+//
+// It costs a single test when tracing is off.
+
+class P4TraceSpan
+{
+  public:
+    P4TraceSpan(const char *name, const char *cat,
+                const char *argname = nullptr, long argvalue = 0)
+        : name_{name}, cat_{cat}, argname_{argname}, argvalue_{argvalue},
+          t0_{P4Trace::isOn() ? P4Trace::now() : -1}
+    {
+    }
+    ~P4TraceSpan()
+    {
+        if (t0_ >= 0)
+            P4Trace::complete(name_, cat_, t0_, argname_, argvalue_);
+    }
+
+    P4TraceSpan(const P4TraceSpan &) = delete;
+    P4TraceSpan &operator=(const P4TraceSpan &) = delete;
+
+  private:
+    const char *name_;
+    const char *cat_;
+    const char *argname_;
+    long argvalue_;
+    long long t0_;
+};
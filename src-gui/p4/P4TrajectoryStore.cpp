@@ -0,0 +1,492 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "P4TrajectoryStore.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "P4Trace.hpp"
+#include "p4settings.hpp"
+#include "structures.hpp"
+
+// points of a chunk, its first and last point included
+#define STORE_CHUNKPOINTS 4096
+
+// number of points of the summary of a chunk, apart from the jumps and the
+// changes of color
+#define STORE_SUMMARYPOINTS 64
+
+// a point as it is kept in the scratch file
+struct p4storedpoint {
+    double pcoord[3];
+    int32_t color;
+    int32_t dashes;
+    int32_t dir;
+    int32_t type;
+};
+
+// The chunks of a curve follow each other: the point after the last point
+// of one chunk is the first point of the next.  The last chunk is open, it
+// grows with the curve and is never moved out.  The other ones do not change
+// anymore, so that their copy in the scratch file is kept when they are read
+// back, and moving them out again costs nothing.
+struct p4storedchunk {
+    P4Orbits::orbits_points *first;
+    P4Orbits::orbits_points *last;
+    long n;        // points from first to last
+    long resident; // points in memory: n, or those of the summary
+    bool spilled;
+    qint64 offset; // copy in the scratch file, or -1
+    unsigned long used; // for the LRU order
+};
+
+struct p4storedcurve {
+    P4Orbits::orbits_points **first{nullptr};
+    // the first point when the curve was last seen
+    P4Orbits::orbits_points *head{nullptr};
+    std::vector<p4storedchunk> chunks;
+};
+
+// The maps are never deleted: curves are still forgotten when other static
+// objects, like gVFResults, are destroyed at exit.
+static auto &sCurves = *new std::map<P4Orbits::orbits_points **, p4storedcurve>;
+// the first point of every curve, for P4CurveReader
+static auto &sHeads =
+    *new std::map<P4Orbits::orbits_points *, P4Orbits::orbits_points **>;
+static long sResident{0};
+static unsigned long sClock{0};
+
+static QTemporaryFile *sScratch{nullptr};
+static qint64 sScratchSize{0};
+// free parts of the scratch file, offset -> size
+static auto &sFree = *new std::map<qint64, qint64>;
+
+// -----------------------------------------------------------------------
+//                      SCRATCH FILE
+// -----------------------------------------------------------------------
+
+// removes the scratch file when the application ends
+static void closeScratch()
+{
+    delete sScratch;
+    sScratch = nullptr;
+    sScratchSize = 0;
+    sFree.clear();
+    for (auto &it : sCurves) {
+        for (auto &k : it.second.chunks)
+            k.offset = -1;
+    }
+}
+
+static qint64 allocate(qint64 size)
+{
+    for (auto it = std::begin(sFree); it != std::end(sFree); ++it) {
+        if (it->second >= size) {
+            qint64 offset{it->first};
+            qint64 rest{it->second - size};
+            sFree.erase(it);
+            if (rest > 0)
+                sFree[offset + size] = rest;
+            return offset;
+        }
+    }
+
+    if (sScratch == nullptr) {
+        // like the other temporary files, in the current directory when no
+        // path is set
+        QString path{getP4TempPath()};
+        if (!path.isEmpty())
+            path += QDir::separator();
+        sScratch = new QTemporaryFile{path + "p4curves-XXXXXX"};
+        sScratchSize = 0;
+        if (!sScratch->open()) {
+            delete sScratch;
+            sScratch = nullptr;
+            return -1;
+        }
+        qAddPostRoutine(closeScratch);
+    }
+    if (!sScratch->resize(sScratchSize + size))
+        return -1;
+
+    qint64 offset{sScratchSize};
+    sScratchSize += size;
+    return offset;
+}
+
+static void release(qint64 offset, qint64 size)
+{
+    if (sScratch == nullptr)
+        return;
+
+    auto next = sFree.lower_bound(offset);
+    if (next != std::end(sFree) && offset + size == next->first) {
+        size += next->second;
+        next = sFree.erase(next);
+    }
+    if (next != std::begin(sFree)) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            sFree.erase(prev);
+        }
+    }
+
+    if (offset + size == sScratchSize) {
+        sScratchSize = offset;
+        sScratch->resize(sScratchSize);
+    } else {
+        sFree[offset] = size;
+    }
+}
+
+static qint64 copySize(const p4storedchunk &k)
+{
+    return k.n * static_cast<qint64>(sizeof(p4storedpoint));
+}
+
+static void dropCopy(p4storedchunk &k)
+{
+    if (k.offset >= 0) {
+        release(k.offset, copySize(k));
+        k.offset = -1;
+    }
+}
+
+static bool writeCopy(p4storedchunk &k)
+{
+    qint64 size{copySize(k)};
+    qint64 offset{allocate(size)};
+    if (offset < 0)
+        return false;
+
+    uchar *map{sScratch->map(offset, size)};
+    if (map == nullptr) {
+        release(offset, size);
+        return false;
+    }
+
+    auto q = reinterpret_cast<p4storedpoint *>(map);
+    auto p = k.first;
+    for (long i = 0; i < k.n; i++, p = p->nextpt, q++) {
+        q->pcoord[0] = p->pcoord[0];
+        q->pcoord[1] = p->pcoord[1];
+        q->pcoord[2] = p->pcoord[2];
+        q->color = p->color;
+        q->dashes = p->dashes;
+        q->dir = p->dir;
+        q->type = p->type;
+    }
+    sScratch->unmap(map);
+
+    k.offset = offset;
+    return true;
+}
+
+// Calls point(i, p) for the points 1, ..., n-2 of the copy of the chunk,
+// i.e. for all but its first and last point.
+template <typename F> static bool readCopy(const p4storedchunk &k, F point)
+{
+    P4TraceSpan span{"read chunk", "curves", "points", k.n};
+    qint64 size{copySize(k)};
+
+    if (sScratch == nullptr || k.offset < 0)
+        return false;
+    uchar *map{sScratch->map(k.offset, size)};
+    if (map == nullptr)
+        return false;
+
+    auto q = reinterpret_cast<const p4storedpoint *>(map);
+    for (long i = 1; i < k.n - 1; i++) {
+        double pc[3]{q[i].pcoord[0], q[i].pcoord[1], q[i].pcoord[2]};
+        point(i, P4Orbits::orbits_points{pc, q[i].color, q[i].dashes,
+                                         q[i].dir, q[i].type});
+    }
+    sScratch->unmap(map);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                      MOVING CHUNKS OUT AND IN
+// -----------------------------------------------------------------------
+
+// not through the destructor, which recurses along the whole list
+static void deleteList(P4Orbits::orbits_points *p)
+{
+    while (p != nullptr) {
+        auto q = p->nextpt;
+        p->nextpt = nullptr;
+        delete p;
+        p = q;
+    }
+}
+
+// deletes the points in between the first and the last point of the chunk
+static void deleteInterior(p4storedchunk &k)
+{
+    auto p = k.first->nextpt;
+    while (p != k.last) {
+        auto q = p->nextpt;
+        p->nextpt = nullptr;
+        delete p;
+        p = q;
+    }
+    k.first->nextpt = k.last;
+}
+
+// The summary keeps every jump and the point before it, and the points where
+// the color changes, so that it is drawn with the same pieces and colors as
+// the chunk.
+static bool spill(p4storedchunk &k)
+{
+    P4TraceSpan span{"spill chunk", "curves", "points", k.n};
+    long stride{std::max(1L, k.n / STORE_SUMMARYPOINTS)};
+    P4Orbits::orbits_points *first{nullptr}, *tail{nullptr};
+    long count{2};
+
+    if (k.offset < 0 && !writeCopy(k))
+        return false;
+
+    auto p = k.first;
+    for (long i = 1; p->nextpt != k.last; i++) {
+        auto prev = p;
+        p = p->nextpt;
+        auto next = p->nextpt;
+        if (i % stride == 0 || !p->dashes || !next->dashes ||
+            p->color != prev->color || next->color != p->color) {
+            auto q = new P4Orbits::orbits_points{p->pcoord, p->color,
+                                                 p->dashes, p->dir, p->type};
+            if (tail == nullptr)
+                first = q;
+            else
+                tail->nextpt = q;
+            tail = q;
+            count++;
+        }
+    }
+
+    deleteInterior(k);
+    if (tail != nullptr) {
+        k.first->nextpt = first;
+        tail->nextpt = k.last;
+    }
+
+    sResident -= k.resident - count;
+    k.resident = count;
+    k.spilled = true;
+    return true;
+}
+
+static bool pageIn(p4storedchunk &k)
+{
+    P4Orbits::orbits_points *first{nullptr}, *tail{nullptr};
+
+    if (!readCopy(k, [&](long, const P4Orbits::orbits_points &q) {
+            auto p = new P4Orbits::orbits_points{q};
+            if (tail == nullptr)
+                first = p;
+            else
+                tail->nextpt = p;
+            tail = p;
+        })) {
+        deleteList(first);
+        return false;
+    }
+
+    deleteInterior(k);
+    if (tail != nullptr) {
+        k.first->nextpt = first;
+        tail->nextpt = k.last;
+    }
+
+    sResident += k.n - k.resident;
+    k.resident = k.n;
+    k.spilled = false;
+    k.used = ++sClock;
+    return true;
+}
+
+static qint64 residentLimit()
+{
+    qint64 limit{getMemoryBudget()};
+    if (limit <= 0)
+        return -1;
+    return limit * 1024 * 1024 / sizeof(P4Orbits::orbits_points);
+}
+
+// Moves the least recently used chunks out until the budget is met.  The
+// last chunk of a curve is open, and stays in memory.
+static void fit()
+{
+    qint64 limit{residentLimit()};
+    if (limit < 0)
+        return;
+
+    while (sResident > limit) {
+        p4storedchunk *lru{nullptr};
+        for (auto &it : sCurves) {
+            auto &chunks = it.second.chunks;
+            for (auto k = std::begin(chunks); k + 1 < std::end(chunks); ++k) {
+                if (!k->spilled && (lru == nullptr || k->used < lru->used))
+                    lru = &*k;
+            }
+        }
+        if (lru == nullptr || !spill(*lru))
+            break;
+    }
+}
+
+static void clearChunks(p4storedcurve &c)
+{
+    for (auto &k : c.chunks) {
+        dropCopy(k);
+        sResident -= k.resident;
+    }
+    c.chunks.clear();
+}
+
+static void setHead(p4storedcurve &c, P4Orbits::orbits_points *head)
+{
+    auto it = sHeads.find(c.head);
+    if (it != std::end(sHeads) && it->second == c.first)
+        sHeads.erase(it);
+    c.head = head;
+    if (head != nullptr)
+        sHeads[head] = c.first;
+}
+
+// -----------------------------------------------------------------------
+//                      P4TrajectoryStore
+// -----------------------------------------------------------------------
+
+void P4TrajectoryStore::grown(P4Orbits::orbits_points **first)
+{
+    if (*first == nullptr) {
+        forget(first);
+        return;
+    }
+
+    auto &c = sCurves[first];
+    c.first = first;
+
+    if (c.head != *first) {
+        // a new curve, or one whose points have been replaced
+        clearChunks(c);
+        setHead(c, *first);
+    }
+    if (c.chunks.empty()) {
+        c.chunks.push_back({*first, *first, 1, 1, false, -1, ++sClock});
+        sResident++;
+    }
+
+    // the points that have been added after the last one seen
+    auto k = &c.chunks.back();
+    for (auto p = k->last->nextpt; p != nullptr; p = p->nextpt) {
+        if (k->n == STORE_CHUNKPOINTS) {
+            c.chunks.push_back({p, p, 1, 1, false, -1, 0});
+            k = &c.chunks.back();
+        } else {
+            k->last = p;
+            k->n++;
+            k->resident++;
+        }
+        k->used = ++sClock;
+        sResident++;
+    }
+
+    fit();
+}
+
+void P4TrajectoryStore::forget(P4Orbits::orbits_points **first)
+{
+    auto it = sCurves.find(first);
+    if (it == std::end(sCurves))
+        return;
+
+    auto &c = it->second;
+    setHead(c, nullptr);
+    clearChunks(c);
+    sCurves.erase(it);
+}
+
+// -----------------------------------------------------------------------
+//                      P4CurveReader
+// -----------------------------------------------------------------------
+
+P4CurveReader::P4CurveReader(P4Orbits::orbits_points *first, bool all)
+    : p_{first}, curve_{nullptr}
+{
+    if (!all || first == nullptr)
+        return;
+
+    auto h = sHeads.find(first);
+    if (h == std::end(sHeads))
+        return;
+    auto &c = sCurves[h->second];
+    if (*c.first == first)
+        curve_ = &c;
+}
+
+P4CurveReader::~P4CurveReader() = default;
+
+const P4Orbits::orbits_points *P4CurveReader::next()
+{
+    if (pos_ < size_)
+        return &buffer_[pos_++];
+
+    auto p = p_;
+    if (p == nullptr)
+        return nullptr;
+    p_ = p->nextpt;
+
+    if (curve_ == nullptr || chunk_ >= curve_->chunks.size() ||
+        p != curve_->chunks[chunk_].first)
+        return p;
+
+    // the first point of a chunk
+    auto &k = curve_->chunks[chunk_++];
+    if (!k.spilled)
+        return p;
+
+    qint64 limit{residentLimit()};
+    if ((limit < 0 || sResident + k.n - k.resident <= limit) && pageIn(k)) {
+        p_ = p->nextpt;
+        return p;
+    }
+
+    if (buffer_ == nullptr)
+        buffer_.reset(new P4Orbits::orbits_points[STORE_CHUNKPOINTS]);
+    if (readCopy(k, [&](long i, const P4Orbits::orbits_points &q) {
+            buffer_[i - 1] = q;
+        })) {
+        size_ = k.n - 2;
+        pos_ = 0;
+        p_ = k.last;
+    }
+    return p;
+}
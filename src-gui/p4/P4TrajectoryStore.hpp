@@ -0,0 +1,75 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+
+namespace P4Orbits
+{
+struct orbits_points;
+}
+
+struct p4storedcurve;
+
+// Keeps the points of the orbits, limit cycles and separatrices within the
+// memory budget of the settings (see getMemoryBudget).  A curve is known by
+// the pointer to its first point in the struct that owns it, and is divided
+// in chunks of STORE_CHUNKPOINTS points.  When the curves hold more points
+// than the budget allows, the least recently used chunks are copied to a
+// memory-mapped scratch file.  In memory, only the first and the last point
+// of such a chunk are kept, with a summary of the points in between: a few
+// of them, together with every jump and every change of color, so that the
+// curve can still be drawn in the plot window and continued.  The first and
+// the last point of a curve never move.  P4CurveReader reads all the points
+// back.  Everything happens on the GUI thread.
+
+class P4TrajectoryStore
+{
+  public:
+    // the curve owned at first has been started or continued
+    static void grown(P4Orbits::orbits_points **first);
+    // the owner is about to delete the points of the curve
+    static void forget(P4Orbits::orbits_points **first);
+};
+
+// Walks the points of a curve.  With all, also the points of the chunks that
+// have been moved out are returned: such a chunk is read back into memory if
+// the budget allows it, or else decoded into a buffer of the reader without
+// taking memory from the other curves.  Without all, only the summary of
+// these chunks is seen, as when following nextpt.  A point returned stays
+// valid while the next one is read, so that steps can be drawn from the
+// previous point.
+
+class P4CurveReader
+{
+  public:
+    P4CurveReader(P4Orbits::orbits_points *first, bool all);
+    ~P4CurveReader();
+
+    // the next point of the curve, or nullptr at its end
+    const P4Orbits::orbits_points *next();
+
+  private:
+    P4Orbits::orbits_points *p_;  // next point in memory
+    p4storedcurve *curve_;        // chunks of the curve, or nullptr
+    unsigned long chunk_{0};      // chunk that starts at or after p_
+    std::unique_ptr<P4Orbits::orbits_points[]> buffer_;
+    long size_{0}, pos_{0}; // points decoded in buffer_, and read
+};
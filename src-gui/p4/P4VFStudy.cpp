@@ -22,7 +22,7 @@
 #include <QByteArray>
 #include <QFile>
 #include <QString>
-#include <QTextEdit>
+#include <QStringList>
 
 #include "P4ParentStudy.hpp"
 #include "math_polynom.hpp"
@@ -305,47 +305,46 @@ bool P4VFStudy::readVectorFieldCylinder(FILE *fp, P4Polynom::term3 *vf[2])
 // -----------------------------------------------------------------------
 bool P4VFStudy::readPoints(FILE *fp)
 {
-    int N, i, typ;
+    int N, i;
 
     if (fscanf(fp, "%d", &N) != 1 || N < 0)
         return false;
 
     for (i = 0; i < N; i++) {
-        if (fscanf(fp, "%d ", &typ) != 1)
+        if (!readPoint(fp))
             return false;
-
-        switch (typ) {
-        case P4SingularityType::saddle:
-            if (!readSaddlePoint(fp))
-                return false;
-            break;
-        case P4SingularityType::semi_hyperbolic:
-            if (!readSemiElementaryPoint(fp))
-                return false;
-            break;
-        case P4SingularityType::node:
-            if (!readNodePoint(fp))
-                return false;
-            break;
-        case P4SingularityType::strong_focus:
-            if (!readStrongFocusPoint(fp))
-                return false;
-            break;
-        case P4SingularityType::weak_focus:
-            if (!readWeakFocusPoint(fp))
-                return false;
-            break;
-        case P4SingularityType::non_elementary:
-            if (!readDegeneratePoint(fp))
-                return false;
-            break;
-        default:
-            return false;
-        }
     }
     return true;
 }
 
+// -----------------------------------------------------------------------
+//          P4VFStudy::readPoint
+// -----------------------------------------------------------------------
+bool P4VFStudy::readPoint(FILE *fp)
+{
+    int typ;
+
+    if (fscanf(fp, "%d ", &typ) != 1)
+        return false;
+
+    switch (typ) {
+    case P4SingularityType::saddle:
+        return readSaddlePoint(fp);
+    case P4SingularityType::semi_hyperbolic:
+        return readSemiElementaryPoint(fp);
+    case P4SingularityType::node:
+        return readNodePoint(fp);
+    case P4SingularityType::strong_focus:
+        return readStrongFocusPoint(fp);
+    case P4SingularityType::weak_focus:
+        return readWeakFocusPoint(fp);
+    case P4SingularityType::non_elementary:
+        return readDegeneratePoint(fp);
+    default:
+        return false;
+    }
+}
+
 // -----------------------------------------------------------------------
 //          P4VFStudy::readSaddlePoint
 // -----------------------------------------------------------------------
@@ -1185,7 +1184,8 @@ bool P4VFStudy::readBlowupPoints(FILE *fp, P4Blowup::blow_up_points *b, int n)
 //          DUMP FUNCTIONS
 // -----------------------------------------------------------------------
 
-void P4VFStudy::dumpSeparatrices(QTextEdit &m, P4Blowup::sep *separ, int margin)
+void P4VFStudy::dumpSeparatrices(QStringList &m, P4Blowup::sep *separ,
+                                 int margin)
 {
     QString s;
     char smargin[80];
@@ -1230,7 +1230,7 @@ void P4VFStudy::dumpSeparatrices(QTextEdit &m, P4Blowup::sep *separ, int margin)
 }
 
 // dump saddle singularities
-void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::saddle *p,
+void P4VFStudy::dumpSingularities(QStringList &m, P4Singularities::saddle *p,
                                   bool longversion)
 {
     const char *chart;
@@ -1279,7 +1279,8 @@ void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::saddle *p,
 }
 
 // dump degenerate singularities
-void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::degenerate *p,
+void P4VFStudy::dumpSingularities(QStringList &m,
+                                  P4Singularities::degenerate *p,
                                   bool longversion)
 {
     const char *chart;
@@ -1318,7 +1319,7 @@ void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::degenerate *p,
 }
 
 // dump strong focus singularities
-void P4VFStudy::dumpSingularities(QTextEdit &m,
+void P4VFStudy::dumpSingularities(QStringList &m,
                                   P4Singularities::strong_focus *p,
                                   bool longversion)
 {
@@ -1366,7 +1367,8 @@ void P4VFStudy::dumpSingularities(QTextEdit &m,
 }
 
 // dump weak focus singularities
-void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::weak_focus *p,
+void P4VFStudy::dumpSingularities(QStringList &m,
+                                  P4Singularities::weak_focus *p,
                                   bool longversion)
 {
     const char *chart;
@@ -1404,7 +1406,7 @@ void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::weak_focus *p,
 }
 
 // dump node singularities
-void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::node *p,
+void P4VFStudy::dumpSingularities(QStringList &m, P4Singularities::node *p,
                                   bool longversion)
 {
     const char *chart;
@@ -1451,7 +1453,7 @@ void P4VFStudy::dumpSingularities(QTextEdit &m, P4Singularities::node *p,
 }
 
 // dump semi elementary singularities
-void P4VFStudy::dumpSingularities(QTextEdit &m,
+void P4VFStudy::dumpSingularities(QStringList &m,
                                   P4Singularities::semi_elementary *p,
                                   bool longversion)
 {
@@ -1502,7 +1504,7 @@ void P4VFStudy::dumpSingularities(QTextEdit &m,
     }
 }
 
-void P4VFStudy::dump(QTextEdit &m)
+void P4VFStudy::dump(QStringList &m)
 {
     QString s;
     QByteArray ss;
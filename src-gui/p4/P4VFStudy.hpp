@@ -21,9 +21,9 @@
 
 #include <QObject>
 
-#include "structures.hpp"
+#include <QStringList>
 
-class QTextEdit;
+#include "structures.hpp"
 
 class P4ParentStudy;
 
@@ -84,6 +84,8 @@ class P4VFStudy : public QObject
     bool readVectorFieldCylinder(FILE *fp, P4Polynom::term3 *vf[]);
 
     bool readPoints(FILE *fp);
+    // one singularity, as Maple writes it after its type
+    bool readPoint(FILE *fp);
     bool readSaddlePoint(FILE *fp);
     bool readSemiElementaryPoint(FILE *fp);
     bool readStrongFocusPoint(FILE *fp);
@@ -95,20 +97,21 @@ class P4VFStudy : public QObject
 
     void setupCoordinateTransformations(); // see math_p4.cpp
 
-    void dump(QTextEdit &m);
+    void dump(QStringList &m);
 
   private:
-    void dumpSeparatrices(QTextEdit &m, P4Blowup::sep *separ, int margin);
-    void dumpSingularities(QTextEdit &m, P4Singularities::saddle *p,
+    void dumpSeparatrices(QStringList &m, P4Blowup::sep *separ, int margin);
+    void dumpSingularities(QStringList &m, P4Singularities::saddle *p,
                            bool longversion);
-    void dumpSingularities(QTextEdit &m, P4Singularities::degenerate *p,
+    void dumpSingularities(QStringList &m, P4Singularities::degenerate *p,
                            bool longversion);
-    void dumpSingularities(QTextEdit &m, P4Singularities::strong_focus *p,
+    void dumpSingularities(QStringList &m, P4Singularities::strong_focus *p,
                            bool longversion);
-    void dumpSingularities(QTextEdit &m, P4Singularities::weak_focus *p,
+    void dumpSingularities(QStringList &m, P4Singularities::weak_focus *p,
                            bool longversion);
-    void dumpSingularities(QTextEdit &m, P4Singularities::node *p,
+    void dumpSingularities(QStringList &m, P4Singularities::node *p,
                            bool longversion);
-    void dumpSingularities(QTextEdit &m, P4Singularities::semi_elementary *p,
+    void dumpSingularities(QStringList &m,
+                           P4Singularities::semi_elementary *p,
                            bool longversion);
 };
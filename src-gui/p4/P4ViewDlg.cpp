@@ -34,6 +34,7 @@
 #include "custom.hpp"
 #include "main.hpp"
 #include "math_p4.hpp"
+#include "math_refine.hpp"
 #include "structures.hpp"
 
 P4ViewDlg::~P4ViewDlg() { getDataFromDlg(); }
@@ -86,6 +87,19 @@ P4ViewDlg::P4ViewDlg(bool virtualchk, QWidget *parent)
     lbl_y1->setFont(gP4app->getBoldFont());
     edt_y1_ = new QLineEdit{"1", this};
 
+    auto lbl_flow = new QLabel{"Direction field: ", this};
+    lbl_flow->setFont(gP4app->getBoldFont());
+
+    auto flowgrp = new QButtonGroup{this};
+    btn_flownone_ = new QRadioButton{"None", this};
+    btn_flowarrows_ = new QRadioButton{"Arrows", this};
+    btn_flowspeed_ = new QRadioButton{"Speed", this};
+    btn_flowdivergence_ = new QRadioButton{"Divergence", this};
+    flowgrp->addButton(btn_flownone_);
+    flowgrp->addButton(btn_flowarrows_);
+    flowgrp->addButton(btn_flowspeed_);
+    flowgrp->addButton(btn_flowdivergence_);
+
     if (haveVirtualCheckBox_)
         chk_plotvirtuals_ = new QCheckBox{"Plot Virtual Singularities", this};
 
@@ -108,6 +122,15 @@ P4ViewDlg::P4ViewDlg(bool virtualchk, QWidget *parent)
     btn_square_->setToolTip("Fills fields MinY, MaxX, MaxY with "
                             "MinX,-MinX,-MinX respectively,\nto make a square "
                             "rectangle around the origin.");
+    btn_flownone_->setToolTip("Do not draw the direction of the vector field");
+    btn_flowarrows_->setToolTip(
+        "Draw arrows along the vector field on a grid in the background");
+    btn_flowspeed_->setToolTip(
+        "Draw arrows coloured by the speed of the vector field, from blue "
+        "(slow) to red (fast)");
+    btn_flowdivergence_->setToolTip(
+        "Draw arrows coloured by the divergence of the vector field, from "
+        "blue (contracting) to red (expanding)");
     if (haveVirtualCheckBox_)
         chk_plotvirtuals_->setToolTip(
             "Determines wheter or not to plot singularities of vector fields "
@@ -163,6 +186,15 @@ P4ViewDlg::P4ViewDlg(bool virtualchk, QWidget *parent)
     mainLayout_->addLayout(layout3);
     mainLayout_->addLayout(layout4);
     mainLayout_->addLayout(layout5);
+
+    auto flowLayout = new QGridLayout{};
+    flowLayout->addWidget(lbl_flow, 0, 0);
+    flowLayout->addWidget(btn_flownone_, 0, 1);
+    flowLayout->addWidget(btn_flowarrows_, 0, 2);
+    flowLayout->addWidget(btn_flowspeed_, 1, 1);
+    flowLayout->addWidget(btn_flowdivergence_, 1, 2);
+    mainLayout_->addLayout(flowLayout);
+
     if (haveVirtualCheckBox_)
         mainLayout_->addWidget(chk_plotvirtuals_);
     mainLayout_->addStretch(0);
@@ -186,6 +218,14 @@ P4ViewDlg::P4ViewDlg(bool virtualchk, QWidget *parent)
                      &P4ViewDlg::btn_V2_toggled);
     QObject::connect(btn_square_, &QPushButton::clicked, this,
                      &P4ViewDlg::btn_square_clicked);
+    QObject::connect(btn_flownone_, &QRadioButton::toggled, this,
+                     &P4ViewDlg::onFieldChange);
+    QObject::connect(btn_flowarrows_, &QRadioButton::toggled, this,
+                     &P4ViewDlg::onFieldChange);
+    QObject::connect(btn_flowspeed_, &QRadioButton::toggled, this,
+                     &P4ViewDlg::onFieldChange);
+    QObject::connect(btn_flowdivergence_, &QRadioButton::toggled, this,
+                     &P4ViewDlg::onFieldChange);
     QObject::connect(edt_projection_, &QLineEdit::textChanged, this,
                      &P4ViewDlg::onFieldChange);
     QObject::connect(edt_x0_, &QLineEdit::textChanged, this,
@@ -397,6 +437,9 @@ bool P4ViewDlg::getDataFromDlg()
         return false;
     }
 
+    // the render of a zoom window may be refining curves in this view
+    stopRefinedCurves();
+
     changed_ = false;
     if (btn_sphere_->isChecked()) {
         if (gVFResults.typeofview_ != P4TypeOfView::typeofview_sphere) {
@@ -435,6 +478,18 @@ bool P4ViewDlg::getDataFromDlg()
         }
     }
 
+    int flowfield{P4TypeOfFlowField::flowfield_none};
+    if (btn_flowarrows_->isChecked())
+        flowfield = P4TypeOfFlowField::flowfield_arrows;
+    if (btn_flowspeed_->isChecked())
+        flowfield = P4TypeOfFlowField::flowfield_speed;
+    if (btn_flowdivergence_->isChecked())
+        flowfield = P4TypeOfFlowField::flowfield_divergence;
+    if (gVFResults.flowField_ != flowfield) {
+        changed_ = true;
+        gVFResults.flowField_ = flowfield;
+    }
+
     double oldxmin{gVFResults.xmin_};
     double oldymin{gVFResults.ymin_};
     double oldxmax{gVFResults.xmax_};
@@ -531,6 +586,21 @@ void P4ViewDlg::updateDlgData()
         btn_square_->setEnabled(false);
     }
 
+    switch (gVFResults.flowField_) {
+    case P4TypeOfFlowField::flowfield_arrows:
+        btn_flowarrows_->toggle();
+        break;
+    case P4TypeOfFlowField::flowfield_speed:
+        btn_flowspeed_->toggle();
+        break;
+    case P4TypeOfFlowField::flowfield_divergence:
+        btn_flowdivergence_->toggle();
+        break;
+    default:
+        btn_flownone_->toggle();
+        break;
+    }
+
     if (haveVirtualCheckBox_)
         chk_plotvirtuals_->setChecked(gVFResults.plotVirtualSingularities_);
 }
@@ -59,6 +59,11 @@ class P4ViewDlg : public QWidget
     QRadioButton *btn_U2_;
     QRadioButton *btn_V2_;
 
+    QRadioButton *btn_flownone_;
+    QRadioButton *btn_flowarrows_;
+    QRadioButton *btn_flowspeed_;
+    QRadioButton *btn_flowdivergence_;
+
     bool readFloatField(QLineEdit *, double &, double, double, double);
 
   public slots:
@@ -69,6 +69,10 @@ P4ZoomWnd::P4ZoomWnd(P4PlotWnd *main, int id, double x1, double y1, double x2,
                      &P4ZoomWnd::onBtnPrint);
     toolBar1->addAction(actPrint);
 
+    auto actRefine = new QAction{"Refine", this};
+    actRefine->setCheckable(true);
+    toolBar1->addAction(actRefine);
+
     QObject::connect(gThisVF, &P4InputVF::saveSignal, this,
                      &P4ZoomWnd::onSaveSignal);
 
@@ -77,6 +81,9 @@ P4ZoomWnd::P4ZoomWnd(P4PlotWnd *main, int id, double x1, double y1, double x2,
         "Closes the plot window, all subwindows and zoom window");
     actRefresh->setToolTip("Redraw the plot window");
     actPrint->setToolTip("Opens the print window");
+    actRefine->setToolTip(
+        "Integrate orbits and separatrices again where they cross the zoom "
+        "window,\nwith steps that suit its magnification");
 #endif
 
     statusBar()->showMessage("Ready");
@@ -88,6 +95,9 @@ P4ZoomWnd::P4ZoomWnd(P4PlotWnd *main, int id, double x1, double y1, double x2,
     resize(NOMINALWIDTHPLOTWINDOW, NOMINALHEIGHTPLOTWINDOW);
     sphere_->setupPlot();
 
+    QObject::connect(actRefine, &QAction::toggled, sphere_,
+                     &P4Sphere::setRefineCurves);
+
     setP4WindowTitle(this, "Phase Portrait - Zoom");
 }
 
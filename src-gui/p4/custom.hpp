@@ -123,6 +123,10 @@
 #define MIN_INTPOINTS 1
 #define MAX_INTPOINTS 32767
 
+#define DEFAULT_AUTOFILLSEP 24 // pixels in between orbits filling the plot
+#define MIN_AUTOFILLSEP 4
+#define MAX_AUTOFILLSEP 200
+
 #define DEFAULT_LINESTYLE                                                      \
     LINESTYLE_DASHES // choose between LINESTYLE_DASHES and LINESTYLE_POINTS
 
@@ -272,6 +276,13 @@
 
 #define TOOLTIPS
 
+// INTEGRATION STATISTICS
+
+// if you define INTSTATS then the integration routines count their steps, and
+// the integration parameters window shows the counts (see P4IntStats.hpp)
+
+#define INTSTATS
+
 namespace P4Charts
 {
 enum { chart_R2 = 0, chart_U1 = 1, chart_U2 = 2, chart_V1 = 3, chart_V2 = 4 };
@@ -19,7 +19,7 @@
 
 #include "file_paths.hpp"
 
-#include <QApplication>
+#include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
 #include <QSettings>
@@ -63,7 +63,7 @@ QString getDefaultP4Path(void)
 
     if (f.isNull()) {
         // try to find by another means
-        f = QApplication::applicationFilePath();
+        f = QCoreApplication::applicationFilePath();
         if (!f.isEmpty()) {
             if (f[f.length() - 1] == QDir::separator()) {
                 // remove trailing slash if it is present
@@ -23,6 +23,7 @@
 #include "main.hpp"
 
 #include <QDebug>
+#include <QFile>
 #include <QMessageBox>
 #include <QPixmap>
 #include <QPrinter>
@@ -30,9 +31,13 @@
 #include "P4Application.hpp"
 #include "P4FindDlg.hpp"
 #include "P4InputVF.hpp"
+#include "P4IntParamsDlg.hpp"
 #include "P4ParentStudy.hpp"
+#include "P4PlotWnd.hpp"
 #include "P4SettingsDlg.hpp"
 #include "P4StartDlg.hpp"
+#include "P4Trace.hpp"
+#include "math_p4.hpp"
 #include "p4settings.hpp"
 
 #ifdef HAVE_CONFIG_H
@@ -125,6 +130,16 @@ void handleCommandLineArgument(char *arg)
     return;
 }
 
+// the step of the integration, see set_current_step
+static void showCurrentStep(double curstep)
+{
+    if (gP4startDlg != nullptr) {
+        auto p = gP4startDlg->getPlotWindowPtr();
+        if (p != nullptr)
+            p->getIntParamsWindowPtr()->setCurrentStep(curstep);
+    }
+}
+
 // -----------------------------------------------------------------------
 //          Main function
 // -----------------------------------------------------------------------
@@ -159,6 +174,12 @@ int main(int argc, char *argv[])
     gP4app->setQuitOnLastWindowClosed(false);
     v = readP4Settings();
 
+    // timeline of the evaluation and the plotting, see P4Trace
+    auto tracefile = qgetenv("P4_TRACE");
+    if (tracefile.isEmpty())
+        tracefile = QFile::encodeName(getP4TraceFile());
+    P4Trace::start(tracefile.constData());
+
     gP4printer = new QPrinter{QPrinter::PrinterResolution};
     gP4smallIcon = new QPixmap{};
     if (gP4smallIcon->load(getP4BinPath() + "/p4smallicon.ico") == false) {
@@ -169,6 +190,17 @@ int main(int argc, char *argv[])
     //  gP4app->setStyle( new QCDEStyle() );
 
     gThisVF = new P4InputVF{};
+    QObject::connect(gThisVF, &P4InputVF::evaluated, gP4app,
+                     &P4Application::signalEvaluated);
+    QObject::connect(gThisVF, &P4InputVF::singularityEvaluated, gP4app,
+                     &P4Application::signalSingularityEvaluated);
+    QObject::connect(gThisVF, &P4InputVF::finiteEvaluated, gP4app,
+                     &P4Application::signalFiniteEvaluated);
+    QObject::connect(gThisVF, &P4InputVF::curveEvaluated, gP4app,
+                     &P4Application::signalCurveEvaluated);
+    QObject::connect(gThisVF, &P4InputVF::separatingCurvesEvaluated, gP4app,
+                     &P4Application::signalSeparatingCurvesEvaluated);
+    show_current_step = showCurrentStep;
 
     gP4startDlg = new P4StartDlg{gCmdLineFilename};
     if (!gCmdLineAutoExit)
@@ -209,6 +241,7 @@ int main(int argc, char *argv[])
     returnvalue = gP4app->exec();
 
     saveP4Settings();
+    P4Trace::stop();
 
     if (gP4smallIcon != nullptr) {
         delete gP4smallIcon;
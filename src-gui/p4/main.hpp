@@ -20,13 +20,13 @@
 #pragma once
 
 #include <QPixmap>
-#include <QPrinter>
 #include <QString>
 
 #include <memory>
 
 class P4ParentStudy;
 
+class QPrinter;
 class QWidget;
 
 // to avoid warnings of unused variables in case we cannot avoid it
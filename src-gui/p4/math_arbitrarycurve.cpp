@@ -23,9 +23,10 @@
 
 #include <cmath>
 
+#include "P4Canvas.hpp"
 #include "P4InputVF.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
+#include "P4Trace.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
 #include "math_p4.hpp"
@@ -36,7 +37,7 @@ P4Orbits::orbits_points *gLastArbitraryCurvePoint{nullptr};
 
 // static global variables
 static int sCurveTask{EVAL_CURVE_NONE};
-static P4Sphere *sCurveSphere{nullptr};
+static P4Canvas *sCurveSphere{nullptr};
 static int sCurveDashes{0};
 static bool sCurveError{false};
 
@@ -46,7 +47,7 @@ static bool readTaskResults(int);
 static bool read_curve(void (*chart)(double, double, double *));
 
 // function definitions
-bool evalArbitraryCurveStart(P4Sphere *sp, int dashes, int precision,
+bool evalArbitraryCurveStart(P4Canvas *sp, int dashes, int precision,
                              int points)
 {
     if (gVFResults.plweights_)
@@ -88,7 +89,7 @@ bool evalArbitraryCurveContinue(int precision, int points)
 bool evalArbitraryCurveFinish() // return false in case an error occured
 {
     if (sCurveTask != EVAL_CURVE_NONE) {
-        sCurveSphere->prepareDrawing();
+        sCurveSphere->prepareDrawing(P4SphereLayers::layer_arbitrary_curves);
         drawArbitraryCurve(sCurveSphere,
                            gVFResults.arbitraryCurves_.back().points,
                            P4ColourSettings::colour_arbitrary_curve, 1);
@@ -106,6 +107,7 @@ bool evalArbitraryCurveFinish() // return false in case an error occured
 
 bool runTaskArbitraryCurve(int task, int precision, int points)
 {
+    P4TraceSpan span{"arbitrary curve task", "curves", "task", task};
     bool value;
 
     switch (task) {
@@ -161,6 +163,7 @@ bool runTaskArbitraryCurve(int task, int precision, int points)
 
 static bool readTaskResults(int task)
 {
+    P4TraceSpan span{"read arbitrary curve", "curves", "task", task};
     bool value;
 
     switch (task) {
@@ -201,7 +204,7 @@ static bool readTaskResults(int task)
     return value;
 }
 
-void drawArbitraryCurve(P4Sphere *spherewnd,
+void drawArbitraryCurve(P4Canvas *spherewnd,
                         const std::vector<P4Orbits::orbits_points> &sep,
                         int color, int dashes)
 {
@@ -254,7 +257,7 @@ static bool read_curve(void (*chart)(double, double, double *))
     return true;
 }
 
-void deleteLastArbitraryCurve(P4Sphere *sp)
+void deleteLastArbitraryCurve(P4Canvas *sp)
 {
     if (gVFResults.arbitraryCurves_.empty())
         return;
@@ -34,21 +34,21 @@
 #define EVAL_CURVE_CYL4 11
 #define EVAL_CURVE_FINISHLYAPUNOV 12
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Orbits
 {
 struct orbits_points;
 }
 
-bool evalArbitraryCurveStart(P4Sphere *sp, int dashes, int precision,
+bool evalArbitraryCurveStart(P4Canvas *sp, int dashes, int precision,
                              int points);
 bool evalArbitraryCurveContinue(int precision, int points);
 bool evalArbitraryCurveFinish();
 bool runTaskArbitraryCurve(int task, int precision, int points);
-void drawArbitraryCurve(P4Sphere *spherewnd,
+void drawArbitraryCurve(P4Canvas *spherewnd,
                         const std::vector<P4Orbits::orbits_points> &sep,
                         int color, int dashes);
-void deleteLastArbitraryCurve(P4Sphere *sp);
+void deleteLastArbitraryCurve(P4Canvas *sp);
 
 extern P4Orbits::orbits_points *gLastArbitraryCurvePoint;
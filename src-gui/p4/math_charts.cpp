@@ -359,7 +359,8 @@ static void U2_to_cylinder(double u, double s, double *c);
 static void V1_to_cylinder(double u, double s, double *c);
 static void V2_to_cylinder(double u, double s, double *c);
 
-static double sU{0.0};
+// thread_local: the direction field is evaluated on several threads
+static thread_local double sU{0.0};
 
 static double func_U1(double x)
 {
@@ -663,8 +664,8 @@ void plsphere_annulus(double x, double y, double z, double *u)
 //
 //  Once we have calculated u, we determine v using atan2.
 
-static double sA{0.0};
-static double sB{0.0};
+static thread_local double sA{0.0};
+static thread_local double sB{0.0};
 
 static double func(double z)
 {
@@ -23,9 +23,10 @@
 
 #include <QDebug>
 
+#include "P4Canvas.hpp"
 #include "P4InputVF.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
+#include "P4TrajectoryStore.hpp"
 #include "P4VFStudy.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
@@ -82,7 +83,7 @@ void make_transformations(P4Blowup::transformations *trans, double x0,
 // ---------------------------------------------------------------------------
 //          integrate_blow_up
 // ---------------------------------------------------------------------------
-P4Orbits::orbits_points *integrate_blow_up(P4Sphere *spherewnd, double *pcoord2,
+P4Orbits::orbits_points *integrate_blow_up(P4Canvas *spherewnd, double *pcoord2,
                                            P4Blowup::blow_up_points *de_sep,
                                            double step, int dir, int type,
                                            P4Orbits::orbits_points **orbit,
@@ -331,7 +332,7 @@ P4Orbits::orbits_points *integrate_blow_up(P4Sphere *spherewnd, double *pcoord2,
 //
 // At the end, a normal integration cycle is added.
 static P4Orbits::orbits_points *
-plot_sep_blow_up(P4Sphere *spherewnd, double x0, double y0, int chart,
+plot_sep_blow_up(P4Canvas *spherewnd, double x0, double y0, int chart,
                  double epsilon, P4Blowup::blow_up_points *de_sep,
                  P4Orbits::orbits_points **orbit, int vfindex)
 {
@@ -570,7 +571,7 @@ plot_sep_blow_up(P4Sphere *spherewnd, double x0, double y0, int chart,
 // ---------------------------------------------------------------------------
 //          start_plot_de_sep
 // ---------------------------------------------------------------------------
-void start_plot_de_sep(P4Sphere *spherewnd, int vfindex)
+void start_plot_de_sep(P4Canvas *spherewnd, int vfindex)
 {
     double p[3];
     P4Orbits::orbits_points *points{nullptr};
@@ -603,12 +604,13 @@ void start_plot_de_sep(P4Sphere *spherewnd, int vfindex)
                              depoi->epsilon, desep, &points, vfindex);
         desep->last_sep_point = points;
     }
+    P4TrajectoryStore::grown(&desep->first_sep_point);
 }
 
 // ---------------------------------------------------------------------------
 //          cont_plot_de_sep
 // ---------------------------------------------------------------------------
-void cont_plot_de_sep(P4Sphere *spherewnd)
+void cont_plot_de_sep(P4Canvas *spherewnd)
 {
     double p[3];
     copy_x_into_y(gVFResults.selectedDeSep_->last_sep_point->pcoord, p);
@@ -629,12 +631,13 @@ void cont_plot_de_sep(P4Sphere *spherewnd)
                           gVFResults.config_intpoints_, &points);
     }
     gVFResults.selectedDeSep_->last_sep_point = points;
+    P4TrajectoryStore::grown(&gVFResults.selectedDeSep_->first_sep_point);
 }
 
 // ---------------------------------------------------------------------------
 //          plot_next_de_sep
 // ---------------------------------------------------------------------------
-void plot_next_de_sep(P4Sphere *spherewnd, int vfindex)
+void plot_next_de_sep(P4Canvas *spherewnd, int vfindex)
 {
     draw_sep(spherewnd, gVFResults.selectedDeSep_->first_sep_point);
 
@@ -648,7 +651,7 @@ void plot_next_de_sep(P4Sphere *spherewnd, int vfindex)
 // ---------------------------------------------------------------------------
 //          select_next_de_sep
 // ---------------------------------------------------------------------------
-void select_next_de_sep(P4Sphere *spherewnd)
+void select_next_de_sep(P4Canvas *spherewnd)
 {
     draw_sep(spherewnd, gVFResults.selectedDeSep_->first_sep_point);
 
@@ -663,7 +666,7 @@ void select_next_de_sep(P4Sphere *spherewnd)
 // ---------------------------------------------------------------------------
 //          plot_all_de_sep
 // ---------------------------------------------------------------------------
-void plot_all_de_sep(P4Sphere *spherewnd, int vfindex,
+void plot_all_de_sep(P4Canvas *spherewnd, int vfindex,
                      P4Singularities::degenerate *point)
 {
     double p[3];
@@ -697,6 +700,7 @@ void plot_all_de_sep(P4Sphere *spherewnd, int vfindex,
                     point->epsilon, de_sep, &sep, vfindex);
                 de_sep->last_sep_point = sep;
             }
+            P4TrajectoryStore::grown(&de_sep->first_sep_point);
             de_sep = de_sep->next_blow_up_point;
         }
         point = point->next_de;
@@ -706,7 +710,7 @@ void plot_all_de_sep(P4Sphere *spherewnd, int vfindex,
 // ---------------------------------------------------------------------------
 //          change_epsilon_de
 // ---------------------------------------------------------------------------
-void change_epsilon_de(P4Sphere *spherewnd, double epsilon)
+void change_epsilon_de(P4Canvas *spherewnd, double epsilon)
 {
     gVFResults.selectedDePoint_->epsilon = epsilon;
     auto separatrice = gVFResults.selectedDePoint_->blow_up;
@@ -714,6 +718,7 @@ void change_epsilon_de(P4Sphere *spherewnd, double epsilon)
     while (separatrice != nullptr) {
         draw_selected_sep(spherewnd, separatrice->first_sep_point,
                           P4ColourSettings::colour_background);
+        P4TrajectoryStore::forget(&separatrice->first_sep_point);
         delete separatrice->first_sep_point;
         separatrice->first_sep_point = nullptr;
         separatrice->last_sep_point = nullptr;
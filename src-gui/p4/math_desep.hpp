@@ -37,22 +37,22 @@ namespace P4Orbits
 struct orbits_points;
 }
 
-class P4Sphere;
+class P4Canvas;
 
 void eval_blow_vec_field(const double *y, double *f);
 void make_transformations(P4Blowup::transformations *trans, double x0,
                           double y0, double *point);
 
-P4Orbits::orbits_points *integrate_blow_up(P4Sphere *spherewnd, double *pcoord2,
+P4Orbits::orbits_points *integrate_blow_up(P4Canvas *spherewnd, double *pcoord2,
                                            P4Blowup::blow_up_points *de_sep,
                                            double step, int dir, int type,
                                            P4Orbits::orbits_points **orbit,
                                            int chart);
 
-void change_epsilon_de(P4Sphere *spherewnd, double epsilon);
-void start_plot_de_sep(P4Sphere *spherewnd, int vfindex);
-void cont_plot_de_sep(P4Sphere *spherewnd);
-void plot_next_de_sep(P4Sphere *spherewnd, int vfindex);
-void select_next_de_sep(P4Sphere *spherewnd);
-void plot_all_de_sep(P4Sphere *spherewnd, int vfindex,
+void change_epsilon_de(P4Canvas *spherewnd, double epsilon);
+void start_plot_de_sep(P4Canvas *spherewnd, int vfindex);
+void cont_plot_de_sep(P4Canvas *spherewnd);
+void plot_next_de_sep(P4Canvas *spherewnd, int vfindex);
+void select_next_de_sep(P4Canvas *spherewnd);
+void plot_all_de_sep(P4Canvas *spherewnd, int vfindex,
                      P4Singularities::degenerate *point);
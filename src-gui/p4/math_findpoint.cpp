@@ -19,19 +19,16 @@
 
 #include "math_findpoint.hpp"
 
-#include <cmath>
-
 #include <QDebug>
 
+#include "P4Canvas.hpp"
 #include "P4InputVF.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4SepDlg.hpp"
-#include "P4Sphere.hpp"
+#include "P4PickIndex.hpp"
 #include "P4VFStudy.hpp"
 #include "custom.hpp"
 #include "math_desep.hpp"
 #include "math_p4.hpp"
-#include "math_regions.hpp"
 #include "math_saddlesep.hpp"
 #include "math_separatrice.hpp"
 #include "math_sesep.hpp"
@@ -41,163 +38,46 @@
 //
 // This file implements the selection of a critical point, when the
 // user clicks with the mouse inside the plot window.  The nearest singularity
-// having separatrices is searched, the corresponding separatrice is selected
-// and the separatrice window is set up so that it handes this separatrice.
+// having separatrices is looked up in the pick index (see P4PickIndex), the
+// corresponding separatrice is selected and the separatrice window is set up
+// so that it handes this separatrice.
 //
 // -----------------------------------------------------------------------
 
-static double find_distance_saddle(P4Singularities::saddle *point, double x,
-                                   double y, double distance, int &type,
-                                   double *refpos)
-{
-    double d, pcoord[3], ucoord[2];
-
-    if (point != nullptr) {
-        do {
-            if (point->position == P4Singularities::position_virtual)
-                continue;
-            switch (point->chart) {
-            case P4Charts::chart_R2:
-                MATHFUNC(R2_to_sphere)(point->x0, point->y0, pcoord);
-                break;
-            case P4Charts::chart_U1:
-                MATHFUNC(U1_to_sphere)(point->x0, point->y0, pcoord);
-                break;
-            case P4Charts::chart_V1:
-                MATHFUNC(V1_to_sphere)(point->x0, point->y0, pcoord);
-                break;
-            case P4Charts::chart_U2:
-                MATHFUNC(U2_to_sphere)(point->x0, point->y0, pcoord);
-                break;
-            case P4Charts::chart_V2:
-                MATHFUNC(V2_to_sphere)(point->x0, point->y0, pcoord);
-                break;
-            }
-            MATHFUNC(sphere_to_viewcoord)
-            (pcoord[0], pcoord[1], pcoord[2], ucoord);
-            if (!isInTheSameRegion(pcoord, refpos))
-                continue;
-
-            d = (x - ucoord[0]) * (x - ucoord[0]) +
-                (y - ucoord[1]) * (y - ucoord[1]);
-            if ((d < distance && !std::isnan(d) && std::isfinite(d)) ||
-                (distance == -1)) {
-                distance = d;
-                gVFResults.selectedSaddlePoint_ = point;
-                gVFResults.selected_ucoord_[0] = ucoord[0];
-                gVFResults.selected_ucoord_[1] = ucoord[1];
-                type = P4SingularityType::saddle;
-            }
-        } while ((point = point->next_saddle) != nullptr);
-    }
-    return (distance);
-}
-
-static double find_distance_se(P4Singularities::semi_elementary *point,
-                               double x, double y, double distance, int &type,
-                               double *refpos)
+// Select the nearest singularity of vector field vfindex, using the pick
+// index.  Returns false if there is none in the region of refpos.
+static bool find_nearest_singularity(double x, double y, int vfindex,
+                                     int &type, double *refpos)
 {
-    double d, pcoord[3], ucoord[2];
-
-    if (point != nullptr) {
-        do {
-            if (point->position == P4Singularities::position_virtual)
-                continue;
-            if (point->separatrices != nullptr) {
-                switch (point->chart) {
-                case P4Charts::chart_R2:
-                    MATHFUNC(R2_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_U1:
-                    MATHFUNC(U1_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_V1:
-                    MATHFUNC(V1_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_U2:
-                    MATHFUNC(U2_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_V2:
-                    MATHFUNC(V2_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                }
-                if (!isInTheSameRegion(pcoord, refpos))
-                    continue;
-
-                MATHFUNC(sphere_to_viewcoord)
-                (pcoord[0], pcoord[1], pcoord[2], ucoord);
-                d = (x - ucoord[0]) * (x - ucoord[0]) +
-                    (y - ucoord[1]) * (y - ucoord[1]);
-                if ((d < distance && !std::isnan(d) && std::isfinite(d)) ||
-                    (distance == -1)) {
-                    distance = d;
-                    gVFResults.selectedSePoint_ = point;
-                    gVFResults.selected_ucoord_[0] = ucoord[0];
-                    gVFResults.selected_ucoord_[1] = ucoord[1];
-                    type = P4SingularityType::semi_hyperbolic;
-                }
-            }
-        } while ((point = point->next_se) != nullptr);
-    }
-    return (distance);
-}
-
-static double find_distance_de(P4Singularities::degenerate *point, double x,
-                               double y, double distance, int &type,
-                               double *refpos)
-{
-    double d, pcoord[3], ucoord[2];
-
-    if (point != nullptr) {
-        do {
-            if (point->position == P4Singularities::position_virtual)
-                continue;
-            if (point->blow_up != nullptr) {
-                switch (point->chart) {
-                case P4Charts::chart_R2:
-                    MATHFUNC(R2_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_U1:
-                    MATHFUNC(U1_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_V1:
-                    MATHFUNC(V1_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_U2:
-                    MATHFUNC(U2_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                case P4Charts::chart_V2:
-                    MATHFUNC(V2_to_sphere)(point->x0, point->y0, pcoord);
-                    break;
-                }
-                if (!isInTheSameRegion(pcoord, refpos))
-                    continue;
+    auto s = gPickIndex.nearestSingularity(x, y, vfindex, refpos);
+    if (s == nullptr)
+        return false;
 
-                MATHFUNC(sphere_to_viewcoord)
-                (pcoord[0], pcoord[1], pcoord[2], ucoord);
-                d = (x - ucoord[0]) * (x - ucoord[0]) +
-                    (y - ucoord[1]) * (y - ucoord[1]);
-                if ((d < distance && !std::isnan(d) && std::isfinite(d)) ||
-                    (distance == -1)) {
-                    if ((d < distance) || (distance == -1)) {
-                        distance = d;
-                        gVFResults.selectedDePoint_ = point;
-                        gVFResults.selected_ucoord_[0] = ucoord[0];
-                        gVFResults.selected_ucoord_[1] = ucoord[1];
-                        type = P4SingularityType::non_elementary;
-                    }
-                }
-            }
-        } while ((point = point->next_de) != nullptr);
+    switch (s->type) {
+    case P4SingularityType::saddle:
+        gVFResults.selectedSaddlePoint_ =
+            static_cast<P4Singularities::saddle *>(s->point);
+        break;
+    case P4SingularityType::semi_hyperbolic:
+        gVFResults.selectedSePoint_ =
+            static_cast<P4Singularities::semi_elementary *>(s->point);
+        break;
+    case P4SingularityType::non_elementary:
+        gVFResults.selectedDePoint_ =
+            static_cast<P4Singularities::degenerate *>(s->point);
+        break;
     }
-
-    return (distance);
+    gVFResults.selected_ucoord_[0] = s->ucoord[0];
+    gVFResults.selected_ucoord_[1] = s->ucoord[1];
+    type = s->type;
+    return true;
 }
 
-bool find_critical_point(P4Sphere *spherewnd, double x, double y)
+bool find_critical_point(P4Canvas *spherewnd, double x, double y)
 {
     int type;
-    double distance, epsilon, pcoord[3];
+    bool found;
+    double epsilon, pcoord[3];
     QString s, sx, sy, sz;
     int vfindex, vfindex0;
 
@@ -211,37 +91,25 @@ bool find_critical_point(P4Sphere *spherewnd, double x, double y)
     gCurrentSingularityInfo[2] = "";
     gCurrentSingularityInfo[3] = "";
 
-    distance = -1;
+    found = false;
 
     if ((vfindex0 = gThisVF->getVFIndex_sphere(pcoord)) == -1)
         vfindex0 = gThisVF->numVF_ - 1;
 
     for (vfindex = vfindex0; vfindex >= 0; vfindex--) {
-        distance =
-            find_distance_saddle(gVFResults.vf_[vfindex]->firstSaddlePoint_, x,
-                                 y, distance, type, pcoord);
-        distance = find_distance_se(gVFResults.vf_[vfindex]->firstSePoint_, x,
-                                    y, distance, type, pcoord);
-        distance = find_distance_de(gVFResults.vf_[vfindex]->firstDePoint_, x,
-                                    y, distance, type, pcoord);
-        if (distance != -1)
+        found = find_nearest_singularity(x, y, vfindex, type, pcoord);
+        if (found)
             break;
     }
-    if (distance == -1 && vfindex0 != static_cast<int>(gThisVF->numVF_) - 1) {
+    if (!found && vfindex0 != static_cast<int>(gThisVF->numVF_) - 1) {
         for (vfindex = gThisVF->numVF_ - 1; vfindex > vfindex0; vfindex--) {
-            distance =
-                find_distance_saddle(gVFResults.vf_[vfindex]->firstSaddlePoint_,
-                                     x, y, distance, type, pcoord);
-            distance = find_distance_se(gVFResults.vf_[vfindex]->firstSePoint_,
-                                        x, y, distance, type, pcoord);
-            distance = find_distance_de(gVFResults.vf_[vfindex]->firstDePoint_,
-                                        x, y, distance, type, pcoord);
-            if (distance != -1)
+            found = find_nearest_singularity(x, y, vfindex, type, pcoord);
+            if (found)
                 break;
         }
     }
 
-    if (distance == -1)
+    if (!found)
         return false;
 
     sx = "";
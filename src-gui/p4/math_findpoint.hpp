@@ -19,6 +19,6 @@
 
 #pragma once
 
-class P4Sphere;
+class P4Canvas;
 
-bool find_critical_point(P4Sphere *spherewnd, double x, double y);
+bool find_critical_point(P4Canvas *spherewnd, double x, double y);
@@ -23,9 +23,10 @@
 
 #include <cmath>
 
+#include "P4Canvas.hpp"
 #include "P4InputVF.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
+#include "P4Trace.hpp"
 #include "P4VFStudy.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
@@ -38,7 +39,7 @@ P4Orbits::orbits_points *gLastGcfPoint{nullptr};
 
 // static global variables
 static int sGcfTask{EVAL_GCF_NONE};
-static P4Sphere *sGcfSphere{nullptr};
+static P4Canvas *sGcfSphere{nullptr};
 static int sGcfDashes{0};
 static bool sGcfError{false};
 static unsigned int sGcfVfIndex{0};
@@ -50,9 +51,9 @@ static bool readTaskResults(int task, int index);
 static bool read_gcf(void (*chart)(double, double, double *), int index);
 
 // function definitions
-bool evalGcfStart(P4Sphere *sp, int dashes, int precision, int points)
+bool evalGcfStart(P4Canvas *sp, int dashes, int precision, int points)
 {
-    sp->prepareDrawing();
+    sp->prepareDrawing(P4SphereLayers::layer_gcf);
     for (unsigned int r = 0; r < gThisVF->numVF_; r++) {
         if (gVFResults.vf_[r]->gcf_points_ != nullptr) {
             draw_gcf(sp, gVFResults.vf_[r]->gcf_points_,
@@ -117,7 +118,7 @@ bool evalGcfFinish() // return false in case an error occured
     if (sGcfTask != EVAL_GCF_NONE) {
         for (unsigned int index = 0; index < gThisVF->numVF_; index++)
             gThisVF->resampleGcf(index);
-        sGcfSphere->prepareDrawing();
+        sGcfSphere->prepareDrawing(P4SphereLayers::layer_gcf);
         for (unsigned int index = 0; index < gThisVF->numVF_; index++) {
             if (gVFResults.vf_[index]->gcf_points_ != nullptr)
                 draw_gcf(sGcfSphere, gVFResults.vf_[index]->gcf_points_,
@@ -137,6 +138,7 @@ bool evalGcfFinish() // return false in case an error occured
 
 bool runTask(int task, int precision, int points, unsigned int index)
 {
+    P4TraceSpan span{"gcf task", "curves", "task", task};
     bool value;
 
     while (gVFResults.vf_[index]->gcf_ == nullptr) {
@@ -198,6 +200,7 @@ bool runTask(int task, int precision, int points, unsigned int index)
 
 static bool readTaskResults(int task, int index)
 {
+    P4TraceSpan span{"read gcf", "curves", "task", task};
     bool value;
 
     switch (task) {
@@ -240,7 +243,7 @@ static bool readTaskResults(int task, int index)
     return value;
 }
 
-void draw_gcf(P4Sphere *spherewnd, P4Orbits::orbits_points *sep, int color,
+void draw_gcf(P4Canvas *spherewnd, P4Orbits::orbits_points *sep, int color,
               int dashes)
 {
     double pcoord[3];
@@ -35,18 +35,18 @@
 #define EVAL_GCF_CYL4 11
 #define EVAL_GCF_FINISHLYAPUNOV 12
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Orbits
 {
 struct orbits_points;
 }
 
-bool evalGcfStart(P4Sphere *sp, int dashes, int precision, int points);
+bool evalGcfStart(P4Canvas *sp, int dashes, int precision, int points);
 bool evalGcfContinue(int precision, int points);
 bool evalGcfFinish();
 bool runTask(int task, int precision, int points, unsigned int index);
-void draw_gcf(P4Sphere *spherewnd, P4Orbits::orbits_points *sep, int color,
+void draw_gcf(P4Canvas *spherewnd, P4Orbits::orbits_points *sep, int color,
               int dashes);
 
 extern P4Orbits::orbits_points *gLastGcfPoint;
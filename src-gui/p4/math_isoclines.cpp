@@ -23,9 +23,10 @@
 
 #include <cmath>
 
+#include "P4Canvas.hpp"
 #include "P4InputVF.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
+#include "P4Trace.hpp"
 #include "P4VFStudy.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
@@ -38,7 +39,7 @@ P4Orbits::orbits_points *gLastIsoclinePoint{nullptr};
 
 // static global variables
 static int sIsoclinesTask{EVAL_ISOCLINES_NONE};
-static P4Sphere *sIsoclinesSphere{nullptr};
+static P4Canvas *sIsoclinesSphere{nullptr};
 static int sIsoclinesDashes{0};
 static bool sIsoclinesError{false};
 static unsigned int sIsoclinesVfIndex{0};
@@ -50,7 +51,7 @@ static bool readTaskResults(int, int);
 static bool read_isoclines(void (*chart)(double, double, double *), int index);
 
 // function definitions
-bool evalIsoclinesStart(P4Sphere *sp, int dashes, int precision, int points)
+bool evalIsoclinesStart(P4Canvas *sp, int dashes, int precision, int points)
 {
     if (gVFResults.plweights_)
         sIsoclinesTask = EVAL_ISOCLINES_LYP_R2;
@@ -119,7 +120,7 @@ bool evalIsoclinesFinish() // return false in case an error occured
             gThisVF->resampleIsoclines(index);
         }
         // start drawing the last isocline for every VF
-        sIsoclinesSphere->prepareDrawing();
+        sIsoclinesSphere->prepareDrawing(P4SphereLayers::layer_isoclines);
         for (auto const &vf : gVFResults.vf_) {
             if (!vf->isocline_vector_.empty())
                 draw_isoclines(sIsoclinesSphere,
@@ -141,6 +142,7 @@ bool evalIsoclinesFinish() // return false in case an error occured
 
 bool runTaskIsoclines(int task, int precision, int points, unsigned int index)
 {
+    P4TraceSpan span{"isoclines task", "curves", "task", task};
     bool value;
 
     auto &vf = gVFResults.vf_[index];
@@ -198,6 +200,7 @@ bool runTaskIsoclines(int task, int precision, int points, unsigned int index)
 
 static bool readTaskResults(int task, int index)
 {
+    P4TraceSpan span{"read isoclines", "curves", "task", task};
     bool value;
 
     switch (task) {
@@ -238,7 +241,7 @@ static bool readTaskResults(int task, int index)
     return value;
 }
 
-void draw_isoclines(P4Sphere *spherewnd,
+void draw_isoclines(P4Canvas *spherewnd,
                     const std::vector<P4Orbits::orbits_points> &isoc, int color,
                     int dashes)
 {
@@ -294,7 +297,7 @@ static bool read_isoclines(void (*chart)(double, double, double *), int index)
     return true;
 }
 
-void deleteLastIsocline(P4Sphere *sp, unsigned int index)
+void deleteLastIsocline(P4Canvas *sp, unsigned int index)
 {
     //    for (auto &vf : gVFResults.vf_) {
     //        if (vf->isocline_vector_.empty())
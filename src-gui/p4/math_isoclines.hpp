@@ -35,20 +35,20 @@
 #define EVAL_ISOCLINES_CYL4 11
 #define EVAL_ISOCLINES_FINISHLYAPUNOV 12
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Orbits
 {
 struct orbits_points;
 }
 
-bool evalIsoclinesStart(P4Sphere *sp, int dashes, int precision, int points);
+bool evalIsoclinesStart(P4Canvas *sp, int dashes, int precision, int points);
 bool evalIsoclinesContinue(int precision, int points);
 bool evalIsoclinesFinish();
 bool runTaskIsoclines(int task, int precision, int points, unsigned int index);
-void draw_isoclines(P4Sphere *spherewnd,
+void draw_isoclines(P4Canvas *spherewnd,
                     const std::vector<P4Orbits::orbits_points> &isoc, int color,
                     int dashes);
-void deleteLastIsocline(P4Sphere *sp, unsigned int index);
+void deleteLastIsocline(P4Canvas *sp, unsigned int index);
 
 extern P4Orbits::orbits_points *gLastIsoclinePoint;
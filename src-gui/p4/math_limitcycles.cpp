@@ -21,9 +21,9 @@
 
 #include <cmath>
 
-#include "P4LimitCyclesDlg.hpp"
+#include "P4Canvas.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
+#include "P4TrajectoryStore.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
 #include "math_orbits.hpp"
@@ -151,7 +151,7 @@ static bool eval_orbit(double qp[3], double a, double b, double c, double pp[3],
 //
 // Loop to find limit cycles cutting some transverse section determined by two
 // end points.
-void searchLimitCycle(P4Sphere *spherewnd, double x0, double y0, double x1,
+void searchLimitCycle(P4Canvas *spherewnd, double x0, double y0, double x1,
                       double y1, double grid)
 {
     double p1[3], pf1[3], pb1[3], rf1[2], rb1[2];
@@ -291,7 +291,8 @@ void searchLimitCycle(P4Sphere *spherewnd, double x0, double y0, double x1,
                         if (MATHFUNC(less2)(pf2, p3) &&
                             MATHFUNC(less2)(p1, pf2)) {
                             MATHFUNC(sphere_to_R2)(pf2[0], pf2[1], pf2[2], rf2);
-                            spherewnd->prepareDrawing();
+                            spherewnd->prepareDrawing(
+                                P4SphereLayers::layer_limit_cycles);
                             storeLimitCycle(spherewnd, (rf1[0] + rf2[0]) / 2,
                                             (rf1[1] + rf2[1]) / 2, a, b, c);
                             spherewnd->finishDrawing();
@@ -334,7 +335,8 @@ void searchLimitCycle(P4Sphere *spherewnd, double x0, double y0, double x1,
                         if (MATHFUNC(less2)(pb2, p3) &&
                             MATHFUNC(less2)(p1, pb2)) {
                             MATHFUNC(sphere_to_R2)(pb2[0], pb2[1], pb2[2], rb2);
-                            spherewnd->prepareDrawing();
+                            spherewnd->prepareDrawing(
+                                P4SphereLayers::layer_limit_cycles);
                             storeLimitCycle(spherewnd, (rb1[0] + rb2[0]) / 2,
                                             (rb1[1] + rb2[1]) / 2, a, b, c);
                             spherewnd->finishDrawing();
@@ -374,7 +376,7 @@ void searchLimitCycle(P4Sphere *spherewnd, double x0, double y0, double x1,
 // The found limit cycle is re-integrated, and stored in memory.
 // It is meanwhile drawn on the screen.
 // The limit cycle is found through forward integration.
-void storeLimitCycle(P4Sphere *spherewnd, double x, double y, double a,
+void storeLimitCycle(P4Canvas *spherewnd, double x, double y, double a,
                      double b, double c)
 {
     double p1[3], p2[3];
@@ -466,6 +468,8 @@ void storeLimitCycle(P4Sphere *spherewnd, double x, double y, double a,
         (*plot_l)(spherewnd, p1, p2, P4ColourSettings::colour_limit_cycle);
     else
         (*plot_p)(spherewnd, p2, P4ColourSettings::colour_limit_cycle);
+
+    P4TrajectoryStore::grown(&LC->firstpt);
 }
 
 // -----------------------------------------------------------------------
@@ -473,7 +477,7 @@ void storeLimitCycle(P4Sphere *spherewnd, double x, double y, double a,
 // -----------------------------------------------------------------------
 // Draw limit cycles that were calculated earlier.  This is called during
 // a repaint (but also during a print command).
-void drawLimitCycles(P4Sphere *spherewnd)
+void drawLimitCycles(P4Canvas *spherewnd)
 {
     auto orbit = gVFResults.firstLimCycle_;
     while (orbit != nullptr) {
@@ -485,14 +489,12 @@ void drawLimitCycles(P4Sphere *spherewnd)
 // -----------------------------------------------------------------------
 //          deleteLastLimitCycle
 // -----------------------------------------------------------------------
-void deleteLastLimitCycle(P4Sphere *spherewnd)
+void deleteLastLimitCycle(P4Canvas *spherewnd)
 {
     if (gVFResults.currentLimCycle_ == nullptr)
         return;
 
     auto orbit2 = gVFResults.currentLimCycle_;
-    drawOrbit(spherewnd, orbit2->pcoord, orbit2->firstpt,
-              spherewnd->spherebgcolor_);
 
     if (gVFResults.firstLimCycle_ == gVFResults.currentLimCycle_) {
         gVFResults.firstLimCycle_ = nullptr;
@@ -508,4 +510,7 @@ void deleteLastLimitCycle(P4Sphere *spherewnd)
 
     //    delete orbit2->firstpt;
     delete orbit2;
+
+    // the other layers are just replayed
+    spherewnd->refreshLayer(P4SphereLayers::layer_limit_cycles);
 }
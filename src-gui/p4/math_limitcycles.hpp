@@ -19,13 +19,13 @@
 
 #pragma once
 
-class P4Sphere;
+class P4Canvas;
 
-void drawLimitCycle(P4Sphere *spherewnd, double x, double y, double a,
+void drawLimitCycle(P4Canvas *spherewnd, double x, double y, double a,
                     double b, double c);
-void searchLimitCycle(P4Sphere *spherewnd, double x0, double y0, double x1,
+void searchLimitCycle(P4Canvas *spherewnd, double x0, double y0, double x1,
                       double y1, double grid);
-void storeLimitCycle(P4Sphere *spherewnd, double x, double y, double a,
+void storeLimitCycle(P4Canvas *spherewnd, double x, double y, double a,
                      double b, double c);
-void drawLimitCycles(P4Sphere *spherewnd);
-void deleteLastLimitCycle(P4Sphere *spherewnd);
+void drawLimitCycles(P4Canvas *spherewnd);
+void deleteLastLimitCycle(P4Canvas *spherewnd);
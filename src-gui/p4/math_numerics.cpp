@@ -33,6 +33,7 @@
 #include <cfloat>
 #include <cmath>
 
+#include "P4IntStats.hpp"
 #include "math_p4.hpp"
 
 static double sPrecision1 = 1e-16;
@@ -331,9 +332,17 @@ void rk78(void (*deriv)(const double *, double *), double y[2], double *hh,
         }
         d = d / 2;
         e3 = e1 * (1.0 + dd * 1.E-2);
+        P4IntStats::count(P4IntCounter::rhs, 13);
         if (((fabs(h) <= hmi) || (d < e3)) && !(std::isnan(f[0])) &&
-            !(std::isnan(f[1])) && std::isfinite(f[0]) && std::isfinite(f[1]))
+            !(std::isnan(f[1])) && std::isfinite(f[0]) && std::isfinite(f[1])) {
+            P4IntStats::count(P4IntCounter::accepted);
+            if (!(d < e3)) {
+                P4IntStats::count(P4IntCounter::at_hmi);
+                P4IntStats::countHmiTime(fabs(h));
+            }
             break;
+        }
+        P4IntStats::count(P4IntCounter::rejected);
 
         h = h * 0.9 * sqrt(sqrt(sqrt(e3 / d)));
 
@@ -23,15 +23,18 @@
 
 #include <cmath>
 
+#include "P4Canvas.hpp"
 #include "P4InputVF.hpp"
+#include "P4IntStats.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
+#include "P4TrajectoryStore.hpp"
 #include "P4VFStudy.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
 #include "math_numerics.hpp"
 #include "math_p4.hpp"
 #include "math_polynom.hpp"
+#include "math_refine.hpp"
 #include "plot_tools.hpp"
 #include "structures.hpp"
 
@@ -54,7 +57,7 @@ bool prepareVfForIntegration(double *pcoord)
 // -----------------------------------------------------------------------
 // dir = -1: backwards, dir=0: continue, dir=+1: forwards
 // Continues orbit integration
-void integrateOrbit(P4Sphere *sphere, int dir)
+void integrateOrbit(P4Canvas *sphere, int dir)
 {
     P4Orbits::orbits_points *sep;
     double pcoord[3], ucoord[2];
@@ -72,6 +75,7 @@ void integrateOrbit(P4Sphere *sphere, int dir)
             sphere, pcoord, gVFResults.config_currentstep_, dir,
             P4ColourSettings::colour_orbit, gVFResults.config_intpoints_, &sep);
         gVFResults.currentOrbit_->currentpt = sep;
+        P4TrajectoryStore::grown(&gVFResults.currentOrbit_->firstpt);
 
         return;
     }
@@ -103,13 +107,14 @@ void integrateOrbit(P4Sphere *sphere, int dir)
             P4ColourSettings::colour_orbit, gVFResults.config_intpoints_, &sep);
     }
     gVFResults.currentOrbit_->currentpt = sep;
+    P4TrajectoryStore::grown(&gVFResults.currentOrbit_->firstpt);
 }
 
 // -----------------------------------------------------------------------
 //          startOrbit
 // -----------------------------------------------------------------------
 /* R=0 then point selected in the drawing canvas else in the orbit window */
-bool startOrbit(P4Sphere *sphere, double x, double y, bool R)
+bool startOrbit(P4Canvas *sphere, double x, double y, bool R)
 {
     double pcoord[3], ucoord[2];
 
@@ -137,32 +142,53 @@ bool startOrbit(P4Sphere *sphere, double x, double y, bool R)
     return true;
 }
 
+// -----------------------------------------------------------------------
+//          drawsAllPoints
+// -----------------------------------------------------------------------
+// The plot window draws the summary of the chunks of a curve that have been
+// moved out of memory, but printing needs all of the points, and so does a
+// zoom window.  Since the plot functions hand each primitive to every canvas
+// that is drawing, one zoom window among them is enough.
+bool drawsAllPoints()
+{
+    if (plot_l != spherePlotLine)
+        return true;
+    for (auto const &it : P4Canvas::sM_canvasList) {
+        if (it->isZoom() && it->isDrawing())
+            return true;
+    }
+    return false;
+}
+
 // -----------------------------------------------------------------------
 //          drawOrbit
 // -----------------------------------------------------------------------
-void drawOrbit(P4Sphere *spherewnd, const double *pcoord,
+void drawOrbit(P4Canvas *spherewnd, const double *pcoord,
                P4Orbits::orbits_points *points, int color)
 {
     double pcoord1[3];
 
+    if (drawRefinedCurve(spherewnd, pcoord, points, color))
+        return;
+
     copy_x_into_y(pcoord, pcoord1);
     (*plot_p)(spherewnd, pcoord, color);
 
-    while (points != nullptr) {
-        if (points->dashes) {
-            (*plot_l)(spherewnd, pcoord1, points->pcoord, color);
+    P4CurveReader r{points, drawsAllPoints()};
+    for (auto p = r.next(); p != nullptr; p = r.next()) {
+        if (p->dashes) {
+            (*plot_l)(spherewnd, pcoord1, p->pcoord, color);
         } else {
-            (*plot_p)(spherewnd, points->pcoord, color);
+            (*plot_p)(spherewnd, p->pcoord, color);
         }
-        copy_x_into_y(points->pcoord, pcoord1);
-        points = points->nextpt;
+        copy_x_into_y(p->pcoord, pcoord1);
     }
 }
 
 // -----------------------------------------------------------------------
 //                      DRAWORBITS
 // -----------------------------------------------------------------------
-void drawOrbits(P4Sphere *spherewnd)
+void drawOrbits(P4Canvas *spherewnd)
 {
     for (auto orbit = gVFResults.firstOrbit_; orbit != nullptr;
          orbit = orbit->next)
@@ -172,14 +198,12 @@ void drawOrbits(P4Sphere *spherewnd)
 // -----------------------------------------------------------------------
 //          deleteLastOrbit
 // -----------------------------------------------------------------------
-void deleteLastOrbit(P4Sphere *spherewnd)
+void deleteLastOrbit(P4Canvas *spherewnd)
 {
     if (gVFResults.currentOrbit_ == nullptr)
         return;
 
     auto orbit1 = gVFResults.currentOrbit_;
-    drawOrbit(spherewnd, orbit1->pcoord, orbit1->firstpt,
-              spherewnd->spherebgcolor_);
 
     if (gVFResults.firstOrbit_ == gVFResults.currentOrbit_) {
         gVFResults.firstOrbit_ = nullptr;
@@ -194,7 +218,47 @@ void deleteLastOrbit(P4Sphere *spherewnd)
         } while (orbit2 != orbit1);
         gVFResults.currentOrbit_->next = nullptr;
     }
+    if (gVFResults.selectedOrbit_ == orbit1)
+        gVFResults.selectedOrbit_ = nullptr;
+    P4TrajectoryStore::forget(&orbit1->firstpt);
     delete orbit1->firstpt;
+
+    // the other layers are just replayed
+    spherewnd->refreshLayer(P4SphereLayers::layer_orbits);
+}
+
+// -----------------------------------------------------------------------
+//          deleteOrbit
+// -----------------------------------------------------------------------
+// Delete an arbitrary orbit, for example the one picked with the mouse.
+void deleteOrbit(P4Canvas *spherewnd, P4Orbits::orbits *orbit)
+{
+    P4Orbits::orbits *prev{nullptr};
+    P4Orbits::orbits *orbit1;
+
+    for (orbit1 = gVFResults.firstOrbit_; orbit1 != nullptr;
+         orbit1 = orbit1->next) {
+        if (orbit1 == orbit)
+            break;
+        prev = orbit1;
+    }
+    if (orbit1 == nullptr)
+        return;
+
+    if (prev == nullptr)
+        gVFResults.firstOrbit_ = orbit->next;
+    else
+        prev->next = orbit->next;
+    if (gVFResults.currentOrbit_ == orbit)
+        gVFResults.currentOrbit_ = prev;
+    if (gVFResults.selectedOrbit_ == orbit)
+        gVFResults.selectedOrbit_ = nullptr;
+
+    // the destructor would delete the rest of the list too
+    orbit->next = nullptr;
+    delete orbit;
+
+    spherewnd->refreshLayer(P4SphereLayers::layer_orbits);
 }
 
 // ---------------------------------------------------------------------------
@@ -214,11 +278,13 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
             dashes = true;
             dir = 1;
             psphere_to_R2(p0, p1, p2, y);
+            P4IntStats::useChart(P4Charts::chart_R2);
             rk78(eval_r_vec_field, y, &hhi0, h_min, h_max,
                  gVFResults.config_tolerance_);
             if (gThisVF->getVFIndex_R2(y) == gVFResults.K_)
                 break;
             h_min = gVFResults.config_branchhmi_;
+            P4IntStats::count(P4IntCounter::halvings);
             h_max /= 2;
             hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
             if (fabs(hhi0) < h_min || h_max < gVFResults.config_branchhmi_) {
@@ -239,6 +305,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                     dashes = true;
                     dir = 1;
                     psphere_to_U1(p0, p1, p2, y);
+                    P4IntStats::useChart(P4Charts::chart_U1);
                     rk78(eval_U1_vec_field, y, &hhi0, h_min, h_max,
                          gVFResults.config_tolerance_);
                     if (y[1] >= 0 || !gVFResults.vf_[gVFResults.K_]->singinf_) {
@@ -249,6 +316,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                             break;
                     }
                     h_min = gVFResults.config_branchhmi_;
+                    P4IntStats::count(P4IntCounter::halvings);
                     h_max /= 2;
                     hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                     if (fabs(hhi0) < h_min ||
@@ -277,6 +345,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                     dashes = true;
                     dir = 1;
                     psphere_to_V1(p0, p1, p2, y);
+                    P4IntStats::useChart(P4Charts::chart_V1);
                     rk78(eval_V1_vec_field, y, &hhi0, h_min, h_max,
                          gVFResults.config_tolerance_);
                     if (y[1] >= 0 || !gVFResults.vf_[gVFResults.K_]->singinf_) {
@@ -287,6 +356,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                             break;
                     }
                     h_min = gVFResults.config_branchhmi_;
+                    P4IntStats::count(P4IntCounter::halvings);
                     h_max /= 2;
                     hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                     if (fabs(hhi0) < h_min ||
@@ -315,6 +385,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                 hhi0 = hhi;
                 while (1) {
                     psphere_to_U2(p0, p1, p2, y);
+                    P4IntStats::useChart(P4Charts::chart_U2);
                     rk78(eval_U2_vec_field, y, &hhi0, h_min, h_max,
                          gVFResults.config_tolerance_);
                     if (y[1] >= 0 || !gVFResults.vf_[gVFResults.K_]->singinf_) {
@@ -325,6 +396,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                             break;
                     }
                     h_min = gVFResults.config_branchhmi_;
+                    P4IntStats::count(P4IntCounter::halvings);
                     h_max /= 2;
                     hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                     if (fabs(hhi0) < h_min ||
@@ -351,6 +423,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                 hhi0 = hhi;
                 while (1) {
                     psphere_to_V2(p0, p1, p2, y);
+                    P4IntStats::useChart(P4Charts::chart_V2);
                     rk78(eval_V2_vec_field, y, &hhi, h_min, h_max,
                          gVFResults.config_tolerance_);
                     if (y[1] >= 0 || !gVFResults.vf_[gVFResults.K_]->singinf_) {
@@ -361,6 +434,7 @@ void integrate_poincare_orbit(double p0, double p1, double p2, double *pcoord,
                             break;
                     }
                     h_min = gVFResults.config_branchhmi_;
+                    P4IntStats::count(P4IntCounter::halvings);
                     h_max /= 2;
                     hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                     if (fabs(hhi0) < h_min ||
@@ -405,11 +479,13 @@ void integrate_lyapunov_orbit(double p0, double p1, double p2, double *pcoord,
             dashes = true;
             y[0] = p1;
             y[1] = p2;
+            P4IntStats::useChart(P4Charts::chart_R2);
             rk78(eval_r_vec_field, y, &hhi, h_min, h_max,
                  gVFResults.config_tolerance_);
             if (gThisVF->getVFIndex_R2(y) == gVFResults.K_)
                 break;
             h_min = gVFResults.config_branchhmi_;
+            P4IntStats::count(P4IntCounter::halvings);
             h_max /= 2;
             hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
             if (fabs(hhi0) < h_min || h_max < gVFResults.config_branchhmi_) {
@@ -427,11 +503,13 @@ void integrate_lyapunov_orbit(double p0, double p1, double p2, double *pcoord,
             dir = 1;
             y[0] = p1;
             y[1] = p2;
+            P4IntStats::useChart(P4IntStats::chart_cylinder);
             rk78(eval_vec_field_cyl, y, &hhi, h_min, h_max,
                  gVFResults.config_tolerance_);
             if (gThisVF->getVFIndex_cyl(y) == gVFResults.K_)
                 break;
             h_min = gVFResults.config_branchhmi_;
+            P4IntStats::count(P4IntCounter::halvings);
             h_max /= 2;
             hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
             if (fabs(hhi0) < h_min || h_max < gVFResults.config_branchhmi_) {
@@ -450,7 +528,7 @@ void integrate_lyapunov_orbit(double p0, double p1, double p2, double *pcoord,
 //          integrate_orbit
 // ---------------------------------------------------------------------------
 // Integrate a number of points (user-dependent)
-P4Orbits::orbits_points *integrate_orbit(P4Sphere *spherewnd, double pcoord[3],
+P4Orbits::orbits_points *integrate_orbit(P4Canvas *spherewnd, double pcoord[3],
                                          double step, int dir, int color,
                                          int points_to_int,
                                          P4Orbits::orbits_points **orbit)
@@ -464,6 +542,7 @@ P4Orbits::orbits_points *integrate_orbit(P4Sphere *spherewnd, double pcoord[3],
     double h_min{gVFResults.config_hmi_};
     double h_max{gVFResults.config_hma_};
 
+    P4IntStats::startCurve();
     copy_x_into_y(pcoord, pcoord2);
 
     for (int i = 1; i <= points_to_int; ++i) {
@@ -21,11 +21,12 @@
 
 #include <vector>
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Orbits
 {
 struct orbits_points;
+struct orbits;
 }
 
 bool prepareVfForIntegration(double *pcoord);
@@ -38,18 +39,24 @@ void integrate_lyapunov_orbit(double p0, double p1, double p2, double *pcoord,
                               double &hhi, int &dashes, int &dir, double h_min,
                               double h_max);
 
-void integrateOrbit(P4Sphere *, int);
+void integrateOrbit(P4Canvas *, int);
 
-P4Orbits::orbits_points *integrate_orbit(P4Sphere *spherewnd, double pcoord[3],
+P4Orbits::orbits_points *integrate_orbit(P4Canvas *spherewnd, double pcoord[3],
                                          double step, int dir, int color,
                                          int points_to_int,
                                          P4Orbits::orbits_points **orbit);
 
-void drawOrbit(P4Sphere *spherewnd, const double *pcoord,
+// whether the orbits and separatrices being plotted now need all of their
+// points, and not only the summary of the chunks moved out of memory
+bool drawsAllPoints();
+
+void drawOrbit(P4Canvas *spherewnd, const double *pcoord,
                P4Orbits::orbits_points *points, int color);
 
-bool startOrbit(P4Sphere *sphere, double x, double y, bool R);
+bool startOrbit(P4Canvas *sphere, double x, double y, bool R);
+
+void drawOrbits(P4Canvas *spherewnd);
 
-void drawOrbits(P4Sphere *spherewnd);
+void deleteLastOrbit(P4Canvas *spherewnd);
 
-void deleteLastOrbit(P4Sphere *spherewnd);
+void deleteOrbit(P4Canvas *spherewnd, P4Orbits::orbits *orbit);
@@ -21,11 +21,7 @@
 
 #include <cmath>
 
-#include "P4IntParamsDlg.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4PlotWnd.hpp"
-#include "P4Sphere.hpp"
-#include "P4StartDlg.hpp"
 #include "math_charts.hpp"
 #include "structures.hpp"
 
@@ -70,16 +66,14 @@ bool less_lyapunov(double *p1, double *p2)
     return (0);
 }
 
+void (*show_current_step)(double) = nullptr;
+
 void set_current_step(double curstep)
 {
     gVFResults.config_currentstep_ = curstep;
 
-    if (gP4startDlg != nullptr) {
-        auto p = gP4startDlg->getPlotWindowPtr();
-        if (p != nullptr) {
-            p->getIntParamsWindowPtr()->setCurrentStep(curstep);
-        }
-    }
+    if (show_current_step != nullptr)
+        show_current_step(curstep);
 }
 
 void rplane_plsphere0(double x, double y, double *pcoord)
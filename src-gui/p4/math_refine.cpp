@@ -0,0 +1,351 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "math_refine.hpp"
+
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "P4Canvas.hpp"
+#include "P4DisplayList.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4TrajectoryStore.hpp"
+#include "math_charts.hpp"
+#include "math_orbits.hpp"
+#include "plot_tools.hpp"
+#include "structures.hpp"
+
+// -----------------------------------------------------------------------
+//                      REFINING CURVES IN ZOOM WINDOWS
+// -----------------------------------------------------------------------
+//
+// Stored orbits and separatrices consist of the points of the original
+// integration, whose steps are bounded by hma.  Magnified in a zoom window,
+// they look like a jagged polyline.  When the zoom window refines curves,
+// each stored step that crosses the window is integrated again, starting
+// from its first point in the orientation of time stored with the second
+// one, with hma divided by the magnification, until the second point is
+// reached.  This happens on the worker thread that renders the window.  The
+// refined steps are cached per zoom level, i.e. per bound on the step size.
+
+// steps that are shorter than this (in pixels) are not refined
+#define REFINE_MINPIXELS 3
+
+// maximum number of refined steps for one stored step
+#define REFINE_MAXSTEPS 1000
+
+// the refinement has arrived when it is this close to the second point, or
+// is accepted as long as it came this close (relative to the stored step)
+#define REFINE_ARRIVED 0.02
+#define REFINE_CLOSE 0.1
+
+// the cache is emptied when it holds this many stored steps
+#define REFINE_CACHESIZE 100000
+
+using P4RefineKey =
+    std::tuple<double, double, double, double, double, double, double, int>;
+using P4RefinedStep = std::vector<std::array<double, 3>>;
+
+// the renders of several zoom windows may refine at the same time
+static std::mutex sRefineMutex;
+static std::map<P4RefineKey, P4RefinedStep> sRefineCache;
+
+void clearRefinedCurves()
+{
+    std::lock_guard<std::mutex> lock{sRefineMutex};
+    sRefineCache.clear();
+}
+
+// The refine jobs that are running.  A job only runs for the vector fields
+// it was made for: stopping the jobs starts a new generation.
+static int sRefineRunning{0};
+static std::atomic<unsigned long> sRefineGeneration{0};
+static std::condition_variable sRefineDone;
+
+void stopRefinedCurves()
+{
+    std::unique_lock<std::mutex> lock{sRefineMutex};
+    sRefineGeneration++;
+    sRefineDone.wait(lock, [] { return sRefineRunning == 0; });
+}
+
+// The zoom level is the magnification of the window, rounded up to a power
+// of two.
+static int zoomLevel(const P4Canvas *sp)
+{
+    double full;
+
+    if (gVFResults.typeofview_ == P4TypeOfView::typeofview_sphere)
+        full = 2.2;
+    else
+        full = gVFResults.xmax_ - gVFResults.xmin_;
+
+    double zoom{full / sp->dx_};
+    if (zoom <= 1)
+        return 0;
+    return static_cast<int>(std::ceil(std::log2(zoom)));
+}
+
+double P4RefineJob::viewDistance(const double *pcoord,
+                                 const double *ucoord) const
+{
+    double u[2];
+
+    toView_(pcoord[0], pcoord[1], pcoord[2], u);
+    return std::hypot(u[0] - ucoord[0], u[1] - ucoord[1]);
+}
+
+// Integrates from p1 towards p2, forwards in time if dir is positive.
+// Returns false if p2 was not reached, e.g. because a line of singularities
+// was met.
+bool P4RefineJob::refineStep(const double *p1, const double *p2, int dir,
+                             P4RefinedStep &out) const
+{
+    double u2[2], pcoord[3], hhi, len, dmin, d;
+    int dashes, d2;
+
+    if (dir == 0)
+        return false;
+
+    toView_(p2[0], p2[1], p2[2], u2);
+    len = viewDistance(p1, u2);
+    if (len == 0)
+        return false;
+
+    hhi = (dir > 0) ? hmax_ : -hmax_;
+
+    copy_x_into_y(p1, pcoord);
+    dmin = len;
+    for (int i = 0; i < REFINE_MAXSTEPS; i++) {
+        if (!prepareVfForIntegration(pcoord))
+            return false;
+        integrate_(pcoord[0], pcoord[1], pcoord[2], pcoord, hhi, dashes, d2,
+                   hmin_, hmax_);
+        if (!dashes)
+            return false;
+
+        d = viewDistance(pcoord, u2);
+        if (d < REFINE_ARRIVED * len)
+            return true;
+        if (d > dmin) // p2 has been passed
+            return dmin < REFINE_CLOSE * len;
+
+        dmin = d;
+        out.push_back({{pcoord[0], pcoord[1], pcoord[2]}});
+    }
+    return false;
+}
+
+// The cache is only locked to look up and to store: the integration itself
+// runs in parallel.
+P4RefinedStep P4RefineJob::refinedStep(const double *p1, const double *p2,
+                                       int dir) const
+{
+    P4RefineKey key{hmax_, p1[0], p1[1], p1[2], p2[0], p2[1], p2[2], dir};
+
+    {
+        std::lock_guard<std::mutex> lock{sRefineMutex};
+        auto it = sRefineCache.find(key);
+        if (it != sRefineCache.end())
+            return it->second;
+    }
+
+    // a step that cannot be refined is kept empty, and drawn straight
+    P4RefinedStep step;
+    if (!refineStep(p1, p2, dir, step))
+        step.clear();
+
+    std::lock_guard<std::mutex> lock{sRefineMutex};
+    if (sRefineCache.size() >= REFINE_CACHESIZE)
+        sRefineCache.clear();
+    sRefineCache[key] = step;
+    return step;
+}
+
+static void drawLineOn(P4Canvas *sp, const double *p1, const double *p2,
+                       int color)
+{
+    double ucoord1[2], ucoord2[2], ucoord3[2], ucoord4[2];
+
+    if (MATHFUNC(sphere_to_viewcoordpair)(p1, p2, ucoord1, ucoord2, ucoord3,
+                                          ucoord4)) {
+        sp->drawLine(ucoord1[0], ucoord1[1], ucoord2[0], ucoord2[1], color);
+    } else {
+        sp->drawLine(ucoord1[0], ucoord1[1], ucoord2[0], ucoord2[1], color);
+        sp->drawLine(ucoord3[0], ucoord3[1], ucoord4[0], ucoord4[1], color);
+    }
+}
+
+static void drawPointOn(P4Canvas *sp, const double *p, int color)
+{
+    double ucoord[2];
+
+    MATHFUNC(sphere_to_viewcoord)(p[0], p[1], p[2], ucoord);
+    sp->drawPoint(ucoord[0], ucoord[1], color);
+}
+
+// Draws a stored step straight, or leaves it to the refine job if it
+// crosses the window and is long enough to look jagged.
+static void drawStepOn(P4Canvas *sp, P4RefineJob *job, const double *p1,
+                       const P4Orbits::orbits_points *p2, int color)
+{
+    double ucoord1[2], ucoord2[2], ucoord3[2], ucoord4[2];
+
+    if (!job->isRefining()) {
+        drawLineOn(sp, p1, p2->pcoord, color);
+        return;
+    }
+    if (!MATHFUNC(sphere_to_viewcoordpair)(p1, p2->pcoord, ucoord1, ucoord2,
+                                           ucoord3, ucoord4)) {
+        // the step is split between two charts: not refined
+        drawLineOn(sp, p1, p2->pcoord, color);
+        return;
+    }
+
+    double pixel{sp->dx_ / (sp->w_ - 1)};
+    if (std::fmax(ucoord1[0], ucoord2[0]) < sp->x0_ ||
+        std::fmin(ucoord1[0], ucoord2[0]) > sp->x1_ ||
+        std::fmax(ucoord1[1], ucoord2[1]) < sp->y0_ ||
+        std::fmin(ucoord1[1], ucoord2[1]) > sp->y1_ ||
+        std::hypot(ucoord2[0] - ucoord1[0], ucoord2[1] - ucoord1[1]) <
+            REFINE_MINPIXELS * pixel) {
+        sp->drawLine(ucoord1[0], ucoord1[1], ucoord2[0], ucoord2[1], color);
+        return;
+    }
+
+    job->add(p1, p2->pcoord, color, p2->dir);
+}
+
+bool drawRefinedCurve(P4Canvas *sp, const double *pcoord,
+                      P4Orbits::orbits_points *points, int color)
+{
+    P4RefineJob *job{sp->refineJob()};
+    if (job == nullptr)
+        return false;
+
+    const double *prev{pcoord};
+
+    if (pcoord != nullptr)
+        drawPointOn(sp, pcoord, color);
+
+    // a refining sphere is a zoom window, so it needs all the points; the
+    // previous point stays valid while the next one is read
+    P4CurveReader r{points, true};
+    for (auto p = r.next(); p != nullptr; p = r.next()) {
+        int c{(color == -1) ? p->color : color};
+        if (p->dashes && prev != nullptr)
+            drawStepOn(sp, job, prev, p, c);
+        else
+            drawPointOn(sp, p->pcoord, c);
+        prev = p->pcoord;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                      P4RefineJob
+// -----------------------------------------------------------------------
+
+P4RefineJob::P4RefineJob(const P4Canvas *sp)
+    : level_{zoomLevel(sp)}, hmax_{std::ldexp(gVFResults.config_hma_,
+                                              -level_)},
+      x0_{sp->x0_}, y0_{sp->y0_}, x1_{sp->x1_}, y1_{sp->y1_},
+      generation_{sRefineGeneration},
+      toView_{gVFResults.sphere_to_viewcoord},
+      toViewPair_{gVFResults.sphere_to_viewcoordpair},
+      integrate_{gVFResults.integrate_sphere_orbit}
+{
+    hmin_ = std::fmin(gVFResults.config_hmi_, hmax_);
+}
+
+bool P4RefineJob::isStopped() const
+{
+    return sRefineGeneration != generation_;
+}
+
+void P4RefineJob::add(const double *p1, const double *p2, int color, int dir)
+{
+    steps_.push_back({{p1[0], p1[1], p1[2]}, {p2[0], p2[1], p2[2]}, color,
+                      dir});
+}
+
+// Like drawLineOn, but on a display list, clipped as P4Sphere::drawLine
+// does.
+static void addLine(P4DisplayList &list, const double *u1, const double *u2,
+                    int color, double x0, double y0, double x1, double y1)
+{
+    double ax{u1[0]}, ay{u1[1]}, bx{u2[0]}, by{u2[1]};
+
+    if (ax < x0 || ax > x1 || ay < y0 || ay > y1 || bx < x0 || bx > x1 ||
+        by < y0 || by > y1) {
+        if (!lineRectangleIntersect(ax, ay, bx, by, x0, x1, y0, y1))
+            return;
+    }
+    list.addLine(ax, ay, bx, by, color);
+}
+
+bool P4RefineJob::run(P4DisplayList &list,
+                      const std::atomic<bool> *cancel) const
+{
+    double ucoord1[2], ucoord2[2], ucoord3[2], ucoord4[2];
+    bool done{true};
+
+    {
+        std::lock_guard<std::mutex> lock{sRefineMutex};
+        if (sRefineGeneration != generation_)
+            return false;
+        sRefineRunning++;
+    }
+
+    for (auto const &it : steps_) {
+        if ((cancel != nullptr && *cancel) ||
+            sRefineGeneration != generation_) {
+            done = false;
+            break;
+        }
+
+        const double *prev{it.p1};
+        auto line = [&](const double *p) {
+            if (toViewPair_(prev, p, ucoord1, ucoord2, ucoord3, ucoord4)) {
+                addLine(list, ucoord1, ucoord2, it.color, x0_, y0_, x1_, y1_);
+            } else {
+                addLine(list, ucoord1, ucoord2, it.color, x0_, y0_, x1_, y1_);
+                addLine(list, ucoord3, ucoord4, it.color, x0_, y0_, x1_, y1_);
+            }
+            prev = p;
+        };
+
+        auto refined = refinedStep(it.p1, it.p2, it.dir);
+        for (auto const &p : refined)
+            line(p.data());
+        line(it.p2);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{sRefineMutex};
+        sRefineRunning--;
+    }
+    sRefineDone.notify_all();
+    return done;
+}
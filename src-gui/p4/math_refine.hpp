@@ -0,0 +1,102 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+class P4Canvas;
+class P4DisplayList;
+
+namespace P4Orbits
+{
+struct orbits_points;
+}
+
+// The steps of the stored curves that a zoom window refines.  They are
+// gathered while the layer is recorded, and integrated again by the render
+// of the window, off the GUI thread.  The view and the integration
+// parameters are copied from gVFResults when the job is made, on the GUI
+// thread, so that run does not read them while they may change.
+class P4RefineJob
+{
+  public:
+    // the bound on the step size follows from the magnification of sp,
+    // whose window is taken to clip the refined steps
+    explicit P4RefineJob(const P4Canvas *sp);
+
+    // whether the window is magnified enough to refine at all
+    bool isRefining() const { return level_ > 0; }
+
+    // whether stopRefinedCurves was called since the job was made: it does
+    // not run anymore, and its layer has to be recorded again
+    bool isStopped() const;
+
+    // dir is the orientation of time from p1 to p2, as stored with p2
+    void add(const double *p1, const double *p2, int color, int dir);
+    bool empty() const { return steps_.empty(); }
+
+    // Integrates the steps and records them in list.  Returns false, with
+    // the list incomplete, as soon as cancel is set.
+    bool run(P4DisplayList &list, const std::atomic<bool> *cancel) const;
+
+  private:
+    struct step {
+        double p1[3];
+        double p2[3];
+        int color;
+        int dir;
+    };
+
+    int level_;
+    double hmin_, hmax_;
+    double x0_, y0_, x1_, y1_;
+    unsigned long generation_; // see stopRefinedCurves
+    std::vector<step> steps_;
+
+    // the coordinate transformations and the integrator of the view
+    void (*toView_)(double, double, double, double *);
+    bool (*toViewPair_)(const double *, const double *, double *, double *,
+                        double *, double *);
+    void (*integrate_)(double, double, double, double *, double &, int &,
+                       int &, double, double);
+
+    double viewDistance(const double *pcoord, const double *ucoord) const;
+    bool refineStep(const double *p1, const double *p2, int dir,
+                    std::vector<std::array<double, 3>> &out) const;
+    std::vector<std::array<double, 3>>
+    refinedStep(const double *p1, const double *p2, int dir) const;
+};
+
+// Draws a stored orbit or separatrix on a zoom window that refines curves
+// (see P4Sphere::setRefineCurves).  The steps that cross the window are not
+// drawn, but added to the refine job of the sphere.  Returns false, without
+// drawing anything, if the sphere does not refine.  A color of -1 means
+// that each point carries its own color.
+bool drawRefinedCurve(P4Canvas *sp, const double *pcoord,
+                      P4Orbits::orbits_points *points, int color);
+
+void clearRefinedCurves();
+
+// Stops the refine jobs that are running, and waits for them, before the
+// vector fields that they integrate, the view or the integration parameters
+// are changed.  The jobs that were made before do not run anymore.
+void stopRefinedCurves();
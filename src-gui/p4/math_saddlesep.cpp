@@ -22,6 +22,7 @@
 #include <QDebug>
 
 #include "P4ParentStudy.hpp"
+#include "P4TrajectoryStore.hpp"
 #include "math_charts.hpp"
 #include "math_orbits.hpp"
 #include "math_regions.hpp"
@@ -32,7 +33,7 @@
 //      start_plot_saddle_sep
 // ---------------------------------------------------------------------------
 // Start plotting a separatrice for a saddle singular point
-void start_plot_saddle_sep(P4Sphere *spherewnd, int vfindex)
+void start_plot_saddle_sep(P4Canvas *spherewnd, int vfindex)
 {
     double p[3];
 
@@ -63,6 +64,7 @@ void start_plot_saddle_sep(P4Sphere *spherewnd, int vfindex)
             &points, gVFResults.selectedSaddlePoint_->chart, vfindex);
     }
     gVFResults.selectedSep_->last_sep_point = points;
+    P4TrajectoryStore::grown(&gVFResults.selectedSep_->first_sep_point);
 }
 
 // ---------------------------------------------------------------------------
@@ -70,7 +72,7 @@ void start_plot_saddle_sep(P4Sphere *spherewnd, int vfindex)
 // ---------------------------------------------------------------------------
 // Continuation of the plot is done via the standard integrate_sep method,
 // and no longer depends on the type of the singularity.
-void cont_plot_saddle_sep(P4Sphere *spherewnd)
+void cont_plot_saddle_sep(P4Canvas *spherewnd)
 {
     double p[3];
 
@@ -88,12 +90,13 @@ void cont_plot_saddle_sep(P4Sphere *spherewnd)
                       gVFResults.config_intpoints_, &points);
 
     gVFResults.selectedSep_->last_sep_point = points;
+    P4TrajectoryStore::grown(&gVFResults.selectedSep_->first_sep_point);
 }
 
 // ---------------------------------------------------------------------------
 //          plot_next_saddle_sep
 // ---------------------------------------------------------------------------
-void plot_next_saddle_sep(P4Sphere *spherewnd, int vfindex)
+void plot_next_saddle_sep(P4Canvas *spherewnd, int vfindex)
 {
     draw_sep(spherewnd, gVFResults.selectedSep_->first_sep_point);
 
@@ -107,7 +110,7 @@ void plot_next_saddle_sep(P4Sphere *spherewnd, int vfindex)
 // ---------------------------------------------------------------------------
 //          select_next_saddle_sep
 // ---------------------------------------------------------------------------
-void select_next_saddle_sep(P4Sphere *spherewnd)
+void select_next_saddle_sep(P4Canvas *spherewnd)
 {
     draw_sep(spherewnd, gVFResults.selectedSep_->first_sep_point);
 
@@ -122,7 +125,7 @@ void select_next_saddle_sep(P4Sphere *spherewnd)
 // ---------------------------------------------------------------------------
 //          plot_all_saddle_sep
 // ---------------------------------------------------------------------------
-void plot_all_saddle_sep(P4Sphere *spherewnd, int vfindex,
+void plot_all_saddle_sep(P4Canvas *spherewnd, int vfindex,
                          P4Singularities::saddle *point)
 {
     double p[3];
@@ -149,6 +152,7 @@ void plot_all_saddle_sep(P4Sphere *spherewnd, int vfindex,
                         point->chart, vfindex);
                 }
                 sep1->last_sep_point = points;
+                P4TrajectoryStore::grown(&sep1->first_sep_point);
                 sep1 = sep1->next_sep;
             }
         }
@@ -159,7 +163,7 @@ void plot_all_saddle_sep(P4Sphere *spherewnd, int vfindex,
 // ---------------------------------------------------------------------------
 //          change_epsilon_saddle
 // ---------------------------------------------------------------------------
-void change_epsilon_saddle(P4Sphere *spherewnd, double epsilon)
+void change_epsilon_saddle(P4Canvas *spherewnd, double epsilon)
 {
     gVFResults.selectedSaddlePoint_->epsilon = epsilon;
     auto separatrice = gVFResults.selectedSaddlePoint_->separatrices;
@@ -167,6 +171,7 @@ void change_epsilon_saddle(P4Sphere *spherewnd, double epsilon)
     while (separatrice != nullptr) {
         draw_selected_sep(spherewnd, separatrice->first_sep_point,
                           P4ColourSettings::colour_background);
+        P4TrajectoryStore::forget(&separatrice->first_sep_point);
         delete separatrice->first_sep_point;
         separatrice->first_sep_point = nullptr;
         separatrice->last_sep_point = nullptr;
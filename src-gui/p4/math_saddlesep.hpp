@@ -21,17 +21,17 @@
 
 #include <vector>
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Singularities
 {
 struct saddle;
 }
 
-void start_plot_saddle_sep(P4Sphere *spherewnd, int vfindex);
-void cont_plot_saddle_sep(P4Sphere *spherewnd);
-void plot_next_saddle_sep(P4Sphere *spherewnd, int vfindex);
-void select_next_saddle_sep(P4Sphere *spherewnd);
-void plot_all_saddle_sep(P4Sphere *spherewnd, int vfindex,
+void start_plot_saddle_sep(P4Canvas *spherewnd, int vfindex);
+void cont_plot_saddle_sep(P4Canvas *spherewnd);
+void plot_next_saddle_sep(P4Canvas *spherewnd, int vfindex);
+void select_next_saddle_sep(P4Canvas *spherewnd);
+void plot_all_saddle_sep(P4Canvas *spherewnd, int vfindex,
                          P4Singularities::saddle *point);
-void change_epsilon_saddle(P4Sphere *spherewnd, double epsilon);
+void change_epsilon_saddle(P4Canvas *spherewnd, double epsilon);
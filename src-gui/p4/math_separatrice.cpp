@@ -23,7 +23,9 @@
 
 #include <QDebug>
 
+#include "P4IntStats.hpp"
 #include "P4ParentStudy.hpp"
+#include "P4TrajectoryStore.hpp"
 #include "P4VFStudy.hpp"
 #include "custom.hpp"
 #include "math_charts.hpp"
@@ -32,16 +34,17 @@
 #include "math_orbits.hpp"
 #include "math_p4.hpp"
 #include "math_polynom.hpp"
+#include "math_refine.hpp"
 #include "math_saddlesep.hpp"
 #include "math_sesep.hpp"
 #include "plot_tools.hpp"
 #include "structures.hpp"
 
-void (*change_epsilon)(P4Sphere *, double) = nullptr;
-void (*start_plot_sep)(P4Sphere *, int) = nullptr;
-void (*cont_plot_sep)(P4Sphere *) = nullptr;
-void (*plot_next_sep)(P4Sphere *, int) = nullptr;
-void (*select_next_sep)(P4Sphere *) = nullptr;
+void (*change_epsilon)(P4Canvas *, double) = nullptr;
+void (*start_plot_sep)(P4Canvas *, int) = nullptr;
+void (*cont_plot_sep)(P4Canvas *) = nullptr;
+void (*plot_next_sep)(P4Canvas *, int) = nullptr;
+void (*select_next_sep)(P4Canvas *) = nullptr;
 
 // ---------------------------------------------------------------------------
 //          findSepColor2
@@ -195,11 +198,13 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
             dashes = true;
             dir = 1;
             psphere_to_R2(p0, p1, p2, y);
+            P4IntStats::useChart(P4Charts::chart_R2);
             rk78(eval_r_vec_field, y, &hhi0, h_min, h_max,
                  gVFResults.config_tolerance_);
             if (gThisVF->getVFIndex_R2(y) == gVFResults.K_)
                 break;
             h_min = gVFResults.config_branchhmi_;
+            P4IntStats::count(P4IntCounter::halvings);
             h_max /= 2;
             hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
             if (fabs(hhi0) < h_min || h_max < gVFResults.config_branchhmi_) {
@@ -221,6 +226,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                     dashes = true;
                     dir = 1;
                     psphere_to_U1(p0, p1, p2, y);
+                    P4IntStats::useChart(P4Charts::chart_U1);
                     rk78(eval_U1_vec_field, y, &hhi0, h_min, h_max,
                          gVFResults.config_tolerance_);
                     if (y[1] >= 0 || !vfResultsK->singinf_) {
@@ -231,6 +237,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                             break;
                     }
                     h_min = gVFResults.config_branchhmi_;
+                    P4IntStats::count(P4IntCounter::halvings);
                     h_max /= 2;
                     hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                     if (fabs(hhi0) < h_min ||
@@ -262,6 +269,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                     dashes = true;
                     dir = 1;
                     psphere_to_V1(p0, p1, p2, y);
+                    P4IntStats::useChart(P4Charts::chart_V1);
                     rk78(eval_V1_vec_field, y, &hhi0, h_min, h_max,
                          gVFResults.config_tolerance_);
                     if (y[1] >= 0 || !vfResultsK->singinf_) {
@@ -272,6 +280,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                             break;
                     }
                     h_min = gVFResults.config_branchhmi_;
+                    P4IntStats::count(P4IntCounter::halvings);
                     h_max /= 2;
                     hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                     if (fabs(hhi0) < h_min ||
@@ -302,6 +311,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
             hhi0 = hhi;
             while (1) {
                 psphere_to_U2(p0, p1, p2, y);
+                P4IntStats::useChart(P4Charts::chart_U2);
                 rk78(eval_U2_vec_field, y, &hhi0, h_min, h_max,
                      gVFResults.config_tolerance_);
                 if (y[1] >= 0 || !vfResultsK->singinf_) {
@@ -312,6 +322,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                         break;
                 }
                 h_min = gVFResults.config_branchhmi_;
+                P4IntStats::count(P4IntCounter::halvings);
                 h_max /= 2;
                 hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                 if (fabs(hhi0) < h_min ||
@@ -345,6 +356,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                 psphere_to_V2(p0, p1, p2, y);
                 // TODO: comprovar tots els rk78 pq hhi0 era hhi al codi
                 // original pero sembla que hauria de ferse servir hhi0
+                P4IntStats::useChart(P4Charts::chart_V2);
                 rk78(eval_V2_vec_field, y, &hhi0, h_min, h_max,
                      gVFResults.config_tolerance_);
                 if (y[1] >= 0 || !vfResultsK->singinf_) {
@@ -355,6 +367,7 @@ void integrate_poincare_sep(double p0, double p1, double p2, double *pcoord,
                         break;
                 }
                 h_min = gVFResults.config_branchhmi_;
+                P4IntStats::count(P4IntCounter::halvings);
                 h_max /= 2;
                 hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
                 if (fabs(hhi0) < h_min ||
@@ -404,11 +417,13 @@ void integrate_lyapunov_sep(double p0, double p1, double p2, double *pcoord,
             dir = 1;
             y[0] = p1;
             y[1] = p2;
+            P4IntStats::useChart(P4Charts::chart_R2);
             rk78(eval_r_vec_field, y, &hhi0, h_min, h_max,
                  gVFResults.config_tolerance_);
             if (gThisVF->getVFIndex_R2(y) == gVFResults.K_)
                 break;
             h_min = gVFResults.config_branchhmi_;
+            P4IntStats::count(P4IntCounter::halvings);
             h_max /= 2;
             hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
             if (fabs(hhi0) < h_min || h_max < gVFResults.config_branchhmi_) {
@@ -428,6 +443,7 @@ void integrate_lyapunov_sep(double p0, double p1, double p2, double *pcoord,
             dir = 1;
             y[0] = p1;
             y[1] = p2;
+            P4IntStats::useChart(P4IntStats::chart_cylinder);
             rk78(eval_vec_field_cyl, y, &hhi0, h_min, h_max,
                  gVFResults.config_tolerance_);
             if (y[1] >= TWOPI)
@@ -435,6 +451,7 @@ void integrate_lyapunov_sep(double p0, double p1, double p2, double *pcoord,
             if (gThisVF->getVFIndex_cyl(y) == gVFResults.K_)
                 break;
             h_min = gVFResults.config_branchhmi_;
+            P4IntStats::count(P4IntCounter::halvings);
             h_max /= 2;
             hhi0 = fabs(hhi0 * hhi) / 2 / hhi;
             if (fabs(hhi0) < h_min || h_max < gVFResults.config_branchhmi_) {
@@ -458,7 +475,7 @@ void integrate_lyapunov_sep(double p0, double p1, double p2, double *pcoord,
 // result is valid before operating on it.
 //
 // The vector field vfK need not be prepared
-P4Orbits::orbits_points *integrate_sep(P4Sphere *spherewnd, double pcoord[3],
+P4Orbits::orbits_points *integrate_sep(P4Canvas *spherewnd, double pcoord[3],
                                        double step, int dir, int type,
                                        int points_to_int,
                                        P4Orbits::orbits_points **orbit)
@@ -484,6 +501,7 @@ P4Orbits::orbits_points *integrate_sep(P4Sphere *spherewnd, double pcoord[3],
     else
         hhi = static_cast<double>(dir) * step;
 
+    P4IntStats::startCurve();
     copy_x_into_y(pcoord, pcoord2);
     for (i = 1; i <= points_to_int; ++i) {
         MATHFUNC(integrate_sphere_sep)
@@ -611,7 +629,7 @@ static double findInitialSepPoint(P4Polynom::term1 *sep, double epsilon,
 //
 // The vector field vfK needs not be prepared.
 P4Orbits::orbits_points *
-plot_separatrice(P4Sphere *spherewnd, double x0, double y0, double a11,
+plot_separatrice(P4Canvas *spherewnd, double x0, double y0, double a11,
                  double a12, double a21, double a22, double epsilon,
                  const P4Blowup::sep *sep1, P4Orbits::orbits_points **orbit,
                  short int chart, int vfindex)
@@ -891,7 +909,7 @@ plot_separatrice(P4Sphere *spherewnd, double x0, double y0, double a11,
 // ---------------------------------------------------------------------------
 // Plots all separatrices.  If the separatrix plotting has not started yet,
 // it will be started; otherwhise it will be continued.
-void plot_all_sep(P4Sphere *spherewnd)
+void plot_all_sep(P4Canvas *spherewnd)
 {
     if (!gVFResults.vf_.empty()) {
         for (unsigned int i = 0; i < gThisVF->numVF_; i++) {
@@ -909,17 +927,20 @@ void plot_all_sep(P4Sphere *spherewnd)
 // Does the plotting of a separatrix that was previously calculated.
 // The separatrix is plotted in the color according to the type and
 // stability.
-void draw_sep(P4Sphere *spherewnd, P4Orbits::orbits_points *sep)
+void draw_sep(P4Canvas *spherewnd, P4Orbits::orbits_points *sep)
 {
     double pcoord[3];
 
-    while (sep != nullptr) {
-        if (sep->dashes)
-            (*plot_l)(spherewnd, sep->pcoord, pcoord, sep->color);
+    if (drawRefinedCurve(spherewnd, nullptr, sep, -1))
+        return;
+
+    P4CurveReader r{sep, drawsAllPoints()};
+    for (auto p = r.next(); p != nullptr; p = r.next()) {
+        if (p->dashes)
+            (*plot_l)(spherewnd, p->pcoord, pcoord, p->color);
         else
-            (*plot_p)(spherewnd, sep->pcoord, sep->color);
-        copy_x_into_y(sep->pcoord, pcoord);
-        sep = sep->nextpt;
+            (*plot_p)(spherewnd, p->pcoord, p->color);
+        copy_x_into_y(p->pcoord, pcoord);
     }
 }
 
@@ -928,17 +949,17 @@ void draw_sep(P4Sphere *spherewnd, P4Orbits::orbits_points *sep)
 // ---------------------------------------------------------------------------
 // Does the plotting of a separatrix that was previously calculated.
 // The separatrix is plotted in a specified color.
-void draw_selected_sep(P4Sphere *spherewnd, P4Orbits::orbits_points *sep,
+void draw_selected_sep(P4Canvas *spherewnd, P4Orbits::orbits_points *sep,
                        int color)
 {
     double pcoord[3];
 
-    while (sep != nullptr) {
-        if (sep->dashes)
-            (*plot_l)(spherewnd, sep->pcoord, pcoord, color);
+    P4CurveReader r{sep, drawsAllPoints()};
+    for (auto p = r.next(); p != nullptr; p = r.next()) {
+        if (p->dashes)
+            (*plot_l)(spherewnd, p->pcoord, pcoord, color);
         else
-            (*plot_p)(spherewnd, sep->pcoord, color);
-        copy_x_into_y(sep->pcoord, pcoord);
-        sep = sep->nextpt;
+            (*plot_p)(spherewnd, p->pcoord, color);
+        copy_x_into_y(p->pcoord, pcoord);
     }
 }
@@ -21,7 +21,7 @@
 
 #include <vector>
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Polynom
 {
@@ -39,16 +39,16 @@ namespace P4Blowup
 struct sep;
 }
 
-extern void (*change_epsilon)(P4Sphere *, double);
-extern void (*start_plot_sep)(P4Sphere *, int);
-extern void (*cont_plot_sep)(P4Sphere *);
-extern void (*plot_next_sep)(P4Sphere *, int);
-extern void (*select_next_sep)(P4Sphere *);
+extern void (*change_epsilon)(P4Canvas *, double);
+extern void (*start_plot_sep)(P4Canvas *, int);
+extern void (*cont_plot_sep)(P4Canvas *);
+extern void (*plot_next_sep)(P4Canvas *, int);
+extern void (*select_next_sep)(P4Canvas *);
 
-void plot_all_sep(P4Sphere *spherewnd);
-void draw_sep(P4Sphere *spherewnd,
+void plot_all_sep(P4Canvas *spherewnd);
+void draw_sep(P4Canvas *spherewnd,
               P4Orbits::orbits_points *sep);
-void draw_selected_sep(P4Sphere *spherewnd,
+void draw_selected_sep(P4Canvas *spherewnd,
                        P4Orbits::orbits_points *sep,
                        int color);
 
@@ -64,13 +64,13 @@ void integrate_lyapunov_sep(double p0, double p1, double p2, double *pcoord,
                             double &hhi, int &type, int &color, int &dashes,
                             int &dir, double h_min, double h_max);
 
-P4Orbits::orbits_points *integrate_sep(P4Sphere *spherewnd,
+P4Orbits::orbits_points *integrate_sep(P4Canvas *spherewnd,
                                                    double pcoord[3],
                                                    double step, int dir,
                                                    int type, int points_to_int, P4Orbits::orbits_points **orbit);
 
 int change_type(int type);
 
-P4Orbits::orbits_points *plot_separatrice(P4Sphere *spherewnd, double x0, double y0, double a11,
+P4Orbits::orbits_points *plot_separatrice(P4Canvas *spherewnd, double x0, double y0, double a11,
                  double a12, double a21, double a22, double epsilon,
                  const P4Blowup::sep *sep1, P4Orbits::orbits_points **orbit, short int chart, int index);
@@ -20,6 +20,7 @@
 #include "math_sesep.hpp"
 
 #include "P4ParentStudy.hpp"
+#include "P4TrajectoryStore.hpp"
 #include "math_charts.hpp"
 #include "math_regions.hpp"
 #include "math_separatrice.hpp"
@@ -27,13 +28,15 @@
 // ---------------------------------------------------------------------------
 //          start_plot_se_sep
 // ---------------------------------------------------------------------------
-void start_plot_se_sep(P4Sphere *spherewnd, int vfindex)
+void start_plot_se_sep(P4Canvas *spherewnd, int vfindex)
 {
     double p[3];
-    auto points = gVFResults.selectedSep_->last_sep_point;
 
     draw_sep(spherewnd, gVFResults.selectedSep_->first_sep_point);
 
+    // drawing may have read the points back, see P4TrajectoryStore
+    auto points = gVFResults.selectedSep_->last_sep_point;
+
     if (points != nullptr) {
         copy_x_into_y(points->pcoord, p);
         gVFResults.selectedSep_->last_sep_point->nextpt =
@@ -51,6 +54,7 @@ void start_plot_se_sep(P4Sphere *spherewnd, int vfindex)
             &points, gVFResults.selectedSePoint_->chart, vfindex);
     }
     gVFResults.selectedSep_->last_sep_point = points;
+    P4TrajectoryStore::grown(&gVFResults.selectedSep_->first_sep_point);
 }
 
 // ---------------------------------------------------------------------------
@@ -58,7 +62,7 @@ void start_plot_se_sep(P4Sphere *spherewnd, int vfindex)
 // ---------------------------------------------------------------------------
 // Continuation of the plot is done via the standard integrate_sep method,
 // and no longer depends on the type of the singularity.
-void cont_plot_se_sep(P4Sphere *spherewnd)
+void cont_plot_se_sep(P4Canvas *spherewnd)
 {
     double p[3];
     auto points = gVFResults.selectedSep_->last_sep_point;
@@ -73,12 +77,13 @@ void cont_plot_se_sep(P4Sphere *spherewnd)
                       gVFResults.config_intpoints_, &points);
 
     gVFResults.selectedSep_->last_sep_point = points;
+    P4TrajectoryStore::grown(&gVFResults.selectedSep_->first_sep_point);
 }
 
 // ---------------------------------------------------------------------------
 //          plot_next_se_sep
 // ---------------------------------------------------------------------------
-void plot_next_se_sep(P4Sphere *spherewnd, int vfindex)
+void plot_next_se_sep(P4Canvas *spherewnd, int vfindex)
 {
     draw_sep(spherewnd, gVFResults.selectedSep_->first_sep_point);
 
@@ -92,7 +97,7 @@ void plot_next_se_sep(P4Sphere *spherewnd, int vfindex)
 // ---------------------------------------------------------------------------
 //          select_next_se_sep
 // ---------------------------------------------------------------------------
-void select_next_se_sep(P4Sphere *spherewnd)
+void select_next_se_sep(P4Canvas *spherewnd)
 {
     draw_sep(spherewnd, gVFResults.selectedSep_->first_sep_point);
 
@@ -107,7 +112,7 @@ void select_next_se_sep(P4Sphere *spherewnd)
 // ---------------------------------------------------------------------------
 //          plot_all_se_sep
 // ---------------------------------------------------------------------------
-void plot_all_se_sep(P4Sphere *spherewnd, int vfindex,
+void plot_all_se_sep(P4Canvas *spherewnd, int vfindex,
                      P4Singularities::semi_elementary *point)
 {
     double p[3];
@@ -135,6 +140,7 @@ void plot_all_se_sep(P4Sphere *spherewnd, int vfindex,
                         point->chart, vfindex);
                 }
                 sep1->last_sep_point = points;
+                P4TrajectoryStore::grown(&sep1->first_sep_point);
                 sep1 = sep1->next_sep;
             }
         }
@@ -145,7 +151,7 @@ void plot_all_se_sep(P4Sphere *spherewnd, int vfindex,
 // ---------------------------------------------------------------------------
 //          change_epsilon_se
 // ---------------------------------------------------------------------------
-void change_epsilon_se(P4Sphere *spherewnd, double epsilon)
+void change_epsilon_se(P4Canvas *spherewnd, double epsilon)
 {
     auto separatrice = gVFResults.selectedSePoint_->separatrices;
 
@@ -154,6 +160,7 @@ void change_epsilon_se(P4Sphere *spherewnd, double epsilon)
     while (separatrice != nullptr) {
         draw_selected_sep(spherewnd, separatrice->first_sep_point,
                           P4ColourSettings::colour_background);
+        P4TrajectoryStore::forget(&separatrice->first_sep_point);
         delete separatrice->first_sep_point;
         separatrice->first_sep_point = nullptr;
         separatrice->last_sep_point = nullptr;
@@ -21,17 +21,17 @@
 
 #include <vector>
 
-class P4Sphere;
+class P4Canvas;
 
 namespace P4Singularities
 {
 struct semi_elementary;
 }
 
-void start_plot_se_sep(P4Sphere *, int);
-void cont_plot_se_sep(P4Sphere *);
-void plot_next_se_sep(P4Sphere *, int);
-void select_next_se_sep(P4Sphere *);
-void change_epsilon_se(P4Sphere *, double);
-void plot_all_se_sep(P4Sphere *, int,
+void start_plot_se_sep(P4Canvas *, int);
+void cont_plot_se_sep(P4Canvas *);
+void plot_next_se_sep(P4Canvas *, int);
+void select_next_se_sep(P4Canvas *);
+void change_epsilon_se(P4Canvas *, double);
+void plot_all_se_sep(P4Canvas *, int,
                      P4Singularities::semi_elementary *);
@@ -0,0 +1,627 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "math_streamlines.hpp"
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "P4Canvas.hpp"
+#include "P4ParentStudy.hpp"
+#include "P4Trace.hpp"
+#include "P4TrajectoryStore.hpp"
+#include "P4VFStudy.hpp"
+#include "custom.hpp"
+#include "math_charts.hpp"
+#include "math_orbits.hpp"
+#include "math_polynom.hpp"
+#include "structures.hpp"
+
+// The orbits are placed as evenly spaced streamlines (Jobard and Lefer): new
+// orbits start at the separation distance from the ones placed before, and
+// are stopped when they come nearer than half of it to another orbit.
+// Seeds are integrated in batches on all threads, each against the orbits
+// placed before the batch.  The results are then accepted one by one, and
+// cut where they come near an orbit accepted earlier in the same batch.
+
+// distances, relative to the separation
+#define STREAMLINE_TESTRATIO 0.5 // an orbit stops this near to another one
+#define STREAMLINE_SEEDRATIO 0.9 // a seed is at least this far from orbits
+#define STREAMLINE_MINLENGTH 1.0 // shorter orbits are dropped
+#define STREAMLINE_SELFARC 2.0   // an orbit only meets itself after this
+
+#define STREAMLINE_MAXORBITS 2000
+#define STREAMLINE_MAXPOINTS 20000 // in each time direction
+// an orbit that has moved less than a pixel in this number of steps has
+// come to a singular point
+#define STREAMLINE_STALLSTEPS 100
+
+// The window of the sphere, taken once, so that the threads do not need the
+// sphere itself.  Positions are measured in pixels from the corner (x0,y0).
+struct p4streamwindow {
+    double x0, y0, x1, y1;
+    double sx, sy; // pixels per unit of view coordinates
+    double w, h;
+    void (*toView)(double, double, double, double *);
+
+    // false if pcoord is not visible in the window
+    bool toPixel(const double *pcoord, double *q) const
+    {
+        double ucoord[2];
+
+        toView(pcoord[0], pcoord[1], pcoord[2], ucoord);
+        if (ucoord[0] < x0 || ucoord[0] > x1 || ucoord[1] < y0 ||
+            ucoord[1] > y1)
+            return false;
+        q[0] = (ucoord[0] - x0) * sx;
+        q[1] = (ucoord[1] - y0) * sy;
+        return true;
+    }
+};
+
+// The integration parameters and routines, taken once as well: the GUI
+// thread may change those of gVFResults while the orbits are placed.
+struct p4streamparams {
+    double step, hmin, hmax;
+    bool dashes;
+    bool original; // the original vector field, not the reduced one
+    void (*integrate)(double, double, double, double *, double &, int &,
+                      int &, double, double);
+    void (*toR2)(double, double, double, double *);
+    bool (*isValid)(double, double, double *);
+};
+
+struct p4streampoint {
+    double pcoord[3];
+    double q[2]; // position in pixels
+    double arc;  // arc length from the seed in pixels, negative backwards
+    int dashes;
+    int dir;
+};
+
+struct p4streamseed {
+    double q[2];
+    double pcoord[3];
+    int dir; // forward time direction, reversed where the gcf is negative
+    int line;
+    bool valid;
+    std::vector<p4streampoint> half[2]; // forwards and backwards
+};
+
+// -----------------------------------------------------------------------
+//                      OCCUPANCY GRID
+// -----------------------------------------------------------------------
+
+// Points of the orbits, hashed in square cells of the window.  Each point
+// is stored with its orbit and its arc length along it.
+class P4OccupancyGrid
+{
+  public:
+    P4OccupancyGrid(const p4streamwindow &win, double cellsize)
+        : cell_{cellsize}
+    {
+        nx_ = std::max(1, static_cast<int>(std::ceil(win.w / cell_)));
+        ny_ = std::max(1, static_cast<int>(std::ceil(win.h / cell_)));
+        cells_.resize(nx_ * ny_);
+    }
+
+    void add(const double *q, int line, double arc)
+    {
+        cells_[cellY(q[1]) * nx_ + cellX(q[0])].push_back(
+            {q[0], q[1], arc, line});
+    }
+
+    // Is there a point within distance d of q, on another orbit than line,
+    // or on the same orbit but further than minarc away along it?  Pass
+    // line = -1 to look at all orbits.
+    bool isNear(const double *q, double d, int line, double arc,
+                double minarc) const
+    {
+        int i1{cellX(q[0] - d)}, i2{cellX(q[0] + d)};
+        int j1{cellY(q[1] - d)}, j2{cellY(q[1] + d)};
+
+        for (int j = j1; j <= j2; j++) {
+            for (int i = i1; i <= i2; i++) {
+                for (auto const &e : cells_[j * nx_ + i]) {
+                    if (e.line == line && std::fabs(e.arc - arc) <= minarc)
+                        continue;
+                    if (std::hypot(e.x - q[0], e.y - q[1]) < d)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+  private:
+    struct entry {
+        double x, y, arc;
+        int line;
+    };
+
+    double cell_;
+    int nx_, ny_;
+    std::vector<std::vector<entry>> cells_;
+
+    int cellX(double x) const
+    {
+        return std::max(0, std::min(nx_ - 1, static_cast<int>(x / cell_)));
+    }
+    int cellY(double y) const
+    {
+        return std::max(0, std::min(ny_ - 1, static_cast<int>(y / cell_)));
+    }
+};
+
+// Calls f for points at most step pixels apart on the segment from p to q,
+// with the fraction of the segment covered; q itself comes last.  Stops as
+// soon as f returns false.
+template <typename FUNC>
+static bool alongSegment(const double *p, const double *q, double step,
+                         FUNC f)
+{
+    double len{std::hypot(q[0] - p[0], q[1] - p[1])};
+    int n{std::max(1, static_cast<int>(std::ceil(len / step)))};
+    double r[2];
+
+    for (int i = 1; i <= n; i++) {
+        r[0] = p[0] + (q[0] - p[0]) * i / n;
+        r[1] = p[1] + (q[1] - p[1]) * i / n;
+        if (!f(r, static_cast<double>(i) / n))
+            return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------
+//                      INTEGRATION
+// -----------------------------------------------------------------------
+
+// Integrates one half of the orbit through the seed, the same way as
+// integrate_orbit, until it leaves the window, comes near another orbit or
+// itself, or stops at a singular point.  Gives up when cancel is set.
+static void integrateHalf(const p4streamwindow &win,
+                          const p4streamparams &par,
+                          const P4OccupancyGrid &others, P4OccupancyGrid &own,
+                          p4streamseed &s, int half, double dsep,
+                          const std::atomic<bool> *cancel)
+{
+    std::vector<p4streampoint> &pts{s.half[half]};
+    int dir{(half == 0) ? s.dir : -s.dir};
+    double hhi{dir * par.step};
+    double h_min{par.hmin};
+    double h_max{par.hmax};
+    double dtest{STREAMLINE_TESTRATIO * dsep};
+    double minarc{STREAMLINE_SELFARC * dsep};
+    double pcoord[3], q[2], prevq[2], arc, prevarc{0}, stallarc{0};
+    int d, dashes, i;
+
+    copy_x_into_y(s.pcoord, pcoord);
+    prevq[0] = s.q[0];
+    prevq[1] = s.q[1];
+
+    for (i = 1; i <= STREAMLINE_MAXPOINTS; i++) {
+        if (*cancel || !prepareVfForIntegration(pcoord))
+            break;
+        par.integrate(pcoord[0], pcoord[1], pcoord[2], pcoord, hhi, dashes, d,
+                      h_min, h_max);
+        if (!win.toPixel(pcoord, q))
+            break;
+
+        dashes = dashes && par.dashes;
+        arc = std::hypot(q[0] - prevq[0], q[1] - prevq[1]);
+        arc = prevarc + ((half == 0) ? arc : -arc);
+
+        // the steps may be several pixels long
+        if (!alongSegment(dashes ? prevq : q, q, dtest / 2,
+                          [&](const double *r, double t) {
+                              double a{prevarc + t * (arc - prevarc)};
+                              return !others.isNear(r, dtest, -1, 0, 0) &&
+                                     !own.isNear(r, dtest, s.line, a, minarc);
+                          }))
+            break;
+        alongSegment(dashes ? prevq : q, q, dtest / 2,
+                     [&](const double *r, double t) {
+                         own.add(r, s.line, prevarc + t * (arc - prevarc));
+                         return true;
+                     });
+
+        pts.push_back({{pcoord[0], pcoord[1], pcoord[2]},
+                       {q[0], q[1]},
+                       arc,
+                       dashes,
+                       d * (pts.empty() ? dir : pts.back().dir)});
+
+        if (i % STREAMLINE_STALLSTEPS == 0) {
+            if (std::fabs(arc - stallarc) < 1.0)
+                break;
+            stallarc = arc;
+        }
+        prevq[0] = q[0];
+        prevq[1] = q[1];
+        prevarc = arc;
+    }
+}
+
+// Runs on a worker thread.  The grid of the orbits placed before is only
+// read.
+static void integrateSeed(const p4streamwindow &win,
+                          const p4streamparams &par,
+                          const P4OccupancyGrid &others, p4streamseed &s,
+                          double dsep, const std::atomic<bool> *cancel)
+{
+    P4OccupancyGrid own{win, dsep};
+    double rcoord[2];
+
+    s.valid = false;
+    if (!prepareVfForIntegration(s.pcoord))
+        return;
+
+    s.dir = 1;
+    if (par.original) {
+        par.toR2(s.pcoord[0], s.pcoord[1], s.pcoord[2], rcoord);
+        if (eval_term2(gVFResults.vf_[gVFResults.K_]->gcf_, rcoord) < 0)
+            s.dir = -1;
+    }
+
+    own.add(s.q, s.line, 0);
+    integrateHalf(win, par, others, own, s, 0, dsep, cancel);
+    integrateHalf(win, par, others, own, s, 1, dsep, cancel);
+    s.valid = true;
+}
+
+// -----------------------------------------------------------------------
+//                      ACCEPTING ORBITS
+// -----------------------------------------------------------------------
+
+// Cuts the half orbit where it comes near an orbit in the grid.
+static void cutHalf(const P4OccupancyGrid &grid,
+                    std::vector<p4streampoint> &pts, const double *seedq,
+                    double dtest)
+{
+    const double *prevq{seedq};
+
+    for (auto it = pts.begin(); it != pts.end(); ++it) {
+        if (!alongSegment(it->dashes ? prevq : it->q, it->q, dtest / 2,
+                          [&](const double *r, double) {
+                              return !grid.isNear(r, dtest, -1, 0, 0);
+                          })) {
+            pts.erase(it, pts.end());
+            return;
+        }
+        prevq = it->q;
+    }
+}
+
+static void addHalf(P4OccupancyGrid &grid,
+                    const std::vector<p4streampoint> &pts, const double *seedq,
+                    int line, double dtest)
+{
+    const double *prevq{seedq};
+    double prevarc{0};
+
+    for (auto const &p : pts) {
+        alongSegment(p.dashes ? prevq : p.q, p.q, dtest / 2,
+                     [&](const double *r, double t) {
+                         grid.add(r, line, prevarc + t * (p.arc - prevarc));
+                         return true;
+                     });
+        prevq = p.q;
+        prevarc = p.arc;
+    }
+}
+
+// New seeds on both sides of the orbit, every dsep along it.
+static void addSeeds(std::deque<std::array<double, 2>> &seeds,
+                     const std::vector<p4streampoint> &pts, const double *seedq,
+                     double dsep)
+{
+    const double *prevq{seedq};
+    double next{0}, t[2], len;
+
+    for (auto const &p : pts) {
+        if (p.dashes && std::fabs(p.arc) >= next) {
+            t[0] = p.q[0] - prevq[0];
+            t[1] = p.q[1] - prevq[1];
+            len = std::hypot(t[0], t[1]);
+            if (len > 0) {
+                seeds.push_back({p.q[0] - dsep * t[1] / len,
+                                 p.q[1] + dsep * t[0] / len});
+                seeds.push_back({p.q[0] + dsep * t[1] / len,
+                                 p.q[1] - dsep * t[0] / len});
+                next = std::fabs(p.arc) + dsep;
+            }
+        }
+        prevq = p.q;
+    }
+}
+
+static P4Orbits::orbits *makeOrbit(p4streamseed &s)
+{
+    int color{P4ColourSettings::colour_orbit};
+    auto orbit = new P4Orbits::orbits{s.pcoord, color};
+    P4Orbits::orbits_points *last{nullptr};
+
+    auto append = [&](P4Orbits::orbits_points *p) {
+        if (last == nullptr)
+            orbit->firstpt = p;
+        else
+            last->nextpt = p;
+        last = p;
+    };
+
+    for (auto &p : s.half[0])
+        append(new P4Orbits::orbits_points{p.pcoord, color, p.dashes, p.dir});
+    if (!s.half[1].empty()) {
+        // as in integrateOrbit, the backward part starts with a jump back
+        append(new P4Orbits::orbits_points{s.pcoord, color, 0, -s.dir});
+        for (auto &p : s.half[1])
+            append(new P4Orbits::orbits_points{p.pcoord, color, p.dashes,
+                                               p.dir});
+    }
+    orbit->currentpt = last;
+    P4TrajectoryStore::grown(&orbit->firstpt);
+    return orbit;
+}
+
+// -----------------------------------------------------------------------
+//                      AUTOFILLORBITS
+// -----------------------------------------------------------------------
+
+// The fills that are running.  A fill only runs for the vector fields it
+// was made for: stopping the fills starts a new generation.
+static std::mutex sFillMutex;
+static int sFillRunning{0};
+static std::atomic<unsigned long> sFillGeneration{0};
+static std::condition_variable sFillDone;
+
+void stopAutoFill()
+{
+    std::unique_lock<std::mutex> lock{sFillMutex};
+    sFillGeneration++;
+    sFillDone.wait(lock, [] { return sFillRunning == 0; });
+}
+
+struct P4AutoFill::data {
+    p4streamwindow win;
+    p4streamparams par;
+    double dsep;
+    P4OccupancyGrid grid;
+    std::deque<std::array<double, 2>> seeds;
+    int numlines, lattice, nlx, nly;
+    unsigned long generation;
+    std::vector<p4streamseed> placed;
+};
+
+P4AutoFill::P4AutoFill(const P4Canvas *sphere, double separation)
+{
+    p4streamwindow win{sphere->x0_,
+                       sphere->y0_,
+                       sphere->x1_,
+                       sphere->y1_,
+                       (sphere->w_ - 1) / sphere->dx_,
+                       (sphere->h_ - 1) / sphere->dy_,
+                       static_cast<double>(sphere->w_),
+                       static_cast<double>(sphere->h_),
+                       gVFResults.sphere_to_viewcoord};
+    p4streamparams par{gVFResults.config_step_,
+                       gVFResults.config_hmi_,
+                       gVFResults.config_hma_,
+                       gVFResults.config_dashes_,
+                       gVFResults.config_kindvf_ == INTCONFIG_ORIGINAL,
+                       gVFResults.integrate_sphere_orbit,
+                       gVFResults.sphere_to_R2,
+                       gVFResults.is_valid_viewcoord};
+    double dsep{separation};
+    double dtest{STREAMLINE_TESTRATIO * dsep};
+    double q[2];
+
+    d_.reset(new data{win, par, dsep, P4OccupancyGrid{win, dsep}, {}, 0, 0,
+                      0, 0, sFillGeneration, {}});
+    P4OccupancyGrid &grid{d_->grid};
+    int &numlines{d_->numlines};
+
+    // the orbits that are already there
+    for (auto o = gVFResults.firstOrbit_; o != nullptr; o = o->next) {
+        double prevq[2];
+        bool visible{win.toPixel(o->pcoord, prevq)};
+        if (visible)
+            grid.add(prevq, numlines, 0);
+        P4CurveReader r{o->firstpt, true};
+        for (auto p = r.next(); p != nullptr; p = r.next()) {
+            if (!win.toPixel(p->pcoord, q)) {
+                visible = false;
+                continue;
+            }
+            alongSegment((p->dashes && visible) ? prevq : q, q, dtest / 2,
+                         [&](const double *r, double) {
+                             grid.add(r, numlines, 0);
+                             return true;
+                         });
+            prevq[0] = q[0];
+            prevq[1] = q[1];
+            visible = true;
+        }
+        numlines++;
+    }
+
+    // seeds from the queue, or else from a lattice over the window
+    d_->nlx = std::max(1, static_cast<int>(win.w / dsep));
+    d_->nly = std::max(1, static_cast<int>(win.h / dsep));
+    d_->seeds.push_back({win.w / 2, win.h / 2});
+}
+
+P4AutoFill::~P4AutoFill() = default;
+
+bool P4AutoFill::run(const std::atomic<bool> *cancel)
+{
+    const p4streamwindow &win{d_->win};
+    const p4streamparams &par{d_->par};
+    double dsep{d_->dsep};
+    double dtest{STREAMLINE_TESTRATIO * dsep};
+    P4OccupancyGrid &grid{d_->grid};
+    std::deque<std::array<double, 2>> &seeds{d_->seeds};
+    std::vector<p4streamseed> batch;
+    int &numlines{d_->numlines};
+    int &lattice{d_->lattice};
+    int nlx{d_->nlx}, nly{d_->nly};
+    double q[2], u[2], pcoord[3];
+    std::atomic<bool> never{false};
+    bool done{true};
+
+    if (cancel == nullptr)
+        cancel = &never;
+
+    {
+        std::lock_guard<std::mutex> lock{sFillMutex};
+        if (sFillGeneration != d_->generation)
+            return false;
+        sFillRunning++;
+    }
+
+    while (d_->placed.size() < STREAMLINE_MAXORBITS) {
+        if (*cancel || sFillGeneration != d_->generation) {
+            done = false;
+            break;
+        }
+
+        batch.clear();
+        while (static_cast<int>(batch.size()) <
+               std::max(1, QThread::idealThreadCount())) {
+            if (!seeds.empty()) {
+                q[0] = seeds.front()[0];
+                q[1] = seeds.front()[1];
+                seeds.pop_front();
+            } else if (lattice < nlx * nly) {
+                q[0] = (lattice % nlx + 0.5) * win.w / nlx;
+                q[1] = (lattice / nlx + 0.5) * win.h / nly;
+                lattice++;
+            } else {
+                break;
+            }
+
+            if (q[0] < 0 || q[0] > win.w - 1 || q[1] < 0 || q[1] > win.h - 1)
+                continue;
+            if (grid.isNear(q, STREAMLINE_SEEDRATIO * dsep, -1, 0, 0))
+                continue;
+            if (std::any_of(batch.begin(), batch.end(),
+                            [&](const p4streamseed &s) {
+                                return std::hypot(s.q[0] - q[0],
+                                                  s.q[1] - q[1]) < dsep;
+                            }))
+                continue;
+            u[0] = win.x0 + q[0] / win.sx;
+            u[1] = win.y0 + q[1] / win.sy;
+            if (!par.isValid(u[0], u[1], pcoord))
+                continue;
+
+            batch.push_back(p4streamseed{});
+            auto &s = batch.back();
+            s.q[0] = q[0];
+            s.q[1] = q[1];
+            copy_x_into_y(pcoord, s.pcoord);
+            s.line = numlines + static_cast<int>(batch.size()) - 1;
+        }
+        if (batch.empty())
+            break;
+
+        // on a worker thread of the pool, which takes part in the map
+        QtConcurrent::blockingMap(batch, [&](p4streamseed &s) {
+            P4TraceSpan span{"streamline", "curves", "line", s.line};
+            integrateSeed(win, par, grid, s, dsep, cancel);
+        });
+        if (*cancel) {
+            done = false;
+            break;
+        }
+
+        for (auto &s : batch) {
+            if (!s.valid || grid.isNear(s.q, dtest, -1, 0, 0))
+                continue;
+            cutHalf(grid, s.half[0], s.q, dtest);
+            cutHalf(grid, s.half[1], s.q, dtest);
+
+            double len{(s.half[0].empty() ? 0 : s.half[0].back().arc) -
+                       (s.half[1].empty() ? 0 : s.half[1].back().arc)};
+            if (len < STREAMLINE_MINLENGTH * dsep)
+                continue;
+
+            s.line = numlines++;
+            grid.add(s.q, s.line, 0);
+            addHalf(grid, s.half[0], s.q, s.line, dtest);
+            addHalf(grid, s.half[1], s.q, s.line, dtest);
+            addSeeds(seeds, s.half[0], s.q, dsep);
+            addSeeds(seeds, s.half[1], s.q, dsep);
+
+            d_->placed.push_back(std::move(s));
+            if (d_->placed.size() == STREAMLINE_MAXORBITS)
+                break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{sFillMutex};
+        sFillRunning--;
+    }
+    sFillDone.notify_all();
+    return done;
+}
+
+int P4AutoFill::addOrbits(P4Canvas *sphere)
+{
+    P4Orbits::orbits *lastorbit{gVFResults.firstOrbit_};
+    int added{0};
+
+    // orbits may have been added or deleted in the mean time
+    while (lastorbit != nullptr && lastorbit->next != nullptr)
+        lastorbit = lastorbit->next;
+
+    for (auto &s : d_->placed) {
+        auto orbit = makeOrbit(s);
+        if (lastorbit == nullptr)
+            gVFResults.firstOrbit_ = orbit;
+        else
+            lastorbit->next = orbit;
+        lastorbit = orbit;
+        gVFResults.currentOrbit_ = orbit;
+        added++;
+    }
+    d_->placed.clear();
+
+    if (added > 0)
+        sphere->refreshLayer(P4SphereLayers::layer_orbits);
+    return added;
+}
+
+int autoFillOrbits(P4Canvas *sphere, double separation)
+{
+    P4AutoFill fill{sphere, separation};
+
+    if (!fill.run(nullptr))
+        return 0;
+    return fill.addOrbits(sphere);
+}
@@ -0,0 +1,54 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+class P4Canvas;
+
+// Fills the window of the sphere with orbits that are evenly spaced,
+// separation pixels apart, next to the orbits that are already there.
+// Returns the number of orbits that were added.
+int autoFillOrbits(P4Canvas *sphere, double separation);
+
+// The same in three steps, so that the orbits can be placed off the GUI
+// thread (see P4OrbitsDlg::onBtnAutoFill).  The constructor takes the
+// window of the sphere, the integration parameters and the orbits that are
+// already there, on the GUI thread.  run places the new orbits on a worker
+// thread, and returns false as soon as cancel is set.  addOrbits adds them
+// to gVFResults, on the GUI thread again, and returns their number.
+class P4AutoFill
+{
+  public:
+    P4AutoFill(const P4Canvas *sphere, double separation);
+    ~P4AutoFill();
+
+    bool run(const std::atomic<bool> *cancel);
+    int addOrbits(P4Canvas *sphere);
+
+  private:
+    struct data;
+    std::unique_ptr<data> d_;
+};
+
+// Stops the fills that are running, and waits for them, before the vector
+// fields that they integrate are replaced.  They do not run anymore.
+void stopAutoFill();
@@ -0,0 +1,34 @@
+#  This file is part of P4
+# 
+#  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier,
+#                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+# 
+#  P4 is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU Lesser General Public License as published
+#  by the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+# 
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Lesser General Public License for more details.
+# 
+#  You should have received a copy of the GNU Lesser General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Links a program against the static p4core library (see
+# ../p4core/p4core.pro): everything of p4 but its windows.  It is built first
+# by src-gui.pro.
+
+QT += gui
+QT += concurrent
+
+INCLUDEPATH += $$PWD
+
+LIBS += -L$$BUILD_DIR/p4core -lp4core
+
+win32-msvc*: PRE_TARGETDEPS += $$BUILD_DIR/p4core/p4core.lib
+else: PRE_TARGETDEPS += $$BUILD_DIR/p4core/libp4core.a
+
+# zlib compresses the PNG and TIFF images, see P4BandImageWriter
+LIBS += -lz
@@ -36,6 +36,10 @@
     Temporary path
     Maple Exe
     Reduce Exe
+    Trace file
+    Compress sessions
+    Certify lyapunov constants
+    Memory budget
 */
 
 static QString sSettingsMathManipulator;
@@ -43,6 +47,10 @@ static QString sSettingsP4Path;
 static QString sSettingsSumtablePath;
 static QString sSettingsTempPath;
 static QString sSettingsMapleExe;
+static QString sSettingsTraceFile;
+static bool sSettingsCompressSessions;
+static bool sSettingsCertifyLyapunov;
+static int sSettingsMemoryBudget;
 // static QString sSettingsReduceExe;
 static bool sSettingsChanged;
 
@@ -50,6 +58,10 @@ QString getP4Path() { return sSettingsP4Path; }
 QString getP4TempPath() { return sSettingsTempPath; }
 QString getP4SumTablePath() { return sSettingsSumtablePath; }
 QString getMapleExe() { return sSettingsMapleExe; }
+QString getP4TraceFile() { return sSettingsTraceFile; }
+bool getCompressSessions() { return sSettingsCompressSessions; }
+bool getCertifyLyapunov() { return sSettingsCertifyLyapunov; }
+int getMemoryBudget() { return sSettingsMemoryBudget; }
 
 void setMathManipulator(QString s)
 {
@@ -91,6 +103,38 @@ void setMapleExe(QString s)
     }
 }
 
+void setP4TraceFile(QString s)
+{
+    if (sSettingsTraceFile != s) {
+        sSettingsTraceFile = s;
+        sSettingsChanged = true;
+    }
+}
+
+void setCompressSessions(bool b)
+{
+    if (sSettingsCompressSessions != b) {
+        sSettingsCompressSessions = b;
+        sSettingsChanged = true;
+    }
+}
+
+void setCertifyLyapunov(bool b)
+{
+    if (sSettingsCertifyLyapunov != b) {
+        sSettingsCertifyLyapunov = b;
+        sSettingsChanged = true;
+    }
+}
+
+void setMemoryBudget(int mb)
+{
+    if (sSettingsMemoryBudget != mb) {
+        sSettingsMemoryBudget = mb;
+        sSettingsChanged = true;
+    }
+}
+
 QString getP4MaplePath()
 {
     QString f, g;
@@ -144,6 +188,12 @@ bool readP4Settings()
         sSettingsSumtablePath = p4settings->value("/SumtablePath").toString();
         sSettingsTempPath = p4settings->value("/TempPath").toString();
         sSettingsMapleExe = p4settings->value("/MapleExe").toString();
+        sSettingsTraceFile = p4settings->value("/TraceFile").toString();
+        sSettingsCompressSessions =
+            p4settings->value("/CompressSessions", true).toBool();
+        sSettingsCertifyLyapunov =
+            p4settings->value("/CertifyLyapunov", false).toBool();
+        sSettingsMemoryBudget = p4settings->value("/MemoryBudget", 0).toInt();
         sSettingsMathManipulator = "Maple";
         if (sSettingsP4Path == "" || (sSettingsMapleExe == "")) {
             _ok = false;
@@ -158,6 +208,10 @@ bool readP4Settings()
         sSettingsSumtablePath = getDefaultP4SumTablePath();
         sSettingsTempPath = getDefaultP4TempPath();
         sSettingsMapleExe = getDefaultMapleInstallation();
+        sSettingsTraceFile = "";
+        sSettingsCompressSessions = true;
+        sSettingsCertifyLyapunov = false;
+        sSettingsMemoryBudget = 0;
         sSettingsMathManipulator = getDefaultMathManipulator();
         sSettingsChanged = true;
         return false;
@@ -178,6 +232,10 @@ void saveP4Settings()
     p4settings->setValue("/SumtablePath", getP4SumTablePath());
     p4settings->setValue("/TempPath", getP4TempPath());
     p4settings->setValue("/MapleExe", getMapleExe());
+    p4settings->setValue("/TraceFile", getP4TraceFile());
+    p4settings->setValue("/CompressSessions", getCompressSessions());
+    p4settings->setValue("/CertifyLyapunov", getCertifyLyapunov());
+    p4settings->setValue("/MemoryBudget", getMemoryBudget());
 #ifndef Q_OS_WIN
     p4settings->setValue("/Math", getMathManipulator());
 #endif
@@ -33,6 +33,23 @@ QString getP4SumTablePath(void);
 void setMapleExe(QString s);
 QString getMapleExe(void);
 
+// file of the timeline recorded by P4Trace, empty when not tracing
+void setP4TraceFile(QString s);
+QString getP4TraceFile(void);
+
+// compress the session files written when saving, see P4Session
+void setCompressSessions(bool b);
+bool getCompressSessions(void);
+// compute the lyapunov constants of every weak focus with certified signs
+// (lyapunov_mpf), instead of only those whose sign is in doubt
+void setCertifyLyapunov(bool b);
+bool getCertifyLyapunov(void);
+
+// memory for the points of orbits and separatrices, in MB, 0 for no limit;
+// see P4TrajectoryStore
+void setMemoryBudget(int mb);
+int getMemoryBudget(void);
+
 QString getP4HelpPath(void);
 QString getP4BinPath(void);
 QString getP4MaplePath(void);
@@ -21,13 +21,13 @@
 
 #include <cmath>
 
+#include "P4Canvas.hpp"
 #include "P4ParentStudy.hpp"
-#include "P4Sphere.hpp"
 #include "math_p4.hpp"
 #include "structures.hpp"
 
-void (*plot_l)(P4Sphere *, const double *, const double *, int) = nullptr;
-void (*plot_p)(P4Sphere *, const double *, int) = nullptr;
+void (*plot_l)(P4Canvas *, const double *, const double *, int) = nullptr;
+void (*plot_p)(P4Canvas *, const double *, int) = nullptr;
 
 /*
 void plotEllipse( QPainter * p, int cx, int cy, int a, int b, int color, bool
@@ -56,36 +56,36 @@ WHEN ZOOMING
 */
 
 // FIXME: com fer que ho faci per cada sphere del vector?
-void spherePlotLine(P4Sphere *sp, const double *p1, const double *p2,
+void spherePlotLine(P4Canvas *sp, const double *p1, const double *p2,
                     int color)
 {
     double ucoord1[2], ucoord2[2], ucoord3[2], ucoord4[2];
 
     if (MATHFUNC(sphere_to_viewcoordpair)(p1, p2, ucoord1, ucoord2, ucoord3,
                                           ucoord4)) {
-        for (auto const &it : sp->sM_sphereList) {
+        for (auto const &it : P4Canvas::sM_canvasList) {
             it->drawLine(ucoord1[0], ucoord1[1], ucoord2[0], ucoord2[1], color);
         }
     } else {
-        for (auto const &it : sp->sM_sphereList) {
+        for (auto const &it : P4Canvas::sM_canvasList) {
             it->drawLine(ucoord1[0], ucoord1[1], ucoord2[0], ucoord2[1], color);
             it->drawLine(ucoord3[0], ucoord3[1], ucoord4[0], ucoord4[1], color);
         }
     }
 }
 
-void spherePlotPoint(P4Sphere *sp, const double *p, int color)
+void spherePlotPoint(P4Canvas *sp, const double *p, int color)
 {
     double ucoord[2];
 
     MATHFUNC(sphere_to_viewcoord)(p[0], p[1], p[2], ucoord);
 
-    for (auto const &it : sp->sM_sphereList) {
+    for (auto const &it : P4Canvas::sM_canvasList) {
         it->drawPoint(ucoord[0], ucoord[1], color);
     }
 }
 
-void spherePrintLine(P4Sphere *sp, const double *p1, const double *p2,
+void spherePrintLine(P4Canvas *sp, const double *p1, const double *p2,
                      int color)
 {
     double ucoord1[2];
@@ -102,7 +102,7 @@ void spherePrintLine(P4Sphere *sp, const double *p1, const double *p2,
     }
 }
 
-void spherePrintPoint(P4Sphere *sp, const double *p, int color)
+void spherePrintPoint(P4Canvas *sp, const double *p, int color)
 {
     double ucoord[2];
 
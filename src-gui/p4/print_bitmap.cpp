@@ -20,10 +20,16 @@
 #include "print_bitmap.hpp"
 
 #include <QBrush>
+#include <QFile>
+#include <QImage>
 #include <QPainter>
+#include <QThread>
+#include <QtConcurrentMap>
 
+#include <algorithm>
 #include <cmath>
 
+#include "P4BandImageWriter.hpp"
 #include "P4ParentStudy.hpp"
 #include "custom.hpp"
 #include "main.hpp"
@@ -32,13 +38,14 @@
 
 static bool sP4PrintBlackWhite{true};
 
-static QPainter *sP4PrintPainter;
+// thread_local, since bands of a tiled image are printed on several threads
+static thread_local QPainter *sP4PrintPainter;
 
 static int sP4PrintLineWidth{0};
 static int sP4PrintSymbolWidth{0};
-static int sLastP4PrintX0{0};
-static int sLastP4PrintY0{0};
-static int sLastP4PrintColor{0};
+static thread_local int sLastP4PrintX0{0};
+static thread_local int sLastP4PrintY0{0};
+static thread_local int sLastP4PrintColor{0};
 
 // ----------------------------------------------------------------------------
 int printColorTable(int color)
@@ -853,6 +860,21 @@ static void p4Print_print_line(double _x0, double _y0, double _x1, double _y1,
     sP4PrintPainter->drawLine(x0, y0, x1, y1);
 }
 
+void printP4Polyline(const QVector<QPointF> &path, int color)
+{
+    color = printColorTable(color);
+    if (sP4PrintBlackWhite)
+        color = printColorTable(P4ColourSettings::colour_foreground);
+
+    QPen p{P4Colours::p4XfigColour(color),
+           static_cast<qreal>(sP4PrintLineWidth)};
+    p.setCapStyle(Qt::RoundCap);
+    p.setJoinStyle(Qt::RoundJoin);
+
+    sP4PrintPainter->setPen(p);
+    sP4PrintPainter->drawPolyline(path.constData(), path.size());
+}
+
 static void p4Print_print_point(double _x0, double _y0, int color)
 {
     if (sP4PrintBlackWhite)
@@ -957,3 +979,227 @@ void finishP4Printing()
     plot_l = spherePlotLine;
     plot_p = spherePlotPoint;
 }
+
+// ---------------------------------------------------------------------------
+//                      TILED PRINTING
+// ---------------------------------------------------------------------------
+//
+// Large bitmaps are not painted in one image.  Instead, the print commands
+// are recorded, and replayed through the functions above for one horizontal
+// band of the image at a time.  Each band is then appended to a PNG or TIFF
+// file (see P4BandImageWriter).
+
+// approximate size of the image of one band, in bytes
+#define TILEDPRINT_BANDBYTES (16 * 1024 * 1024)
+
+namespace P4PrintCommand
+{
+enum { symbol, line, point, elips };
+}
+
+struct p4printcommand {
+    int type;                       // P4PrintCommand constants
+    void (*symbol)(double, double); // for symbols
+    double x0, y0, x1, y1;          // for ellipses: center and axes
+    int color;
+    bool dotted;
+    int ellipse; // index in sP4PrintEllipses
+};
+
+struct p4printband {
+    int y0;
+    int h;
+    std::vector<int> commands; // indices in sP4PrintCommands
+    QImage image;
+};
+
+static std::vector<p4printcommand> sP4PrintCommands;
+static std::vector<std::vector<P4POLYLINES>> sP4PrintEllipses;
+static int sP4TiledWidth{0};
+static int sP4TiledHeight{0};
+
+static void recordSymbol(void (*symbol)(double, double), double x, double y)
+{
+    sP4PrintCommands.push_back(
+        {P4PrintCommand::symbol, symbol, x, y, x, y, 0, false, -1});
+}
+
+#define P4PRINT_RECORDSYMBOL(name)                                             \
+    static void record_print_##name(double x, double y)                        \
+    {                                                                          \
+        recordSymbol(p4Print_print_##name, x, y);                              \
+    }
+P4PRINT_SYMBOLS(P4PRINT_RECORDSYMBOL)
+
+static void record_print_elips(double x0, double y0, double a, double b,
+                               int color, bool dotted,
+                               const std::vector<P4POLYLINES> &ellipse)
+{
+    sP4PrintEllipses.push_back(ellipse);
+    sP4PrintCommands.push_back({P4PrintCommand::elips, nullptr, x0, y0, a, b,
+                                color, dotted,
+                                static_cast<int>(sP4PrintEllipses.size()) -
+                                    1});
+}
+
+static void record_print_line(double x0, double y0, double x1, double y1,
+                              int color)
+{
+    sP4PrintCommands.push_back(
+        {P4PrintCommand::line, nullptr, x0, y0, x1, y1, color, false, -1});
+}
+
+static void record_print_point(double x0, double y0, int color)
+{
+    sP4PrintCommands.push_back(
+        {P4PrintCommand::point, nullptr, x0, y0, x0, y0, color, false, -1});
+}
+
+// vertical extent of what a command paints, in pixels
+static void commandExtent(const p4printcommand &c, double &ymin, double &ymax)
+{
+    double margin{static_cast<double>(
+        std::max(sP4PrintLineWidth, sP4PrintSymbolWidth) + 2)};
+
+    if (c.type == P4PrintCommand::elips) {
+        ymin = ymax = c.y0;
+        for (auto const &it : sP4PrintEllipses[c.ellipse]) {
+            ymin = std::min(ymin, std::min(it.y1, it.y2));
+            ymax = std::max(ymax, std::max(it.y1, it.y2));
+        }
+    } else {
+        ymin = std::min(c.y0, c.y1);
+        ymax = std::max(c.y0, c.y1);
+    }
+    ymin -= margin;
+    ymax += margin;
+}
+
+static void printBand(p4printband &band)
+{
+    band.image = QImage{sP4TiledWidth, band.h, QImage::Format_RGB32};
+
+    QPainter p{&band.image};
+    p.translate(0, -band.y0);
+    p.fillRect(0, band.y0, sP4TiledWidth, band.h,
+               QBrush(P4Colours::p4XfigColour(
+                   printColorTable(P4ColourSettings::colour_background))));
+
+    sP4PrintPainter = &p;
+    sLastP4PrintColor = -1;
+
+    for (auto i : band.commands) {
+        auto const &c = sP4PrintCommands[i];
+        switch (c.type) {
+        case P4PrintCommand::symbol:
+            c.symbol(c.x0, c.y0);
+            break;
+        case P4PrintCommand::line:
+            p4Print_print_line(c.x0, c.y0, c.x1, c.y1, c.color);
+            break;
+        case P4PrintCommand::point:
+            p4Print_print_point(c.x0, c.y0, c.color);
+            break;
+        case P4PrintCommand::elips:
+            p4Print_print_elips(c.x0, c.y0, c.x1, c.y1, c.color, c.dotted,
+                                sP4PrintEllipses[c.ellipse]);
+            break;
+        }
+    }
+
+    p.end();
+    sP4PrintPainter = nullptr;
+    band.image = band.image.convertToFormat(QImage::Format_RGB888);
+}
+
+#define P4PRINT_SETRECORDSYMBOL(name) print_##name = record_print_##name;
+
+void prepareP4TiledPrinting(int w, int h, bool isblackwhite, int linewidth,
+                            int symbolwidth)
+{
+    sP4PrintBlackWhite = isblackwhite;
+    sP4PrintPainter = nullptr;
+    sP4PrintLineWidth = linewidth;
+    sP4PrintSymbolWidth = symbolwidth;
+    sP4TiledWidth = w;
+    sP4TiledHeight = h;
+
+    sP4PrintCommands.clear();
+    sP4PrintEllipses.clear();
+
+    plot_l = spherePrintLine;
+    plot_p = spherePrintPoint;
+
+    P4PRINT_SYMBOLS(P4PRINT_SETRECORDSYMBOL)
+
+    print_elips = record_print_elips;
+    print_point = record_print_point;
+    print_line = record_print_line;
+    print_comment = p4Print_comment;
+}
+
+bool finishP4TiledPrinting(const QString &filename, int format, double dpi,
+                           bool parallel)
+{
+    P4BandImageWriter writer;
+    std::vector<p4printband> bands;
+    int bandh, nbands, batch, i, j;
+    double ymin, ymax;
+    bool result;
+
+    finishP4Printing();
+
+    bandh = TILEDPRINT_BANDBYTES / (4 * sP4TiledWidth);
+    bandh = std::max(1, std::min(bandh, sP4TiledHeight));
+    nbands = (sP4TiledHeight + bandh - 1) / bandh;
+
+    result = writer.open(QFile::encodeName(filename).constData(), format,
+                         sP4TiledWidth, sP4TiledHeight, dpi);
+
+    // sort the commands into the bands they touch, keeping their order
+    std::vector<std::vector<int>> commands(nbands);
+    for (i = 0; result && i < static_cast<int>(sP4PrintCommands.size());
+         i++) {
+        commandExtent(sP4PrintCommands[i], ymin, ymax);
+        if (std::isnan(ymin) || std::isnan(ymax) || ymax < 0 ||
+            ymin >= sP4TiledHeight)
+            continue;
+        int b1{static_cast<int>(std::max(ymin, 0.0)) / bandh};
+        int b2{static_cast<int>(std::min(ymax, sP4TiledHeight - 1.0)) /
+               bandh};
+        for (j = b1; j <= b2; j++)
+            commands[j].push_back(i);
+    }
+
+    // only a batch of bands is held in memory at the same time
+    batch = parallel ? std::max(1, QThread::idealThreadCount()) : 1;
+    for (i = 0; result && i < nbands; i += batch) {
+        bands.clear();
+        for (j = i; j < std::min(i + batch, nbands); j++) {
+            bands.push_back(p4printband{});
+            bands.back().y0 = j * bandh;
+            bands.back().h = std::min(bandh, sP4TiledHeight - j * bandh);
+            bands.back().commands.swap(commands[j]);
+        }
+
+        if (batch > 1)
+            QtConcurrent::blockingMap(bands, printBand);
+        else
+            printBand(bands.front());
+
+        for (auto const &b : bands) {
+            result = writer.writeRows(b.image.constBits(),
+                                      b.image.bytesPerLine(), b.h);
+            if (!result)
+                break;
+        }
+    }
+
+    if (!writer.close())
+        result = false;
+
+    sP4PrintCommands.clear();
+    sP4PrintCommands.shrink_to_fit();
+    sP4PrintEllipses.clear();
+    return result;
+}
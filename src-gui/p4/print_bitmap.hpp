@@ -19,9 +19,23 @@
 
 #pragma once
 
+#include <QPointF>
+#include <QVector>
+
 class QPainter;
+class QString;
 
 int printColorTable(int color);
 void prepareP4Printing(int w, int h, bool isblackwhite, QPainter *p4paint,
                        int linewidth, int symbolwidth);
 void finishP4Printing();
+
+// paints a path of preparePathPrinting with the painter of prepareP4Printing
+void printP4Polyline(const QVector<QPointF> &path, int color);
+
+// bitmaps that are too large to hold in memory, printed in bands to a
+// P4ImageFormat file
+void prepareP4TiledPrinting(int w, int h, bool isblackwhite, int linewidth,
+                            int symbolwidth);
+bool finishP4TiledPrinting(const QString &filename, int format, double dpi,
+                           bool parallel);
@@ -0,0 +1,161 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "print_paths.hpp"
+
+#include <QString>
+
+#include <cmath>
+
+#include "P4DisplayList.hpp"
+#include "print_points.hpp"
+
+// two points closer than this (in device units) are the same
+#define PATHS_JOINDISTANCE 1e-6
+
+static void (*sEmitPath)(const QVector<QPointF> &, int){nullptr};
+static double sPathTolerance{0};
+static int sPathMaxPoints{0};
+
+static QVector<QPointF> sPath;
+static int sPathColor{-1};
+
+// -----------------------------------------------------------------------
+//                      PATH STREAM
+// -----------------------------------------------------------------------
+
+static void flushPath()
+{
+    if (sPath.size() >= 2 && sEmitPath != nullptr) {
+        simplifyPolyline(sPath, sPathTolerance);
+        sEmitPath(sPath, sPathColor);
+    }
+    sPath.clear();
+}
+
+static void paths_print_line(double x0, double y0, double x1, double y1,
+                             int color)
+{
+    if (x0 == x1 && y0 == y1)
+        return;
+
+    if (!sPath.isEmpty() && color == sPathColor &&
+        std::abs(sPath.last().x() - x0) <= PATHS_JOINDISTANCE &&
+        std::abs(sPath.last().y() - y0) <= PATHS_JOINDISTANCE) {
+        if (sPath.size() < sPathMaxPoints) {
+            sPath.append(QPointF{x1, y1});
+            return;
+        }
+        // the next piece starts where this one ends
+        flushPath();
+    } else {
+        flushPath();
+    }
+    sPathColor = color;
+    sPath.append(QPointF{x0, y0});
+    sPath.append(QPointF{x1, y1});
+}
+
+// -----------------------------------------------------------------------
+//                      WRAPPED PRIMITIVES
+// -----------------------------------------------------------------------
+
+#define PATHS_WRAPSYMBOL(name)                                                 \
+    static void (*sSaved_print_##name)(double, double){nullptr};               \
+    static void paths_print_##name(double x, double y)                         \
+    {                                                                          \
+        flushPath();                                                           \
+        if (sSaved_print_##name != nullptr)                                    \
+            sSaved_print_##name(x, y);                                         \
+    }
+P4PRINT_SYMBOLS(PATHS_WRAPSYMBOL)
+
+static void (*sSaved_print_elips)(double, double, double, double, int, bool,
+                                  const std::vector<P4POLYLINES> &){nullptr};
+static void (*sSaved_print_line)(double, double, double, double,
+                                 int){nullptr};
+static void (*sSaved_print_point)(double, double, int){nullptr};
+static void (*sSaved_print_comment)(QString){nullptr};
+
+static void paths_print_elips(double x0, double y0, double a, double b,
+                              int color, bool dotted,
+                              const std::vector<P4POLYLINES> &ellipse)
+{
+    flushPath();
+    if (sSaved_print_elips != nullptr)
+        sSaved_print_elips(x0, y0, a, b, color, dotted, ellipse);
+}
+
+static void paths_print_point(double x0, double y0, int color)
+{
+    flushPath();
+    if (sSaved_print_point != nullptr)
+        sSaved_print_point(x0, y0, color);
+}
+
+static void paths_print_comment(QString s)
+{
+    flushPath();
+    if (sSaved_print_comment != nullptr)
+        sSaved_print_comment(s);
+}
+
+// -----------------------------------------------------------------------
+//                      PREPARE/FINISH
+// -----------------------------------------------------------------------
+
+void preparePathPrinting(void (*emitpath)(const QVector<QPointF> &, int),
+                         double tolerance, int maxpoints)
+{
+    sEmitPath = emitpath;
+    sPathTolerance = tolerance;
+    sPathMaxPoints = (maxpoints < 2) ? 2 : maxpoints;
+    sPath.clear();
+    sPathColor = -1;
+
+#define PATHS_INSTALLSYMBOL(name)                                              \
+    sSaved_print_##name = print_##name;                                        \
+    print_##name = paths_print_##name;
+    P4PRINT_SYMBOLS(PATHS_INSTALLSYMBOL)
+#undef PATHS_INSTALLSYMBOL
+
+    sSaved_print_elips = print_elips;
+    sSaved_print_line = print_line;
+    sSaved_print_point = print_point;
+    sSaved_print_comment = print_comment;
+    print_elips = paths_print_elips;
+    print_line = paths_print_line;
+    print_point = paths_print_point;
+    print_comment = paths_print_comment;
+}
+
+void finishPathPrinting()
+{
+    flushPath();
+
+#define PATHS_RESTORESYMBOL(name) print_##name = sSaved_print_##name;
+    P4PRINT_SYMBOLS(PATHS_RESTORESYMBOL)
+#undef PATHS_RESTORESYMBOL
+
+    print_elips = sSaved_print_elips;
+    print_line = sSaved_print_line;
+    print_point = sSaved_print_point;
+    print_comment = sSaved_print_comment;
+    sEmitPath = nullptr;
+}
@@ -0,0 +1,38 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+// largest distance, in device units, between a simplified path and the
+// original pieces
+#define P4PRINT_PATHTOLERANCE 0.5
+
+// The vector back ends (EPS, XFig, SVG and PDF) do not write the little line
+// pieces of orbits, separatrices and curves one at a time.  In between
+// preparePathPrinting and finishPathPrinting, print_line gathers pieces that
+// continue each other in the same color into a path, simplifies it up to
+// tolerance device units and passes it to emitpath, in pieces of at most
+// maxpoints points.  The other print_ functions that are set at the time of
+// the call first flush the pending path, so the order of painting is kept.
+void preparePathPrinting(void (*emitpath)(const QVector<QPointF> &, int),
+                         double tolerance, int maxpoints);
+void finishPathPrinting();
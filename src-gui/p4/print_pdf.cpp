@@ -0,0 +1,99 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "print_pdf.hpp"
+
+#include <QMarginsF>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPen>
+
+#include "P4InputVF.hpp"
+#include "P4ParentStudy.hpp"
+#include "color.hpp"
+#include "custom.hpp"
+#include "print_bitmap.hpp"
+#include "print_paths.hpp"
+
+// the PDF viewers we know of have no limit on the number of points in a path
+#define PDF_PATH_MAXPOINTS 10000
+
+static QPdfWriter *sPDFWriter{nullptr};
+static QPainter *sPDFPainter{nullptr};
+
+// The page is painted with the functions of print_bitmap, on a QPdfWriter
+// whose resolution is the chosen one, so that the pixel coordinates of the
+// other back ends can be used.  Lines are gathered into paths first, which
+// keeps the file small.
+bool preparePDFPrinting(int w, int h, bool iszoom, bool isblackwhite,
+                        int resolution, int linewidth, int symbolwidth)
+{
+    QString title{"Phase portrait of \"" + gThisVF->getbarefilename() + "\""};
+    if (iszoom)
+        title += " (zoom window)";
+
+    sPDFWriter = new QPdfWriter{gThisVF->getbarefilename() + ".pdf"};
+    sPDFWriter->setTitle(title);
+    sPDFWriter->setCreator("P4");
+    sPDFWriter->setResolution(resolution);
+    sPDFWriter->setPageSize(QPageSize{QSizeF{w * 25.4 / resolution,
+                                             h * 25.4 / resolution},
+                                      QPageSize::Millimeter});
+    sPDFWriter->setPageMargins(QMarginsF{0, 0, 0, 0});
+
+    sPDFPainter = new QPainter{};
+    if (!sPDFPainter->begin(sPDFWriter)) {
+        delete sPDFPainter;
+        sPDFPainter = nullptr;
+        delete sPDFWriter;
+        sPDFWriter = nullptr;
+        return false;
+    }
+
+    prepareP4Printing(w, h, isblackwhite, sPDFPainter, linewidth,
+                      symbolwidth);
+
+    if (iszoom || gVFResults.typeofview_ == P4TypeOfView::typeofview_plane) {
+        QPen p{P4Colours::p4XfigColour(
+                   printColorTable(P4ColourSettings::colour_foreground)),
+               static_cast<qreal>(linewidth)};
+        sPDFPainter->setPen(p);
+        sPDFPainter->drawRect(0, 0, w, h);
+    }
+
+    preparePathPrinting(printP4Polyline, P4PRINT_PATHTOLERANCE,
+                        PDF_PATH_MAXPOINTS);
+    return true;
+}
+
+void finishPDFPrinting()
+{
+    if (sPDFPainter == nullptr)
+        return;
+
+    finishPathPrinting();
+    finishP4Printing();
+
+    sPDFPainter->end();
+    delete sPDFPainter;
+    sPDFPainter = nullptr;
+    delete sPDFWriter;
+    sPDFWriter = nullptr;
+}
@@ -60,3 +60,36 @@ extern void (*print_elips)(double, double, double, double, int, bool,
 extern void (*print_line)(double, double, double, double, int);
 extern void (*print_point)(double, double, int);
 extern void (*print_comment)(QString);
+
+// Applies F to the names of all singularity symbols above, with the print_
+// prefix stripped.  Used by back ends that wrap or record the symbols.
+#define P4PRINT_SYMBOLS(F)                                                     \
+    F(saddle)                                                                  \
+    F(virtualsaddle)                                                           \
+    F(stablenode)                                                              \
+    F(virtualstablenode)                                                       \
+    F(unstablenode)                                                            \
+    F(virtualunstablenode)                                                     \
+    F(stableweakfocus)                                                         \
+    F(virtualstableweakfocus)                                                  \
+    F(unstableweakfocus)                                                       \
+    F(virtualunstableweakfocus)                                                \
+    F(weakfocus)                                                               \
+    F(virtualweakfocus)                                                        \
+    F(stablestrongfocus)                                                       \
+    F(virtualstablestrongfocus)                                                \
+    F(unstablestrongfocus)                                                     \
+    F(virtualunstablestrongfocus)                                              \
+    F(sesaddle)                                                                \
+    F(virtualsesaddle)                                                         \
+    F(sesaddlenode)                                                            \
+    F(virtualsesaddlenode)                                                     \
+    F(sestablenode)                                                            \
+    F(virtualsestablenode)                                                     \
+    F(seunstablenode)                                                          \
+    F(virtualseunstablenode)                                                   \
+    F(degen)                                                                   \
+    F(virtualdegen)                                                            \
+    F(center)                                                                  \
+    F(virtualcenter)                                                           \
+    F(coinciding)
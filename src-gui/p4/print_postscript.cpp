@@ -30,6 +30,7 @@
 #include "math_p4.hpp"
 #include "plot_tools.hpp"
 #include "print_bitmap.hpp"
+#include "print_paths.hpp"
 #include "print_points.hpp"
 #include "structures.hpp"
 
@@ -44,9 +45,10 @@ static double sLastPSX0{0};
 static double sLastPSY0{0};
 static int sLastPSColor{0};
 
-static void ps_print_line(double x0, double y0, double x1, double y1,
-                          int color);
-// ---------------------------------------------------------------------------------------
+// PostScript level 1 interpreters limit the number of points in a path
+#define PS_PATH_MAXPOINTS 1000
+// number of points written on one line of the file
+#define PS_PATH_POINTSPERLINE 6
 
 static void ps_print_comment(QString s)
 {
@@ -660,10 +662,10 @@ static void ps_print_elips(double x0, double y0, double a, double b, int color,
             sPSFileStream << "gsave\n";
 
         if (sPSBlackWhitePrint)
-            s.sprintf("col%d\n",
-                      printColorTable(P4ColourSettings::colour_foreground));
+            sLastPSColor = P4ColourSettings::colour_foreground;
         else
-            s.sprintf("col%d\n", printColorTable(color));
+            sLastPSColor = color;
+        s.sprintf("col%d\n", printColorTable(sLastPSColor));
 
         sPSFileStream << s;
         sPSFileStream << "newpath\n";
@@ -690,49 +692,39 @@ static void ps_print_elips(double x0, double y0, double a, double b, int color,
             }
         } else {
             for (auto const &it : ellipse) {
-                ps_print_line(it.x1, it.y1, it.x2, it.y2, color);
+                print_line(it.x1, it.y1, it.x2, it.y2, color);
             }
         }
     }
 }
 
-static void ps_print_line(double x0, double y0, double x1, double y1, int color)
+// Prints a path of merged line pieces, see preparePathPrinting.  The whole
+// path is formatted first and handed to the stream at once.
+static void ps_print_path(const QVector<QPointF> &path, int color)
 {
-    if (x0 == x1 && y0 == y1)
+    QString buf, s;
+    int i;
+
+    if (sPSFile == nullptr)
         return;
 
-    if (sPSFile != nullptr) {
-        QString s;
-        if (sPSBlackWhitePrint) {
-            if (sLastPSColor == P4ColourSettings::colour_foreground) {
-                s.sprintf("%d %d moveto %d %d lineto stroke\n",
-                          static_cast<int>(std::trunc(x0)),
-                          static_cast<int>(std::trunc(y0)),
-                          static_cast<int>(std::trunc(x1)),
-                          static_cast<int>(std::trunc(y1)));
-            } else {
-                sLastPSColor = P4ColourSettings::colour_foreground;
-                s.sprintf(
-                    "%8.5g %8.5g moveto\n%8.5g %8.5g lineto col%d stroke\n", x0,
-                    y0, x1, y1,
-                    printColorTable(P4ColourSettings::colour_foreground));
-            }
-        } else {
-            if (sLastPSColor == color) {
-                s.sprintf("%d %d moveto %d %d lineto stroke\n",
-                          static_cast<int>(std::trunc(x0)),
-                          static_cast<int>(std::trunc(y0)),
-                          static_cast<int>(std::trunc(x1)),
-                          static_cast<int>(std::trunc(y1)));
-            } else {
-                sLastPSColor = color;
-                s.sprintf(
-                    "%8.5g %8.5g moveto\n%8.5g %8.5g lineto col%d stroke\n", x0,
-                    y0, x1, y1, printColorTable(color));
-            }
-        }
-        sPSFileStream << s;
+    if (sPSBlackWhitePrint)
+        color = P4ColourSettings::colour_foreground;
+
+    buf.reserve(16 * path.size() + 16);
+    if (sLastPSColor != color) {
+        sLastPSColor = color;
+        s.sprintf("col%d\n", printColorTable(color));
+        buf += s;
+    }
+    for (i = 0; i < path.size(); i++) {
+        s.sprintf("%g %g %c", path[i].x(), path[i].y(), (i == 0) ? 'm' : 'l');
+        buf += s;
+        buf += (i % PS_PATH_POINTSPERLINE == PS_PATH_POINTSPERLINE - 1) ? '\n'
+                                                                        : ' ';
     }
+    buf += "stroke\n";
+    sPSFileStream << buf;
 }
 
 static void ps_print_point(double x0, double y0, int color)
@@ -839,7 +831,6 @@ void preparePostscriptPrinting(int x0, int y0, int w, int h, bool iszoom,
     print_center = ps_print_center;
     print_elips = ps_print_elips;
     print_point = ps_print_point;
-    print_line = ps_print_line;
     print_comment = ps_print_comment;
     print_virtualsaddle = ps_print_virtualsaddle;
     print_virtualstablenode = ps_print_virtualstablenode;
@@ -941,7 +932,11 @@ void preparePostscriptPrinting(int x0, int y0, int w, int h, bool iszoom,
                          "/col28 {1.000 0.630 0.630 setrgbcolor} bind def\n"
                          "/col29 {1.000 0.750 0.750 setrgbcolor} bind def\n"
                          "/col30 {1.000 0.880 0.880 setrgbcolor} bind def\n"
-                         "/col31 {1.000 0.840 0.000 setrgbcolor} bind def\n";
+                         "/col31 {1.000 0.840 0.000 setrgbcolor} bind def\n\n";
+
+        sPSFileStream << "%% Short names for the paths of orbits and curves:\n"
+                         "/m {moveto} bind def\n"
+                         "/l {lineto} bind def\n\n";
 
         sPSFileStream << "/box{ moveto\n"
                          "SW neg 2 div SW 2 div rmoveto\n"
@@ -1061,12 +1056,18 @@ void preparePostscriptPrinting(int x0, int y0, int w, int h, bool iszoom,
 
         sPSFileStream << "\n"
                          "%% Plot the orbits\n\n"
-                         "LW setlinewidth\n";
+                         "LW setlinewidth\n"
+                         "1 setlinejoin\n";
     }
+
+    preparePathPrinting(ps_print_path, P4PRINT_PATHTOLERANCE,
+                        PS_PATH_MAXPOINTS);
 }
 
 void finishPostscriptPrinting(void)
 {
+    finishPathPrinting();
+
     if (sPSFile != nullptr) {
         sPSFileStream << "grestore\n"
                          "showpage\n"
@@ -0,0 +1,343 @@
+/*  This file is part of P4
+ *
+ *  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier
+ *                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+ *
+ *  P4 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "print_svg.hpp"
+
+#include <QFile>
+#include <QTextStream>
+
+#include "P4InputVF.hpp"
+#include "P4ParentStudy.hpp"
+#include "color.hpp"
+#include "custom.hpp"
+#include "plot_tools.hpp"
+#include "print_bitmap.hpp"
+#include "print_paths.hpp"
+#include "print_points.hpp"
+#include "structures.hpp"
+
+// an SVG polyline has no limit on the number of points; this only keeps the
+// lines of the file short enough for text editors
+#define SVG_PATH_MAXPOINTS 2000
+// number of points written on one line of the file
+#define SVG_PATH_POINTSPERLINE 8
+
+static QFile *sSVGFile{nullptr};
+static QTextStream sSVGStream;
+
+static bool sSVGBlackWhitePrint{true};
+static int sSVGLineWidth{0};
+static int sSVGSymbolWidth{0};
+
+static double sLastSVGX0{0};
+static double sLastSVGY0{0};
+static int sLastSVGColor{-1};
+
+// -----------------------------------------------------------------------
+//                      HELPERS
+// -----------------------------------------------------------------------
+
+static QString svgColor(int color)
+{
+    if (sSVGBlackWhitePrint)
+        color = P4ColourSettings::colour_foreground;
+
+    const P4Colours::P4RGBITEM &c{
+        P4Colours::gXFigToRGB[printColorTable(color)]};
+    QString s;
+    s.sprintf("#%02x%02x%02x", c.r, c.g, c.b);
+    return s;
+}
+
+static QString svgEscape(QString s)
+{
+    s.replace('&', "&amp;");
+    s.replace('<', "&lt;");
+    s.replace('>', "&gt;");
+    s.replace('"', "&quot;");
+    return s;
+}
+
+// The symbols are defined once in the <defs> section, drawn in currentColor,
+// and placed with <use>.
+static void svg_print_symbol(const char *symbol, int color, double x, double y)
+{
+    if (sSVGFile == nullptr)
+        return;
+
+    QString s;
+    s.sprintf("<use xlink:href=\"#%s\" x=\"%g\" y=\"%g\" color=\"", symbol, x,
+              y);
+    sSVGStream << s << svgColor(color) << "\"/>\n";
+}
+
+// -----------------------------------------------------------------------
+//                      SYMBOLS
+// -----------------------------------------------------------------------
+
+#define SVG_SYMBOL(name, symbol, colour)                                       \
+    static void svg_print_##name(double x, double y)                           \
+    {                                                                          \
+        svg_print_symbol(symbol, P4ColourSettings::colour, x, y);              \
+    }
+
+#define SVG_VIRTUALSYMBOL(name, symbol, colour)                                \
+    static void svg_print_##name(double x, double y)                           \
+    {                                                                          \
+        if (gVFResults.plotVirtualSingularities_)                              \
+            svg_print_symbol(symbol, P4ColourSettings::colour, x, y);          \
+    }
+
+SVG_SYMBOL(saddle, "box", colour_saddle)
+SVG_VIRTUALSYMBOL(virtualsaddle, "vbox", colour_saddle)
+SVG_SYMBOL(stablenode, "box", colour_node_stable)
+SVG_VIRTUALSYMBOL(virtualstablenode, "vbox", colour_node_stable)
+SVG_SYMBOL(unstablenode, "box", colour_node_unstable)
+SVG_VIRTUALSYMBOL(virtualunstablenode, "vbox", colour_node_unstable)
+SVG_SYMBOL(stableweakfocus, "diamond", colour_weak_focus_stable)
+SVG_VIRTUALSYMBOL(virtualstableweakfocus, "vdiamond",
+                  colour_weak_focus_stable)
+SVG_SYMBOL(unstableweakfocus, "diamond", colour_weak_focus_unstable)
+SVG_VIRTUALSYMBOL(virtualunstableweakfocus, "vdiamond",
+                  colour_weak_focus_unstable)
+SVG_SYMBOL(weakfocus, "diamond", colour_weak_focus)
+SVG_VIRTUALSYMBOL(virtualweakfocus, "vdiamond", colour_weak_focus)
+SVG_SYMBOL(stablestrongfocus, "diamond", colour_strong_focus_stable)
+SVG_VIRTUALSYMBOL(virtualstablestrongfocus, "vdiamond",
+                  colour_strong_focus_stable)
+SVG_SYMBOL(unstablestrongfocus, "diamond", colour_strong_focus_unstable)
+SVG_VIRTUALSYMBOL(virtualunstablestrongfocus, "vdiamond",
+                  colour_strong_focus_unstable)
+SVG_SYMBOL(sesaddle, "triangle", colour_saddle)
+SVG_VIRTUALSYMBOL(virtualsesaddle, "vtriangle", colour_saddle)
+SVG_SYMBOL(sesaddlenode, "triangle", colour_saddle_node)
+SVG_VIRTUALSYMBOL(virtualsesaddlenode, "vtriangle", colour_saddle_node)
+SVG_SYMBOL(sestablenode, "triangle", colour_node_stable)
+SVG_VIRTUALSYMBOL(virtualsestablenode, "vtriangle", colour_node_stable)
+SVG_SYMBOL(seunstablenode, "triangle", colour_node_unstable)
+SVG_VIRTUALSYMBOL(virtualseunstablenode, "vtriangle", colour_node_unstable)
+SVG_SYMBOL(degen, "cross", colour_degen)
+SVG_VIRTUALSYMBOL(virtualdegen, "cross", colour_degen)
+SVG_SYMBOL(center, "diamond", colour_center)
+SVG_VIRTUALSYMBOL(virtualcenter, "vdiamond", colour_center)
+SVG_SYMBOL(coinciding, "doublecross", colour_degen)
+
+// -----------------------------------------------------------------------
+//                      LINES, POINTS AND ELLIPSES
+// -----------------------------------------------------------------------
+
+static void svg_print_comment(QString s)
+{
+    if (sSVGFile != nullptr)
+        sSVGStream << "<!-- " << s.replace("--", "- -") << " -->\n";
+}
+
+// Prints a path of merged line pieces, see preparePathPrinting.  The whole
+// element is formatted first and handed to the stream at once.
+static void svg_print_path(const QVector<QPointF> &path, int color)
+{
+    QString buf, s;
+    int i;
+
+    if (sSVGFile == nullptr)
+        return;
+
+    buf.reserve(16 * path.size() + 64);
+    buf = "<polyline stroke=\"" + svgColor(color) + "\" points=\"";
+    for (i = 0; i < path.size(); i++) {
+        s.sprintf("%g,%g", path[i].x(), path[i].y());
+        buf += s;
+        if (i + 1 < path.size())
+            buf += (i % SVG_PATH_POINTSPERLINE == SVG_PATH_POINTSPERLINE - 1)
+                       ? '\n'
+                       : ' ';
+    }
+    buf += "\"/>\n";
+    sSVGStream << buf;
+}
+
+static void svg_print_point(double x0, double y0, int color)
+{
+    if (sLastSVGX0 == x0 && sLastSVGY0 == y0 && sLastSVGColor == color)
+        return; // do not print series of the same points
+
+    sLastSVGX0 = x0;
+    sLastSVGY0 = y0;
+    sLastSVGColor = color;
+
+    if (sSVGFile == nullptr)
+        return;
+
+    QString s;
+    s.sprintf("<circle cx=\"%g\" cy=\"%g\" r=\"%g\" stroke=\"none\" fill=\"",
+              x0, y0, sSVGLineWidth / 2.0);
+    sSVGStream << s << svgColor(color) << "\"/>\n";
+}
+
+// SVG clips to the view box, so the ellipse can always be drawn as a whole,
+// instead of the precompiled pieces that are visible.
+static void svg_print_elips(double x0, double y0, double a, double b,
+                            int color, bool dotted,
+                            const std::vector<P4POLYLINES> &)
+{
+    if (sSVGFile == nullptr)
+        return;
+
+    QString s;
+    s.sprintf("<ellipse cx=\"%g\" cy=\"%g\" rx=\"%g\" ry=\"%g\" ", x0, y0, a,
+              b);
+    sSVGStream << s;
+    if (dotted) {
+        s.sprintf("stroke-dasharray=\"%d\" ", sSVGLineWidth * 6);
+        sSVGStream << s;
+    }
+    sSVGStream << "stroke=\"" << svgColor(color) << "\"/>\n";
+}
+
+// -----------------------------------------------------------------------
+//                      PREPARE/FINISH
+// -----------------------------------------------------------------------
+
+void prepareSVGPrinting(int w, int h, bool iszoom, bool isblackwhite,
+                        int resolution, int linewidth, int symbolwidth)
+{
+    QString s;
+    double sw;
+
+    sSVGBlackWhitePrint = isblackwhite;
+    sSVGLineWidth = linewidth;
+    sSVGSymbolWidth = symbolwidth;
+    sLastSVGColor = -1;
+
+    if (sSVGFile != nullptr)
+        delete sSVGFile;
+    sSVGFile = new QFile{gThisVF->getbarefilename() + ".svg"};
+    if (sSVGFile->open(QIODevice::WriteOnly))
+        sSVGStream.setDevice(sSVGFile);
+    else {
+        delete sSVGFile;
+        sSVGFile = nullptr;
+    }
+
+    plot_l = spherePrintLine;
+    plot_p = spherePrintPoint;
+
+#define SVG_INSTALLSYMBOL(name) print_##name = svg_print_##name;
+    P4PRINT_SYMBOLS(SVG_INSTALLSYMBOL)
+#undef SVG_INSTALLSYMBOL
+    print_elips = svg_print_elips;
+    print_point = svg_print_point;
+    print_comment = svg_print_comment;
+
+    if (sSVGFile != nullptr) {
+        QString title{"Phase portrait of \"" + gThisVF->getbarefilename() +
+                      "\""};
+        if (iszoom)
+            title += " (zoom window)";
+
+        // one unit of the view box is one pixel at the chosen resolution
+        s.sprintf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                  "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                  "xmlns:xlink=\"http://www.w3.org/1999/xlink\"\n"
+                  "     version=\"1.1\" width=\"%gin\" height=\"%gin\" "
+                  "viewBox=\"0 0 %d %d\">\n",
+                  static_cast<double>(w) / resolution,
+                  static_cast<double>(h) / resolution, w, h);
+        sSVGStream << s;
+        sSVGStream << "<title>" << svgEscape(title) << "</title>\n";
+        sSVGStream << "<desc>Created by P4</desc>\n";
+
+        // the same shapes as the symbols of print_postscript
+        sw = sSVGSymbolWidth;
+        s.sprintf(
+            "<defs>\n"
+            "<rect id=\"box\" x=\"%g\" y=\"%g\" width=\"%g\" height=\"%g\" "
+            "fill=\"currentColor\" stroke=\"none\"/>\n"
+            "<rect id=\"vbox\" x=\"%g\" y=\"%g\" width=\"%g\" height=\"%g\" "
+            "fill=\"none\" stroke=\"currentColor\"/>\n",
+            -sw / 2, -sw / 2, sw, sw, -sw / 2, -sw / 2, sw, sw);
+        sSVGStream << s;
+        s.sprintf("<polygon id=\"diamond\" points=\"0,%g %g,0 0,%g %g,0\" "
+                  "fill=\"currentColor\" stroke=\"none\"/>\n"
+                  "<polygon id=\"vdiamond\" points=\"0,%g %g,0 0,%g %g,0\" "
+                  "fill=\"none\" stroke=\"currentColor\"/>\n",
+                  -0.65 * sw, 0.65 * sw, 0.65 * sw, -0.65 * sw, -0.65 * sw,
+                  0.65 * sw, 0.65 * sw, -0.65 * sw);
+        sSVGStream << s;
+        s.sprintf("<polygon id=\"triangle\" points=\"0,%g %g,%g %g,%g\" "
+                  "fill=\"currentColor\" stroke=\"none\"/>\n"
+                  "<polygon id=\"vtriangle\" points=\"0,%g %g,%g %g,%g\" "
+                  "fill=\"none\" stroke=\"currentColor\"/>\n",
+                  -0.6 * sw, 0.6 * sw, 0.6 * sw, -0.6 * sw, 0.6 * sw,
+                  -0.6 * sw, 0.6 * sw, 0.6 * sw, -0.6 * sw, 0.6 * sw);
+        sSVGStream << s;
+        s.sprintf("<path id=\"cross\" d=\"M%g,%gL%g,%gM%g,%gL%g,%g\" "
+                  "fill=\"none\" stroke=\"currentColor\" "
+                  "stroke-width=\"%g\"/>\n"
+                  "<path id=\"doublecross\" "
+                  "d=\"M%g,%gL%g,%gM%g,%gL%g,%gM0,%gL0,%gM%g,0L%g,0\" "
+                  "fill=\"none\" stroke=\"currentColor\" "
+                  "stroke-width=\"%g\"/>\n"
+                  "</defs>\n",
+                  -sw / 2, -sw / 2, sw / 2, sw / 2, -sw / 2, sw / 2, sw / 2,
+                  -sw / 2, 1.3 * sSVGLineWidth, -sw / 2, -sw / 2, sw / 2,
+                  sw / 2, -sw / 2, sw / 2, sw / 2, -sw / 2, -0.75 * sw,
+                  0.75 * sw, -0.75 * sw, 0.75 * sw, 1.3 * sSVGLineWidth);
+        sSVGStream << s;
+
+        if (!P4ColourSettings::print_white_bg) {
+            s.sprintf("<rect width=\"%d\" height=\"%d\" fill=\"#000000\"/>\n",
+                      w, h);
+            sSVGStream << s;
+        }
+        if (iszoom ||
+            gVFResults.typeofview_ == P4TypeOfView::typeofview_plane) {
+            s.sprintf("<rect width=\"%d\" height=\"%d\" fill=\"none\" "
+                      "stroke-width=\"1\" stroke=\"",
+                      w, h);
+            sSVGStream << s << svgColor(P4ColourSettings::colour_foreground)
+                       << "\"/>\n";
+        }
+
+        s.sprintf("<g fill=\"none\" stroke-width=\"%d\" "
+                  "stroke-linecap=\"round\" stroke-linejoin=\"round\">\n",
+                  sSVGLineWidth);
+        sSVGStream << s;
+    }
+
+    preparePathPrinting(svg_print_path, P4PRINT_PATHTOLERANCE,
+                        SVG_PATH_MAXPOINTS);
+}
+
+void finishSVGPrinting()
+{
+    finishPathPrinting();
+
+    if (sSVGFile != nullptr) {
+        sSVGStream << "</g>\n</svg>\n";
+        sSVGStream.flush();
+        sSVGStream.setDevice(nullptr);
+        sSVGFile->close();
+        delete sSVGFile;
+        sSVGFile = nullptr;
+    }
+
+    plot_l = spherePlotLine;
+    plot_p = spherePlotPoint;
+}
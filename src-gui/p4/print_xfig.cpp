@@ -30,6 +30,7 @@
 #include "main.hpp"
 #include "plot_tools.hpp"
 #include "print_bitmap.hpp"
+#include "print_paths.hpp"
 #include "print_points.hpp"
 #include "structures.hpp"
 
@@ -48,25 +49,10 @@ static int sLastXFigX0 = 0;
 static int sLastXFigY0 = 0;
 static int sLastXFigColor = -1;
 
-static bool sXFigLineBusy = false;
-static int sXFigLineLastX = 0;
-static int sXFigLineLastY = 0;
-static int sXFigLineColor = 0;
-static int sXFigLineNumPoints = 0;
-// NOTE: check if this works
-static int *sXFigLinePoints{nullptr};
-
-static void xfig_line_start(int x0, int y0, int x1, int y1, int color);
-static void xfig_line_continue(int x1, int y1);
-static void xfig_line_finish(void);
-
 // -----------------------------------------------------------------------------
 
 static void xfig_print_comment(QString s)
 {
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigFile) {
         sXFigStream << "# " << s << "\n";
     }
@@ -77,9 +63,6 @@ static void xfig_print_box(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     x *= 1200;
     x /= sXFigResolution;
     y *= 1200;
@@ -124,9 +107,6 @@ static void xfig_print_box2(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     x *= 1200;
     x /= sXFigResolution;
     y *= 1200;
@@ -152,9 +132,6 @@ static void xfig_print_diamond(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -181,9 +158,6 @@ static void xfig_print_diamond2(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -210,9 +184,6 @@ static void xfig_print_triangle(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -241,9 +212,6 @@ static void xfig_print_triangle2(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -271,9 +239,6 @@ static void xfig_print_cross(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -305,9 +270,6 @@ static void xfig_print_cross2(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -339,9 +301,6 @@ void xfig_print_doublecross(int x, int y, int color)
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     if (sXFigBlackWhitePrint)
         color = printColorTable(P4ColourSettings::colour_foreground);
 
@@ -376,44 +335,6 @@ void xfig_print_doublecross(int x, int y, int color)
     sXFigStream << s;
 }
 
-static void xfig_print_line(double _x0, double _y0, double _x1, double _y1,
-                            int color)
-{
-    if (!sXFigFile)
-        return;
-
-    _x0 *= 1200;
-    _x0 /= sXFigResolution;
-    _y0 *= 1200;
-    _y0 /= sXFigResolution;
-
-    _x1 *= 1200;
-    _x1 /= sXFigResolution;
-    _y1 *= 1200;
-    _y1 /= sXFigResolution;
-
-    color = printColorTable(color);
-    if (sXFigBlackWhitePrint)
-        color = printColorTable(P4ColourSettings::colour_foreground);
-
-    int x0{static_cast<int>(std::floor(_x0))};
-    int y0{static_cast<int>(std::floor(_y0))};
-    int x1{static_cast<int>(std::floor(_x1))};
-    int y1{static_cast<int>(std::floor(_y1))};
-    if (x0 == x1 && y0 == y1)
-        return;
-
-    if (sXFigLineBusy && sXFigLineLastX == x0 && sXFigLineLastY == y0 &&
-        sXFigLineColor == color) {
-        xfig_line_continue(x1, y1);
-    } else {
-        if (sXFigLineBusy)
-            xfig_line_finish();
-
-        xfig_line_start(x0, y0, x1, y1, color);
-    }
-}
-
 static void xfig_print_elips(double x0, double y0, double a, double b,
                              int color, bool dotted,
                              const std::vector<P4POLYLINES> &ellipse)
@@ -421,9 +342,6 @@ static void xfig_print_elips(double x0, double y0, double a, double b,
     if (!sXFigFile)
         return;
 
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     x0 *= 1200;
     x0 /= sXFigResolution;
     y0 *= 1200;
@@ -483,47 +401,15 @@ static void xfig_print_elips(double x0, double y0, double a, double b,
     } else {
         // ellipse is only partially visible, so emulate with polygon.
         for (auto const &it : ellipse) {
-            xfig_print_line(it.x1, it.y1, it.x2, it.y2, color);
+            print_line(it.x1, it.y1, it.x2, it.y2, color);
         }
     }
 }
 
-static void xfig_line_start(int x0, int y0, int x1, int y1, int color)
+// Prints a path of merged line pieces, see preparePathPrinting.  Points
+// that coincide in Fig units are dropped.
+static void xfig_print_path(const QVector<QPointF> &path, int color)
 {
-    sXFigLineBusy = true;
-    sXFigLinePoints[0] = x0;
-    sXFigLinePoints[1] = y0;
-    sXFigLinePoints[2] = x1;
-    sXFigLinePoints[3] = y1;
-    sXFigLineNumPoints = 2;
-    sXFigLineLastX = x1;
-    sXFigLineLastY = y1;
-    sXFigLineColor = color;
-}
-
-static void xfig_line_continue(int x1, int y1)
-{
-    if (sXFigLineNumPoints < XFIG_LINE_MAXPOINTS) {
-        sXFigLinePoints[2 * sXFigLineNumPoints] = sXFigLineLastX = x1;
-        sXFigLinePoints[2 * sXFigLineNumPoints + 1] = sXFigLineLastY = y1;
-        sXFigLineNumPoints++;
-    } else {
-        int x0{sXFigLineLastX};
-        int y0{sXFigLineLastY};
-        int color{sXFigLineColor};
-
-        xfig_line_finish();
-        xfig_line_start(x0, y0, x1, y1, color);
-    }
-}
-
-static void xfig_line_finish(void)
-{
-    if (!sXFigLineBusy)
-        return;
-
-    sXFigLineBusy = false;
-
     /*
         object type     2   (=polyline)
         subtype         1   (=polyline)
@@ -540,39 +426,49 @@ static void xfig_line_finish(void)
         radius          -1  (only relevant for arced boxes, irrelevant here)
         forwardarrow    0   (no arrow)
         backwardarrow   0   (no arrow)
-        npoints         2   (=2 points)
+        npoints         n
     */
 
-    int k;
+    QVector<int> pts;
+    QString buf, s;
+    int x, y, i, n;
 
-    if (sXFigFile) {
-        QString s;
-        s.sprintf("2 1 0 %d %d 7 50 0 -1 0.0 0 1 -1 0 0 %d\n   ",
-                  sXFigLineWidth / 2, sXFigLineColor, sXFigLineNumPoints);
-        sXFigStream << s;
-        for (int i = 0; i < sXFigLineNumPoints; i += 8) {
-            k = 2 * (sXFigLineNumPoints - i);
-            if (k >= 16)
-                k = 16;
-
-            for (int j = 0; j < k; j++) {
-                s.sprintf(" %d", sXFigLinePoints[2 * i + j]);
-                sXFigStream << s;
-            }
-
-            if (i + 8 < sXFigLineNumPoints)
-                sXFigStream << "\n   ";
-            else
-                sXFigStream << "\n";
-        }
+    if (!sXFigFile)
+        return;
+
+    color = printColorTable(color);
+    if (sXFigBlackWhitePrint)
+        color = printColorTable(P4ColourSettings::colour_foreground);
+
+    pts.reserve(2 * path.size());
+    for (auto const &pt : path) {
+        x = static_cast<int>(std::floor(pt.x() * 1200 / sXFigResolution));
+        y = static_cast<int>(std::floor(pt.y() * 1200 / sXFigResolution));
+        if (pts.size() > 0 && pts[pts.size() - 2] == x &&
+            pts[pts.size() - 1] == y)
+            continue;
+        pts.append(x);
+        pts.append(y);
+    }
+    n = pts.size() / 2;
+    if (n < 2)
+        return;
+
+    buf.reserve(16 * n + 64);
+    buf.sprintf("2 1 0 %d %d 7 50 0 -1 0.0 0 1 -1 0 0 %d\n   ",
+                sXFigLineWidth / 2, color, n);
+    for (i = 0; i < n; i++) {
+        s.sprintf(" %d %d", pts[2 * i], pts[2 * i + 1]);
+        buf += s;
+        if (i % 8 == 7 && i + 1 < n)
+            buf += "\n   ";
     }
+    buf += "\n";
+    sXFigStream << buf;
 }
 
 static void xfig_print_point(double _x0, double _y0, int color)
 {
-    if (sXFigLineBusy)
-        xfig_line_finish();
-
     _x0 *= 1200;
     _x0 /= sXFigResolution;
     _y0 *= 1200;
@@ -911,7 +807,6 @@ void prepareXFigPrinting(int w, int h, bool iszoom, bool isblackwhite,
     print_center = xfig_print_center;
     print_elips = xfig_print_elips;
     print_point = xfig_print_point;
-    print_line = xfig_print_line;
     print_comment = xfig_print_comment;
     print_virtualsaddle = xfig_print_virtualsaddle;
     print_virtualstablenode = xfig_print_virtualstablenode;
@@ -931,10 +826,6 @@ void prepareXFigPrinting(int w, int h, bool iszoom, bool isblackwhite,
 
     sLastXFigColor = -1;
 
-    sXFigLineBusy = false;
-    // max points *2 for x and y coords
-    sXFigLinePoints = new int[XFIG_LINE_MAXPOINTS * 2];
-
     sXFigW = w * 1200;
     sXFigW /= resolution;
     sXFigH = h * 1200;
@@ -999,10 +890,15 @@ void prepareXFigPrinting(int w, int h, bool iszoom, bool isblackwhite,
             sXFigStream << s;
         }
     }
+
+    preparePathPrinting(xfig_print_path, P4PRINT_PATHTOLERANCE,
+                        XFIG_LINE_MAXPOINTS);
 }
 
 void finishXFigPrinting(void)
 {
+    finishPathPrinting();
+
     if (sXFigFile) {
         sXFigStream.flush();
         sXFigStream.setDevice(nullptr);
@@ -1013,9 +909,4 @@ void finishXFigPrinting(void)
 
     plot_l = spherePlotLine;
     plot_p = spherePlotPoint;
-
-    if (sXFigLinePoints != nullptr) {
-        delete[] sXFigLinePoints;
-        sXFigLinePoints = nullptr;
-    }
 }
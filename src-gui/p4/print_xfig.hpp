@@ -19,7 +19,7 @@
 
 #pragma once
 
-// group line pieces together in polylines of at most this number of points.
+// line pieces are grouped in polylines of at most this number of points
 #define XFIG_LINE_MAXPOINTS 2000
 
 void prepareXFigPrinting(int w, int h, bool iszoom, bool isblackwhite,
@@ -21,6 +21,8 @@
 
 #include <vector>
 
+#include "P4TrajectoryStore.hpp"
+
 // FIXME: add deleters? smart pointers? try again using vectors/lists?
 
 // -----------------------------------------------------------------------
@@ -160,6 +162,7 @@ struct orbits {
     }
     ~orbits()
     {
+        P4TrajectoryStore::forget(&firstpt);
         if (firstpt != nullptr) {
             delete firstpt;
             firstpt = nullptr;
@@ -303,6 +306,7 @@ struct blow_up_points {
             delete vector_field[1];
             vector_field[1] = nullptr;
         }
+        P4TrajectoryStore::forget(&first_sep_point);
         if (first_sep_point != nullptr) {
             delete first_sep_point;
             first_sep_point = nullptr;
@@ -337,6 +341,7 @@ struct sep {
     }
     ~sep()
     {
+        P4TrajectoryStore::forget(&first_sep_point);
         if (first_sep_point != nullptr) {
             delete first_sep_point;
             first_sep_point = nullptr;
@@ -0,0 +1,153 @@
+#  This file is part of P4
+# 
+#  Copyright (C) 1996-2018  J.C. Artés, P. De Maesschalck, F. Dumortier,
+#                           C. Herssens, J. Llibre, O. Saleta, J. Torregrosa
+# 
+#  P4 is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU Lesser General Public License as published
+#  by the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+# 
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Lesser General Public License for more details.
+# 
+#  You should have received a copy of the GNU Lesser General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#
+# P4CORE PROJECT FILE.  Use qmake to build makefile
+#
+# Static library of everything p4, p4-render and p4-bench share: the math
+# routines, the data of the study and the printing of the plot.  It has no
+# windows: the math routines only draw on a P4Canvas and P4InputVF reports to
+# them with signals, so the library is built without the widgets module.
+# Link against it by including p4/p4core.pri.
+
+include(../../P4.pri)
+
+TEMPLATE = lib
+TARGET = p4core
+
+CONFIG += qt
+CONFIG += staticlib
+CONFIG += c++14
+
+QT += gui
+QT += concurrent
+QT -= widgets
+
+QMAKE_CXXFLAGS += -std=c++14
+
+unix {
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter
+# only the simd pragmas (P4WinTransform::coWin), not the OpenMP runtime
+QMAKE_CXXFLAGS += -fopenmp-simd
+}
+
+macx {
+    QMAKE_CXXFLAGS += -I/usr/local/opt/qt/include -I/usr/local/include
+}
+
+DESTDIR = $$BUILD_DIR/p4core/
+
+INCLUDEPATH += $$PWD/../p4
+
+SOURCES += $$PWD/../p4/color.cpp \
+    $$PWD/../p4/file_paths.cpp \
+    $$PWD/../p4/math_arbitrarycurve.cpp \
+    $$PWD/../p4/math_changedir.cpp \
+    $$PWD/../p4/math_charts.cpp \
+    $$PWD/../p4/math_desep.cpp \
+    $$PWD/../p4/math_findpoint.cpp \
+    $$PWD/../p4/math_gcf.cpp \
+    $$PWD/../p4/math_isoclines.cpp \
+    $$PWD/../p4/math_limitcycles.cpp \
+    $$PWD/../p4/math_numerics.cpp \
+    $$PWD/../p4/math_orbits.cpp \
+    $$PWD/../p4/math_p4.cpp \
+    $$PWD/../p4/math_polynom.cpp \
+    $$PWD/../p4/math_refine.cpp \
+    $$PWD/../p4/math_regions.cpp \
+    $$PWD/../p4/math_saddlesep.cpp \
+    $$PWD/../p4/math_separatingcurves.cpp \
+    $$PWD/../p4/math_separatrice.cpp \
+    $$PWD/../p4/math_sesep.cpp \
+    $$PWD/../p4/math_streamlines.cpp \
+    $$PWD/../p4/P4BandImageWriter.cpp \
+    $$PWD/../p4/P4Canvas.cpp \
+    $$PWD/../p4/P4Event.cpp \
+    $$PWD/../p4/P4InputVF.cpp \
+    $$PWD/../p4/P4IntStats.cpp \
+    $$PWD/../p4/P4ParentStudy.cpp \
+    $$PWD/../p4/P4PickIndex.cpp \
+    $$PWD/../p4/P4PlotCanvas.cpp \
+    $$PWD/../p4/P4Session.cpp \
+    $$PWD/../p4/p4settings.cpp \
+    $$PWD/../p4/P4Trace.cpp \
+    $$PWD/../p4/P4TrajectoryStore.cpp \
+    $$PWD/../p4/P4VFStudy.cpp \
+    $$PWD/../p4/P4DisplayList.cpp \
+    $$PWD/../p4/P4FlowGrid.cpp \
+    $$PWD/../p4/plot_points.cpp \
+    $$PWD/../p4/plot_tools.cpp \
+    $$PWD/../p4/print_bitmap.cpp \
+    $$PWD/../p4/print_paths.cpp \
+    $$PWD/../p4/print_pdf.cpp \
+    $$PWD/../p4/print_points.cpp \
+    $$PWD/../p4/print_postscript.cpp \
+    $$PWD/../p4/print_svg.cpp \
+    $$PWD/../p4/print_xfig.cpp
+
+HEADERS += $$PWD/../version.h \
+    $$PWD/../p4/color.hpp \
+    $$PWD/../p4/custom.hpp \
+    $$PWD/../p4/main.hpp \
+    $$PWD/../p4/file_paths.hpp \
+    $$PWD/../p4/math_arbitrarycurve.hpp \
+    $$PWD/../p4/math_changedir.hpp \
+    $$PWD/../p4/math_charts.hpp \
+    $$PWD/../p4/math_desep.hpp \
+    $$PWD/../p4/math_findpoint.hpp \
+    $$PWD/../p4/math_gcf.hpp \
+    $$PWD/../p4/math_isoclines.hpp \
+    $$PWD/../p4/math_limitcycles.hpp \
+    $$PWD/../p4/math_numerics.hpp \
+    $$PWD/../p4/math_orbits.hpp \
+    $$PWD/../p4/math_p4.hpp \
+    $$PWD/../p4/math_polynom.hpp \
+    $$PWD/../p4/math_refine.hpp \
+    $$PWD/../p4/math_regions.hpp \
+    $$PWD/../p4/math_saddlesep.hpp \
+    $$PWD/../p4/math_separatingcurves.hpp \
+    $$PWD/../p4/math_separatrice.hpp \
+    $$PWD/../p4/math_sesep.hpp \
+    $$PWD/../p4/math_streamlines.hpp \
+    $$PWD/../p4/P4BandImageWriter.hpp \
+    $$PWD/../p4/P4Canvas.hpp \
+    $$PWD/../p4/P4Event.hpp \
+    $$PWD/../p4/P4InputVF.hpp \
+    $$PWD/../p4/P4IntStats.hpp \
+    $$PWD/../p4/P4ParentStudy.hpp \
+    $$PWD/../p4/P4PickIndex.hpp \
+    $$PWD/../p4/P4PlotCanvas.hpp \
+    $$PWD/../p4/P4Session.hpp \
+    $$PWD/../p4/p4settings.hpp \
+    $$PWD/../p4/P4Trace.hpp \
+    $$PWD/../p4/P4TrajectoryStore.hpp \
+    $$PWD/../p4/P4VFStudy.hpp \
+    $$PWD/../p4/P4DisplayList.hpp \
+    $$PWD/../p4/P4FlowGrid.hpp \
+    $$PWD/../p4/plot_points.hpp \
+    $$PWD/../p4/plot_tools.hpp \
+    $$PWD/../p4/print_bitmap.hpp \
+    $$PWD/../p4/print_paths.hpp \
+    $$PWD/../p4/print_pdf.hpp \
+    $$PWD/../p4/print_points.hpp \
+    $$PWD/../p4/print_postscript.hpp \
+    $$PWD/../p4/print_svg.hpp \
+    $$PWD/../p4/print_xfig.hpp \
+    $$PWD/../p4/structures.hpp \
+    $$PWD/../p4/tables.hpp
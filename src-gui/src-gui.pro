@@ -18,4 +18,10 @@
 
 include(../P4.pri)
 TEMPLATE = subdirs
-SUBDIRS = p4 lyapunov lyapunov_mpf separatrice
+SUBDIRS = p4core p4 p4-render p4-bench lyapunov lyapunov-bench lyapunov_mpf \
+          separatrice
+
+# the programs link against the static p4core library
+p4.depends = p4core
+p4-render.depends = p4core
+p4-bench.depends = p4core